@@ -0,0 +1,24 @@
+#pragma once
+
+#define BENCHMARKS(XX)                                                         \
+  XX(list, decode)                                                             \
+  XX(name, index_lookup)                                                       \
+  XX(normalize, inplace)                                                       \
+  XX(normalize, buffer_reuse)                                                  \
+  XX(edit, change_extension)                                                   \
+  XX(edit, change_basename)                                                    \
+  XX(cover, inventory)                                                         \
+  XX(diff, inventory)                                                          \
+  XX(glob, match)                                                              \
+  XX(patternset, match)                                                        \
+  XX(pipeline, staging)                                                        \
+  XX(rebase, rule_count)                                                       \
+  XX(rollup, inventory)                                                        \
+  XX(sanitize, manifest)                                                       \
+  XX(sort, inventory)                                                          \
+  XX(table, lookup)                                                            \
+  XX(walk, tree)                                                               \
+  XX(builder, push_pop)                                                        \
+  XX(fs, resolve)                                                              \
+  XX(fs, stat_column)                                                          \
+  XX(searchpath, include)
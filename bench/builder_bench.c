@@ -0,0 +1,70 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define STEP_COUNT (1 << 22)
+#define DEPTH_MAX 12
+
+/**
+ * Walks up and down a pseudo random tree, the way a recursive traversal does.
+ * Returns whether the next step goes one level deeper.
+ */
+static bool builder_step(cpj_size_t *seed, cpj_size_t depth)
+{
+  *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return depth == 0 || (depth < DEPTH_MAX && (*seed >> 33) % 3 != 0);
+}
+
+void builder_push_pop(void)
+{
+  static const cpj_char_t *names[] = {"src", "include", "x86_64-linux-gnu",
+    "network", "test_file.c", "assets", "texture.png", "build"};
+  cpj_string_t base = {CPJ_ZSTR_ARG("/home/user/projects/cpj")};
+  cpj_string_t segments[DEPTH_MAX + 1], name;
+  cpj_size_t ends[DEPTH_MAX + 4], i, depth, seed, bytes;
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_path_builder_t builder;
+  double start;
+
+  // Every step joins the base with all names again, which is what a
+  // traversal does without a builder.
+  segments[0] = base;
+  start = cpj_bench_now();
+  for (i = 0, depth = 0, seed = 1, bytes = 0; i < STEP_COUNT; ++i) {
+    if (builder_step(&seed, depth)) {
+      ++depth;
+      segments[depth].ptr = names[(seed >> 40) % 8];
+      segments[depth].size = strlen(segments[depth].ptr);
+    } else {
+      --depth;
+    }
+    bytes += cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, segments, depth + 1, buffer, sizeof(buffer)
+    );
+  }
+  cpj_bench_report(
+    "cpj_path_join_multiple", STEP_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  cpj_path_builder_init(
+    &builder, CPJ_STYLE_UNIX, &base, buffer, sizeof(buffer), ends,
+    DEPTH_MAX + 4
+  );
+  start = cpj_bench_now();
+  for (i = 0, depth = 0, seed = 1, bytes = 0; i < STEP_COUNT; ++i) {
+    if (builder_step(&seed, depth)) {
+      ++depth;
+      name.ptr = names[(seed >> 40) % 8];
+      name.size = strlen(name.ptr);
+      cpj_path_builder_push_segment(&builder, &name);
+    } else {
+      --depth;
+      cpj_path_builder_pop_segment(&builder);
+    }
+    bytes += builder.size;
+  }
+  cpj_bench_report(
+    "cpj_path_builder_push_segment", STEP_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+  printf("  last path %s\n", builder.buffer);
+}
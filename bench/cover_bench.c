@@ -0,0 +1,60 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+
+void cover_inventory(void)
+{
+  static const cpj_size_t max_roots[] = {PATH_COUNT, 1 << 16, 1 << 12};
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_char_t *sorted_data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_string_t *roots = malloc(PATH_COUNT * sizeof(*roots));
+  cpj_size_t i, j, bytes = 0, root_count;
+  char name[64];
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *path = data + i * PATH_STRIDE;
+    cpj_string_t raw;
+    cpj_bench_path_create(i, true, path, PATH_STRIDE);
+    raw.ptr = path;
+    raw.size = strlen(path);
+    paths[i].ptr = path;
+    paths[i].size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, &raw, 1, path, PATH_STRIDE
+    );
+    // Every path gets a file of its own, so none of them covers another.
+    if (paths[i].size > 1) {
+      path[paths[i].size++] = '/';
+    }
+    paths[i].size += (cpj_size_t)snprintf(
+      path + paths[i].size, PATH_STRIDE - paths[i].size, "%zu.txt", i
+    );
+    bytes += paths[i].size;
+  }
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_DEFAULT);
+  for (i = 0, j = 0; i < PATH_COUNT; ++i) {
+    memcpy(sorted_data + j, paths[i].ptr, paths[i].size);
+    paths[i].ptr = sorted_data + j;
+    j += paths[i].size;
+  }
+
+  for (i = 0; i < sizeof(max_roots) / sizeof(*max_roots); ++i) {
+    start = cpj_bench_now();
+    root_count = cpj_path_minimal_cover(
+      CPJ_STYLE_UNIX, paths, PATH_COUNT, max_roots[i], 1.0, roots
+    );
+    snprintf(
+      name, sizeof(name), "cpj_path_minimal_cover_%zu/%zu", root_count,
+      max_roots[i]
+    );
+    cpj_bench_report(name, PATH_COUNT, bytes, cpj_bench_now() - start);
+  }
+
+  free(roots);
+  free(paths);
+  free(sorted_data);
+  free(data);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cpj.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Gets a monotonic enough timestamp in seconds for measuring a benchmark.
+ */
+static inline double cpj_bench_now(void)
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Prints the result of a single measurement. The throughput is based on the
+ * amount of input bytes which have been processed.
+ */
+static inline void cpj_bench_report(
+  const char *name, cpj_size_t operations, cpj_size_t bytes, double seconds
+)
+{
+  printf(
+    "  %-36s %10.2f ns/op %10.2f MB/s\n", name,
+    seconds * 1e9 / (double)operations, (double)bytes / seconds / 1e6
+  );
+}
+
+/**
+ * Fills `buffer` with a pseudo random path which contains the usual noise
+ * seen in real world paths, like `.` and `..` segments and double separators.
+ * Returns the size of the generated path.
+ */
+static inline cpj_size_t cpj_bench_path_create(
+  cpj_size_t seed, bool absolute, cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  static const char *segments[] = {
+    "usr", "lib", "x86_64-linux-gnu", "..", ".", "", "include", "src",
+    "network", "test_file.c", "assets", "texture.png", "build", "out",
+  };
+  cpj_size_t segment_count = 4 + seed % 8;
+  cpj_size_t size = 0;
+  cpj_size_t i;
+
+  if (absolute) {
+    buffer[size++] = '/';
+  }
+  for (i = 0; i < segment_count; ++i) {
+    const char *segment;
+    cpj_size_t segment_size;
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    segment = segments[(seed >> 33) % (sizeof(segments) / sizeof(*segments))];
+    segment_size = strlen(segment);
+    if (size + segment_size + 2 >= buffer_size) {
+      break;
+    }
+    if (i > 0) {
+      buffer[size++] = '/';
+    }
+    memcpy(buffer + size, segment, segment_size);
+    size += segment_size;
+  }
+  buffer[size] = '\0';
+  return size;
+}
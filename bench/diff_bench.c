@@ -0,0 +1,138 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+
+/**
+ * Builds a column from every path of a sorted list except the ones which
+ * are dropped by `skip`.
+ */
+static cpj_string_column_t diff_column_create(
+  const cpj_string_t *paths, cpj_size_t count, cpj_size_t skip,
+  cpj_char_t *data, cpj_size_t *offsets
+)
+{
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  column.count = 0;
+  offsets[0] = 0;
+  for (i = 0; i < count; ++i) {
+    if (i % 64 == skip) {
+      continue;
+    }
+    memcpy(data + offsets[column.count], paths[i].ptr, paths[i].size);
+    offsets[column.count + 1] = offsets[column.count] + paths[i].size;
+    ++column.count;
+  }
+  column.data = data;
+  column.offsets = offsets;
+  return column;
+}
+
+/**
+ * Merges two columns by comparing the raw bytes, which is the lower bound
+ * for any merge of sorted lists.
+ */
+static cpj_size_t diff_merge_memcmp(
+  const cpj_string_column_t *old_paths, const cpj_string_column_t *new_paths
+)
+{
+  cpj_size_t i = 0, j = 0, changes = 0;
+  while (i < old_paths->count && j < new_paths->count) {
+    cpj_size_t old_size = old_paths->offsets[i + 1] - old_paths->offsets[i];
+    cpj_size_t new_size = new_paths->offsets[j + 1] - new_paths->offsets[j];
+    int result = memcmp(
+      old_paths->data + old_paths->offsets[i],
+      new_paths->data + new_paths->offsets[j],
+      old_size < new_size ? old_size : new_size
+    );
+    if (result == 0 && old_size != new_size) {
+      result = old_size < new_size ? -1 : 1;
+    }
+    if (result <= 0) {
+      ++i;
+    }
+    if (result >= 0) {
+      ++j;
+    }
+    changes += result != 0;
+  }
+  return changes + old_paths->count - i + new_paths->count - j;
+}
+
+void diff_inventory(void)
+{
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_char_t *old_data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_char_t *new_data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_size_t *old_offsets = malloc((PATH_COUNT + 1) * sizeof(*old_offsets));
+  cpj_size_t *new_offsets = malloc((PATH_COUNT + 1) * sizeof(*new_offsets));
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_string_column_t old_paths, new_paths;
+  cpj_path_diff_t diff;
+  cpj_path_diff_entry_t entry;
+  cpj_size_t i, count = 0, bytes, changes;
+  double start;
+
+  // Both inventories are sorted lists of unique paths, each of them misses a
+  // different share of the paths.
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *path = data + i * PATH_STRIDE;
+    cpj_string_t raw;
+    cpj_bench_path_create(i, true, path, PATH_STRIDE);
+    raw.ptr = path;
+    raw.size = strlen(path);
+    paths[i].ptr = path;
+    paths[i].size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, &raw, 1, path, PATH_STRIDE
+    );
+  }
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_DEFAULT);
+  for (i = 0; i < PATH_COUNT; ++i) {
+    if (count == 0 || paths[i].size != paths[count - 1].size ||
+        memcmp(paths[i].ptr, paths[count - 1].ptr, paths[i].size) != 0) {
+      paths[count++] = paths[i];
+    }
+  }
+  old_paths = diff_column_create(paths, count, 0, old_data, old_offsets);
+  new_paths = diff_column_create(paths, count, 1, new_data, new_offsets);
+  bytes = old_offsets[old_paths.count] + new_offsets[new_paths.count];
+
+  start = cpj_bench_now();
+  changes = diff_merge_memcmp(&old_paths, &new_paths);
+  cpj_bench_report("merge_memcmp", count, bytes, cpj_bench_now() - start);
+
+  start = cpj_bench_now();
+  cpj_path_diff_sorted(
+    &diff, CPJ_STYLE_UNIX, &old_paths, &new_paths, CPJ_DIFF_DEFAULT
+  );
+  while (cpj_path_diff_next(&diff, &entry)) {
+    changes += entry.type != CPJ_DIFF_COMMON;
+  }
+  cpj_bench_report("cpj_path_diff", count, bytes, cpj_bench_now() - start);
+
+  start = cpj_bench_now();
+  cpj_path_diff_sorted(
+    &diff, CPJ_STYLE_UNIX, &old_paths, &new_paths,
+    CPJ_DIFF_COLLAPSE | CPJ_DIFF_SKIP_COMMON
+  );
+  while (cpj_path_diff_next(&diff, &entry)) {
+    changes += entry.count;
+  }
+  cpj_bench_report(
+    "cpj_path_diff_collapse", count, bytes, cpj_bench_now() - start
+  );
+
+  if (changes == 0) {
+    printf("  no changes found\n");
+  }
+
+  free(paths);
+  free(new_offsets);
+  free(old_offsets);
+  free(new_data);
+  free(old_data);
+  free(data);
+}
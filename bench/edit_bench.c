@@ -0,0 +1,108 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT 4096
+#define ROUND_COUNT 128
+#define PATH_STRIDE 256
+
+static cpj_char_t *paths_create(cpj_size_t *sizes, cpj_size_t *bytes)
+{
+  cpj_char_t *paths = malloc(PATH_COUNT * PATH_STRIDE);
+  cpj_size_t i;
+
+  *bytes = 0;
+  for (i = 0; i < PATH_COUNT; ++i) {
+    sizes[i] = cpj_bench_path_create(
+      i, i % 2 == 0, paths + i * PATH_STRIDE, PATH_STRIDE
+    );
+    *bytes += sizes[i];
+  }
+  *bytes *= ROUND_COUNT;
+  return paths;
+}
+
+void edit_change_extension(void)
+{
+  static cpj_size_t sizes[PATH_COUNT];
+  cpj_string_t extension = {".ktx2", 5};
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t i, round, bytes;
+  cpj_char_t *paths = paths_create(sizes, &bytes);
+  double start;
+
+  // A buffer which is only just large enough takes the route which looks up
+  // the extension and joins the path with it afterwards. The results are not
+  // compared, since that route loses the root of paths like `/a/..`.
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      cpj_path_change_extension(
+        CPJ_STYLE_UNIX, &path, &extension, buffer,
+        path.size + extension.size + 3
+      );
+    }
+  }
+  cpj_bench_report(
+    "change_extension_join", PATH_COUNT * ROUND_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      cpj_path_change_extension(
+        CPJ_STYLE_UNIX, &path, &extension, buffer, sizeof(buffer)
+      );
+    }
+  }
+  cpj_bench_report(
+    "change_extension_fused", PATH_COUNT * ROUND_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+
+  free(paths);
+}
+
+void edit_change_basename(void)
+{
+  static cpj_size_t sizes[PATH_COUNT];
+  cpj_string_t basename = {"basename.txt", 12};
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t i, round, bytes;
+  cpj_char_t *paths = paths_create(sizes, &bytes);
+  double start;
+
+  // The same applies to the basename, where a buffer which is only just large
+  // enough takes the route which joins the path with the new basename.
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      cpj_path_change_basename(
+        CPJ_STYLE_UNIX, &path, &basename, buffer, path.size + basename.size + 2
+      );
+    }
+  }
+  cpj_bench_report(
+    "change_basename_join", PATH_COUNT * ROUND_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      cpj_path_change_basename(
+        CPJ_STYLE_UNIX, &path, &basename, buffer, sizeof(buffer)
+      );
+    }
+  }
+  cpj_bench_report(
+    "change_basename_fused", PATH_COUNT * ROUND_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+
+  free(paths);
+}
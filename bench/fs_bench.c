@@ -0,0 +1,194 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <ftw.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FS_DIRECTORY_COUNT 10
+#define FS_FILE_COUNT 100
+#define FS_PATH_COUNT (1 << 17)
+
+/**
+ * Creates directories full of files, along with a symbolic link to each
+ * directory.
+ */
+static bool fs_tree_create(char *root)
+{
+  char path[256], target[32];
+  int i, j, fd;
+
+  strcpy(root, "/tmp/cpj_fs_bench_XXXXXX");
+  if (!mkdtemp(root)) {
+    return false;
+  }
+  for (i = 0; i < FS_DIRECTORY_COUNT; ++i) {
+    snprintf(path, sizeof(path), "%s/directory_%d", root, i);
+    if (mkdir(path, 0700) != 0) {
+      return false;
+    }
+    for (j = 0; j < FS_FILE_COUNT; ++j) {
+      snprintf(path, sizeof(path), "%s/directory_%d/file_%d.c", root, i, j);
+      fd = open(path, O_WRONLY | O_CREAT, 0600);
+      if (fd < 0) {
+        return false;
+      }
+      close(fd);
+    }
+    snprintf(path, sizeof(path), "%s/link_%d", root, i);
+    snprintf(target, sizeof(target), "directory_%d", i);
+    if (symlink(target, path) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int fs_tree_remove_entry(
+  const char *path, const struct stat *status, int flag, struct FTW *ftw
+)
+{
+  (void)status;
+  (void)flag;
+  (void)ftw;
+  return remove(path);
+}
+#endif
+
+void fs_resolve(void)
+{
+#ifndef _WIN32
+  char root[64], path[256], buffer[PATH_MAX];
+  cpj_fs_cache_t cache;
+  cpj_string_t string;
+  cpj_size_t i, seed, bytes, size;
+  void *storage;
+  double start;
+
+  if (!fs_tree_create(root)) {
+    printf("  could not create %s\n", root);
+    return;
+  }
+
+  // Every path goes through a link and back up again, so each prefix needs
+  // to be looked at.
+  start = cpj_bench_now();
+  for (i = 0, seed = 1, bytes = 0; i < FS_PATH_COUNT; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    snprintf(path, sizeof(path), "%s/link_%d/../link_%d/file_%d.c", root,
+      (int)((seed >> 33) % FS_DIRECTORY_COUNT),
+      (int)((seed >> 40) % FS_DIRECTORY_COUNT),
+      (int)((seed >> 47) % FS_FILE_COUNT));
+    bytes += realpath(path, buffer) ? strlen(path) : 0;
+  }
+  cpj_bench_report("realpath", FS_PATH_COUNT, bytes, cpj_bench_now() - start);
+
+  storage = malloc(cpj_fs_cache_storage_size(4096, 1 << 18));
+  cpj_fs_cache_init(&cache, storage, 4096, 1 << 18);
+  start = cpj_bench_now();
+  for (i = 0, seed = 1, bytes = 0; i < FS_PATH_COUNT; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    size = (cpj_size_t)snprintf(path, sizeof(path),
+      "%s/link_%d/../link_%d/file_%d.c", root,
+      (int)((seed >> 33) % FS_DIRECTORY_COUNT),
+      (int)((seed >> 40) % FS_DIRECTORY_COUNT),
+      (int)((seed >> 47) % FS_FILE_COUNT));
+    string.ptr = path;
+    string.size = size;
+    if (cpj_fs_resolve(&cache, &string, buffer, sizeof(buffer)) > 0) {
+      bytes += size;
+    }
+  }
+  cpj_bench_report(
+    "cpj_fs_resolve", FS_PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+  printf("  %zu probes for %d paths\n", cache.probe_count, FS_PATH_COUNT);
+  free(storage);
+
+  nftw(root, fs_tree_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+#else
+  printf("  cpj_fs_resolve is not supported on Windows\n");
+#endif
+}
+
+void fs_stat_column(void)
+{
+#ifndef _WIN32
+  static cpj_char_t data[FS_DIRECTORY_COUNT * FS_FILE_COUNT * 64];
+  static cpj_size_t offsets[FS_DIRECTORY_COUNT * FS_FILE_COUNT + 1];
+  static long long mtimes[FS_DIRECTORY_COUNT * FS_FILE_COUNT];
+  cpj_fs_stat_column_t results = {NULL, NULL, NULL, mtimes};
+  cpj_string_column_t column = {data, offsets, 0};
+  cpj_size_t i, j, round, found_count;
+  struct stat status;
+  char root[64], path[256];
+  double start;
+
+  if (!fs_tree_create(root)) {
+    printf("  could not create %s\n", root);
+    return;
+  }
+
+  // The paths are sorted, the way a normalized and sorted list would be. The
+  // strings of a column are not terminated, so stat gets a copy of each.
+  offsets[0] = 0;
+  for (i = 0; i < FS_DIRECTORY_COUNT; ++i) {
+    for (j = 0; j < FS_FILE_COUNT; ++j, ++column.count) {
+      offsets[column.count + 1] =
+        offsets[column.count] +
+        (cpj_size_t)sprintf(data + offsets[column.count],
+          "%s/directory_%d/file_%d.c", root, (int)i, (int)j);
+    }
+  }
+
+  start = cpj_bench_now();
+  for (round = 0, found_count = 0; round < 100; ++round) {
+    for (i = 0; i < column.count; ++i) {
+      memcpy(path, data + offsets[i], offsets[i + 1] - offsets[i]);
+      path[offsets[i + 1] - offsets[i]] = '\0';
+      found_count += stat(path, &status) == 0;
+    }
+  }
+  cpj_bench_report(
+    "stat", found_count, offsets[column.count] * 100, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0, found_count = 0; round < 100; ++round) {
+    found_count += cpj_fs_stat_column(&column, CPJ_FS_STAT_DEFAULT, &results);
+  }
+  cpj_bench_report(
+    "cpj_fs_stat_column", found_count, offsets[column.count] * 100,
+    cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0, found_count = 0; round < 100; ++round) {
+    found_count += cpj_fs_stat_column(&column, CPJ_FS_STAT_NO_RING, &results);
+  }
+  cpj_bench_report(
+    "cpj_fs_stat_column (fstatat)", found_count, offsets[column.count] * 100,
+    cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0, found_count = 0; round < 100; ++round) {
+    found_count += cpj_fs_stat_column(&column, CPJ_FS_STAT_PARALLEL, &results);
+  }
+  cpj_bench_report(
+    "cpj_fs_stat_column (parallel)", found_count, offsets[column.count] * 100,
+    cpj_bench_now() - start
+  );
+
+  nftw(root, fs_tree_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+#else
+  printf("  cpj_fs_stat_column is not supported on Windows\n");
+#endif
+}
@@ -0,0 +1,74 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 18)
+#define PATH_STRIDE 128
+
+void glob_match(void)
+{
+  static const cpj_char_t *patterns[] = {"**/test_file.c", "usr/**/*.png",
+    "/usr/lib/**/include/*", "**/src/**/[a-n]*"};
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_char_t buffer[PATH_STRIDE];
+  cpj_glob_segment_t segments[16];
+  cpj_glob_t globs[sizeof(patterns) / sizeof(*patterns)];
+  cpj_string_t pattern, normalized;
+  cpj_size_t i, j, bytes = 0, matched = 0, expected = 0;
+  const cpj_size_t glob_count = sizeof(globs) / sizeof(*globs);
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    paths[i].ptr = data + i * PATH_STRIDE;
+    paths[i].size = cpj_bench_path_create(
+      i, i % 2 == 0, data + i * PATH_STRIDE, PATH_STRIDE
+    );
+    bytes += paths[i].size;
+  }
+
+  // The segments of all globs share one buffer, since they are only read.
+  for (i = 0, j = 0; i < glob_count; ++i) {
+    pattern.ptr = patterns[i];
+    pattern.size = strlen(patterns[i]);
+    j += cpj_glob_compile(
+      globs + i, CPJ_STYLE_UNIX, &pattern, segments + j,
+      sizeof(segments) / sizeof(*segments) - j
+    );
+  }
+
+  // Without matching normalized segments every path would have to be
+  // normalized into a buffer first.
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; ++i) {
+    normalized.ptr = buffer;
+    normalized.size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, paths + i, 1, buffer, sizeof(buffer)
+    );
+    for (j = 0; j < glob_count; ++j) {
+      expected += cpj_glob_match(globs + j, &normalized);
+    }
+  }
+  cpj_bench_report(
+    "normalize and cpj_glob_match", PATH_COUNT * glob_count,
+    bytes * glob_count, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; ++i) {
+    for (j = 0; j < glob_count; ++j) {
+      matched += cpj_glob_match(globs + j, paths + i);
+    }
+  }
+  cpj_bench_report(
+    "cpj_glob_match", PATH_COUNT * glob_count, bytes * glob_count,
+    cpj_bench_now() - start
+  );
+
+  printf("  %zu of %zu paths matched\n", matched, PATH_COUNT * glob_count);
+  if (matched != expected) {
+    printf("  but %zu matched after normalizing\n", expected);
+  }
+
+  free(paths);
+  free(data);
+}
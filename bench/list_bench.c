@@ -0,0 +1,81 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+#define RESTART_INTERVAL 16
+
+void list_decode(void)
+{
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_char_t *list_data, previous[PATH_STRIDE], buffer[PATH_STRIDE];
+  cpj_path_list_writer_t writer;
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t i, bytes = 0, decoded = 0, found = 0, capacity, size;
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *buffer_path = data + i * PATH_STRIDE;
+    cpj_string_t raw;
+    cpj_bench_path_create(i, true, buffer_path, PATH_STRIDE);
+    raw.ptr = buffer_path;
+    raw.size = strlen(buffer_path);
+    paths[i].ptr = buffer_path;
+    paths[i].size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, &raw, 1, buffer_path, PATH_STRIDE
+    );
+    bytes += paths[i].size;
+  }
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_DEFAULT);
+
+  capacity = bytes + PATH_COUNT * 4;
+  list_data = malloc(capacity);
+  start = cpj_bench_now();
+  cpj_path_list_writer_init(
+    &writer, CPJ_STYLE_UNIX, RESTART_INTERVAL, list_data, capacity, previous,
+    sizeof(previous)
+  );
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_path_list_writer_add(&writer, paths + i);
+  }
+  size = cpj_path_list_writer_finish(&writer);
+  cpj_bench_report(
+    "cpj_path_list_writer_add", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  // The throughput of the reader is based on the decoded paths, not on the
+  // size of the list.
+  cpj_path_list_open(&list, list_data, size);
+  cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer));
+  start = cpj_bench_now();
+  while (cpj_path_list_next(&reader, &path)) {
+    decoded += path.size;
+  }
+  cpj_bench_report(
+    "cpj_path_list_next", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; i += 97) {
+    found += cpj_path_list_find(&reader, paths + i) <= i;
+  }
+  cpj_bench_report(
+    "cpj_path_list_find", (PATH_COUNT + 96) / 97, bytes / 97,
+    cpj_bench_now() - start
+  );
+
+  printf(
+    "  %zu bytes of paths stored in %zu bytes (%.1f%%)\n", bytes, size,
+    (double)size * 100.0 / (double)bytes
+  );
+  if (decoded != bytes || found != (PATH_COUNT + 96) / 97) {
+    printf("  wrong result %zu of %zu bytes\n", decoded, bytes);
+  }
+
+  free(list_data);
+  free(paths);
+  free(data);
+}
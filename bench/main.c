@@ -0,0 +1,53 @@
+#include "benchmarks.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * This is just a small macro which calculates the size of an array.
+ */
+#define CPJ_ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+struct cpj_benchmark
+{
+  const char *unit_name;
+  const char *benchmark_name;
+  void (*fn)(void);
+};
+
+#define XX(u, t) extern void u##_##t(void);
+BENCHMARKS(XX)
+#undef XX
+
+static struct cpj_benchmark benchmarks[] = {
+#define XX(u, t) {.unit_name = #u, .benchmark_name = #t, .fn = u##_##t},
+  BENCHMARKS(XX)
+#undef XX
+};
+
+int main(int argc, char *argv[])
+{
+  size_t i, count;
+  struct cpj_benchmark *benchmark;
+
+  count = 0;
+  for (i = 0; i < CPJ_ARRAY_SIZE(benchmarks); ++i) {
+    benchmark = &benchmarks[i];
+    if (argc >= 2 && strcmp(benchmark->unit_name, argv[1]) != 0) {
+      continue;
+    }
+    if (argc >= 3 && strcmp(benchmark->benchmark_name, argv[2]) != 0) {
+      continue;
+    }
+    printf("%s/%s\n", benchmark->unit_name, benchmark->benchmark_name);
+    benchmark->fn();
+    ++count;
+  }
+
+  if (count == 0) {
+    printf("No benchmarks found.\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
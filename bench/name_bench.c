@@ -0,0 +1,110 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+
+void name_index_lookup(void)
+{
+  static const cpj_char_t *extensions[] = {".c", ".png", ".h"};
+  static const cpj_char_t *basenames[] = {"test_file.c", "include", "missing"};
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_size_t *offsets = malloc((PATH_COUNT + 1) * sizeof(*offsets));
+  cpj_size_t *storage = malloc(
+    cpj_name_index_storage_size(PATH_COUNT) * sizeof(*storage)
+  );
+  const cpj_size_t *positions;
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+  cpj_string_t path, name, extension;
+  cpj_size_t i, j, scanned = 0, found = 0;
+  double start;
+
+  offsets[0] = 0;
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t raw[PATH_STRIDE];
+    path.ptr = raw;
+    path.size = cpj_bench_path_create(i, i % 2 == 0, raw, sizeof(raw));
+    offsets[i + 1] = offsets[i] + cpj_path_join_multiple(
+                                    CPJ_STYLE_UNIX, false, true, &path, 1,
+                                    data + offsets[i], PATH_STRIDE
+                                  );
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = PATH_COUNT;
+
+  start = cpj_bench_now();
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_DEFAULT
+  );
+  cpj_bench_report(
+    "cpj_name_index_build", PATH_COUNT, offsets[PATH_COUNT],
+    cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_PARALLEL
+  );
+  cpj_bench_report(
+    "cpj_name_index_build (parallel)", PATH_COUNT, offsets[PATH_COUNT],
+    cpj_bench_now() - start
+  );
+
+  // Scanning every path is what a lookup costs without an index.
+  start = cpj_bench_now();
+  for (i = 0; i < sizeof(extensions) / sizeof(*extensions); ++i) {
+    cpj_size_t size = strlen(extensions[i]);
+    for (j = 0; j < PATH_COUNT; ++j) {
+      path.ptr = data + offsets[j];
+      path.size = offsets[j + 1] - offsets[j];
+      scanned += cpj_path_get_extension(CPJ_STYLE_UNIX, &path, &extension) &&
+                 extension.size == size &&
+                 memcmp(extension.ptr, extensions[i], size) == 0;
+    }
+  }
+  cpj_bench_report(
+    "extension scan", sizeof(extensions) / sizeof(*extensions),
+    offsets[PATH_COUNT] * 3, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < 1000; ++i) {
+    name.ptr = extensions[i % 3];
+    name.size = strlen(name.ptr);
+    found += cpj_name_index_find(
+      &index, CPJ_NAME_EXTENSION, &name, &positions
+    );
+  }
+  cpj_bench_report(
+    "cpj_name_index_find (extension)", 1000, 0, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < 1000000; ++i) {
+    name.ptr = basenames[i % 3];
+    name.size = strlen(name.ptr);
+    cpj_name_index_find(&index, CPJ_NAME_BASENAME, &name, &positions);
+  }
+  cpj_bench_report(
+    "cpj_name_index_find (basename)", 1000000, 0, cpj_bench_now() - start
+  );
+
+  // Every lookup returns the same paths as the scan did.
+  for (i = 0, found = 0; i < sizeof(extensions) / sizeof(*extensions); ++i) {
+    name.ptr = extensions[i];
+    name.size = strlen(name.ptr);
+    found += cpj_name_index_find(
+      &index, CPJ_NAME_EXTENSION, &name, &positions
+    );
+  }
+  printf("  %zu paths with one of the extensions\n", scanned);
+  if (found != scanned) {
+    printf("  but %zu paths found in the index\n", found);
+  }
+
+  free(storage);
+  free(offsets);
+  free(data);
+}
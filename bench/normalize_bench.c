@@ -0,0 +1,121 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT 4096
+#define ROUND_COUNT 256
+#define PATH_STRIDE 256
+
+static cpj_char_t *paths_create(cpj_size_t *sizes)
+{
+  cpj_char_t *paths = malloc(PATH_COUNT * PATH_STRIDE);
+  cpj_size_t i;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    sizes[i] = cpj_bench_path_create(
+      i, i % 2 == 0, paths + i * PATH_STRIDE, PATH_STRIDE
+    );
+  }
+  return paths;
+}
+
+void normalize_inplace(void)
+{
+  static cpj_size_t sizes[PATH_COUNT];
+  cpj_char_t *paths = paths_create(sizes);
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t i, round, bytes = 0, checksum = 0;
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    bytes += sizes[i];
+  }
+  bytes *= ROUND_COUNT;
+
+  // The path is joined with an empty path, which takes the generic route of
+  // generating the path at the tail of the buffer and moving it to the head.
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path_list[2];
+      memcpy(buffer, paths + i * PATH_STRIDE, sizes[i] + 1);
+      path_list[0].ptr = buffer;
+      path_list[0].size = sizes[i];
+      path_list[1].ptr = "";
+      path_list[1].size = 0;
+      checksum += cpj_path_join_multiple(
+        CPJ_STYLE_UNIX, false, true, path_list, 2, buffer, sizeof(buffer)
+      );
+    }
+  }
+  cpj_bench_report(
+    "join_multiple_tail", PATH_COUNT * ROUND_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      memcpy(buffer, paths + i * PATH_STRIDE, sizes[i] + 1);
+      checksum -= cpj_path_normalize_inplace(
+        CPJ_STYLE_UNIX, buffer, sizes[i], sizeof(buffer)
+      );
+    }
+  }
+  cpj_bench_report(
+    "normalize_inplace", PATH_COUNT * ROUND_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+
+  if (checksum != 0) {
+    printf("  results differ\n");
+  }
+  free(paths);
+}
+
+void normalize_buffer_reuse(void)
+{
+  static const cpj_char_t *segments[] = {"see", "dog", "..", "cat", ".", "..", ".."};
+  cpj_size_t segment_count = sizeof(segments) / sizeof(*segments);
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t i, size, operations = PATH_COUNT * ROUND_COUNT, bytes = 0;
+  double start;
+
+  // This is the pattern of the buffer_reuse test in absolute_test.c, the
+  // buffer is both the base path and the output.
+  strcpy(buffer, "/");
+  start = cpj_bench_now();
+  for (i = 0; i < operations; ++i) {
+    cpj_string_t path_list[2];
+    path_list[0].ptr = buffer;
+    path_list[0].size = strlen(buffer);
+    path_list[1].ptr = segments[i % segment_count];
+    path_list[1].size = strlen(path_list[1].ptr);
+    bytes += path_list[0].size + path_list[1].size;
+    cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, true, true, path_list, 2, buffer, sizeof(buffer)
+    );
+  }
+  cpj_bench_report(
+    "join_multiple", operations, bytes, cpj_bench_now() - start
+  );
+
+  // The segment is appended to the buffer, which is normalized in place.
+  strcpy(buffer, "/");
+  size = 1;
+  bytes = 0;
+  start = cpj_bench_now();
+  for (i = 0; i < operations; ++i) {
+    const cpj_char_t *segment = segments[i % segment_count];
+    cpj_size_t segment_size = strlen(segment);
+    buffer[size] = '/';
+    memcpy(buffer + size + 1, segment, segment_size);
+    size += segment_size + 1;
+    bytes += size;
+    size = cpj_path_normalize_inplace(
+      CPJ_STYLE_UNIX, buffer, size, sizeof(buffer)
+    );
+  }
+  cpj_bench_report(
+    "append_normalize_inplace", operations, bytes, cpj_bench_now() - start
+  );
+}
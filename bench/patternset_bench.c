@@ -0,0 +1,104 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATTERN_COUNT 2048
+#define PATTERN_STRIDE 32
+#define PATH_COUNT (1 << 18)
+#define PATH_STRIDE 128
+#define SCAN_COUNT (1 << 10)
+
+void patternset_match(void)
+{
+  cpj_char_t *pattern_data = malloc(PATTERN_COUNT * PATTERN_STRIDE);
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_string_t *patterns = malloc(PATTERN_COUNT * sizeof(*patterns));
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_pattern_rule_t *rules = malloc(PATTERN_COUNT * sizeof(*rules));
+  cpj_glob_segment_t *segments = malloc(4 * PATTERN_COUNT * sizeof(*segments));
+  cpj_glob_t *globs = malloc(PATTERN_COUNT * sizeof(*globs));
+  cpj_size_t i, j, bytes = 0, ignored = 0, segment_count;
+  cpj_patternset_t set;
+  double start;
+
+  // Most patterns of large ignore files are basenames and extensions, but a
+  // few of them are anchored or use wildcards.
+  for (i = 0; i < PATTERN_COUNT; ++i) {
+    cpj_char_t *pattern = pattern_data + i * PATTERN_STRIDE;
+    switch (i % 8) {
+    case 0:
+      sprintf(pattern, "/out/gen_%zu/", i);
+      break;
+    case 1:
+      sprintf(pattern, "*.ext%zu", i);
+      break;
+    case 2:
+      sprintf(pattern, "tmp_%zu_*", i);
+      break;
+    case 3:
+      sprintf(pattern, "!keep_%zu", i);
+      break;
+    default:
+      sprintf(pattern, "name_%zu", i);
+      break;
+    }
+    patterns[i].ptr = pattern;
+    patterns[i].size = strlen(pattern);
+  }
+  patterns[PATTERN_COUNT - 1].ptr = "texture.png";
+  patterns[PATTERN_COUNT - 1].size = strlen("texture.png");
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    paths[i].ptr = data + i * PATH_STRIDE;
+    paths[i].size = cpj_bench_path_create(
+      i, false, data + i * PATH_STRIDE, PATH_STRIDE
+    );
+    bytes += paths[i].size;
+  }
+
+  start = cpj_bench_now();
+  segment_count = cpj_patternset_compile(
+    &set, CPJ_STYLE_UNIX, patterns, PATTERN_COUNT, rules, segments,
+    4 * PATTERN_COUNT
+  );
+  cpj_bench_report(
+    "cpj_patternset_compile", PATTERN_COUNT, 0, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; ++i) {
+    ignored += cpj_patternset_match(&set, paths + i, false) ==
+               CPJ_PATTERN_IGNORED;
+  }
+  cpj_bench_report(
+    "cpj_patternset_match", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+  printf("  %zu of %d paths ignored\n", ignored, PATH_COUNT);
+
+  // Matching the rules one by one costs a glob match per pattern. The rules
+  // of the set already hold the compiled globs, which keeps this loop simple.
+  for (i = 0; i < set.rule_count; ++i) {
+    globs[i] = rules[i].glob;
+  }
+  start = cpj_bench_now();
+  for (i = 0, ignored = 0; i < SCAN_COUNT; ++i) {
+    for (j = set.rule_count; j > 0; --j) {
+      if (cpj_glob_match(globs + j - 1, paths + i)) {
+        ++ignored;
+        break;
+      }
+    }
+  }
+  cpj_bench_report(
+    "cpj_glob_match for every pattern", SCAN_COUNT, bytes / PATH_COUNT *
+    SCAN_COUNT, cpj_bench_now() - start
+  );
+  printf("  %zu segments compiled\n", segment_count);
+
+  free(globs);
+  free(segments);
+  free(rules);
+  free(paths);
+  free(patterns);
+  free(data);
+  free(pattern_data);
+}
@@ -0,0 +1,80 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT 4096
+#define ROUND_COUNT 64
+#define PATH_STRIDE 256
+
+static const cpj_pipeline_stage_t stages[] = {
+  {CPJ_PIPELINE_NORMALIZE, {"", 0}},
+  {CPJ_PIPELINE_CHANGE_ROOT, {"/build/out/tree", 15}},
+  {CPJ_PIPELINE_CHANGE_EXTENSION, {".ktx2", 5}},
+  {CPJ_PIPELINE_GET_RELATIVE, {"/build/out", 10}},
+};
+
+void pipeline_staging(void)
+{
+  static cpj_size_t sizes[PATH_COUNT];
+  cpj_pipeline_t pipeline = {
+    CPJ_STYLE_UNIX, {"/", 1}, stages, sizeof(stages) / sizeof(*stages)
+  };
+  cpj_char_t *paths = malloc(PATH_COUNT * PATH_STRIDE);
+  cpj_char_t buffer[FILENAME_MAX], step[FILENAME_MAX];
+  cpj_size_t i, round, bytes = 0, checksum = 0;
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    sizes[i] = cpj_bench_path_create(
+      i, false, paths + i * PATH_STRIDE, PATH_STRIDE
+    );
+    bytes += sizes[i];
+  }
+  bytes *= ROUND_COUNT;
+
+  // Every stage is a separate call, which parses the result of the previous
+  // stage again.
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      cpj_size_t size = cpj_path_join_multiple(
+        CPJ_STYLE_UNIX, false, true, &path, 1, buffer, sizeof(buffer)
+      );
+      path.ptr = buffer;
+      path.size = size;
+      size = cpj_path_change_root(
+        CPJ_STYLE_UNIX, &path, &stages[1].argument, step, sizeof(step)
+      );
+      path.ptr = step;
+      path.size = size;
+      size = cpj_path_change_extension(
+        CPJ_STYLE_UNIX, &path, &stages[2].argument, buffer, sizeof(buffer)
+      );
+      path.ptr = buffer;
+      path.size = size;
+      checksum += cpj_path_get_relative(
+        CPJ_STYLE_UNIX, &pipeline.cwd_directory, &stages[3].argument, &path,
+        step, sizeof(step)
+      );
+    }
+  }
+  cpj_bench_report(
+    "stepwise", PATH_COUNT * ROUND_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      checksum -= cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+    }
+  }
+  cpj_bench_report(
+    "pipeline_run", PATH_COUNT * ROUND_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  if (checksum != 0) {
+    printf("  results differ\n");
+  }
+  free(paths);
+}
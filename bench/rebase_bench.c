@@ -0,0 +1,85 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT 4096
+#define ROUND_COUNT 16
+#define PATH_STRIDE 256
+#define RULE_MAX 4096
+#define PREFIX_STRIDE 32
+
+/**
+ * Rebases the same paths with `rule_count` rules, each path starts with the
+ * old prefix of one of the rules.
+ */
+static void rebase_run(
+  const char *name, cpj_size_t rule_count, cpj_rebase_rule_t *rules,
+  cpj_char_t *prefixes, cpj_char_t *paths, cpj_size_t *sizes
+)
+{
+  cpj_rebase_slot_t *slots = malloc(2 * RULE_MAX * sizeof(*slots));
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t i, round, bytes = 0, checksum = 0;
+  cpj_rebase_t rebase;
+  double start;
+
+  for (i = 0; i < rule_count; ++i) {
+    cpj_char_t *prefix = prefixes + i * PREFIX_STRIDE;
+    rules[i].from_style = CPJ_STYLE_UNIX;
+    rules[i].from_prefix.ptr = prefix;
+    rules[i].from_prefix.size = (cpj_size_t)sprintf(
+      prefix, "/ws/job%u/src", (unsigned)i
+    );
+    rules[i].to_style = CPJ_STYLE_UNIX;
+    rules[i].to_prefix.ptr = "/src";
+    rules[i].to_prefix.size = 4;
+  }
+  cpj_rebase_init(&rebase, rules, rule_count, slots, 2 * RULE_MAX);
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *path = paths + i * PATH_STRIDE;
+    cpj_size_t size = (cpj_size_t)sprintf(
+      path, "/ws/job%u/src/", (unsigned)(i % rule_count)
+    );
+    sizes[i] = size + cpj_bench_path_create(
+                        i, false, path + size, PATH_STRIDE - size
+                      );
+    bytes += sizes[i];
+  }
+  bytes *= ROUND_COUNT;
+
+  start = cpj_bench_now();
+  for (round = 0; round < ROUND_COUNT; ++round) {
+    for (i = 0; i < PATH_COUNT; ++i) {
+      cpj_string_t path = {paths + i * PATH_STRIDE, sizes[i]};
+      checksum += cpj_path_rebase(
+        &rebase, CPJ_STYLE_UNIX, &path, buffer, sizeof(buffer)
+      );
+    }
+  }
+  cpj_bench_report(
+    name, PATH_COUNT * ROUND_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  if (checksum == 0) {
+    printf("  no paths have been rebased\n");
+  }
+  free(slots);
+}
+
+void rebase_rule_count(void)
+{
+  static cpj_size_t sizes[PATH_COUNT];
+  cpj_rebase_rule_t *rules = malloc(RULE_MAX * sizeof(*rules));
+  cpj_char_t *prefixes = malloc(RULE_MAX * PREFIX_STRIDE);
+  cpj_char_t *paths = malloc(PATH_COUNT * PATH_STRIDE);
+
+  // The lookup takes one probe per segment of the path, so the time per path
+  // should stay the same no matter how many rules there are.
+  rebase_run("rules_4", 4, rules, prefixes, paths, sizes);
+  rebase_run("rules_64", 64, rules, prefixes, paths, sizes);
+  rebase_run("rules_4096", RULE_MAX, rules, prefixes, paths, sizes);
+
+  free(paths);
+  free(prefixes);
+  free(rules);
+}
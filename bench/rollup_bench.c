@@ -0,0 +1,79 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+
+void rollup_inventory(void)
+{
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_char_t *sorted_data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_char_t buffer[PATH_STRIDE];
+  cpj_rollup_level_t levels[PATH_STRIDE];
+  cpj_rollup_t rollup;
+  cpj_string_t directory;
+  unsigned long long value, total = 0;
+  cpj_size_t i, j, bytes = 0, separators = 0, directories = 0;
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *path = data + i * PATH_STRIDE;
+    cpj_string_t raw;
+    cpj_bench_path_create(i, true, path, PATH_STRIDE);
+    raw.ptr = path;
+    raw.size = strlen(path);
+    paths[i].ptr = path;
+    paths[i].size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, &raw, 1, path, PATH_STRIDE
+    );
+    bytes += paths[i].size;
+  }
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_DEFAULT);
+
+  // An inventory is read front to back, so the sorted paths are packed.
+  for (i = 0, j = 0; i < PATH_COUNT; ++i) {
+    memcpy(sorted_data + j, paths[i].ptr, paths[i].size);
+    paths[i].ptr = sorted_data + j;
+    j += paths[i].size;
+  }
+
+  // Looking at every character once is the lower bound for any rollup.
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; ++i) {
+    for (j = 0; j < paths[i].size; ++j) {
+      separators += paths[i].ptr[j] == '/';
+    }
+  }
+  cpj_bench_report(
+    "separator_scan", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  cpj_rollup_init(
+    &rollup, CPJ_STYLE_UNIX, buffer, sizeof(buffer), levels,
+    sizeof(levels) / sizeof(*levels)
+  );
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_path_rollup(&rollup, paths + i, paths[i].size);
+    while (cpj_rollup_next(&rollup, &directory, &value)) {
+      ++directories;
+    }
+  }
+  cpj_rollup_finish(&rollup);
+  while (cpj_rollup_next(&rollup, &directory, &value)) {
+    ++directories;
+    total = value;
+  }
+  cpj_bench_report(
+    "cpj_path_rollup", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  if (total != bytes || separators == 0) {
+    printf("  wrong total %llu of %zu directories\n", total, directories);
+  }
+
+  free(paths);
+  free(sorted_data);
+  free(data);
+}
@@ -0,0 +1,111 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define ENTRY_COUNT 10000000
+#define BATCH_COUNT 4096
+#define PATH_STRIDE 256
+
+/**
+ * Builds a batch of a synthetic archive manifest. Every 64th entry tries to
+ * climb out of the destination.
+ */
+static cpj_size_t sanitize_batch_create(
+  cpj_size_t first, cpj_char_t *data, cpj_size_t *offsets
+)
+{
+  cpj_size_t i;
+  offsets[0] = 0;
+  for (i = 0; i < BATCH_COUNT; ++i) {
+    cpj_char_t *entry = data + offsets[i];
+    cpj_size_t size = 0;
+    if ((first + i) % 64 == 0) {
+      memcpy(entry, "../", 3);
+      size = 3;
+    }
+    size += cpj_bench_path_create(
+      first + i, false, entry + size, PATH_STRIDE - size
+    );
+    offsets[i + 1] = offsets[i] + size;
+  }
+  return offsets[BATCH_COUNT];
+}
+
+void sanitize_manifest(void)
+{
+  static cpj_size_t offsets[BATCH_COUNT + 1], result_offsets[BATCH_COUNT + 1];
+  static cpj_sanitize_status_t statuses[BATCH_COUNT];
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {"/srv/extract", 12}};
+  cpj_char_t *data = malloc(BATCH_COUNT * PATH_STRIDE);
+  cpj_char_t *results;
+  cpj_char_t buffer[FILENAME_MAX], step[FILENAME_MAX];
+  cpj_size_t i, first, bytes = 0, checksum = 0, results_size;
+  cpj_string_column_t column = {data, offsets, BATCH_COUNT};
+  double start, seconds;
+
+  // The manifest is generated batch by batch, the time to do that is not part
+  // of the measurement.
+  seconds = 0;
+  for (first = 0; first < ENTRY_COUNT; first += BATCH_COUNT) {
+    bytes += sanitize_batch_create(first, data, offsets);
+    start = cpj_bench_now();
+    for (i = 0; i < BATCH_COUNT; ++i) {
+      cpj_string_t paths[2] = {{"/srv/extract", 12}, {data + offsets[i], 0}};
+      cpj_size_t size;
+      paths[1].size = offsets[i + 1] - offsets[i];
+      if (cpj_path_get_root(CPJ_STYLE_UNIX, paths[1].ptr) > 0) {
+        continue;
+      }
+      size = cpj_path_join_multiple(
+        CPJ_STYLE_UNIX, false, true, paths + 1, 1, step, sizeof(step)
+      );
+      if (size >= 2 && step[0] == '.' && step[1] == '.' &&
+          (size == 2 || step[2] == '/')) {
+        continue;
+      }
+      checksum += cpj_path_join_multiple(
+        CPJ_STYLE_UNIX, false, true, paths, 2, buffer, sizeof(buffer)
+      );
+    }
+    seconds += cpj_bench_now() - start;
+  }
+  cpj_bench_report("normalize_then_join", ENTRY_COUNT, bytes, seconds);
+
+  seconds = 0;
+  for (first = 0; first < ENTRY_COUNT; first += BATCH_COUNT) {
+    sanitize_batch_create(first, data, offsets);
+    start = cpj_bench_now();
+    for (i = 0; i < BATCH_COUNT; ++i) {
+      cpj_string_t entry = {data + offsets[i], offsets[i + 1] - offsets[i]};
+      cpj_size_t size;
+      if (cpj_sanitizer_run(
+            &sanitizer, &entry, buffer, sizeof(buffer), &size
+          ) == CPJ_SANITIZE_OK) {
+        checksum -= size;
+      }
+    }
+    seconds += cpj_bench_now() - start;
+  }
+  cpj_bench_report("sanitizer_run", ENTRY_COUNT, bytes, seconds);
+
+  // Enough room for any batch, which is what the upper bound of a batch would
+  // return at most.
+  results_size =
+    BATCH_COUNT * (PATH_STRIDE + sanitizer.destination.size + 1) + 1;
+  results = malloc(results_size);
+  seconds = 0;
+  for (first = 0; first < ENTRY_COUNT; first += BATCH_COUNT) {
+    sanitize_batch_create(first, data, offsets);
+    start = cpj_bench_now();
+    cpj_sanitizer_run_column(
+      &sanitizer, &column, results, results_size, result_offsets, statuses
+    );
+    seconds += cpj_bench_now() - start;
+  }
+  cpj_bench_report("sanitizer_run_column", ENTRY_COUNT, bytes, seconds);
+
+  if (checksum != 0) {
+    printf("  results differ\n");
+  }
+  free(results);
+  free(data);
+}
@@ -0,0 +1,140 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SEARCHPATH_DIRECTORY_COUNT 8
+#define SEARCHPATH_FILE_COUNT 200
+#define SEARCHPATH_LOOKUP_COUNT (1 << 18)
+#define SEARCHPATH_NAME_COUNT                                                  \
+  (SEARCHPATH_DIRECTORY_COUNT * SEARCHPATH_FILE_COUNT * 5 / 4)
+
+/**
+ * Creates include directories, where each one holds its own headers. The
+ * names looked up are spread over all of them, and some are not found.
+ */
+static bool searchpath_tree_create(char *root)
+{
+  char path[256];
+  int i, j, fd;
+
+  strcpy(root, "/tmp/cpj_searchpath_bench_XXXXXX");
+  if (!mkdtemp(root)) {
+    return false;
+  }
+  for (i = 0; i < SEARCHPATH_DIRECTORY_COUNT; ++i) {
+    snprintf(path, sizeof(path), "%s/include_%d", root, i);
+    if (mkdir(path, 0700) != 0) {
+      return false;
+    }
+    for (j = 0; j < SEARCHPATH_FILE_COUNT; ++j) {
+      snprintf(path, sizeof(path), "%s/include_%d/header_%d.h", root, i,
+        i * SEARCHPATH_FILE_COUNT + j);
+      fd = open(path, O_WRONLY | O_CREAT, 0600);
+      if (fd < 0) {
+        return false;
+      }
+      close(fd);
+    }
+  }
+  return true;
+}
+
+static int searchpath_tree_remove_entry(
+  const char *path, const struct stat *status, int flag, struct FTW *ftw
+)
+{
+  (void)status;
+  (void)flag;
+  (void)ftw;
+  return remove(path);
+}
+#endif
+
+void searchpath_include(void)
+{
+#ifdef __linux__
+  char root[64], directories[SEARCHPATH_DIRECTORY_COUNT][64], name[32];
+  cpj_string_t strings[SEARCHPATH_DIRECTORY_COUNT], pair[2], string;
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t i, j, seed, bytes, found_count;
+  cpj_searchpath_t searchpath;
+  struct stat status;
+  void *storage;
+  double start;
+
+  if (!searchpath_tree_create(root)) {
+    printf("  could not create %s\n", root);
+    return;
+  }
+  for (i = 0; i < SEARCHPATH_DIRECTORY_COUNT; ++i) {
+    strings[i].ptr = directories[i];
+    strings[i].size = (cpj_size_t)snprintf(directories[i],
+      sizeof(directories[i]), "%s/include_%d", root, (int)i);
+  }
+
+  // Without a search path every directory is joined with the name and
+  // probed in turn.
+  start = cpj_bench_now();
+  for (i = 0, seed = 1, bytes = 0, found_count = 0;
+       i < SEARCHPATH_LOOKUP_COUNT; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    pair[1].size = (cpj_size_t)snprintf(name, sizeof(name), "header_%d.h",
+      (int)((seed >> 33) % SEARCHPATH_NAME_COUNT));
+    pair[1].ptr = name;
+    bytes += pair[1].size;
+    for (j = 0; j < SEARCHPATH_DIRECTORY_COUNT; ++j) {
+      pair[0] = strings[j];
+      cpj_path_join_multiple(
+        CPJ_STYLE_UNIX, false, true, pair, 2, buffer, sizeof(buffer)
+      );
+      if (stat(buffer, &status) == 0) {
+        ++found_count;
+        break;
+      }
+    }
+  }
+  cpj_bench_report(
+    "join + stat", SEARCHPATH_LOOKUP_COUNT, bytes, cpj_bench_now() - start
+  );
+  printf("  %zu found\n", found_count);
+
+  storage = malloc(cpj_searchpath_storage_size(
+    SEARCHPATH_DIRECTORY_COUNT, 4096, 1 << 16
+  ));
+  cpj_searchpath_init(
+    &searchpath, strings, SEARCHPATH_DIRECTORY_COUNT, storage, 4096, 1 << 16
+  );
+  start = cpj_bench_now();
+  for (i = 0, seed = 1, bytes = 0, found_count = 0;
+       i < SEARCHPATH_LOOKUP_COUNT; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    string.size = (cpj_size_t)snprintf(name, sizeof(name), "header_%d.h",
+      (int)((seed >> 33) % SEARCHPATH_NAME_COUNT));
+    string.ptr = name;
+    bytes += string.size;
+    found_count +=
+      cpj_searchpath_find(&searchpath, &string, buffer, sizeof(buffer)) > 0;
+  }
+  cpj_bench_report(
+    "cpj_searchpath_find", SEARCHPATH_LOOKUP_COUNT, bytes,
+    cpj_bench_now() - start
+  );
+  printf(
+    "  %zu found, %zu directories listed\n", found_count, searchpath.list_count
+  );
+  free(storage);
+
+  nftw(root, searchpath_tree_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+#else
+  printf("  cpj_searchpath_find is only supported on Linux\n");
+#endif
+}
@@ -0,0 +1,93 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+
+static int sort_compare_strcmp(const void *a, const void *b)
+{
+  return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/**
+ * Compares two normalized unix paths segment by segment, which is the order
+ * cpj_path_sort produces for absolute paths.
+ */
+static int sort_compare_segments(const void *a, const void *b)
+{
+  const unsigned char *first = *(const unsigned char *const *)a;
+  const unsigned char *second = *(const unsigned char *const *)b;
+  while (*first && *first == *second) {
+    ++first;
+    ++second;
+  }
+  if (*first == *second) {
+    return 0;
+  } else if (*first == '\0' || *second == '\0') {
+    return *first == '\0' ? -1 : 1;
+  } else if (*first == '/' || *second == '/') {
+    return *first == '/' ? -1 : 1;
+  }
+  return *first < *second ? -1 : 1;
+}
+
+void sort_inventory(void)
+{
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_char_t **strings = malloc(PATH_COUNT * sizeof(*strings));
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_size_t i, bytes = 0;
+  double start;
+
+  // The inventory is normalized up front, which both sorts need.
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *path = data + i * PATH_STRIDE;
+    cpj_string_t raw;
+    cpj_bench_path_create(i, true, path, PATH_STRIDE);
+    raw.ptr = path;
+    raw.size = strlen(path);
+    bytes += cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, &raw, 1, path, PATH_STRIDE
+    );
+  }
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    strings[i] = data + i * PATH_STRIDE;
+  }
+  start = cpj_bench_now();
+  qsort(strings, PATH_COUNT, sizeof(*strings), sort_compare_strcmp);
+  cpj_bench_report("qsort_strcmp", PATH_COUNT, bytes, cpj_bench_now() - start);
+
+  // The strcmp order is not the segment order, a fair comparison needs a
+  // comparator which ranks the separator first.
+  for (i = 0; i < PATH_COUNT; ++i) {
+    strings[i] = data + i * PATH_STRIDE;
+  }
+  start = cpj_bench_now();
+  qsort(strings, PATH_COUNT, sizeof(*strings), sort_compare_segments);
+  cpj_bench_report(
+    "qsort_segments", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    paths[i].ptr = data + i * PATH_STRIDE;
+    paths[i].size = strlen(paths[i].ptr);
+  }
+  start = cpj_bench_now();
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_DEFAULT);
+  cpj_bench_report("cpj_path_sort", PATH_COUNT, bytes, cpj_bench_now() - start);
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    paths[i].ptr = data + i * PATH_STRIDE;
+    paths[i].size = strlen(paths[i].ptr);
+  }
+  start = cpj_bench_now();
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_PARALLEL);
+  cpj_bench_report(
+    "cpj_path_sort_parallel", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  free(paths);
+  free(strings);
+  free(data);
+}
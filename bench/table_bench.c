@@ -0,0 +1,106 @@
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#define PATH_COUNT (1 << 20)
+#define PATH_STRIDE 128
+
+void table_lookup(void)
+{
+  cpj_char_t *data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_string_t *paths = malloc(PATH_COUNT * sizeof(*paths));
+  cpj_size_t *offsets = malloc((PATH_COUNT + 1) * sizeof(*offsets));
+  cpj_char_t *column_data = malloc((cpj_size_t)PATH_COUNT * PATH_STRIDE);
+  cpj_char_t *table_data, buffer[PATH_STRIDE];
+  cpj_string_column_t column;
+  cpj_path_index_t index;
+  cpj_path_table_t table;
+  cpj_size_t i, bytes = 0, found = 0, size, position;
+  double start;
+
+  for (i = 0; i < PATH_COUNT; ++i) {
+    cpj_char_t *path = data + i * PATH_STRIDE;
+    cpj_string_t raw;
+    cpj_bench_path_create(i, true, path, PATH_STRIDE);
+    raw.ptr = path;
+    raw.size = strlen(path);
+    paths[i].ptr = path;
+    paths[i].size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, &raw, 1, path, PATH_STRIDE
+    );
+    bytes += paths[i].size;
+  }
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, PATH_COUNT, CPJ_SORT_DEFAULT);
+
+  start = cpj_bench_now();
+  size = cpj_path_table_build(CPJ_STYLE_UNIX, paths, PATH_COUNT, NULL, 0);
+  table_data = malloc(size);
+  cpj_path_table_build(CPJ_STYLE_UNIX, paths, PATH_COUNT, table_data, size);
+  cpj_bench_report(
+    "cpj_path_table_build", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  // Opening the table only reads its header, no matter how large it is.
+  start = cpj_bench_now();
+  for (i = 0; i < 1000; ++i) {
+    found += cpj_path_table_open(&table, table_data, size);
+  }
+  cpj_bench_report("cpj_path_table_open", 1000, 0, cpj_bench_now() - start);
+
+  // The sorted index needs a column of the paths, which has to be rebuilt
+  // from a manifest whenever it is loaded.
+  start = cpj_bench_now();
+  offsets[0] = 0;
+  for (i = 0; i < PATH_COUNT; ++i) {
+    memcpy(column_data + offsets[i], paths[i].ptr, paths[i].size);
+    offsets[i + 1] = offsets[i] + paths[i].size;
+  }
+  column.data = column_data;
+  column.offsets = offsets;
+  column.count = PATH_COUNT;
+  cpj_path_index_init(&index, CPJ_STYLE_UNIX, &column);
+  cpj_bench_report(
+    "cpj_path_index_init", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; ++i) {
+    found += cpj_path_index_lookup(&index, paths + i, &position);
+  }
+  cpj_bench_report(
+    "cpj_path_index_lookup", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; ++i) {
+    found += cpj_path_table_lookup(
+      &table, paths + i, buffer, sizeof(buffer), &position
+    );
+  }
+  cpj_bench_report(
+    "cpj_path_table_lookup", PATH_COUNT, bytes, cpj_bench_now() - start
+  );
+
+  start = cpj_bench_now();
+  for (i = 0; i < PATH_COUNT; i += 97) {
+    found += cpj_path_table_descendants_of(
+               &table, paths + i, buffer, sizeof(buffer), &position
+             ) > 0;
+  }
+  cpj_bench_report(
+    "cpj_path_table_descendants_of", (PATH_COUNT + 96) / 97, bytes / 97,
+    cpj_bench_now() - start
+  );
+
+  printf(
+    "  %zu bytes of paths stored in a table of %zu bytes\n", bytes, size
+  );
+  if (found < 1000 + 2 * PATH_COUNT) {
+    printf("  only %zu paths found\n", found);
+  }
+
+  free(table_data);
+  free(column_data);
+  free(offsets);
+  free(paths);
+  free(data);
+}
@@ -0,0 +1,145 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_bench.h"
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WALK_ROOT "/tmp/cpj_walk_bench"
+#define WALK_TOP_COUNT 100
+#define WALK_SUB_COUNT 10
+#define WALK_FILE_COUNT 1000
+
+static atomic_size_t walk_entry_count;
+static atomic_size_t walk_byte_count;
+
+/**
+ * Creates a tree of about a million files, unless an earlier run already did.
+ * The marker is created last, so an interrupted run starts over.
+ */
+static bool walk_tree_create(void)
+{
+  char path[256];
+  int i, j, k, fd;
+
+  if (access(WALK_ROOT "/complete", F_OK) == 0) {
+    return true;
+  }
+  mkdir(WALK_ROOT, 0700);
+  for (i = 0; i < WALK_TOP_COUNT; ++i) {
+    snprintf(path, sizeof(path), WALK_ROOT "/top_%d", i);
+    mkdir(path, 0700);
+    for (j = 0; j < WALK_SUB_COUNT; ++j) {
+      snprintf(path, sizeof(path), WALK_ROOT "/top_%d/sub_%d", i, j);
+      mkdir(path, 0700);
+      for (k = 0; k < WALK_FILE_COUNT; ++k) {
+        snprintf(path, sizeof(path), WALK_ROOT "/top_%d/sub_%d/file_%d.c", i,
+          j, k);
+        fd = open(path, O_WRONLY | O_CREAT, 0600);
+        if (fd < 0) {
+          return false;
+        }
+        close(fd);
+      }
+    }
+  }
+  fd = open(WALK_ROOT "/complete", O_WRONLY | O_CREAT, 0600);
+  if (fd < 0) {
+    return false;
+  }
+  close(fd);
+  return true;
+}
+
+static int walk_nftw_entry(
+  const char *path, const struct stat *status, int flag, struct FTW *ftw
+)
+{
+  (void)status;
+  (void)flag;
+  (void)ftw;
+  atomic_fetch_add_explicit(&walk_entry_count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(
+    &walk_byte_count, strlen(path), memory_order_relaxed
+  );
+  return 0;
+}
+
+static bool walk_count(
+  void *context, const cpj_walk_entry_t *entries, cpj_size_t entry_count
+)
+{
+  cpj_size_t i, bytes = 0;
+
+  (void)context;
+  for (i = 0; i < entry_count; ++i) {
+    bytes += entries[i].path.size;
+  }
+  atomic_fetch_add_explicit(
+    &walk_entry_count, entry_count, memory_order_relaxed
+  );
+  atomic_fetch_add_explicit(&walk_byte_count, bytes, memory_order_relaxed);
+  return true;
+}
+
+static void walk_run(const char *name, const cpj_walk_t *walk)
+{
+  void *storage = malloc(cpj_walk_storage_size(walk));
+  double start;
+
+  atomic_store(&walk_entry_count, 0);
+  atomic_store(&walk_byte_count, 0);
+  start = cpj_bench_now();
+  cpj_walk(walk, WALK_ROOT, storage);
+  cpj_bench_report(
+    name, atomic_load(&walk_entry_count), atomic_load(&walk_byte_count),
+    cpj_bench_now() - start
+  );
+  free(storage);
+}
+#endif
+
+void walk_tree(void)
+{
+#ifdef __linux__
+  cpj_walk_t walk = {0};
+  double start;
+
+  if (!walk_tree_create()) {
+    printf("  could not create " WALK_ROOT "\n");
+    return;
+  }
+
+  // The first walk only warms up the caches of the file system.
+  walk.callback = walk_count;
+  walk_run("cpj_walk (warm-up)", &walk);
+
+  atomic_store(&walk_entry_count, 0);
+  atomic_store(&walk_byte_count, 0);
+  start = cpj_bench_now();
+  nftw(WALK_ROOT, walk_nftw_entry, 64, FTW_PHYS);
+  cpj_bench_report(
+    "nftw", atomic_load(&walk_entry_count), atomic_load(&walk_byte_count),
+    cpj_bench_now() - start
+  );
+
+  walk_run("cpj_walk", &walk);
+
+  walk.flags = CPJ_WALK_PARALLEL;
+  walk.thread_count = (cpj_size_t)sysconf(_SC_NPROCESSORS_ONLN);
+  walk_run("cpj_walk (parallel)", &walk);
+  printf(
+    "  %zu entries with %zu threads\n", atomic_load(&walk_entry_count),
+    walk.thread_count
+  );
+#else
+  printf("  cpj_walk is only supported on Linux\n");
+#endif
+}
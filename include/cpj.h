@@ -47,6 +47,20 @@ typedef struct
   cpj_size_t size; /**< size of the string, excluding '\0' terminator */
 } cpj_string_t;
 
+/**
+ * Description of a column of strings which are stored back to back, using the
+ * offsets + data layout of Apache Arrow string arrays. The string at index `i`
+ * starts at `data + offsets[i]` and is `offsets[i + 1] - offsets[i]`
+ * characters long, so `offsets` holds `count + 1` entries. The strings are not
+ * required to be zero-terminated.
+ */
+typedef struct
+{
+  const cpj_char_t *data;    /**< characters of all the strings */
+  const cpj_size_t *offsets; /**< `count + 1` offsets into `data` */
+  cpj_size_t count;          /**< number of strings in the column */
+} cpj_string_column_t;
+
 typedef struct
 {
   cpj_size_t segment_count_base;
@@ -64,6 +78,533 @@ typedef enum
   CPJ_STYLE_UNIX
 } cpj_path_style_t;
 
+/**
+ * @brief Determines the rewrite which a stage of a pipeline applies to a path.
+ */
+typedef enum
+{
+  CPJ_PIPELINE_NORMALIZE,        /**< no argument */
+  CPJ_PIPELINE_CHANGE_ROOT,      /**< argument is the new root */
+  CPJ_PIPELINE_CHANGE_EXTENSION, /**< argument is the new extension */
+  CPJ_PIPELINE_GET_RELATIVE      /**< argument is the base directory */
+} cpj_pipeline_stage_type_t;
+
+/**
+ * Description of a single stage of a pipeline.
+ */
+typedef struct
+{
+  cpj_pipeline_stage_type_t type;
+  cpj_string_t argument; /**< argument of the rewrite, if needed */
+} cpj_pipeline_stage_t;
+
+/**
+ * Description of a pipeline, which applies its stages in order to a path. The
+ * stages behave like the cpj function of the same name, but the path is only
+ * parsed once and the result is only written once.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_t cwd_directory; /**< only used by CPJ_PIPELINE_GET_RELATIVE */
+  const cpj_pipeline_stage_t *stages; /**< `stage_count` stages in order */
+  cpj_size_t stage_count;
+} cpj_pipeline_t;
+
+/**
+ * The maximum number of segments a path may have within a pipeline.
+ */
+#define CPJ_PIPELINE_SEGMENT_MAX 128
+
+/**
+ * The maximum number of levels of directories cpj_path_minimal_cover may
+ * choose from, counting the root as the first one.
+ */
+#define CPJ_COVER_LEVEL_MAX 128
+
+/**
+ * Description of a rule which moves the paths below an old prefix to a new
+ * prefix. The old prefix is compared using `from_style`, and the rebased path
+ * is written using `to_style`.
+ */
+typedef struct
+{
+  cpj_path_style_t from_style;
+  cpj_string_t from_prefix;
+  cpj_path_style_t to_style;
+  cpj_string_t to_prefix;
+} cpj_rebase_rule_t;
+
+/**
+ * A slot of the hash table which is used to look up the rules of a rebase.
+ */
+typedef struct
+{
+  const cpj_rebase_rule_t *rule; /**< NULL if the slot is empty */
+  cpj_size_t hash;
+  cpj_size_t component_count;
+} cpj_rebase_slot_t;
+
+/**
+ * Description of a rebase, which is set up with cpj_rebase_init.
+ */
+typedef struct
+{
+  const cpj_rebase_rule_t *rules;
+  cpj_size_t rule_count;
+  cpj_rebase_slot_t *slots; /**< `slot_count` slots, a power of two */
+  cpj_size_t slot_count;
+  cpj_size_t max_component_count; /**< of all the old prefixes */
+  cpj_size_t max_prefix_size;     /**< of all the new prefixes */
+} cpj_rebase_t;
+
+/**
+ * The verdict of the sanitizer on an archive entry name.
+ */
+typedef enum
+{
+  CPJ_SANITIZE_OK,
+  CPJ_SANITIZE_ABSOLUTE, /**< the name has a root, like `/a` or `C:a` */
+  CPJ_SANITIZE_ESCAPE,   /**< the name climbs above the destination */
+  CPJ_SANITIZE_INVALID,  /**< the name contains a '\0' character */
+  CPJ_SANITIZE_TOO_LONG  /**< the output path does not fit into the buffer */
+} cpj_sanitize_status_t;
+
+/**
+ * Description of a sanitizer, which checks archive entry names and places
+ * them below a destination directory. All the names use the same style.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_t destination; /**< written as it is, should be normalized */
+} cpj_sanitizer_t;
+
+/**
+ * Flags which change how cpj_path_sort sorts a list of paths.
+ */
+typedef enum
+{
+  CPJ_SORT_DEFAULT = 0,
+  CPJ_SORT_PARALLEL = 1 /**< use multiple threads, if cpj has been built
+                             with thread support */
+} cpj_sort_flags_t;
+
+/**
+ * A sorted list of paths which can be searched, set up with
+ * cpj_path_index_init. The index only refers to the column, so the column may
+ * point into a mapped file.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_column_t paths; /**< normalized and sorted by cpj_path_sort */
+} cpj_path_index_t;
+
+/**
+ * Determines how a path differs between two sorted lists of paths.
+ */
+typedef enum
+{
+  CPJ_DIFF_REMOVED, /**< only in the old list */
+  CPJ_DIFF_ADDED,   /**< only in the new list */
+  CPJ_DIFF_COMMON   /**< in both lists */
+} cpj_diff_type_t;
+
+/**
+ * Flags which change how cpj_path_diff_sorted reports the differences.
+ */
+typedef enum
+{
+  CPJ_DIFF_DEFAULT = 0,
+  CPJ_DIFF_COLLAPSE = 1,   /**< report removed or added subtrees at once */
+  CPJ_DIFF_SKIP_COMMON = 2 /**< do not report the common paths */
+} cpj_diff_flags_t;
+
+/**
+ * A difference between two sorted lists of paths.
+ */
+typedef struct
+{
+  cpj_diff_type_t type;
+  cpj_string_t path;   /**< points into one of the columns */
+  cpj_size_t position; /**< of the first path within its column */
+  cpj_size_t count;    /**< number of paths, more than 1 for a subtree */
+} cpj_path_diff_entry_t;
+
+/**
+ * The state of a diff of two sorted lists of paths, which is set up using
+ * cpj_path_diff_sorted.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_column_t old_paths;
+  cpj_string_column_t new_paths;
+  cpj_size_t old_position;
+  cpj_size_t new_position;
+  unsigned int flags;
+} cpj_path_diff_t;
+
+/**
+ * A directory of the ancestor chain of a rollup.
+ */
+typedef struct
+{
+  cpj_size_t size;          /**< of the directory path within the buffer */
+  unsigned long long value; /**< total of the directory so far */
+} cpj_rollup_level_t;
+
+/**
+ * The state of a rollup, which adds up values of paths for all of their
+ * directories. It is set up using cpj_rollup_init.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_char_t *buffer; /**< holds the path of the deepest directory */
+  cpj_size_t buffer_size;
+  cpj_rollup_level_t *levels; /**< the ancestor chain, starting at the root */
+  cpj_size_t level_size;
+  cpj_size_t level_count;
+  cpj_size_t closed_count; /**< closed levels which have not been fetched */
+  cpj_string_t path;       /**< waits for the closed levels to be fetched */
+  unsigned long long value;
+  bool has_path;
+} cpj_rollup_t;
+
+/**
+ * The version of the serialized path list format which is written by
+ * cpj_path_list_writer_t.
+ */
+#define CPJ_PATH_LIST_VERSION 1
+
+/**
+ * The state of a writer, which serializes a list of paths in a compact format.
+ * Every path is stored as the number of characters it shares with the
+ * previous one and the remaining characters, except for the restart points
+ * every `restart_interval` paths, which are stored in full.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_char_t *buffer;
+  cpj_size_t buffer_size;
+  cpj_size_t size; /**< of the output, even if it does not fit */
+  cpj_size_t restart_interval;
+  cpj_size_t count;
+  cpj_size_t max_path_size;
+  cpj_char_t *previous; /**< the beginning of the previous path */
+  cpj_size_t previous_size;
+  cpj_size_t previous_capacity;
+} cpj_path_list_writer_t;
+
+/**
+ * A serialized list of paths, which is read in place. It is opened using
+ * cpj_path_list_open.
+ */
+typedef struct
+{
+  const cpj_char_t *data;
+  cpj_size_t size; /**< of the entries, which are followed by the restarts */
+  cpj_path_style_t path_style;
+  cpj_size_t count;
+  cpj_size_t restart_interval;
+  cpj_size_t restart_count;
+  cpj_size_t max_path_size;
+  const cpj_char_t *restarts; /**< the offsets of the restart points */
+} cpj_path_list_t;
+
+/**
+ * The state of a reader, which decodes the paths of a serialized list one
+ * after another.
+ */
+typedef struct
+{
+  const cpj_path_list_t *list;
+  cpj_char_t *buffer; /**< holds the current path */
+  cpj_size_t buffer_size;
+  cpj_size_t path_size;
+  cpj_size_t position; /**< of the next path within the list */
+  cpj_size_t offset;   /**< of the next entry within the data */
+} cpj_path_list_reader_t;
+
+/**
+ * The version of the serialized path table format which is written by
+ * cpj_path_table_build.
+ */
+#define CPJ_PATH_TABLE_VERSION 1
+
+/**
+ * A serialized table of paths, which is opened using cpj_path_table_open. It
+ * is read in place without any parsing, so a mapped file can be used right
+ * away. Besides the paths, the table holds a hash table to look them up and a
+ * trie of their segments to find the paths below a directory.
+ */
+typedef struct
+{
+  const cpj_char_t *data;
+  cpj_path_style_t path_style;
+  cpj_size_t path_count;
+  cpj_size_t max_path_size;
+  cpj_size_t level_count; /**< of the trie, where the roots are the first */
+  cpj_size_t node_count;
+  cpj_size_t hash_size;
+  cpj_size_t string_size;
+  const cpj_char_t *levels; /**< the first node of every level */
+  const cpj_char_t *nodes;
+  const cpj_char_t *paths;   /**< the offset and size of every path */
+  const cpj_char_t *hash;    /**< the position of a path plus one, or 0 */
+  const cpj_char_t *strings; /**< the '\0' terminated paths */
+} cpj_path_table_t;
+
+/**
+ * The kinds of names which are indexed by cpj_name_index_t.
+ */
+typedef enum
+{
+  CPJ_NAME_BASENAME = 0,
+  CPJ_NAME_STEM = 1,     /**< the basename without the extension */
+  CPJ_NAME_EXTENSION = 2 /**< including the dot */
+} cpj_name_kind_t;
+
+typedef enum
+{
+  CPJ_NAME_INDEX_DEFAULT = 0,
+  CPJ_NAME_INDEX_PARALLEL = 1 /**< use a thread for every kind of name, if
+                                   cpj has been built with thread support */
+} cpj_name_index_flags_t;
+
+/**
+ * An index of the basenames, stems and extensions of a column of paths, built
+ * using cpj_name_index_build. Every kind of name has a hash table whose slots
+ * lead to the positions of all the paths with a name.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_column_t paths;
+  cpj_size_t slot_count; /**< of every kind, which is a power of two */
+  cpj_size_t *slots;     /**< the hash, offset, size and first position */
+  cpj_size_t *positions; /**< of every kind, grouped by name */
+  cpj_size_t position_counts[3];
+} cpj_name_index_t;
+
+/**
+ * The kinds of segments of a compiled glob pattern.
+ */
+typedef enum
+{
+  CPJ_GLOB_LITERAL = 0,  /**< matches a segment with the same name */
+  CPJ_GLOB_WILDCARD = 1, /**< matches a segment using `*`, `?` and `[...]` */
+  CPJ_GLOB_ANY = 2,      /**< a `*` which matches any single segment */
+  CPJ_GLOB_RECURSIVE = 3 /**< a `**` which matches any number of segments */
+} cpj_glob_segment_type_t;
+
+typedef struct
+{
+  cpj_glob_segment_type_t type;
+  cpj_string_t name;
+} cpj_glob_segment_t;
+
+/**
+ * A glob pattern which has been compiled using cpj_glob_compile. The segments
+ * point into the pattern, which has to outlive the glob.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_t root;
+  const cpj_glob_segment_t *segments;
+  cpj_size_t segment_count;
+} cpj_glob_t;
+
+/**
+ * The result of matching a path against a pattern set.
+ */
+typedef enum
+{
+  CPJ_PATTERN_UNMATCHED = 0, /**< no pattern matches the path */
+  CPJ_PATTERN_IGNORED = 1,   /**< the path or one of its parents is ignored */
+  CPJ_PATTERN_INCLUDED = 2   /**< the last matching pattern is negated */
+} cpj_pattern_verdict_t;
+
+typedef enum
+{
+  CPJ_PATTERN_NEGATED = 1,    /**< starts with `!` */
+  CPJ_PATTERN_DIRECTORY = 2,  /**< ends with a separator */
+  CPJ_PATTERN_ANCHORED = 4,   /**< contains a separator before its end */
+  CPJ_PATTERN_BASENAME = 8,   /**< looked up by its literal basename */
+  CPJ_PATTERN_EXTENSION = 16, /**< looked up by its literal extension */
+  CPJ_PATTERN_PREFIX = 32     /**< looked up by the first character */
+} cpj_pattern_flags_t;
+
+/**
+ * A single pattern of a cpj_patternset_t. The rules also hold the buckets of
+ * the hash table, which leads from a basename or extension to its rules.
+ */
+typedef struct
+{
+  cpj_glob_t glob;
+  cpj_string_t key;     /**< of its last segment, which it is looked up by */
+  unsigned int flags;   /**< of cpj_pattern_flags_t */
+  cpj_size_t hash;      /**< of the key */
+  cpj_size_t depth;     /**< the least number of segments it matches */
+  bool is_exact;        /**< matches exactly `depth` segments */
+  cpj_size_t bucket;    /**< the last rule of this bucket plus one */
+  cpj_size_t next;      /**< the previous rule of the bucket plus one */
+} cpj_pattern_rule_t;
+
+/**
+ * A set of gitignore patterns compiled using cpj_patternset_compile.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  const cpj_pattern_rule_t *rules;
+  cpj_size_t rule_count;
+  cpj_size_t last_generic; /**< the last rule without a key plus one */
+} cpj_patternset_t;
+
+/**
+ * A normalized path which is built one segment at a time, initialized using
+ * cpj_path_builder_init. The buffer always holds the path with a '\0'
+ * terminator, and the end of every segment is kept, so segments are added and
+ * removed without looking at the rest of the path.
+ */
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_char_t *buffer;
+  cpj_size_t buffer_size;
+  cpj_size_t *segment_ends;
+  cpj_size_t segment_capacity;
+  cpj_size_t root_size;
+  cpj_size_t segment_count;
+  cpj_size_t parent_count; /**< the leading `..` segments of the path */
+  cpj_size_t size;         /**< of the path in the buffer */
+} cpj_path_builder_t;
+
+/**
+ * A cache of the file system entries which cpj_fs_resolve looked at, which is
+ * initialized using cpj_fs_cache_init. Every entry is keyed by a resolved
+ * prefix and holds whether it is a directory, another file, a symbolic link
+ * with its target, or missing. Entries from an older generation count as
+ * empty, so the whole cache is invalidated at once.
+ */
+typedef struct
+{
+  void *lock;            /**< within the storage, if built with threads */
+  cpj_size_t *slots;     /**< the generation, hash, offset, sizes and kind */
+  cpj_size_t slot_count; /**< which is a power of two */
+  cpj_char_t *data;      /**< the prefixes and the targets of the links */
+  cpj_size_t data_capacity;
+  cpj_size_t data_size;
+  cpj_size_t entry_count;
+  cpj_size_t generation;
+  cpj_size_t probe_count; /**< the number of entries which have been probed */
+} cpj_fs_cache_t;
+
+/**
+ * The type of a directory entry found by cpj_walk. Symbolic links are not
+ * followed.
+ */
+typedef enum
+{
+  CPJ_WALK_OTHER = 0,
+  CPJ_WALK_FILE = 1,
+  CPJ_WALK_DIRECTORY = 2,
+  CPJ_WALK_SYMLINK = 3
+} cpj_walk_type_t;
+
+typedef enum
+{
+  CPJ_WALK_DEFAULT = 0,
+  CPJ_WALK_PARALLEL = 1 /**< walk using multiple threads, if cpj has been
+                             built with thread support */
+} cpj_walk_flags_t;
+
+/**
+ * A directory entry found by cpj_walk. The path and name are only valid
+ * during the callback they are passed to.
+ */
+typedef struct
+{
+  cpj_string_t path; /**< the root joined with the names, '\0' terminated */
+  cpj_string_t name; /**< the last segment of the path */
+  cpj_size_t depth;  /**< 1 for the entries of the root */
+  cpj_walk_type_t type;
+  int error; /**< the errno if a directory could not be read, or 0 */
+} cpj_walk_entry_t;
+
+/**
+ * Receives a batch of entries found by cpj_walk. Returning false stops the
+ * walk.
+ */
+typedef bool (*cpj_walk_callback_t)(
+  void *context, const cpj_walk_entry_t *entries, cpj_size_t entry_count
+);
+
+/**
+ * The options of cpj_walk. The sizes which are 0 are replaced by defaults.
+ */
+typedef struct
+{
+  cpj_walk_callback_t callback;
+  void *context;                    /**< passed to the callback */
+  const cpj_patternset_t *patterns; /**< skips ignored entries, or NULL */
+  unsigned int flags;               /**< of cpj_walk_flags_t */
+  cpj_size_t thread_count; /**< used with CPJ_WALK_PARALLEL */
+  cpj_size_t level_count;  /**< directories each thread keeps open */
+  cpj_size_t task_count;   /**< directories each thread can hand out */
+  cpj_size_t batch_size;   /**< entries passed to the callback at once */
+} cpj_walk_t;
+
+typedef enum
+{
+  CPJ_FS_STAT_DEFAULT = 0,
+  CPJ_FS_STAT_NO_FOLLOW = 1, /**< describe symbolic links, not their targets */
+  CPJ_FS_STAT_PARALLEL = 2,  /**< use multiple threads, if cpj has been built
+                                  with thread support */
+  CPJ_FS_STAT_NO_RING = 4    /**< probe using fstatat, even if io_uring is
+                                  available */
+} cpj_fs_stat_flags_t;
+
+/**
+ * The columns which cpj_fs_stat_column writes, holding one value for each
+ * path. Columns which are NULL are skipped.
+ */
+typedef struct
+{
+  int *errors;               /**< 0, or the errno of the failed probe */
+  cpj_walk_type_t *types;    /**< CPJ_WALK_OTHER if the probe failed */
+  unsigned long long *sizes; /**< in bytes */
+  long long *mtimes;         /**< in nanoseconds since the epoch */
+} cpj_fs_stat_column_t;
+
+/**
+ * An ordered list of directories which is searched for names, like the
+ * directories of `PATH` or the include directories of a compiler. It is
+ * initialized using cpj_searchpath_init. The listing of each directory is
+ * read once and kept in a hash set, so most lookups do not touch the file
+ * system at all.
+ */
+typedef struct
+{
+  const cpj_string_t *directories; /**< searched in this order */
+  cpj_size_t directory_count;
+  cpj_size_t *generations; /**< of the listing of each directory, 0 if none */
+  long long *mtimes;       /**< of each directory when it was listed */
+  cpj_size_t *slots;       /**< the hash, name, directory and generation */
+  cpj_size_t slot_count;   /**< which is a power of two */
+  cpj_char_t *data;        /**< the names of all listed entries */
+  cpj_size_t data_capacity;
+  cpj_size_t data_size;
+  cpj_size_t entry_count; /**< including the ones of outdated listings */
+  cpj_size_t generation;  /**< the last one handed out to a listing */
+  cpj_size_t list_count;  /**< the number of directories which were listed */
+} cpj_searchpath_t;
+
 /**
  * Helper to generate a string literal with type const cpj_char_t *
  */
@@ -103,6 +644,27 @@ CPJ_PUBLIC cpj_size_t cpj_path_get_relative(
   cpj_char_t *buffer, cpj_size_t buffer_size
 );
 
+/**
+ * @brief Calculates an upper bound of the size of a relative path.
+ *
+ * This function calculates an upper bound of the size which
+ * cpj_path_get_relative returns for the same arguments. Only the sizes of the
+ * paths are used, the paths are not parsed. A buffer with one more character
+ * than the returned size is always large enough to hold the relative path.
+ *
+ * @param cwd_directory The current directory for prefix the relative paths when
+ * needed
+ * @param base_directory The base path from which the relative path will
+ * start.
+ * @param path The target path where the relative path will point to.
+ * @return Returns the upper bound of the relative path size, excluding the
+ * '\0' terminator.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_relative_max_size(
+  const cpj_string_t *cwd_directory, const cpj_string_t *base_directory,
+  const cpj_string_t *path
+);
+
 /**
  * @brief Joins multiple paths together.
  *
@@ -140,6 +702,52 @@ cpj_size_t cpj_path_join_multiple(
   cpj_char_t *buffer_p, cpj_size_t buffer_size
 );
 
+/**
+ * @brief Normalizes a path within its own buffer.
+ *
+ * This function normalizes a path the same way as cpj_path_join_multiple does
+ * for a single path with `remove_trailing_slash` set, but writes the result
+ * over the path itself. The path is compacted from front to back in a single
+ * pass, since the normalized path never gets longer than the part which has
+ * been read so far. Only the `.` generated for paths like `` or `C:` needs
+ * one more character than the path, the result is truncated if that
+ * character does not fit into the buffer. The result is always
+ * null-terminated.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param path The path which will be normalized, and the buffer where the
+ * result will be written to.
+ * @param path_size The size of the path, excluding the '\0' terminator.
+ * @param buffer_size The size of the buffer which holds the path, it must be
+ * larger than `path_size`.
+ * @return Returns the size of the normalized path, excluding the '\0'
+ * terminator.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_normalize_inplace(
+  cpj_path_style_t path_style, cpj_char_t *path, cpj_size_t path_size,
+  cpj_size_t buffer_size
+);
+
+/**
+ * @brief Calculates an upper bound of the size of joined paths.
+ *
+ * This function calculates an upper bound of the size which
+ * cpj_path_join_multiple returns for the same list of paths, regardless of the
+ * style and flags being used. Only the sizes of the paths are used, the paths
+ * are not parsed. A buffer with one more character than the returned size is
+ * always large enough to hold the joined path, and cpj_path_join_multiple
+ * generates the path in a single pass when given such a buffer.
+ *
+ * @param path_list_p An array of paths which will be joined.
+ * @param path_list_count The count of array of paths.
+ * @return Returns the upper bound of the joined path size, excluding the '\0'
+ * terminator.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_join_max_size(
+  const cpj_string_t *path_list_p, cpj_size_t path_list_count
+);
+
 /**
  * @brief Determines the root of a path.
  *
@@ -376,6 +984,1234 @@ cpj_path_is_separator(cpj_path_style_t path_style, const cpj_char_t ch);
  */
 CPJ_PUBLIC cpj_path_style_t cpj_path_guess_style(const cpj_string_t *path);
 
+/**
+ * @brief Normalizes every path of a string column.
+ *
+ * This function normalizes each path of the column the same way as
+ * cpj_path_join_multiple does for a single path, and writes the results into
+ * a new column. The results are stored back to back in the buffer, and the
+ * offset of each result is written to `offsets`, which must have room for
+ * `paths->count + 1` entries. If the buffer is NULL, nothing is written and a
+ * cheap upper bound of the buffer size (including the '\0' terminator) is
+ * returned instead, computed from the input sizes only. The buffer is always
+ * null-terminated, results which do not fit are truncated.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param paths The column of paths which will be normalized.
+ * @param buffer The buffer where the resulting strings will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the resulting strings within the buffer.
+ * @return Returns the total size of all results, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_normalize_column(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+);
+
+/**
+ * @brief Joins a base path with every path of a string column.
+ *
+ * This function works like cpj_path_normalize_column, but each result is
+ * generated by joining the base path and the path of the column.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param base The base path which every path of the column is joined to.
+ * @param paths The column of paths which will be joined.
+ * @param buffer The buffer where the resulting strings will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the resulting strings within the buffer.
+ * @return Returns the total size of all results, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_join_column(
+  cpj_path_style_t path_style, const cpj_string_t *base,
+  const cpj_string_column_t *paths, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *offsets
+);
+
+/**
+ * @brief Generates relative paths for every path of a string column.
+ *
+ * This function works like cpj_path_normalize_column, but each result is the
+ * relative path from the base directory to the path of the column, as
+ * generated by cpj_path_get_relative.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param cwd_directory The current directory for prefix the relative paths when
+ * needed
+ * @param base_directory The base path from which the relative paths will
+ * start.
+ * @param paths The column of target paths.
+ * @param buffer The buffer where the resulting strings will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the resulting strings within the buffer.
+ * @return Returns the total size of all results, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_get_relative_column(
+  cpj_path_style_t path_style, const cpj_string_t *cwd_directory,
+  const cpj_string_t *base_directory, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+);
+
+/**
+ * @brief Changes the extension of every path of a string column.
+ *
+ * This function works like cpj_path_normalize_column, but each result is
+ * generated by cpj_path_change_extension.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param paths The column of paths which will get the new extension.
+ * @param new_extension The extension which will be placed within the paths.
+ * @param buffer The buffer where the resulting strings will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the resulting strings within the buffer.
+ * @return Returns the total size of all results, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_change_extension_column(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths,
+  const cpj_string_t *new_extension, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_size_t *offsets
+);
+
+/**
+ * @brief Guesses the path style of every path of a string column.
+ *
+ * @param paths The column of paths which will be inspected.
+ * @param styles The output array, which must have room for `paths->count`
+ * entries.
+ */
+CPJ_PUBLIC void cpj_path_guess_style_column(
+  const cpj_string_column_t *paths, cpj_path_style_t *styles
+);
+
+/**
+ * @brief Applies the stages of a pipeline to a path.
+ *
+ * This function parses the path into its segments once, applies the stages
+ * of the pipeline to the segments in order, and writes the result once. The
+ * result is the same as normalizing the path with cpj_path_join_multiple and
+ * calling cpj_path_change_root, cpj_path_change_extension and
+ * cpj_path_get_relative one after another with intermediate buffers, except
+ * that the result is always normalized. The result will be written to a
+ * buffer, which might be truncated if the buffer is not large enough to hold
+ * the full path. However, the truncated result will always be
+ * null-terminated. The buffer must not overlap with the path.
+ *
+ * @param pipeline The pipeline which will be applied.
+ * @param path The path which will be rewritten.
+ * @param buffer The buffer where the result will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @return Returns the total amount of characters of the full path, or 0 if
+ * the path has more than CPJ_PIPELINE_SEGMENT_MAX segments at any stage.
+ */
+CPJ_PUBLIC cpj_size_t cpj_pipeline_run(
+  const cpj_pipeline_t *pipeline, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+);
+
+/**
+ * @brief Applies the stages of a pipeline to every path of a string column.
+ *
+ * This function works like cpj_path_normalize_column, but applies
+ * cpj_pipeline_run to each path.
+ *
+ * @param pipeline The pipeline which will be applied.
+ * @param paths The column of paths which will be rewritten.
+ * @param buffer The buffer where the resulting strings will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the resulting strings within the buffer.
+ * @return Returns the total size of all results, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_pipeline_run_column(
+  const cpj_pipeline_t *pipeline, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+);
+
+/**
+ * @brief Sets up a rebase for a table of rules.
+ *
+ * This function hashes the old prefix of every rule into the slots, so that
+ * looking up the rule for a path does not depend on the number of rules. The
+ * slots are owned by the caller and must outlive the rebase. If two rules
+ * have the same old prefix, the first one is used.
+ *
+ * @param rebase The rebase which will be set up.
+ * @param rules The rules, which must outlive the rebase.
+ * @param rule_count The number of rules.
+ * @param slots The slots of the hash table.
+ * @param slot_count The number of slots, which must be a power of two and
+ * larger than `rule_count`.
+ * @return Returns false if the slot count is not valid, or if an old prefix is
+ * empty or has more than CPJ_PIPELINE_SEGMENT_MAX segments.
+ */
+CPJ_PUBLIC bool cpj_rebase_init(
+  cpj_rebase_t *rebase, const cpj_rebase_rule_t *rules, cpj_size_t rule_count,
+  cpj_rebase_slot_t *slots, cpj_size_t slot_count
+);
+
+/**
+ * @brief Moves a path from the longest matching old prefix to its new prefix.
+ *
+ * This function parses the path once and looks up the rule with the longest
+ * old prefix which matches the leading segments of the path. The prefixes
+ * match segment by segment, so `/home/ci` is a prefix of `/home/ci/a` but not
+ * of `/home/cix`. Windows prefixes are compared case insensitively. The new
+ * prefix and the rest of the path are written using the style of the rule.
+ * Paths without a matching rule are normalized using `path_style`. The result
+ * will be written to a buffer, which might be truncated if the buffer is not
+ * large enough to hold the full path. However, the truncated result will
+ * always be null-terminated.
+ *
+ * @param rebase The rebase with the rules.
+ * @param path_style Style of the path, only rules with the same `from_style`
+ * are used.
+ * @param path The path which will be rebased.
+ * @param buffer The buffer where the result will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @return Returns the total amount of characters of the full path, or 0 if
+ * the path has more than CPJ_PIPELINE_SEGMENT_MAX segments.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_rebase(
+  const cpj_rebase_t *rebase, cpj_path_style_t path_style,
+  const cpj_string_t *path, cpj_char_t *buffer, cpj_size_t buffer_size
+);
+
+/**
+ * @brief Rebases every path of a string column.
+ *
+ * This function works like cpj_path_normalize_column, but applies
+ * cpj_path_rebase to each path.
+ *
+ * @param rebase The rebase with the rules.
+ * @param path_style Style of the paths.
+ * @param paths The column of paths which will be rebased.
+ * @param buffer The buffer where the resulting strings will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the resulting strings within the buffer.
+ * @return Returns the total size of all results, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_rebase_column(
+  const cpj_rebase_t *rebase, cpj_path_style_t path_style,
+  const cpj_string_column_t *paths, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *offsets
+);
+
+/**
+ * @brief Checks whether a path climbs above the point where it starts.
+ *
+ * This function walks the segments of the path once from the front and
+ * returns as soon as a ".." segment removes more segments than there are in
+ * front of it. The "." and ".." segments are treated the same way as by
+ * cpj_path_normalize_inplace. The root of the path is not a segment, so "/.."
+ * escapes the root as well, even though normalizing it results in "/". Checks
+ * for archive entries or sandboxes should reject absolute paths separately.
+ * Nothing is written and the path does not have to be null-terminated.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param path The path which will be checked.
+ * @return Returns true if the path escapes its root, or false otherwise.
+ */
+CPJ_PUBLIC bool
+cpj_path_escapes_root(cpj_path_style_t path_style, const cpj_string_t *path);
+
+/**
+ * @brief Checks whether a path nests a number of segments deep.
+ *
+ * This function walks the segments of the path once from the front, the same
+ * way as cpj_path_escapes_root, and returns as soon as there are `max_depth`
+ * segments below the point where the path starts. A ".." segment which
+ * climbs above that point does not change the depth, so "../a" has a depth of
+ * one. The depth in between counts as well, "a/b/../c" reaches a depth of two.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param path The path which will be checked.
+ * @param max_depth The depth at which the path is reported.
+ * @return Returns true if the path reaches `max_depth`, or false otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_max_depth_reached(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_size_t max_depth
+);
+
+/**
+ * @brief Checks every path of a string column for escaping its root.
+ *
+ * This function works like cpj_path_escapes_root for each path of the column.
+ * Paths without any ".." are skipped by a quick scan first, which is what
+ * most of the entries of an archive look like.
+ *
+ * @param path_style Style of the paths.
+ * @param paths The column of paths which will be checked.
+ * @param escapes The output array, which must have room for `paths->count`
+ * entries. It may be NULL if only the number of escaping paths is needed.
+ * @return Returns the number of paths which escape their root.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_escapes_root_column(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths, bool *escapes
+);
+
+/**
+ * @brief Checks an archive entry name and places it below the destination.
+ *
+ * This function walks the segments of the entry name once. While walking, it
+ * validates the name and writes the destination followed by the normalized
+ * name into the buffer, using the separator of the style of the sanitizer.
+ * Names which have a root according to cpj_path_get_root, which climb above
+ * the destination using ".." or which contain a '\0' character are rejected.
+ * A name without any segments, like "./", results in the destination itself.
+ * Unlike most other functions the result is never truncated: if it does not
+ * fit into the buffer the name is still validated, but CPJ_SANITIZE_TOO_LONG
+ * is returned. Whenever the status is not CPJ_SANITIZE_OK the buffer will
+ * contain an empty string. The buffer needs at most `destination.size +
+ * entry->size + 2` characters.
+ *
+ * @param sanitizer The sanitizer with the style and the destination.
+ * @param entry The entry name which will be checked.
+ * @param buffer The buffer where the output path will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param size Receives the size of the output path, excluding the '\0'
+ * terminator. It may be NULL.
+ * @return Returns the verdict on the entry name.
+ */
+CPJ_PUBLIC cpj_sanitize_status_t cpj_sanitizer_run(
+  const cpj_sanitizer_t *sanitizer, const cpj_string_t *entry,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *size
+);
+
+/**
+ * @brief Sanitizes every entry name of a string column.
+ *
+ * This function works like cpj_path_normalize_column, but applies
+ * cpj_sanitizer_run to each name. Rejected names result in empty strings, and
+ * names which do not fit into the rest of the buffer are reported as
+ * CPJ_SANITIZE_TOO_LONG.
+ *
+ * @param sanitizer The sanitizer with the style and the destination.
+ * @param paths The column of entry names which will be checked.
+ * @param buffer The buffer where the output paths will be written to.
+ * @param buffer_size The size of the result buffer.
+ * @param offsets The offsets of the output paths within the buffer.
+ * @param statuses The verdicts on the names, which must have room for
+ * `paths->count` entries.
+ * @return Returns the total size of all output paths, excluding the '\0'
+ * terminator, or the upper bound of the buffer size if buffer is NULL.
+ */
+CPJ_PUBLIC cpj_size_t cpj_sanitizer_run_column(
+  const cpj_sanitizer_t *sanitizer, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets,
+  cpj_sanitize_status_t *statuses
+);
+
+/**
+ * @brief Encodes a path into a key which sorts segment by segment.
+ *
+ * This function walks the path once and encodes its normalized segments into
+ * a byte key, so that comparing two keys with memcmp orders the paths segment
+ * by segment: a path comes before all the paths below it, and `a/b` comes
+ * before `a-b/c`. The root is encoded first, so relative paths come before
+ * absolute ones. Windows keys are case folded and use the same separator in
+ * the root, which makes keys of paths naming the same file equal. With
+ * `natural_order`, runs of digits are ordered by their value, so `a2` comes
+ * before `a10`. The key is binary and not null-terminated. It needs at most
+ * `2 * path->size + 2` bytes, or `4 * path->size + 2` with `natural_order`.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param path The path which will be encoded.
+ * @param natural_order Whether runs of digits are ordered by their value.
+ * @param buffer The buffer where the key will be written to.
+ * @param buffer_size The size of the key buffer.
+ * @return Returns the size of the key, or 0 if it does not fit into the
+ * buffer.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_sort_key(
+  cpj_path_style_t path_style, const cpj_string_t *path, bool natural_order,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+);
+
+/**
+ * @brief Sorts a list of paths segment by segment.
+ *
+ * This function sorts the paths in place into the order of their sort keys,
+ * see cpj_path_sort_key without `natural_order`: a parent comes right before
+ * the paths below it, siblings are contiguous, and relative paths come before
+ * absolute ones. Windows paths are compared the same way as when checking
+ * them for equality, ignoring the case and the kind of separator. The paths
+ * must be normalized, for instance using cpj_path_normalize_inplace, since the
+ * sort looks at them character by character without allocating any keys. Equal
+ * paths end up next to each other in no particular order.
+ *
+ * @param path_style Style depending on the operating system. So this should
+ * detect whether we should use windows or unix paths.
+ * @param paths The paths which will be sorted.
+ * @param path_count The number of paths.
+ * @param flags A combination of cpj_sort_flags_t values.
+ */
+CPJ_PUBLIC void cpj_path_sort(
+  cpj_path_style_t path_style, cpj_string_t *paths, cpj_size_t path_count,
+  unsigned int flags
+);
+
+/**
+ * @brief Sets up an index over a sorted column of paths.
+ *
+ * The paths of the column must be normalized and sorted the way cpj_path_sort
+ * sorts them. Nothing is copied or allocated, the column has to outlive the
+ * index.
+ *
+ * @param index The index which will be set up.
+ * @param path_style Style of the paths.
+ * @param paths The sorted column of paths.
+ */
+CPJ_PUBLIC void cpj_path_index_init(
+  cpj_path_index_t *index, cpj_path_style_t path_style,
+  const cpj_string_column_t *paths
+);
+
+/**
+ * @brief Looks up a path within an index.
+ *
+ * This function uses a binary search to find a path which is equal to the
+ * normalized `path`, comparing the same way cpj_path_sort does.
+ *
+ * @param index The index which will be searched.
+ * @param path The normalized path which will be looked up.
+ * @param position Receives the position of the path within the column, or the
+ * position where it would have to be inserted if it is not found. It may be
+ * NULL.
+ * @return Returns true if the path has been found, or false otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_index_lookup(
+  const cpj_path_index_t *index, const cpj_string_t *path,
+  cpj_size_t *position
+);
+
+/**
+ * @brief Finds all the paths below a path within an index.
+ *
+ * Since the paths below a path are sorted right behind it, they form a
+ * contiguous range which is found using two binary searches. The path itself
+ * is not part of the range. The descendants of "." or of a root like "/" are
+ * all the paths which share the root.
+ *
+ * @param index The index which will be searched.
+ * @param path The normalized path whose descendants will be found.
+ * @param first Receives the position of the first descendant.
+ * @return Returns the number of descendants.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_index_descendants_of(
+  const cpj_path_index_t *index, const cpj_string_t *path, cpj_size_t *first
+);
+
+/**
+ * @brief Finds the paths right below a path within an index.
+ *
+ * This function finds the paths which have exactly one segment more than the
+ * normalized `path`. The descendants of each child are skipped at once using
+ * a binary search, so the paths further below are not looked at one by one.
+ * Children which are only implied by the paths below them are skipped.
+ *
+ * @param index The index which will be searched.
+ * @param path The normalized path whose children will be found.
+ * @param children Receives the positions of the children.
+ * @param children_size The number of positions `children` has room for.
+ * @return Returns the number of children, which might be larger than
+ * `children_size`.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_index_children_of(
+  const cpj_path_index_t *index, const cpj_string_t *path,
+  cpj_size_t *children, cpj_size_t children_size
+);
+
+/**
+ * @brief Starts a diff of two sorted lists of paths.
+ *
+ * Both columns must be normalized and sorted the way cpj_path_sort sorts them.
+ * The differences are fetched one by one using cpj_path_diff_next, which
+ * merges both columns in a single pass and needs no memory besides the diff.
+ * With CPJ_DIFF_COLLAPSE, a subtree which only exists in one of the lists is
+ * reported as a single entry for its topmost directory, even if the
+ * directory itself is only implied by the paths below it. The path of such an
+ * entry is the beginning of the first path of the subtree.
+ *
+ * @param diff The diff which will be set up.
+ * @param path_style Style of the paths.
+ * @param old_paths The sorted column of old paths.
+ * @param new_paths The sorted column of new paths.
+ * @param flags A combination of cpj_diff_flags_t values.
+ */
+CPJ_PUBLIC void cpj_path_diff_sorted(
+  cpj_path_diff_t *diff, cpj_path_style_t path_style,
+  const cpj_string_column_t *old_paths, const cpj_string_column_t *new_paths,
+  unsigned int flags
+);
+
+/**
+ * @brief Fetches the next difference of a diff.
+ *
+ * The differences are reported in sort order. The position of an entry
+ * refers to the old column for removed paths, and to the new column
+ * otherwise.
+ *
+ * @param diff The diff which has been set up using cpj_path_diff_sorted.
+ * @param entry Receives the next difference.
+ * @return Returns false once there are no more differences, or true
+ * otherwise.
+ */
+CPJ_PUBLIC bool
+cpj_path_diff_next(cpj_path_diff_t *diff, cpj_path_diff_entry_t *entry);
+
+/**
+ * @brief Sets up a rollup of values over a sorted list of paths.
+ *
+ * A rollup computes totals for directories, like the disk usage of all the
+ * files below them, in a single pass over the paths. It only keeps the chain
+ * of directories of the current path, using the buffers of the caller.
+ *
+ * @param rollup The rollup which will be set up.
+ * @param path_style Style of the paths.
+ * @param buffer The buffer for the path of the current directory, which must
+ * fit the longest directory path.
+ * @param buffer_size The size of the buffer.
+ * @param levels The levels for the chain of directories, which need one
+ * level for the root and one for each directory.
+ * @param level_size The number of levels.
+ */
+CPJ_PUBLIC void cpj_rollup_init(
+  cpj_rollup_t *rollup, cpj_path_style_t path_style, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_rollup_level_t *levels, cpj_size_t level_size
+);
+
+/**
+ * @brief Adds the value of a path to all of its directories.
+ *
+ * The paths must be normalized and passed in the order of cpj_path_sort. The
+ * value is added to the directory which contains the path, and to all the
+ * directories above it. Directories which do not contain the path are
+ * closed, since no later path can be below them, and have to be fetched
+ * using cpj_rollup_next before the next path can be added. The path must
+ * stay valid until then.
+ *
+ * @param rollup The rollup which has been set up using cpj_rollup_init.
+ * @param path The path of the value.
+ * @param value The value which will be added.
+ * @return Returns false if the directory of the path does not fit into the
+ * buffer or the levels, or if closed directories have not been fetched yet.
+ */
+CPJ_PUBLIC bool cpj_path_rollup(
+  cpj_rollup_t *rollup, const cpj_string_t *path, unsigned long long value
+);
+
+/**
+ * @brief Closes all the directories of a rollup.
+ *
+ * This is called after the last path has been added, the totals of all the
+ * remaining directories can then be fetched using cpj_rollup_next.
+ *
+ * @param rollup The rollup which has been set up using cpj_rollup_init.
+ * @return Returns false if closed directories have not been fetched yet.
+ */
+CPJ_PUBLIC bool cpj_rollup_finish(cpj_rollup_t *rollup);
+
+/**
+ * @brief Fetches the next closed directory of a rollup.
+ *
+ * The directories are fetched from the deepest one up to the root, which is
+ * `.` for relative paths. The directory path is valid until the next call
+ * of cpj_rollup_next.
+ *
+ * @param rollup The rollup which has been set up using cpj_rollup_init.
+ * @param directory Receives the path of the directory.
+ * @param value Receives the total of the directory.
+ * @return Returns false once there are no more closed directories, or true
+ * otherwise.
+ */
+CPJ_PUBLIC bool cpj_rollup_next(
+  cpj_rollup_t *rollup, cpj_string_t *directory, unsigned long long *value
+);
+
+/**
+ * @brief Finds a small set of directories which covers a list of paths.
+ *
+ * The paths must be normalized and sorted using cpj_path_sort. The cover
+ * contains the topmost paths of the list, unless that are more than
+ * `max_roots`. In that case, paths are replaced by the directories which
+ * contain them, choosing the deepest level of the directories which
+ * satisfies the limit. Only directories which contain at least two of the
+ * paths are chosen, and paths with different roots are never merged.
+ *
+ * The waste limits how far a path may be moved up: a path with `n`
+ * segments may lose at most `max_waste * n` of them. With a waste of 0 the
+ * cover only contains the topmost paths, with a waste of 1 the paths may be
+ * covered by their root. The limit wins over `max_roots`, which means the
+ * cover may contain more directories than requested.
+ *
+ * The cover refers to the characters of the paths, the root of a relative
+ * path is written as `.`.
+ *
+ * @param path_style Style of the paths.
+ * @param paths The sorted paths which will be covered.
+ * @param count The number of paths.
+ * @param max_roots The number of directories which should not be exceeded.
+ * @param max_waste The share of segments a path may lose, from 0 to 1.
+ * @param roots Receives the directories of the cover in sort order. It must
+ * have room for `count` entries, since it is also used to build the cover.
+ * @return Returns the number of directories of the cover.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_minimal_cover(
+  cpj_path_style_t path_style, const cpj_string_t *paths, cpj_size_t count,
+  cpj_size_t max_roots, double max_waste, cpj_string_t *roots
+);
+
+/**
+ * @brief Sets up a writer for a serialized list of paths.
+ *
+ * The writer only needs the output buffer and a buffer for the previous
+ * path. The paths should be sorted using cpj_path_sort, which makes them
+ * share long beginnings and is needed by cpj_path_list_find. A previous path
+ * which does not fit into its buffer only makes the output larger.
+ *
+ * @param writer The writer which will be set up.
+ * @param path_style Style of the paths, which is stored in the list.
+ * @param restart_interval The number of paths between two restart points. A
+ * larger interval makes the list smaller, but random access slower.
+ * @param buffer The buffer where the list will be written to.
+ * @param buffer_size The size of the buffer.
+ * @param previous The buffer for the previous path.
+ * @param previous_size The size of the buffer for the previous path.
+ */
+CPJ_PUBLIC void cpj_path_list_writer_init(
+  cpj_path_list_writer_t *writer, cpj_path_style_t path_style,
+  cpj_size_t restart_interval, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_char_t *previous, cpj_size_t previous_size
+);
+
+/**
+ * @brief Adds a path to a serialized list.
+ *
+ * Whatever does not fit into the buffer is not written, but still counted.
+ *
+ * @param writer The writer which has been set up using
+ * cpj_path_list_writer_init.
+ * @param path The path which will be added.
+ */
+CPJ_PUBLIC void cpj_path_list_writer_add(
+  cpj_path_list_writer_t *writer, const cpj_string_t *path
+);
+
+/**
+ * @brief Completes a serialized list.
+ *
+ * This writes the offsets of the restart points behind the paths, which
+ * are found by skipping over the written entries.
+ *
+ * @param writer The writer which has been set up using
+ * cpj_path_list_writer_init.
+ * @return Returns the size of the whole list. The list is only complete if
+ * that is not larger than the buffer.
+ */
+CPJ_PUBLIC cpj_size_t
+cpj_path_list_writer_finish(cpj_path_list_writer_t *writer);
+
+/**
+ * @brief Opens a serialized list of paths.
+ *
+ * The list is read in place, so the data may be mapped from a file. It has
+ * to stay valid as long as the list is used.
+ *
+ * @param list The list which will be opened.
+ * @param data The serialized list.
+ * @param size The size of the serialized list.
+ * @return Returns false if the data is not a complete list, or true
+ * otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_list_open(
+  cpj_path_list_t *list, const cpj_char_t *data, cpj_size_t size
+);
+
+/**
+ * @brief Sets up a reader for a serialized list of paths.
+ *
+ * The reader starts at the first path of the list.
+ *
+ * @param reader The reader which will be set up.
+ * @param list The list which has been opened using cpj_path_list_open.
+ * @param buffer The buffer for the current path.
+ * @param buffer_size The size of the buffer, which needs to be larger than
+ * the longest path of the list.
+ * @return Returns false if the buffer is too small, or true otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_list_reader_init(
+  cpj_path_list_reader_t *reader, const cpj_path_list_t *list,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+);
+
+/**
+ * @brief Reads the next path of a serialized list.
+ *
+ * @param reader The reader which has been set up using
+ * cpj_path_list_reader_init.
+ * @param path Receives the path, which points into the buffer of the reader
+ * and is followed by a '\0' terminator.
+ * @return Returns false at the end of the list or if the list is corrupt, or
+ * true otherwise.
+ */
+CPJ_PUBLIC bool
+cpj_path_list_next(cpj_path_list_reader_t *reader, cpj_string_t *path);
+
+/**
+ * @brief Moves a reader to a position of a serialized list.
+ *
+ * The reader starts at the closest restart point in front of the position,
+ * so at most `restart_interval - 1` paths are decoded.
+ *
+ * @param reader The reader which has been set up using
+ * cpj_path_list_reader_init.
+ * @param position The position of the path which is read next.
+ * @return Returns false if the position is not within the list or if the
+ * list is corrupt, or true otherwise.
+ */
+CPJ_PUBLIC bool
+cpj_path_list_seek(cpj_path_list_reader_t *reader, cpj_size_t position);
+
+/**
+ * @brief Moves a reader to the first path which is not in front of a path.
+ *
+ * The list must be sorted using cpj_path_sort. The restart points are
+ * searched using a binary search, so only a single interval is decoded.
+ *
+ * @param reader The reader which has been set up using
+ * cpj_path_list_reader_init.
+ * @param path The normalized path which is searched for.
+ * @return Returns the position of the path which is read next, which is the
+ * number of paths if all of them are in front of the path.
+ */
+CPJ_PUBLIC cpj_size_t
+cpj_path_list_find(cpj_path_list_reader_t *reader, const cpj_string_t *path);
+
+/**
+ * @brief Serializes a table of paths.
+ *
+ * The paths must be normalized and sorted the way cpj_path_sort sorts them.
+ * Equal paths are only stored once. Nothing is written unless the whole table
+ * fits into the buffer, so the size may be queried using an empty buffer
+ * first.
+ *
+ * @param path_style Style of the paths, which is stored in the table.
+ * @param paths The sorted paths.
+ * @param count The number of paths.
+ * @param buffer The buffer where the table will be written to.
+ * @param buffer_size The size of the buffer.
+ * @return Returns the size of the table.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_table_build(
+  cpj_path_style_t path_style, const cpj_string_t *paths, cpj_size_t count,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+);
+
+/**
+ * @brief Opens a serialized table of paths.
+ *
+ * Only the header is read, the table is used in place. The data has to stay
+ * valid as long as the table is used.
+ *
+ * @param table The table which will be opened.
+ * @param data The serialized table.
+ * @param size The size of the serialized table.
+ * @return Returns false if the data is not a complete table, or true
+ * otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_table_open(
+  cpj_path_table_t *table, const cpj_char_t *data, cpj_size_t size
+);
+
+/**
+ * @brief Gets a path of a table.
+ *
+ * @param table The table which has been opened using cpj_path_table_open.
+ * @param position The position of the path in sort order.
+ * @param path Receives the path, which points into the table and is followed
+ * by a '\0' terminator.
+ * @return Returns false if there is no such path or the table is corrupt, or
+ * true otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_table_get(
+  const cpj_path_table_t *table, cpj_size_t position, cpj_string_t *path
+);
+
+/**
+ * @brief Looks up a path within a table.
+ *
+ * The path is normalized the same way cpj_path_join_multiple does for a single
+ * path with `remove_trailing_slash` set, and then found using the hash table.
+ *
+ * @param table The table which has been opened using cpj_path_table_open.
+ * @param path The path which will be looked up.
+ * @param buffer The buffer for the normalized path.
+ * @param buffer_size The size of the buffer. Paths which are longer than the
+ * longest path of the table are never found, so a buffer larger than that is
+ * sufficient.
+ * @param position Receives the position of the path. It may be NULL.
+ * @return Returns true if the path has been found, or false otherwise.
+ */
+CPJ_PUBLIC bool cpj_path_table_lookup(
+  const cpj_path_table_t *table, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_size_t *position
+);
+
+/**
+ * @brief Finds all the paths below a path within a table.
+ *
+ * The path is normalized like in cpj_path_table_lookup, and its segments are
+ * followed through the trie, which holds the range of paths below every
+ * directory. The path itself is not part of the range. The descendants of "."
+ * or of a root like "/" are all the paths which share the root.
+ *
+ * @param table The table which has been opened using cpj_path_table_open.
+ * @param path The path whose descendants will be found.
+ * @param buffer The buffer for the normalized path.
+ * @param buffer_size The size of the buffer.
+ * @param first Receives the position of the first descendant.
+ * @return Returns the number of descendants.
+ */
+CPJ_PUBLIC cpj_size_t cpj_path_table_descendants_of(
+  const cpj_path_table_t *table, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_size_t *first
+);
+
+/**
+ * @brief Counts the storage a name index needs.
+ *
+ * @param count The number of paths which will be indexed.
+ * @return Returns the number of cpj_size_t values the storage of the index
+ * needs to hold.
+ */
+CPJ_PUBLIC cpj_size_t cpj_name_index_storage_size(cpj_size_t count);
+
+/**
+ * @brief Builds an index of the names of a column of paths.
+ *
+ * Every path is indexed by its basename, its stem and its extension, which
+ * are found the way cpj_path_get_basename and cpj_path_get_extension find
+ * them. The extension includes the dot, and the stem is the basename without
+ * the extension. Paths without such a name, like a root or a basename which
+ * starts with its only dot for the stem, are not indexed by it. Windows names
+ * are compared case insensitively. With CPJ_NAME_INDEX_PARALLEL, the three
+ * kinds of names are indexed on threads of their own.
+ *
+ * @param index The index which will be built.
+ * @param path_style Style of the paths.
+ * @param paths The column of paths, which has to outlive the index.
+ * @param storage The storage of the index, which needs to hold the number of
+ * values returned by cpj_name_index_storage_size.
+ * @param flags Flags of cpj_name_index_flags_t.
+ */
+CPJ_PUBLIC void cpj_name_index_build(
+  cpj_name_index_t *index, cpj_path_style_t path_style,
+  const cpj_string_column_t *paths, cpj_size_t *storage, unsigned int flags
+);
+
+/**
+ * @brief Finds all the paths with a name.
+ *
+ * The name is looked up using a hash table, which leads right to the list of
+ * its paths.
+ *
+ * @param index The index which has been built using cpj_name_index_build.
+ * @param kind The kind of the name.
+ * @param name The name which is searched for. An extension has to start with
+ * a dot.
+ * @param positions Receives the positions of the paths within the column, in
+ * ascending order. They point into the storage of the index.
+ * @return Returns the number of paths with the name.
+ */
+CPJ_PUBLIC cpj_size_t cpj_name_index_find(
+  const cpj_name_index_t *index, cpj_name_kind_t kind,
+  const cpj_string_t *name, const cpj_size_t **positions
+);
+
+/**
+ * @brief Compiles a glob pattern into a list of segments.
+ *
+ * The pattern is split into its root and segments the same way a path is, so
+ * `/`, and also `\` for Windows, separate the segments. Empty and `.`
+ * segments are removed and `..` removes the segment before it, unless that is
+ * a `**`. A segment which is `**` matches any number of segments, including
+ * none. Within the other segments, `*` matches any number of characters, `?`
+ * matches one character and `[...]` matches one character of a set like
+ * `[abc]`, `[a-z]` or `[!.]`. A special character is matched literally when it
+ * is put in a set, like `[*]`.
+ *
+ * @param glob The glob which will be compiled.
+ * @param path_style Style of the pattern and the matched paths.
+ * @param pattern The pattern, which has to outlive the glob.
+ * @param segments The buffer which receives the segments.
+ * @param segment_capacity The number of segments which fit into the buffer.
+ * @return Returns the number of segments of the pattern. The glob can only be
+ * used if it is not larger than the capacity.
+ */
+CPJ_PUBLIC cpj_size_t cpj_glob_compile(
+  cpj_glob_t *glob, cpj_path_style_t path_style, const cpj_string_t *pattern,
+  cpj_glob_segment_t *segments, cpj_size_t segment_capacity
+);
+
+/**
+ * @brief Checks whether a path matches a glob pattern.
+ *
+ * The path is matched as if it had been normalized, so `a/./b`, `a//b` and
+ * `a/x/../b` all match `a/b`, but it is neither copied nor modified. The root
+ * of the path has to be equal to the root of the pattern, which means a
+ * relative pattern only matches relative paths. Windows paths are matched
+ * case insensitively.
+ *
+ * @param glob The glob which has been compiled using cpj_glob_compile.
+ * @param path The path which will be matched.
+ * @return Returns true if the path matches the pattern.
+ */
+CPJ_PUBLIC bool
+cpj_glob_match(const cpj_glob_t *glob, const cpj_string_t *path);
+
+/**
+ * @brief Compiles a list of gitignore patterns into a pattern set.
+ *
+ * Every pattern follows the rules of a line of a `.gitignore` file. Empty
+ * patterns and patterns starting with `#` are skipped. A pattern starting
+ * with `!` includes the paths which an earlier pattern ignored, and a pattern
+ * ending with a separator only matches directories. A pattern containing a
+ * separator anywhere else is matched against the whole path, otherwise it is
+ * matched against the basename of the path and of each of its parents. The
+ * segments of a pattern are matched like those of cpj_glob_compile, except
+ * that a trailing `**` needs to match at least one segment.
+ *
+ * Patterns are looked up using a hash table by their last segment, if it is a
+ * literal basename like `node_modules`, a literal extension like `*.o` or
+ * starts with a literal character like `tmp_*`. Only the other patterns are
+ * matched one by one.
+ *
+ * @param set The pattern set which will be compiled.
+ * @param path_style Style of the patterns and the matched paths.
+ * @param patterns The patterns, which have to outlive the set.
+ * @param pattern_count The number of patterns.
+ * @param rules The buffer for the rules, which has to hold `pattern_count`
+ * rules.
+ * @param segments The buffer for the segments of all patterns.
+ * @param segment_capacity The number of segments which fit into the buffer.
+ * @return Returns the number of segments of all patterns. Nothing is compiled
+ * if they do not fit into the buffer.
+ */
+CPJ_PUBLIC cpj_size_t cpj_patternset_compile(
+  cpj_patternset_t *set, cpj_path_style_t path_style,
+  const cpj_string_t *patterns, cpj_size_t pattern_count,
+  cpj_pattern_rule_t *rules, cpj_glob_segment_t *segments,
+  cpj_size_t segment_capacity
+);
+
+/**
+ * @brief Matches a path against a pattern set.
+ *
+ * The path is relative to the directory of the patterns and is matched as if
+ * it had been normalized, a root is skipped. The last pattern which matches
+ * the path decides, unless one of the parents of the path is ignored, since
+ * the contents of an ignored directory can not be included again.
+ *
+ * @param set The pattern set which has been compiled.
+ * @param path The path which will be matched.
+ * @param is_directory Whether the path is a directory.
+ * @return Returns whether the path is ignored, included or not matched at all.
+ */
+CPJ_PUBLIC cpj_pattern_verdict_t cpj_patternset_match(
+  const cpj_patternset_t *set, const cpj_string_t *path, bool is_directory
+);
+
+/**
+ * @brief Initializes a path builder with a path.
+ *
+ * The path is normalized into the buffer, which the builder uses from there
+ * on. The builder does not allocate anything, so a segment which does not fit
+ * into the buffer or the segment ends can not be added.
+ *
+ * @param builder The builder which will be initialized.
+ * @param path_style The style of the path.
+ * @param path The path which the builder starts with.
+ * @param buffer The buffer for the path.
+ * @param buffer_size The size of the buffer, including the '\0' terminator.
+ * @param segment_ends The buffer for the ends of the segments.
+ * @param segment_capacity The number of segments which fit into it.
+ * @return Returns false if the normalized path does not fit, in which case the
+ * builder can not be used.
+ */
+CPJ_PUBLIC bool cpj_path_builder_init(
+  cpj_path_builder_t *builder, cpj_path_style_t path_style,
+  const cpj_string_t *path, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *segment_ends, cpj_size_t segment_capacity
+);
+
+/**
+ * @brief Adds a single segment to the end of the path.
+ *
+ * A `.` is skipped and a `..` removes the last segment, the way
+ * cpj_path_normalize_inplace would. A relative path keeps a `..` which leads
+ * out of it, but an absolute path can not go above its root.
+ *
+ * @param builder The builder of the path.
+ * @param name The name of the segment, which must not contain a separator.
+ * @return Returns false if the name contains a separator or does not fit, in
+ * which case the path is left unchanged.
+ */
+CPJ_PUBLIC bool cpj_path_builder_push_segment(
+  cpj_path_builder_t *builder, const cpj_string_t *name
+);
+
+/**
+ * @brief Removes the last segment of the path.
+ *
+ * @param builder The builder of the path.
+ * @return Returns false if the path has no segments left besides its root.
+ */
+CPJ_PUBLIC bool cpj_path_builder_pop_segment(cpj_path_builder_t *builder);
+
+/**
+ * @brief Adds a relative path to the end of the path.
+ *
+ * The `.` and `..` segments of the relative path are resolved against the
+ * segments of the path, as if it had been joined and normalized. Only the
+ * segments which change are written.
+ *
+ * @param builder The builder of the path.
+ * @param path The relative path, which must not overlap the buffer.
+ * @return Returns false if the path has a root or the result does not fit, in
+ * which case the path is left unchanged.
+ */
+CPJ_PUBLIC bool cpj_path_builder_push_relative(
+  cpj_path_builder_t *builder, const cpj_string_t *path
+);
+
+/**
+ * @brief Removes segments from the end of the path until only the given
+ * number of segments is left.
+ *
+ * @param builder The builder of the path.
+ * @param segment_count The number of segments to keep, which does nothing if
+ * the path does not have more than that.
+ */
+CPJ_PUBLIC void cpj_path_builder_truncate(
+  cpj_path_builder_t *builder, cpj_size_t segment_count
+);
+
+/**
+ * @brief Determines the size of the storage of a file system cache.
+ *
+ * @param entry_count The number of entries the cache holds at most.
+ * @param data_size The number of characters for the prefixes and targets.
+ * @return Returns the size of the storage in bytes.
+ */
+CPJ_PUBLIC cpj_size_t
+cpj_fs_cache_storage_size(cpj_size_t entry_count, cpj_size_t data_size);
+
+/**
+ * @brief Initializes an empty file system cache.
+ *
+ * The cache is shared by all threads which resolve paths using it. It does
+ * not have to be destroyed, the storage can simply be freed once it is not
+ * used anymore.
+ *
+ * @param cache The cache which will be initialized.
+ * @param storage The storage, which has to hold cpj_fs_cache_storage_size
+ * bytes and has to be aligned like memory returned by malloc.
+ * @param entry_count The number of entries the cache holds at most.
+ * @param data_size The number of characters for the prefixes and targets.
+ */
+CPJ_PUBLIC void cpj_fs_cache_init(
+  cpj_fs_cache_t *cache, void *storage, cpj_size_t entry_count,
+  cpj_size_t data_size
+);
+
+/**
+ * @brief Invalidates all entries of a file system cache.
+ *
+ * This starts a new generation of the cache, which has to be done whenever
+ * the file system might have changed.
+ *
+ * @param cache The cache which will be invalidated.
+ */
+CPJ_PUBLIC void cpj_fs_cache_invalidate(cpj_fs_cache_t *cache);
+
+/**
+ * @brief Resolves a path against the file system, like realpath does.
+ *
+ * The segments of the path are walked from the front. Every prefix is looked
+ * up in the cache, and only probed using `lstat` and `readlink` if it is not
+ * cached yet. Symbolic links are replaced by their targets, and a `..` is
+ * applied to the resolved prefix, so `a/link/..` leads to the parent of the
+ * target of `link`. A relative path is resolved against the current working
+ * directory. When the cache is full it starts a new generation.
+ *
+ * @param cache The cache which is shared by all resolved paths.
+ * @param path The path which will be resolved.
+ * @param buffer The buffer for the resolved path.
+ * @param buffer_size The size of the buffer.
+ * @return Returns the size of the resolved path, which is only written if it
+ * fits into the buffer. Returns 0 if the path can not be resolved, in which
+ * case errno is set. This is always the case on Windows.
+ */
+CPJ_PUBLIC cpj_size_t cpj_fs_resolve(
+  cpj_fs_cache_t *cache, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+);
+
+/**
+ * @brief Probes the metadata of a column of paths.
+ *
+ * The paths are probed in batches. Consecutive paths in the same directory,
+ * like the ones of a column sorted by cpj_path_sort, are probed relative to
+ * that directory, which is only opened once, so the kernel does not walk the
+ * shared prefix for every path. With CPJ_FS_STAT_PARALLEL the batches are
+ * spread over one thread per CPU.
+ *
+ * On Linux the probes of a batch are submitted as IORING_OP_STATX requests
+ * of an io_uring, so a window of 64 paths costs a single system call. If the
+ * kernel does not support it, or denies it with ENOSYS or EPERM, every path
+ * is probed using fstatat instead, which is what other POSIX systems do.
+ *
+ * @param paths The normalized paths which will be probed.
+ * @param flags A combination of cpj_fs_stat_flags_t values.
+ * @param results The columns for the results, which have to hold a value for
+ * every path.
+ * @return Returns the number of paths which have been probed successfully.
+ * On Windows every probe fails with ENOSYS.
+ */
+CPJ_PUBLIC cpj_size_t cpj_fs_stat_column(
+  const cpj_string_column_t *paths, unsigned int flags,
+  const cpj_fs_stat_column_t *results
+);
+
+/**
+ * @brief Determines the size of the storage of a search path.
+ *
+ * @param directory_count The number of directories which are searched.
+ * @param entry_count The number of directory entries the search path holds at
+ * most.
+ * @param data_size The number of characters for the names of the entries.
+ * @return Returns the size of the storage in bytes.
+ */
+CPJ_PUBLIC cpj_size_t cpj_searchpath_storage_size(
+  cpj_size_t directory_count, cpj_size_t entry_count, cpj_size_t data_size
+);
+
+/**
+ * @brief Initializes a search path, without listing any directory yet.
+ *
+ * The directories are listed when a lookup reaches them for the first time.
+ * The search path must not be used by multiple threads at once.
+ *
+ * @param searchpath The search path which will be initialized.
+ * @param directories The directories which will be searched in this order.
+ * They are not copied and have to outlive the search path.
+ * @param directory_count The number of directories.
+ * @param storage The storage, which has to hold cpj_searchpath_storage_size
+ * bytes and has to be aligned like memory returned by malloc.
+ * @param entry_count The number of directory entries the search path holds at
+ * most.
+ * @param data_size The number of characters for the names of the entries.
+ */
+CPJ_PUBLIC void cpj_searchpath_init(
+  cpj_searchpath_t *searchpath, const cpj_string_t *directories,
+  cpj_size_t directory_count, void *storage, cpj_size_t entry_count,
+  cpj_size_t data_size
+);
+
+/**
+ * @brief Drops the listings of the directories which changed on disk.
+ *
+ * Every listed directory is probed once, and its listing is dropped if its
+ * mtime is not the one it had when it was listed. Dropped directories are
+ * listed again by the next lookup which reaches them.
+ *
+ * @param searchpath The search path which will be refreshed.
+ * @return Returns the number of listings which have been dropped.
+ */
+CPJ_PUBLIC cpj_size_t cpj_searchpath_refresh(cpj_searchpath_t *searchpath);
+
+/**
+ * @brief Finds the first directory of a search path which contains a name.
+ *
+ * The name is normalized first, so `a/../b.h` is looked up as `b.h`. A name
+ * with a single segment is answered from the listings, and only the winning
+ * directory is joined with it. For a name with more segments the listings
+ * rule out the directories which lack its first segment, and the remaining
+ * candidates are probed using `stat`. A name which leads out of the
+ * directories using `..` is probed in every directory. Directories are never
+ * found. Symbolic links in a listing, and entries whose type the file system
+ * does not report, are probed as well, so a link is only found if its target
+ * exists and is no directory. The result therefore does not depend on
+ * whether a listing fits into the storage.
+ *
+ * @param searchpath The search path which will be searched.
+ * @param name The relative name which will be looked for.
+ * @param buffer The buffer for the normalized path of the found entry.
+ * @param buffer_size The size of the buffer.
+ * @return Returns the size of the found path, which is only written if it
+ * fits into the buffer. Returns 0 if the name is not found, in which case
+ * errno is set to ENOENT, or to EINVAL if the name is absolute. On platforms
+ * other than Linux nothing is found, and errno is set to ENOSYS.
+ */
+CPJ_PUBLIC cpj_size_t cpj_searchpath_find(
+  cpj_searchpath_t *searchpath, const cpj_string_t *name, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+);
+
+/**
+ * @brief Determines the size of the storage cpj_walk needs.
+ *
+ * @param walk The options of the walk.
+ * @return Returns the size of the storage in bytes.
+ */
+CPJ_PUBLIC cpj_size_t cpj_walk_storage_size(const cpj_walk_t *walk);
+
+/**
+ * @brief Walks through all entries below a directory.
+ *
+ * The directories are read using `getdents64` relative to the descriptor of
+ * their parent, and the path of every entry is built by appending its name to
+ * the path of its directory, without normalizing it again. The entries are
+ * passed to the callback in batches. The root itself is not passed, and the
+ * order of the entries is not specified. An entry which is ignored by the
+ * pattern set is skipped, including everything below it.
+ *
+ * Each thread keeps up to `level_count` directories open, going deeper
+ * before it goes wider. Once all of them are open, the one closest to the
+ * root is closed, and reopened by its path later on to continue where it
+ * stopped, like nftw does. So every entry is found, no matter how deep or
+ * wide the tree is. With CPJ_WALK_PARALLEL, a thread which finds a directory
+ * while another one is idle hands it out instead, and idle threads take the
+ * directories which have been handed out by others. The callback is called
+ * from all of these threads, possibly at the same time.
+ *
+ * A directory which can not be read is passed with the errno of the failure
+ * set. A directory which can not be reopened is passed again that way. The
+ * errno is ENAMETOOLONG for the directory of entries whose paths do not fit
+ * into PATH_MAX characters, which are skipped.
+ *
+ * @param walk The options of the walk.
+ * @param root The directory which will be walked.
+ * @param storage The storage, which has to hold cpj_walk_storage_size bytes
+ * and has to be aligned like memory returned by malloc.
+ * @return Returns false if the root can not be opened, in which case errno is
+ * set. This is always the case on platforms other than Linux.
+ */
+CPJ_PUBLIC bool
+cpj_walk(const cpj_walk_t *walk, const cpj_char_t *root, void *storage);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -1,9 +1,40 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include <assert.h>
 #include <cpj.h>
 #include <ctype.h>
+#include <errno.h>
 #include <stdarg.h>
 #include <string.h>
 
+#ifdef CPJ_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) &&     \
+  defined(STATX_TYPE)
+#define CPJ_FS_IO_URING
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#endif
+#endif
+#endif
+
 typedef struct
 {
   const cpj_string_t *path_list_p;
@@ -28,26 +59,38 @@ bool cpj_path_is_separator(cpj_path_style_t style, const cpj_char_t ch)
   }
 } /* cpj_path_is_separator */
 
-static cpj_size_t cpj_path_get_root_windows(const cpj_char_t *path)
+/**
+ * Gets the character at `index`, treating the end of a sized string the same
+ * as the '\0' terminator.
+ */
+static cpj_char_t
+cpj_path_char_at(const cpj_char_t *path, cpj_size_t size, cpj_size_t index)
 {
-  const cpj_char_t *c;
+  return index < size ? path[index] : '\0';
+} /* cpj_path_char_at */
+
+static cpj_size_t
+cpj_path_get_root_windows(const cpj_char_t *path, cpj_size_t size)
+{
+  cpj_size_t i = 0;
   cpj_size_t length = 0;
   // We can not determine the root if this is an empty string. So we set the
   // root to NULL and the length to zero and cancel the whole thing.
-  c = path;
-  if (!*c) {
+  if (!cpj_path_char_at(path, size, i)) {
     return length;
   }
 
   // Now we have to verify whether this is a windows network path (UNC), which
   // we will consider our root.
-  if (cpj_path_is_separator(CPJ_STYLE_WINDOWS, *c)) {
+  if (cpj_path_is_separator(CPJ_STYLE_WINDOWS, path[i])) {
     bool is_device_path;
-    ++c;
+    ++i;
 
     // Check whether the path starts with a single backslash, which means this
     // is not a network path - just a normal path starting with a backslash.
-    if (!cpj_path_is_separator(CPJ_STYLE_WINDOWS, *c)) {
+    if (!cpj_path_is_separator(
+          CPJ_STYLE_WINDOWS, cpj_path_char_at(path, size, i)
+        )) {
       // Okay, this is not a network path but we still use the backslash as a
       // root.
       ++length;
@@ -61,9 +104,12 @@ static cpj_size_t cpj_path_get_root_windows(const cpj_char_t *path)
     // might advance one character here if the server name starts with a '?' or
     // a '.', but that's fine since we will search for a separator afterwards
     // anyway.
-    ++c;
-    is_device_path = (*c == '?' || *c == '.') &&
-                     cpj_path_is_separator(CPJ_STYLE_WINDOWS, *(++c));
+    ++i;
+    is_device_path = (cpj_path_char_at(path, size, i) == '?' ||
+                      cpj_path_char_at(path, size, i) == '.') &&
+                     cpj_path_is_separator(
+                       CPJ_STYLE_WINDOWS, cpj_path_char_at(path, size, ++i)
+                     );
     if (is_device_path) {
       // That's a device path, and the root must be either "\\.\" or "\\?\"
       // which is 4 characters long. (at least that's how Windows
@@ -74,64 +120,87 @@ static cpj_size_t cpj_path_get_root_windows(const cpj_char_t *path)
 
     // We will grab anything up to the next stop. The next stop might be a '\0'
     // or another separator. That will be the server name.
-    while (*c != '\0' && !cpj_path_is_separator(CPJ_STYLE_WINDOWS, *c)) {
-      ++c;
+    while (cpj_path_char_at(path, size, i) != '\0' &&
+           !cpj_path_is_separator(CPJ_STYLE_WINDOWS, path[i])) {
+      ++i;
     }
 
     // If this is a separator and not the end of a string we wil have to include
     // it. However, if this is a '\0' we must not skip it.
-    while (cpj_path_is_separator(CPJ_STYLE_WINDOWS, *c)) {
-      ++c;
+    while (cpj_path_is_separator(
+      CPJ_STYLE_WINDOWS, cpj_path_char_at(path, size, i)
+    )) {
+      ++i;
     }
 
     // We are now skipping the shared folder name, which will end after the
     // next stop.
-    while (*c != '\0' && !cpj_path_is_separator(CPJ_STYLE_WINDOWS, *c)) {
-      ++c;
+    while (cpj_path_char_at(path, size, i) != '\0' &&
+           !cpj_path_is_separator(CPJ_STYLE_WINDOWS, path[i])) {
+      ++i;
     }
     // Then there might be a separator at the end. We will include that as well,
     // it will mark the path as absolute.
-    if (cpj_path_is_separator(CPJ_STYLE_WINDOWS, *c)) {
-      ++c;
+    if (cpj_path_is_separator(
+          CPJ_STYLE_WINDOWS, cpj_path_char_at(path, size, i)
+        )) {
+      ++i;
     }
 
     // Finally, calculate the size of the root.
-    length = (cpj_size_t)(c - path);
+    length = i;
     return length;
   }
 
   // Move to the next and check whether this is a colon.
-  if (*++c == ':') {
+  if (cpj_path_char_at(path, size, ++i) == ':') {
     length = 2;
 
     // Now check whether this is a backslash (or slash). If it is not, we could
     // assume that the next character is a '\0' if it is a valid path. However,
     // we will not assume that - since ':' is not valid in a path it must be a
     // mistake by the caller than. We will try to understand it anyway.
-    if (cpj_path_is_separator(CPJ_STYLE_WINDOWS, *(++c))) {
+    if (cpj_path_is_separator(
+          CPJ_STYLE_WINDOWS, cpj_path_char_at(path, size, ++i)
+        )) {
       length = 3;
     }
   }
   return length;
 } /* cpj_path_get_root_windows */
 
-static cpj_size_t cpj_path_get_root_unix(const cpj_char_t *path)
+static cpj_size_t
+cpj_path_get_root_unix(const cpj_char_t *path, cpj_size_t size)
 {
   // The slash of the unix path represents the root. There is no root if there
   // is no slash.
-  return cpj_path_is_separator(CPJ_STYLE_UNIX, *path) ? 1 : 0;
+  return cpj_path_is_separator(CPJ_STYLE_UNIX, cpj_path_char_at(path, size, 0))
+           ? 1
+           : 0;
 } /* cpj_path_get_root_unix */
 
-cpj_size_t
-cpj_path_get_root(cpj_path_style_t path_style, const cpj_char_t *path)
+/**
+ * Determines the root length of a path which is not required to be
+ * zero-terminated, the root never extends beyond `size` characters.
+ */
+static cpj_size_t cpj_path_get_root_sized(
+  cpj_path_style_t path_style, const cpj_char_t *path, cpj_size_t size
+)
 {
   if (!path) {
     return 0;
   }
   // We use a different implementation here based on the configuration of the
   // library.
-  return path_style == CPJ_STYLE_WINDOWS ? cpj_path_get_root_windows(path)
-                                         : cpj_path_get_root_unix(path);
+  return path_style == CPJ_STYLE_WINDOWS
+           ? cpj_path_get_root_windows(path, size)
+           : cpj_path_get_root_unix(path, size);
+} /* cpj_path_get_root_sized */
+
+cpj_size_t
+cpj_path_get_root(cpj_path_style_t path_style, const cpj_char_t *path)
+{
+  return cpj_path_get_root_sized(path_style, path, CPJ_SIZE_MAX);
 } /* cpj_path_get_root */
 
 static bool cpj_path_iterator_before_root(cpj_segment_iterator_t *it)
@@ -211,7 +280,7 @@ static void cpj_path_get_prev_segment_detail(
         continue;
       }
     } else if (segment_length == 2) {
-      if (path_current->ptr[it->pos + 1] == '.' ||
+      if (path_current->ptr[it->pos + 1] == '.' &&
           path_current->ptr[it->pos + 2] == '.') {
         it->segment_eat_count += 1;
         continue;
@@ -369,7 +438,9 @@ static cpj_segment_iterator_t cpj_path_interator_init(
     if (it.root_length == 0 && (is_resolve || path_list_i == 0)) {
       /* Find the first root path from right to left when `is_resolve` are
        * `true` */
-      it.root_length = cpj_path_get_root(path_style, path_list_current->ptr);
+      it.root_length = cpj_path_get_root_sized(
+        path_style, path_list_current->ptr, path_list_current->size
+      );
       if (it.root_length > 0) {
         it.path_list_p += path_list_i;
         it.path_list_count -= path_list_i;
@@ -390,6 +461,220 @@ static cpj_segment_iterator_t cpj_path_interator_init(
   return it;
 } /* cpj_path_interator_init */
 
+/**
+ * Normalizes the path into the buffer from front to back in a single pass.
+ * The normalized path is never longer than the part which has been read so
+ * far, so the buffer may be the path itself. Only the `.` generated for paths
+ * like `` or `C:` takes one more character than the path, so the buffer must
+ * be able to hold `path_size + 1` characters. No '\0' terminator is written.
+ */
+static cpj_size_t cpj_path_normalize_forward(
+  cpj_path_style_t path_style, const cpj_char_t *path, cpj_size_t path_size,
+  cpj_char_t *buffer, cpj_size_t *root_length_p
+)
+{
+  cpj_size_t root_length = cpj_path_get_root_sized(path_style, path, path_size);
+  bool root_is_absolute =
+    root_length > 0 && cpj_path_is_separator(path_style, path[root_length - 1]);
+  cpj_char_t separator = path_style == CPJ_STYLE_UNIX ? '/' : '\\';
+  cpj_size_t segment_count = 0;
+  cpj_size_t read_index, write_index;
+
+  // The root is copied as it is, only the separators are unified.
+  for (write_index = 0; write_index < root_length; ++write_index) {
+    buffer[write_index] = cpj_path_is_separator(path_style, path[write_index])
+                            ? separator
+                            : path[write_index];
+  }
+
+  // The written segments act as the stack which is popped by a ".." segment.
+  read_index = root_length;
+  while (read_index < path_size) {
+    cpj_size_t segment_start, segment_length;
+    while (read_index < path_size &&
+           cpj_path_is_separator(path_style, path[read_index])) {
+      ++read_index;
+    }
+    segment_start = read_index;
+    while (read_index < path_size &&
+           !cpj_path_is_separator(path_style, path[read_index])) {
+      ++read_index;
+    }
+    segment_length = read_index - segment_start;
+    if (segment_length == 0 ||
+        (segment_length == 1 && path[segment_start] == '.')) {
+      continue;
+    }
+    if (segment_length == 2 && path[segment_start] == '.' &&
+        path[segment_start + 1] == '.') {
+      if (segment_count > 0) {
+        // Drop the previous segment together with its separator.
+        do {
+          --write_index;
+        } while (write_index > root_length &&
+                 buffer[write_index] != separator);
+        --segment_count;
+        continue;
+      }
+      if (root_is_absolute) {
+        // There is nothing above an absolute root.
+        continue;
+      }
+      // Leading ".." segments of relative paths are kept. They are never
+      // dropped by a later ".." segment, so they are not counted.
+    } else {
+      ++segment_count;
+    }
+    if (write_index > root_length) {
+      buffer[write_index++] = separator;
+    }
+    for (; segment_length > 0; --segment_length) {
+      buffer[write_index++] = path[segment_start++];
+    }
+  }
+
+  if (write_index == root_length && !root_is_absolute) {
+    // Paths like `` `C:` `abc/..` are normalized to `.` within the root.
+    buffer[write_index++] = '.';
+  }
+  if (root_length_p) {
+    *root_length_p = root_length;
+  }
+  return write_index;
+} /* cpj_path_normalize_forward */
+
+/**
+ * Finds the beginning of the basename of a path which has been generated by
+ * cpj_path_normalize_forward. The basename is empty if the path consists of
+ * the root only, and it is the `.` placeholder or a ".." segment if the path
+ * has no basename of its own.
+ */
+static cpj_size_t cpj_path_normalized_basename(
+  cpj_path_style_t path_style, const cpj_char_t *path, cpj_size_t path_size,
+  cpj_size_t root_length
+)
+{
+  cpj_size_t basename_index = path_size;
+  while (basename_index > root_length &&
+         !cpj_path_is_separator(path_style, path[basename_index - 1])) {
+    --basename_index;
+  }
+  return basename_index;
+} /* cpj_path_normalized_basename */
+
+/**
+ * Checks whether a segment is `.` or "..", which means it does not name a
+ * file of its own.
+ */
+static bool
+cpj_path_is_dot_segment(const cpj_char_t *segment, cpj_size_t segment_size)
+{
+  return (segment_size == 1 && segment[0] == '.') ||
+         (segment_size == 2 && segment[0] == '.' && segment[1] == '.');
+} /* cpj_path_is_dot_segment */
+
+/**
+ * Calculates the size of the path which cpj_path_normalize_forward would
+ * generate, without writing it. The segments are walked from back to front,
+ * so a segment is known to be dropped once the ".." segments behind it have
+ * been counted. The basename is set the same way as it would be found by
+ * cpj_path_normalized_basename, but it points into the original path unless
+ * it is the `.` placeholder or a generated ".." segment.
+ */
+static cpj_size_t cpj_path_normalized_size(
+  cpj_path_style_t path_style, const cpj_char_t *path, cpj_size_t path_size,
+  cpj_size_t *root_length_p, cpj_string_t *basename
+)
+{
+  cpj_size_t root_length = cpj_path_get_root_sized(path_style, path, path_size);
+  bool root_is_absolute =
+    root_length > 0 && cpj_path_is_separator(path_style, path[root_length - 1]);
+  cpj_size_t end = path_size, start, eat_count = 0, segment_count = 0;
+  cpj_size_t size = root_length;
+
+  basename->ptr = path + root_length;
+  basename->size = 0;
+  for (;;) {
+    while (end > root_length &&
+           cpj_path_is_separator(path_style, path[end - 1])) {
+      --end;
+    }
+    if (end == root_length) {
+      break;
+    }
+    start = end;
+    while (start > root_length &&
+           !cpj_path_is_separator(path_style, path[start - 1])) {
+      --start;
+    }
+    if (cpj_path_is_dot_segment(path + start, end - start)) {
+      eat_count += end - start - 1;
+    } else if (eat_count > 0) {
+      --eat_count;
+    } else {
+      if (segment_count++ == 0) {
+        basename->ptr = path + start;
+        basename->size = end - start;
+      }
+      size += end - start;
+    }
+    end = start;
+  }
+
+  if (!root_is_absolute && eat_count > 0) {
+    // The ".." segments which lead out of a relative path are kept in front.
+    if (segment_count == 0) {
+      basename->ptr = CPJ_ZSTR_LITERAL("..");
+      basename->size = 2;
+    }
+    segment_count += eat_count;
+    size += eat_count * 2;
+  }
+  if (segment_count > 0) {
+    size += segment_count - 1;
+  } else if (!root_is_absolute) {
+    basename->ptr = CPJ_ZSTR_LITERAL(".");
+    basename->size = 1;
+    ++size;
+  }
+  if (root_length_p) {
+    *root_length_p = root_length;
+  }
+  return size;
+} /* cpj_path_normalized_size */
+
+cpj_size_t cpj_path_normalize_inplace(
+  cpj_path_style_t path_style, cpj_char_t *path, cpj_size_t path_size,
+  cpj_size_t buffer_size
+)
+{
+  // The '.' placeholder is written at most at `path_size`, which is still
+  // within the buffer. Only the '\0' terminator may not fit behind it.
+  cpj_size_t size =
+    cpj_path_normalize_forward(path_style, path, path_size, path, NULL);
+  if (size < buffer_size) {
+    path[size] = '\0';
+  } else if (buffer_size > 0) {
+    path[buffer_size - 1] = '\0';
+  }
+  return size;
+} /* cpj_path_normalize_inplace */
+
+cpj_size_t cpj_path_join_max_size(
+  const cpj_string_t *path_list_p, cpj_size_t path_list_count
+)
+{
+  cpj_size_t path_list_i;
+  cpj_size_t max_size = 0;
+  // Every character of the generated path comes from one of the paths, except
+  // for the separators placed between two paths and a single '.' which is
+  // generated for paths like `` or `C:`.
+  for (path_list_i = 0; path_list_i < path_list_count; ++path_list_i) {
+    max_size += path_list_p[path_list_i].size + 1;
+  }
+  return path_list_count > 0 ? max_size : 1;
+} /* cpj_path_join_max_size */
+
 cpj_size_t cpj_path_join_multiple(
   cpj_path_style_t path_style, bool is_resolve, bool remove_trailing_slash,
   const cpj_string_t *path_list_p, cpj_size_t path_list_count,
@@ -397,12 +682,35 @@ cpj_size_t cpj_path_join_multiple(
 )
 {
   cpj_size_t buffer_size_calculated = 0;
+  bool write_at_tail = false;
+  if (buffer_p && path_list_count == 1 && remove_trailing_slash &&
+      buffer_p == path_list_p[0].ptr && buffer_size > path_list_p[0].size) {
+    /**
+     * Normalizing a path within its own buffer, which is compacted from front
+     * to back without moving the generated path afterwards.
+     */
+    return cpj_path_normalize_inplace(
+      path_style, buffer_p, path_list_p[0].size, buffer_size
+    );
+  }
+  if (buffer_p &&
+      buffer_size >
+        cpj_path_join_max_size(path_list_p, path_list_count)) {
+    /**
+     * The generated path is known to fit into `buffer_p`, so the pass for
+     * calculating the path size is skipped. The path is generated at the tail
+     * of `buffer_p` and moved to the head afterwards.
+     */
+    write_at_tail = true;
+    buffer_size_calculated = buffer_size;
+  }
   for (;;) {
     cpj_segment_iterator_t it = cpj_path_interator_init(
       path_style, is_resolve, remove_trailing_slash, path_list_p,
       path_list_count
     );
     cpj_size_t buffer_index = CPJ_SIZE_MAX;
+    cpj_size_t buffer_index_init;
     cpj_char_t *buffer_p_used;
 
     if (buffer_size_calculated == 0) {
@@ -411,7 +719,9 @@ cpj_size_t cpj_path_join_multiple(
       buffer_index = CPJ_SIZE_MAX;
     } else {
       buffer_p_used = buffer_p;
-      if (buffer_size_calculated > buffer_size) {
+      if (write_at_tail) {
+        buffer_index = buffer_size;
+      } else if (buffer_size_calculated > buffer_size) {
         /**
          * When `buffer_p` exist and `buffer_size_calculated > buffer_size`,
          * that means there is not enough buffer to storage the final generated
@@ -433,6 +743,7 @@ cpj_size_t cpj_path_join_multiple(
         }
       }
     }
+    buffer_index_init = buffer_index;
     cpj_path_push_front_char(
       path_style, buffer_p_used, buffer_size, &buffer_index, '\0'
     );
@@ -454,6 +765,9 @@ cpj_size_t cpj_path_join_multiple(
       }
       continue;
     }
+    if (write_at_tail) {
+      buffer_size_calculated = buffer_index_init - buffer_index;
+    }
     if (buffer_p) {
       if (buffer_index > 0 && buffer_index < buffer_size) {
         memmove(buffer_p, buffer_p + buffer_index, buffer_size_calculated);
@@ -486,6 +800,37 @@ bool cpj_path_get_basename(
   return path_is_root;
 } /* cpj_path_get_basename */
 
+/**
+ * Finds the extension within a basename, which starts at the last dot of the
+ * basename. Returns false if there is no dot.
+ */
+static bool
+cpj_path_find_extension(const cpj_string_t *basename, cpj_string_t *extension)
+{
+  const cpj_char_t *c;
+
+  if (basename->size == 0) {
+    return false;
+  }
+
+  // Now we search for a dot within the segment. If there is a dot, we consider
+  // the rest of the segment the extension. We do this from the end towards the
+  // beginning, since we want to find the last dot.
+  for (c = basename->ptr + basename->size - 1; c >= basename->ptr; --c) {
+    if (*c == '.') {
+      // Okay, we found an extension. We can stop looking now.
+      if (extension) {
+        extension->ptr = c;
+        extension->size = (cpj_size_t)(basename->ptr + basename->size - c);
+      }
+      return true;
+    }
+  }
+
+  // We couldn't find any extension.
+  return false;
+} /* cpj_path_find_extension */
+
 static bool cpj_path_is_string_equal(
   cpj_path_style_t path_style, const cpj_char_t *first,
   const cpj_char_t *second, cpj_size_t first_size, cpj_size_t second_size
@@ -647,6 +992,20 @@ static cpj_size_t cpj_path_relative_generate(
   return segment_eat_count;
 }
 
+cpj_size_t cpj_path_relative_max_size(
+  const cpj_string_t *cwd_directory, const cpj_string_t *base_directory,
+  const cpj_string_t *path
+)
+{
+  const cpj_string_t path_other[] = {*cwd_directory, *path};
+  // Every segment of the base path may turn into a "../", and a segment takes
+  // up at least two characters including its separator. The target is joined
+  // to the current directory in the worst case.
+  cpj_size_t base_segment_count =
+    (cwd_directory->size + base_directory->size) / 2 + 2;
+  return base_segment_count * 3 + cpj_path_join_max_size(path_other, 2);
+} /* cpj_path_relative_max_size */
+
 cpj_size_t cpj_path_get_relative(
   cpj_path_style_t path_style, const cpj_string_t *cwd_directory,
   const cpj_string_t *path_directory, const cpj_string_t *path,
@@ -741,210 +1100,7138 @@ bool cpj_path_is_relative(cpj_path_style_t path_style, const cpj_char_t *path)
   return !cpj_path_is_absolute(path_style, path);
 }
 
-cpj_size_t cpj_path_change_root(
-  cpj_path_style_t path_style, const cpj_string_t *path,
-  const cpj_string_t *new_root, cpj_char_t *buffer, cpj_size_t buffer_size
-)
-{
-  cpj_size_t root_length = cpj_path_get_root(path_style, path->ptr);
-  cpj_string_t paths[2];
-  paths[0] = *new_root;
-  paths[1].ptr = path->ptr + root_length;
-  paths[1].size = path->size - root_length;
-  return cpj_path_join_multiple(
-    path_style, false, true, paths, 2, buffer, buffer_size
-  );
-}
-
-cpj_size_t cpj_path_get_intersection(
-  cpj_path_style_t path_style, const cpj_string_t *path_base,
-  const cpj_string_t *path_other
+/**
+ * Finds the next segment of a path, starting at `*index`. Separators in front
+ * of the segment are skipped, and `*index` is moved behind the segment.
+ * Returns the size of the segment, which is 0 at the end of the path.
+ */
+static cpj_size_t cpj_path_next_segment(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_size_t *index,
+  const cpj_char_t **segment
 )
 {
-  cpj_path_intersection_t intersection =
-    cpj_path_get_intersection_segments(path_style, path_base, path_other, 1);
-  cpj_segment_iterator_t
-    it_base = cpj_path_interator_init(path_style, false, true, path_base, 1);
-  cpj_size_t k;
-  if (intersection.equal_segment == 0) {
-    return 0;
+  cpj_size_t i = *index;
+  while (i < path->size && cpj_path_is_separator(path_style, path->ptr[i])) {
+    ++i;
   }
-  for (k = intersection.segment_count_base; k >= intersection.equal_segment;) {
-    k -= 1;
-    cpj_path_get_prev_segment(path_style, &it_base);
+  *segment = path->ptr + i;
+  while (i < path->size && !cpj_path_is_separator(path_style, path->ptr[i])) {
+    ++i;
   }
-  cpj_string_t segment = cpj_path_get_segment(&it_base);
-  return segment.ptr - path_base->ptr + segment.size;
-}
+  *index = i;
+  return (cpj_size_t)(path->ptr + i - *segment);
+} /* cpj_path_next_segment */
 
-cpj_size_t cpj_path_change_basename(
-  cpj_path_style_t path_style, const cpj_string_t *path,
-  const cpj_string_t *new_basename, cpj_char_t *buffer, cpj_size_t buffer_size
+bool cpj_path_escapes_root(
+  cpj_path_style_t path_style, const cpj_string_t *path
 )
 {
-  cpj_string_t paths[2] = {*path, *new_basename};
-  cpj_string_t basename;
-  // First we try to get the last segment. We may only have a root without any
-  // segments, in which case we will create one.
-  cpj_path_get_basename(path_style, path, &basename);
-  paths[0].size -= basename.size;
-  return cpj_path_join_multiple(
-    path_style, true, true, paths, 2, buffer, buffer_size
-  );
-}
+  const cpj_char_t *segment;
+  cpj_size_t i = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t segment_size, depth = 0;
 
-bool cpj_path_get_extension(
-  cpj_path_style_t path_style, const cpj_string_t *path, cpj_string_t *extension
+  for (;;) {
+    segment_size = cpj_path_next_segment(path_style, path, &i, &segment);
+    if (segment_size == 0) {
+      break;
+    }
+    if (segment_size == 2 && segment[0] == '.' && segment[1] == '.') {
+      if (depth == 0) {
+        return true;
+      }
+      --depth;
+    } else if (segment_size != 1 || segment[0] != '.') {
+      ++depth;
+    }
+  }
+  return false;
+} /* cpj_path_escapes_root */
+
+bool cpj_path_max_depth_reached(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_size_t max_depth
 )
 {
-  const cpj_char_t *c;
-  cpj_string_t basename;
-  // First we try to get the last segment. We may only have a root without any
-  // segments, in which case we will create one.
-  cpj_path_get_basename(path_style, path, &basename);
+  const cpj_char_t *segment;
+  cpj_size_t i = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t segment_size, depth = 0;
 
-  // We get the last segment of the path. The last segment will contain the
-  // extension if there is any.
-  if (basename.size == 0) {
-    return false;
+  if (max_depth == 0) {
+    return true;
   }
-
-  // Now we search for a dot within the segment. If there is a dot, we consider
-  // the rest of the segment the extension. We do this from the end towards the
-  // beginning, since we want to find the last dot.
-  for (c = basename.ptr + basename.size - 1; c >= basename.ptr; --c) {
-    if (*c == '.') {
-      // Okay, we found an extension. We can stop looking now.
-      if (extension) {
-        extension->ptr = c;
-        extension->size = (cpj_size_t)(basename.ptr + basename.size - c);
+  for (;;) {
+    segment_size = cpj_path_next_segment(path_style, path, &i, &segment);
+    if (segment_size == 0) {
+      break;
+    }
+    if (segment_size == 2 && segment[0] == '.' && segment[1] == '.') {
+      if (depth > 0) {
+        --depth;
+      }
+    } else if (segment_size != 1 || segment[0] != '.') {
+      if (++depth == max_depth) {
+        return true;
       }
-      return true;
     }
   }
-
-  // We couldn't find any extension.
   return false;
-}
+} /* cpj_path_max_depth_reached */
 
-cpj_size_t
-cpj_path_get_dirname(cpj_path_style_t path_style, const cpj_string_t *path)
+static void cpj_sort_key_put(
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *buffer_index,
+  unsigned char byte
+)
 {
-  cpj_string_t basename;
-  // First we try to get the last segment. We may only have a root without any
-  // segments, in which case we will create one.
-  cpj_path_get_basename(path_style, path, &basename);
+  if (*buffer_index < buffer_size) {
+    buffer[*buffer_index] = (cpj_char_t)byte;
+  }
+  ++*buffer_index;
+} /* cpj_sort_key_put */
 
-  // We can now return the length from the beginning of the string up to the
-  // beginning of the last segment.
-  return basename.ptr ? (cpj_size_t)(basename.ptr - path->ptr) : path->size;
-}
+/**
+ * Puts a character of a segment or the root into the key. The bytes 0 and 1
+ * are escaped, so that a 0 byte only ever ends a component of the key.
+ */
+static void cpj_sort_key_put_char(
+  cpj_path_style_t path_style, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *buffer_index, cpj_char_t ch
+)
+{
+  unsigned char byte = (unsigned char)ch;
+  if (path_style == CPJ_STYLE_WINDOWS) {
+    byte = cpj_path_is_separator(path_style, ch) ? (unsigned char)'/'
+                                                 : (unsigned char)tolower(byte);
+  }
+  if (byte <= 1) {
+    cpj_sort_key_put(buffer, buffer_size, buffer_index, 1);
+    ++byte;
+  }
+  cpj_sort_key_put(buffer, buffer_size, buffer_index, byte);
+} /* cpj_sort_key_put_char */
 
-cpj_size_t cpj_path_change_extension(
-  cpj_path_style_t path_style, const cpj_string_t *path,
-  const cpj_string_t *new_extension, cpj_char_t *buffer, cpj_size_t buffer_size
+/**
+ * Puts a run of digits into the key. The run is put as a '0' marker, the
+ * number of significant digits and the digits themselves, followed by the
+ * number of leading zeros to keep `1` and `01` apart. The counts are stored
+ * with an offset of 2 to stay clear of the bytes 0 and 1.
+ */
+static void cpj_sort_key_put_number(
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *buffer_index,
+  const cpj_char_t *digits, cpj_size_t digit_count
 )
 {
-  bool new_extention_start_with_dot = new_extension->size > 0 &&
-                                      new_extension->ptr[0] == '.';
-  if (cpj_path_get_root(path_style, path->ptr) == path->size) {
-    cpj_size_t buffer_size_needed = path->size + new_extension->size + 1;
-    if (!new_extention_start_with_dot) {
-      buffer_size_needed += 1;
-    }
-    cpj_size_t buffer_index = buffer_size_needed;
-    cpj_path_push_front_char(
-      path_style, buffer, buffer_size, &buffer_index, '\0'
-    );
-    cpj_path_push_front_string(
-      path_style, buffer, buffer_size, &buffer_index, new_extension
+  cpj_size_t zero_count = 0;
+  cpj_size_t chunk_size, i;
+
+  while (zero_count < digit_count && digits[zero_count] == '0') {
+    ++zero_count;
+  }
+  digits += zero_count;
+  digit_count -= zero_count;
+
+  // Numbers with more than 253 digits are split into chunks, which keeps
+  // them in order as long as the first chunk is full.
+  do {
+    chunk_size = digit_count < 253 ? digit_count : 253;
+    cpj_sort_key_put(buffer, buffer_size, buffer_index, '0');
+    cpj_sort_key_put(
+      buffer, buffer_size, buffer_index, (unsigned char)(chunk_size + 2)
     );
-    if (!new_extention_start_with_dot) {
-      cpj_path_push_front_char(
-        path_style, buffer, buffer_size, &buffer_index, '.'
+    for (i = 0; i < chunk_size; ++i) {
+      cpj_sort_key_put(
+        buffer, buffer_size, buffer_index, (unsigned char)digits[i]
       );
     }
-    cpj_path_push_front_string(
-      path_style, buffer, buffer_size, &buffer_index, path
-    );
-    return buffer_size_needed - 1;
-  } else {
-    cpj_string_t paths[2] = {*path, *new_extension};
-    cpj_string_t extention;
-    if (cpj_path_get_extension(path_style, &(paths[0]), &extention)) {
-      paths[0].size = extention.ptr - paths[0].ptr;
-    }
-    if (new_extention_start_with_dot) {
-      paths[1].ptr += 1;
-      paths[1].size -= 1;
-    }
-    cpj_size_t path_size = cpj_path_join_multiple(
-      path_style, true, true, paths, 2, buffer, buffer_size
-    );
-    if (paths[1].size > 0) {
-      cpj_size_t pos = path_size - paths[1].size;
-      if (pos > 0 && pos < buffer_size) {
-        buffer[pos - 1] = '.';
-      }
-    }
-    return path_size;
-  }
-}
+    digits += chunk_size;
+    digit_count -= chunk_size;
+  } while (digit_count > 0);
 
-cpj_path_style_t cpj_path_guess_style(const cpj_string_t *path)
-{
-  const cpj_char_t *c;
-  cpj_size_t root_length;
+  cpj_sort_key_put(
+    buffer, buffer_size, buffer_index,
+    (unsigned char)((zero_count < 253 ? zero_count : 253) + 2)
+  );
+} /* cpj_sort_key_put_number */
+
+cpj_size_t cpj_path_sort_key(
+  cpj_path_style_t path_style, const cpj_string_t *path, bool natural_order,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  const cpj_char_t *segment;
+  cpj_size_t root_size, segment_size, i, j, buffer_index = 0, depth = 0;
+  bool root_is_absolute;
+
+  root_size = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  root_is_absolute = root_size > 0 && cpj_path_is_separator(
+                                        path_style, path->ptr[root_size - 1]
+                                      );
+  for (i = 0; i < root_size; ++i) {
+    cpj_sort_key_put_char(
+      path_style, buffer, buffer_size, &buffer_index, path->ptr[i]
+    );
+  }
+  cpj_sort_key_put(buffer, buffer_size, &buffer_index, 0);
+
+  // Each segment is followed by a 0 byte, which sorts before any character of
+  // a segment. The key is always complete up to the last segment, so a ".."
+  // segment removes the last segment by going back to the 0 byte in front of
+  // it.
+  for (i = root_size; buffer_index <= buffer_size;) {
+    segment_size = cpj_path_next_segment(path_style, path, &i, &segment);
+    if (segment_size == 0) {
+      break;
+    } else if (segment_size == 1 && segment[0] == '.') {
+      continue;
+    } else if (segment_size == 2 && segment[0] == '.' && segment[1] == '.') {
+      if (depth > 0) {
+        --depth;
+        --buffer_index;
+        while (buffer[buffer_index - 1] != '\0') {
+          --buffer_index;
+        }
+        continue;
+      } else if (root_is_absolute) {
+        continue;
+      }
+    } else {
+      ++depth;
+    }
+
+    for (j = 0; j < segment_size; ++j) {
+      if (natural_order && isdigit((unsigned char)segment[j])) {
+        cpj_size_t digit_count = 1;
+        while (j + digit_count < segment_size &&
+               isdigit((unsigned char)segment[j + digit_count])) {
+          ++digit_count;
+        }
+        cpj_sort_key_put_number(
+          buffer, buffer_size, &buffer_index, segment + j, digit_count
+        );
+        j += digit_count - 1;
+      } else {
+        cpj_sort_key_put_char(
+          path_style, buffer, buffer_size, &buffer_index, segment[j]
+        );
+      }
+    }
+    cpj_sort_key_put(buffer, buffer_size, &buffer_index, 0);
+  }
+
+  return buffer_index <= buffer_size ? buffer_index : 0;
+} /* cpj_path_sort_key */
+
+/**
+ * Gets the character of a path at a position of the sort order. The sort
+ * order looks at the characters of a path the same way as a sort key does:
+ * the root is followed by a separator of its own, the separators rank below
+ * all the other characters, and the end of the path ranks below everything.
+ * The root size is looked up unless it is passed in `root_size`.
+ */
+static int cpj_path_sort_char(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_size_t position,
+  cpj_size_t root_size
+)
+{
+  unsigned char ch;
+  bool is_separator;
+
+  if (root_size == CPJ_SIZE_MAX) {
+    root_size = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  }
+  if (position == root_size) {
+    return 1;
+  } else if (position > root_size) {
+    // A path which is only a `.` has no segments, like the empty path.
+    --position;
+    if (position >= path->size ||
+        (path->size == root_size + 1 && path->ptr[root_size] == '.')) {
+      return 0;
+    }
+  }
+
+  ch = (unsigned char)path->ptr[position];
+  is_separator = ch == '/' || (path_style == CPJ_STYLE_WINDOWS && ch == '\\');
+  if (is_separator && position >= root_size) {
+    return 1;
+  } else if (path_style == CPJ_STYLE_WINDOWS) {
+    ch = is_separator ? (unsigned char)'/' : (unsigned char)tolower(ch);
+  }
+  return ch + 2;
+} /* cpj_path_sort_char */
+
+static void cpj_path_sort_swap(cpj_string_t *a, cpj_string_t *b)
+{
+  cpj_string_t tmp = *a;
+  *a = *b;
+  *b = tmp;
+} /* cpj_path_sort_swap */
+
+/**
+ * Sorts a few paths whose first `position` characters are equal by insertion.
+ */
+static void cpj_path_sort_insertion(
+  cpj_path_style_t path_style, cpj_string_t *paths, cpj_size_t path_count,
+  cpj_size_t position, cpj_size_t root_size
+)
+{
+  cpj_size_t i, j, k;
+  for (i = 1; i < path_count; ++i) {
+    for (j = i; j > 0; --j) {
+      int a, b;
+      k = position;
+      do {
+        a = cpj_path_sort_char(path_style, paths + j - 1, k, root_size);
+        b = cpj_path_sort_char(path_style, paths + j, k, root_size);
+        ++k;
+      } while (a == b && a != 0);
+      if (a <= b) {
+        break;
+      }
+      cpj_path_sort_swap(paths + j - 1, paths + j);
+    }
+  }
+} /* cpj_path_sort_insertion */
+
+typedef struct
+{
+  cpj_path_style_t path_style;
+  cpj_string_t *paths;
+  cpj_size_t path_count;
+  cpj_size_t position;
+  cpj_size_t root_size; /**< CPJ_SIZE_MAX until it is the same for all */
+  unsigned int thread_count; /**< threads this range may start */
+} cpj_path_sort_range_t;
+
+static void cpj_path_sort_range(cpj_path_sort_range_t range);
+
+#ifdef CPJ_THREADS
+static void *cpj_path_sort_thread(void *argument)
+{
+  cpj_path_sort_range(*(cpj_path_sort_range_t *)argument);
+  return NULL;
+} /* cpj_path_sort_thread */
+#endif
+
+/**
+ * Sorts paths whose first `position` characters are equal using a multikey
+ * quicksort. Each step partitions the paths by a single character into the
+ * paths below, equal to and above the pivot, so that every character is only
+ * looked at once in the equal part. The part below the pivot is sorted on
+ * another thread as long as there are threads left.
+ */
+static void cpj_path_sort_range(cpj_path_sort_range_t range)
+{
+  cpj_path_style_t path_style = range.path_style;
+
+  while (range.path_count > 1) {
+    cpj_string_t *paths = range.paths;
+    cpj_size_t count = range.path_count;
+    cpj_size_t position = range.position;
+    cpj_path_sort_range_t lower = range, upper = range;
+    cpj_size_t lt = 0, gt = count, i = 0;
+    int pivot, a, b, c;
+#ifdef CPJ_THREADS
+    pthread_t thread;
+    bool has_thread = false;
+#endif
+
+    if (count < 16) {
+      cpj_path_sort_insertion(
+        path_style, paths, count, range.position, range.root_size
+      );
+      return;
+    }
+
+    // The median of three keeps already sorted lists from degrading.
+    a = cpj_path_sort_char(path_style, paths, position, range.root_size);
+    b = cpj_path_sort_char(
+      path_style, paths + count / 2, position, range.root_size
+    );
+    c = cpj_path_sort_char(
+      path_style, paths + count - 1, position, range.root_size
+    );
+    pivot = a < b ? (b < c ? b : (a < c ? c : a))
+                  : (a < c ? a : (b < c ? c : b));
+
+    while (i < gt) {
+      int ch = cpj_path_sort_char(
+        path_style, paths + i, position, range.root_size
+      );
+      if (ch < pivot) {
+        cpj_path_sort_swap(paths + lt++, paths + i++);
+      } else if (ch > pivot) {
+        cpj_path_sort_swap(paths + i, paths + --gt);
+      } else {
+        ++i;
+      }
+    }
+
+    lower.path_count = lt;
+    upper.paths = paths + gt;
+    upper.path_count = count - gt;
+#ifdef CPJ_THREADS
+    if (range.thread_count > 0 && lower.path_count > 4096) {
+      // The other parts are sorted one after another on this thread, so
+      // they share the rest of the threads.
+      lower.thread_count = (range.thread_count - 1) / 2;
+      range.thread_count -= 1 + lower.thread_count;
+      upper.thread_count = range.thread_count;
+      has_thread = pthread_create(
+                     &thread, NULL, cpj_path_sort_thread, &lower
+                   ) == 0;
+    }
+    if (!has_thread) {
+      cpj_path_sort_range(lower);
+    }
+#else
+    cpj_path_sort_range(lower);
+#endif
+    cpj_path_sort_range(upper);
+#ifdef CPJ_THREADS
+    if (has_thread) {
+      pthread_join(thread, NULL);
+    }
+#endif
+
+    // The paths which are equal to the pivot continue with the next
+    // character, unless all of them have ended. The first separator they
+    // share is the one behind the root, since the characters of a root never
+    // rank as separators. From there on the root size is known.
+    if (pivot == 0) {
+      return;
+    } else if (pivot == 1 && range.root_size == CPJ_SIZE_MAX) {
+      range.root_size = position;
+    }
+    range.paths = paths + lt;
+    range.path_count = gt - lt;
+    ++range.position;
+  }
+} /* cpj_path_sort_range */
+
+void cpj_path_sort(
+  cpj_path_style_t path_style, cpj_string_t *paths, cpj_size_t path_count,
+  unsigned int flags
+)
+{
+  cpj_path_sort_range_t range;
+  range.path_style = path_style;
+  range.paths = paths;
+  range.path_count = path_count;
+  range.position = 0;
+  range.root_size = CPJ_SIZE_MAX;
+  range.thread_count = 0;
+#ifdef CPJ_THREADS
+  if (flags & CPJ_SORT_PARALLEL) {
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    range.thread_count = cpu_count > 1 ? (unsigned int)(cpu_count - 1) : 0;
+  }
+#else
+  (void)flags;
+#endif
+  cpj_path_sort_range(range);
+} /* cpj_path_sort */
+
+void cpj_path_index_init(
+  cpj_path_index_t *index, cpj_path_style_t path_style,
+  const cpj_string_column_t *paths
+)
+{
+  index->path_style = path_style;
+  index->paths = *paths;
+} /* cpj_path_index_init */
+
+static cpj_string_t
+cpj_path_index_get(const cpj_path_index_t *index, cpj_size_t position)
+{
+  cpj_string_t path;
+  path.ptr = index->paths.data + index->paths.offsets[position];
+  path.size =
+    index->paths.offsets[position + 1] - index->paths.offsets[position];
+  return path;
+} /* cpj_path_index_get */
+
+/**
+ * A bound of a binary search, which consists of the first `size` characters
+ * of a path in sort order, followed by a single character.
+ */
+typedef struct
+{
+  const cpj_string_t *path;
+  cpj_size_t root_size;
+  cpj_size_t size;
+  int last;
+} cpj_path_index_bound_t;
+
+/**
+ * Checks whether a path in the index sorts before the bound.
+ */
+static bool cpj_path_index_is_before(
+  const cpj_path_index_t *index, const cpj_string_t *path,
+  const cpj_path_index_bound_t *bound
+)
+{
+  cpj_path_style_t path_style = index->path_style;
+  cpj_size_t root_size =
+    cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t i;
+  int a, b;
+
+  for (i = 0; i < bound->size; ++i) {
+    a = cpj_path_sort_char(path_style, path, i, root_size);
+    b = cpj_path_sort_char(path_style, bound->path, i, bound->root_size);
+    if (a != b) {
+      return a < b;
+    }
+  }
+  return cpj_path_sort_char(path_style, path, i, root_size) < bound->last;
+} /* cpj_path_index_is_before */
+
+/**
+ * Finds the position of the first path which does not sort before the bound.
+ */
+static cpj_size_t cpj_path_index_lower_bound(
+  const cpj_path_index_t *index, const cpj_path_index_bound_t *bound,
+  cpj_size_t first, cpj_size_t last
+)
+{
+  while (first < last) {
+    cpj_size_t middle = first + (last - first) / 2;
+    cpj_string_t path = cpj_path_index_get(index, middle);
+    if (cpj_path_index_is_before(index, &path, bound)) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return first;
+} /* cpj_path_index_lower_bound */
+
+bool cpj_path_index_lookup(
+  const cpj_path_index_t *index, const cpj_string_t *path,
+  cpj_size_t *position
+)
+{
+  cpj_path_index_bound_t bound;
+  cpj_size_t found;
+  cpj_string_t other;
+
+  // The bound is the whole path followed by the end of the path, so the
+  // search stops at the path itself.
+  bound.path = path;
+  bound.root_size =
+    cpj_path_get_root_sized(index->path_style, path->ptr, path->size);
+  bound.size = path->size + 1;
+  bound.last = 0;
+  found = cpj_path_index_lower_bound(index, &bound, 0, index->paths.count);
+  if (position) {
+    *position = found;
+  }
+  if (found == index->paths.count) {
+    return false;
+  }
+  other = cpj_path_index_get(index, found);
+  bound.path = &other;
+  bound.root_size = cpj_path_get_root_sized(
+    index->path_style, other.ptr, other.size
+  );
+  bound.size = other.size + 1;
+  return !cpj_path_index_is_before(index, path, &bound);
+} /* cpj_path_index_lookup */
+
+/**
+ * Finds the range of the descendants of a path, within a range of the index.
+ */
+static cpj_size_t cpj_path_index_find_descendants(
+  const cpj_path_index_t *index, const cpj_string_t *path, cpj_size_t *first,
+  cpj_size_t last
+)
+{
+  cpj_path_index_bound_t lower, upper;
+  cpj_size_t root_size =
+    cpj_path_get_root_sized(index->path_style, path->ptr, path->size);
+
+  // The descendants start with the path followed by a separator. A path
+  // without any segments already ends with the separator behind its root,
+  // so its `.` is not part of the prefix.
+  lower.path = path;
+  lower.root_size = root_size;
+  lower.size = path->size + 1;
+  if (path->size == root_size ||
+      (path->size == root_size + 1 && path->ptr[root_size] == '.')) {
+    lower.size = root_size + 1;
+  }
+  lower.last = 1;
+  upper = lower;
+  upper.last = 2;
+  if (lower.size == root_size + 1) {
+    upper.size = root_size;
+  }
+
+  *first = cpj_path_index_lower_bound(index, &lower, *first, last);
+  return cpj_path_index_lower_bound(index, &upper, *first, last) - *first;
+} /* cpj_path_index_find_descendants */
+
+cpj_size_t cpj_path_index_descendants_of(
+  const cpj_path_index_t *index, const cpj_string_t *path, cpj_size_t *first
+)
+{
+  *first = 0;
+  return cpj_path_index_find_descendants(
+    index, path, first, index->paths.count
+  );
+} /* cpj_path_index_descendants_of */
+
+cpj_size_t cpj_path_index_children_of(
+  const cpj_path_index_t *index, const cpj_string_t *path,
+  cpj_size_t *children, cpj_size_t children_size
+)
+{
+  cpj_size_t root_size =
+    cpj_path_get_root_sized(index->path_style, path->ptr, path->size);
+  cpj_size_t child_start, position, last, count = 0;
+
+  last = cpj_path_index_descendants_of(index, path, &position);
+  last += position;
+
+  // The segment of a child starts right behind the separator which follows
+  // the path, or right behind the root if the path has no segments.
+  child_start = path->size + 1;
+  if (path->size == root_size ||
+      (path->size == root_size + 1 && path->ptr[root_size] == '.')) {
+    child_start = root_size;
+  }
+
+  while (position < last) {
+    cpj_string_t child = cpj_path_index_get(index, position);
+    cpj_size_t child_size = child_start;
+    while (child_size < child.size &&
+           !cpj_path_is_separator(index->path_style, child.ptr[child_size])) {
+      ++child_size;
+    }
+    if (child_size == child.size) {
+      if (count < children_size) {
+        children[count] = position;
+      }
+      ++count;
+      ++position;
+      continue;
+    }
+
+    // The path is below a child, which is followed by all of its descendants.
+    // They are skipped at once.
+    child.size = child_size;
+    position += cpj_path_index_find_descendants(index, &child, &position, last);
+  }
+  return count;
+} /* cpj_path_index_children_of */
+
+static cpj_string_t
+cpj_path_column_get(const cpj_string_column_t *paths, cpj_size_t position)
+{
+  cpj_string_t path;
+  path.ptr = paths->data + paths->offsets[position];
+  path.size = paths->offsets[position + 1] - paths->offsets[position];
+  return path;
+} /* cpj_path_column_get */
+
+/**
+ * Counts the characters two strings have in common at their beginning,
+ * comparing a whole word at a time where possible.
+ */
+static cpj_size_t cpj_string_common_size(
+  const cpj_char_t *first, const cpj_char_t *second, cpj_size_t size
+)
+{
+  cpj_size_t i = 0;
+
+  while (i + sizeof(size_t) <= size) {
+    size_t a, b;
+    memcpy(&a, first + i, sizeof(a));
+    memcpy(&b, second + i, sizeof(b));
+    if (a != b) {
+      break;
+    }
+    i += sizeof(size_t);
+  }
+  while (i < size && first[i] == second[i]) {
+    ++i;
+  }
+  return i;
+} /* cpj_string_common_size */
+
+/**
+ * Skips the characters two paths with roots of the same size have in common.
+ * Equal characters behind the root rank the same, so the returned position of
+ * the sort order is the first one where the paths might differ.
+ */
+static cpj_size_t cpj_path_sort_skip_equal(
+  const cpj_string_t *first, const cpj_string_t *second, cpj_size_t root_size
+)
+{
+  cpj_size_t size = first->size < second->size ? first->size : second->size;
+  cpj_size_t i = cpj_string_common_size(first->ptr, second->ptr, size);
+  return i > root_size + 1 ? i : 0;
+} /* cpj_path_sort_skip_equal */
+
+/**
+ * Compares two normalized paths in sort order, like strcmp does for strings.
+ */
+static int cpj_path_sort_compare(
+  cpj_path_style_t path_style, const cpj_string_t *first,
+  const cpj_string_t *second
+)
+{
+  cpj_size_t first_root_size =
+    cpj_path_get_root_sized(path_style, first->ptr, first->size);
+  cpj_size_t second_root_size =
+    cpj_path_get_root_sized(path_style, second->ptr, second->size);
+  cpj_size_t i = 0;
+
+  if (first_root_size == second_root_size) {
+    i = cpj_path_sort_skip_equal(first, second, first_root_size);
+  }
+  for (;; ++i) {
+    int a = cpj_path_sort_char(path_style, first, i, first_root_size);
+    int b = cpj_path_sort_char(path_style, second, i, second_root_size);
+    if (a != b) {
+      return a < b ? -1 : 1;
+    } else if (a == 0) {
+      return 0;
+    }
+  }
+} /* cpj_path_sort_compare */
+
+/**
+ * Checks whether a normalized path is a directory or below it. A directory
+ * without segments contains all the paths with the same root.
+ */
+static bool cpj_path_is_within(
+  cpj_path_style_t path_style, const cpj_string_t *directory,
+  const cpj_string_t *path
+)
+{
+  cpj_size_t directory_root_size =
+    cpj_path_get_root_sized(path_style, directory->ptr, directory->size);
+  cpj_size_t root_size =
+    cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t size = directory->size, i;
+  int ch;
+
+  if (cpj_path_sort_char(
+        path_style, directory, directory_root_size + 1, directory_root_size
+      ) == 0) {
+    size = directory_root_size;
+  }
+  if (path->size < size) {
+    return false;
+  }
+  i = 0;
+  if (directory_root_size == root_size) {
+    i = cpj_path_sort_skip_equal(directory, path, root_size);
+  }
+  for (; i <= size; ++i) {
+    if (cpj_path_sort_char(path_style, directory, i, directory_root_size) !=
+        cpj_path_sort_char(path_style, path, i, root_size)) {
+      return false;
+    }
+  }
+  if (size == directory_root_size) {
+    return true;
+  }
+  ch = cpj_path_sort_char(path_style, path, i, root_size);
+  return ch == 0 || ch == 1;
+} /* cpj_path_is_within */
+
+void cpj_path_diff_sorted(
+  cpj_path_diff_t *diff, cpj_path_style_t path_style,
+  const cpj_string_column_t *old_paths, const cpj_string_column_t *new_paths,
+  unsigned int flags
+)
+{
+  diff->path_style = path_style;
+  diff->old_paths = *old_paths;
+  diff->new_paths = *new_paths;
+  diff->old_position = 0;
+  diff->new_position = 0;
+  diff->flags = flags;
+} /* cpj_path_diff_sorted */
+
+/**
+ * Finds the topmost directory of a path which only exists in one of the
+ * lists. The directory must not contain any path of the other list, and no
+ * path of the same list in front of the path, since that one has already
+ * been reported. Both lists are sorted, so only the paths next to the path
+ * have to be checked. The path itself is the last candidate.
+ */
+static bool cpj_path_diff_collapse(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths,
+  cpj_size_t position, const cpj_string_column_t *other_paths,
+  cpj_size_t other_position, cpj_string_t *directory
+)
+{
+  cpj_string_t path = cpj_path_column_get(paths, position);
+  cpj_string_t neighbours[3];
+  cpj_size_t neighbour_count = 0, i;
+  bool is_collapsible;
+
+  if (position > 0) {
+    neighbours[neighbour_count++] = cpj_path_column_get(paths, position - 1);
+  }
+  if (other_position > 0) {
+    neighbours[neighbour_count++] =
+      cpj_path_column_get(other_paths, other_position - 1);
+  }
+  if (other_position < other_paths->count) {
+    neighbours[neighbour_count++] =
+      cpj_path_column_get(other_paths, other_position);
+  }
+
+  directory->ptr = path.ptr;
+  directory->size = cpj_path_get_root_sized(path_style, path.ptr, path.size);
+  do {
+    // The next candidate ends in front of the next separator.
+    do {
+      ++directory->size;
+    } while (directory->size < path.size &&
+             !cpj_path_is_separator(path_style, path.ptr[directory->size]));
+    if (directory->size > path.size) {
+      directory->size = path.size;
+    }
+
+    is_collapsible = true;
+    for (i = 0; i < neighbour_count && is_collapsible; ++i) {
+      is_collapsible =
+        !cpj_path_is_within(path_style, directory, neighbours + i);
+    }
+    if (is_collapsible) {
+      return true;
+    }
+  } while (directory->size < path.size);
+
+  return false;
+} /* cpj_path_diff_collapse */
+
+bool cpj_path_diff_next(cpj_path_diff_t *diff, cpj_path_diff_entry_t *entry)
+{
+  cpj_path_style_t path_style = diff->path_style;
+  const cpj_string_column_t *paths;
+  const cpj_string_column_t *other_paths;
+  cpj_size_t *position, other_position;
+  cpj_string_t path;
+  int result;
+
+  for (;;) {
+    bool has_old = diff->old_position < diff->old_paths.count;
+    bool has_new = diff->new_position < diff->new_paths.count;
+
+    if (!has_old && !has_new) {
+      return false;
+    } else if (!has_new) {
+      result = -1;
+    } else if (!has_old) {
+      result = 1;
+    } else {
+      cpj_string_t old_path =
+        cpj_path_column_get(&diff->old_paths, diff->old_position);
+      cpj_string_t new_path =
+        cpj_path_column_get(&diff->new_paths, diff->new_position);
+      result = cpj_path_sort_compare(path_style, &old_path, &new_path);
+    }
+
+    if (result != 0) {
+      break;
+    }
+
+    ++diff->old_position;
+    if (!(diff->flags & CPJ_DIFF_SKIP_COMMON)) {
+      entry->type = CPJ_DIFF_COMMON;
+      entry->path = cpj_path_column_get(&diff->new_paths, diff->new_position);
+      entry->position = diff->new_position++;
+      entry->count = 1;
+      return true;
+    }
+    ++diff->new_position;
+  }
+
+  // The smaller path only exists in its own list.
+  if (result < 0) {
+    entry->type = CPJ_DIFF_REMOVED;
+    paths = &diff->old_paths;
+    other_paths = &diff->new_paths;
+    position = &diff->old_position;
+    other_position = diff->new_position;
+  } else {
+    entry->type = CPJ_DIFF_ADDED;
+    paths = &diff->new_paths;
+    other_paths = &diff->old_paths;
+    position = &diff->new_position;
+    other_position = diff->old_position;
+  }
+
+  entry->position = *position;
+  entry->path = cpj_path_column_get(paths, *position);
+  entry->count = 1;
+  ++*position;
+  if (!(diff->flags & CPJ_DIFF_COLLAPSE) ||
+      !cpj_path_diff_collapse(
+        path_style, paths, entry->position, other_paths, other_position,
+        &entry->path
+      )) {
+    return true;
+  }
+
+  // The rest of the subtree follows the path within its list.
+  while (*position < paths->count) {
+    path = cpj_path_column_get(paths, *position);
+    if (!cpj_path_is_within(path_style, &entry->path, &path)) {
+      break;
+    }
+    ++*position;
+    ++entry->count;
+  }
+  return true;
+} /* cpj_path_diff_next */
+
+void cpj_rollup_init(
+  cpj_rollup_t *rollup, cpj_path_style_t path_style, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_rollup_level_t *levels, cpj_size_t level_size
+)
+{
+  rollup->path_style = path_style;
+  rollup->buffer = buffer;
+  rollup->buffer_size = buffer_size;
+  rollup->levels = levels;
+  rollup->level_size = level_size;
+  rollup->level_count = 0;
+  rollup->closed_count = 0;
+  rollup->path.ptr = NULL;
+  rollup->path.size = 0;
+  rollup->value = 0;
+  rollup->has_path = false;
+} /* cpj_rollup_init */
+
+/**
+ * Closes the deepest levels of a rollup, so that only `level_count` levels
+ * stay open. The totals of the closed directories are added to their parents
+ * right away, the closed levels stay behind the open ones until they have
+ * been fetched.
+ */
+static void cpj_rollup_close(cpj_rollup_t *rollup, cpj_size_t level_count)
+{
+  cpj_size_t i;
+  for (i = rollup->level_count; i > level_count && i > 1; --i) {
+    rollup->levels[i - 2].value += rollup->levels[i - 1].value;
+  }
+  rollup->closed_count = rollup->level_count - level_count;
+  rollup->level_count = level_count;
+} /* cpj_rollup_close */
+
+/**
+ * Opens the levels for the directories of the waiting path which are not
+ * open yet and adds its value to the directory which contains it.
+ */
+static void cpj_rollup_open(cpj_rollup_t *rollup)
+{
+  const cpj_string_t *path = &rollup->path;
+  const cpj_char_t *segment;
+  cpj_size_t i, start = 0;
+
+  if (rollup->level_count == 0) {
+    rollup->levels[0].size =
+      cpj_path_get_root_sized(rollup->path_style, path->ptr, path->size);
+    rollup->levels[0].value = 0;
+    rollup->level_count = 1;
+  } else {
+    start = rollup->levels[rollup->level_count - 1].size;
+  }
+
+  // The last segment is the path itself and not one of its directories.
+  i = rollup->levels[rollup->level_count - 1].size;
+  while (cpj_path_next_segment(rollup->path_style, path, &i, &segment) > 0 &&
+         i < path->size) {
+    rollup->levels[rollup->level_count].size = i;
+    rollup->levels[rollup->level_count].value = 0;
+    ++rollup->level_count;
+  }
+
+  i = rollup->levels[rollup->level_count - 1].size;
+  if (i > start) {
+    memcpy(rollup->buffer + start, path->ptr + start, i - start);
+  }
+  rollup->levels[rollup->level_count - 1].value += rollup->value;
+  rollup->has_path = false;
+} /* cpj_rollup_open */
+
+bool cpj_path_rollup(
+  cpj_rollup_t *rollup, const cpj_string_t *path, unsigned long long value
+)
+{
+  cpj_path_style_t path_style = rollup->path_style;
+  const cpj_rollup_level_t *levels = rollup->levels;
+  const cpj_char_t *segment;
+  cpj_size_t root_size, segment_size, start, i;
+  cpj_size_t shared_count = 0, level_count = 1, directory_size;
+  bool is_shared;
+
+  if (rollup->closed_count > 0 || rollup->has_path) {
+    return false;
+  }
+
+  // Count the directories the path shares with the current chain, starting
+  // with the root. The directories with equal characters are skipped at once,
+  // the rest is compared segment by segment.
+  root_size = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  is_shared = rollup->level_count > 0 &&
+              cpj_path_is_string_equal(
+                path_style, rollup->buffer, path->ptr, levels[0].size,
+                root_size
+              );
+  if (is_shared) {
+    i = levels[rollup->level_count - 1].size;
+    i = cpj_string_common_size(
+      rollup->buffer, path->ptr, i < path->size ? i : path->size
+    );
+    shared_count = 1;
+    while (shared_count < rollup->level_count &&
+           levels[shared_count].size <= i &&
+           levels[shared_count].size < path->size &&
+           cpj_path_is_separator(
+             path_style, path->ptr[levels[shared_count].size]
+           )) {
+      ++shared_count;
+    }
+  }
+  directory_size = root_size;
+  if (shared_count > 0) {
+    level_count = shared_count;
+    directory_size = levels[shared_count - 1].size;
+  }
+  i = directory_size;
+  while ((segment_size =
+            cpj_path_next_segment(path_style, path, &i, &segment)) > 0 &&
+         i < path->size) {
+    if (is_shared && level_count < rollup->level_count) {
+      start = levels[level_count - 1].size + (level_count > 1 ? 1 : 0);
+      is_shared = cpj_path_is_string_equal(
+        path_style, rollup->buffer + start, segment,
+        levels[level_count].size - start, segment_size
+      );
+      shared_count += is_shared ? 1 : 0;
+    } else {
+      is_shared = false;
+    }
+    directory_size = i;
+    ++level_count;
+  }
+
+  if (level_count > rollup->level_size ||
+      directory_size > rollup->buffer_size) {
+    return false;
+  }
+
+  rollup->path = *path;
+  rollup->value = value;
+  rollup->has_path = true;
+  cpj_rollup_close(rollup, shared_count);
+  if (rollup->closed_count == 0) {
+    cpj_rollup_open(rollup);
+  }
+  return true;
+} /* cpj_path_rollup */
+
+bool cpj_rollup_finish(cpj_rollup_t *rollup)
+{
+  if (rollup->closed_count > 0 || rollup->has_path) {
+    return false;
+  }
+  cpj_rollup_close(rollup, 0);
+  return true;
+} /* cpj_rollup_finish */
+
+bool cpj_rollup_next(
+  cpj_rollup_t *rollup, cpj_string_t *directory, unsigned long long *value
+)
+{
+  const cpj_rollup_level_t *level;
+
+  if (rollup->closed_count == 0) {
+    if (rollup->has_path) {
+      cpj_rollup_open(rollup);
+    }
+    return false;
+  }
+
+  --rollup->closed_count;
+  level = rollup->levels + rollup->level_count + rollup->closed_count;
+  if (level->size == 0) {
+    directory->ptr = ".";
+    directory->size = 1;
+  } else {
+    directory->ptr = rollup->buffer;
+    directory->size = level->size;
+  }
+  *value = level->value;
+  return true;
+} /* cpj_rollup_next */
+
+/**
+ * A directory of the current path while a cover is built. It is a node of
+ * the trie of segments the sorted paths form.
+ */
+typedef struct
+{
+  cpj_string_t path;      /**< within the path which opened the level */
+  cpj_size_t min_level;   /**< the highest level all members may move to */
+  cpj_size_t cover_count; /**< directories for the members if not merged */
+  cpj_size_t first_root;  /**< the first cover entry below it */
+} cpj_cover_level_t;
+
+typedef struct
+{
+  cpj_path_style_t path_style;
+  double max_waste;
+  cpj_cover_level_t levels[CPJ_COVER_LEVEL_MAX];
+  cpj_size_t level_count;
+  cpj_size_t *counts;      /**< directories per level of the merge */
+  cpj_size_t *leaf_counts; /**< topmost paths per level */
+  cpj_size_t merge_level;  /**< merges the directories from this level */
+  cpj_size_t merge_count;  /**< directories before merging on that level */
+  cpj_size_t max_roots;
+  cpj_string_t *roots;
+  cpj_size_t root_count;
+} cpj_cover_t;
+
+/**
+ * Counts the levels two paths share, which is 0 if their roots are not
+ * equal, or one more than the number of equal segments otherwise. Segments
+ * within the characters both paths have in common are equal right away.
+ */
+static cpj_size_t cpj_path_shared_levels(
+  cpj_path_style_t path_style, const cpj_string_t *first,
+  const cpj_string_t *second
+)
+{
+  cpj_size_t i, j, common_size, first_size, second_size, level_count = 1;
+  const cpj_char_t *first_segment, *second_segment;
+
+  i = cpj_path_get_root_sized(path_style, first->ptr, first->size);
+  j = cpj_path_get_root_sized(path_style, second->ptr, second->size);
+  if (!cpj_path_is_string_equal(path_style, first->ptr, second->ptr, i, j)) {
+    return 0;
+  }
+
+  common_size = cpj_string_common_size(
+    first->ptr, second->ptr,
+    first->size < second->size ? first->size : second->size
+  );
+  for (;;) {
+    first_size =
+      cpj_path_next_segment(path_style, first, &i, &first_segment);
+    second_size =
+      cpj_path_next_segment(path_style, second, &j, &second_segment);
+    if (first_size == 0 || second_size == 0 || i != j ||
+        (i > common_size &&
+         !cpj_path_is_string_equal(
+           path_style, first_segment, second_segment, first_size,
+           second_size
+         ))) {
+      return level_count;
+    }
+    ++level_count;
+  }
+} /* cpj_path_shared_levels */
+
+/**
+ * Closes the levels of a cover down to `level_count` levels. A closed
+ * directory is merged if it contains at least two topmost paths which may
+ * all move up to it, and passes its members on to its parent.
+ */
+static void cpj_cover_close(cpj_cover_t *cover, cpj_size_t level_count)
+{
+  cpj_cover_level_t *level, *parent;
+  cpj_size_t cover_count;
+  bool is_mergeable;
+
+  while (cover->level_count > level_count) {
+    level = cover->levels + cover->level_count - 1;
+    is_mergeable = level->cover_count > 1 &&
+                   level->min_level <= cover->level_count;
+
+    // Below the merge level all the directories are merged, on the merge
+    // level only as many as needed.
+    if (!cover->counts && is_mergeable) {
+      if (cover->level_count == cover->merge_level) {
+        is_mergeable = cover->merge_count > cover->max_roots;
+        cover->merge_count -= is_mergeable ? level->cover_count - 1 : 0;
+      } else {
+        is_mergeable = cover->level_count > cover->merge_level;
+      }
+    }
+    cover_count = is_mergeable ? 1 : level->cover_count;
+
+    if (cover->counts) {
+      cover->counts[cover->level_count] += cover_count;
+    } else if (is_mergeable) {
+      // The directory replaces everything which has been added below it.
+      cover->root_count = level->first_root;
+      cover->roots[cover->root_count++] = level->path;
+      if (level->path.size == 0) {
+        cover->roots[cover->root_count - 1].ptr = ".";
+        cover->roots[cover->root_count - 1].size = 1;
+      }
+    }
+
+    if (--cover->level_count > 0) {
+      parent = level - 1;
+      if (level->min_level > parent->min_level) {
+        parent->min_level = level->min_level;
+      }
+      parent->cover_count += cover_count;
+    }
+  }
+} /* cpj_cover_close */
+
+static void
+cpj_cover_open(cpj_cover_t *cover, const cpj_string_t *path, cpj_size_t size)
+{
+  cpj_cover_level_t *level = cover->levels + cover->level_count++;
+  level->path.ptr = path->ptr;
+  level->path.size = size;
+  level->min_level = 0;
+  level->cover_count = 0;
+  level->first_root = cover->root_count;
+} /* cpj_cover_open */
+
+/**
+ * Walks over the topmost paths of a sorted list and the directories which
+ * contain them.
+ */
+static void cpj_cover_walk(
+  cpj_cover_t *cover, const cpj_string_t *paths, cpj_size_t count
+)
+{
+  cpj_path_style_t path_style = cover->path_style;
+  const cpj_string_t *last = NULL;
+  const cpj_char_t *segment;
+  cpj_cover_level_t *level;
+  cpj_size_t i, j, shared_count, level_count = 0, min_level, segment_size;
+
+  for (i = 0; i < count; ++i) {
+    // A path which shares all the levels of the last topmost path is below
+    // it, or equal to it.
+    shared_count =
+      last ? cpj_path_shared_levels(path_style, last, paths + i) : 0;
+    if (last && shared_count >= level_count) {
+      continue;
+    }
+    cpj_cover_close(cover, shared_count);
+    last = paths + i;
+
+    // Opens the directories below the shared ones, up to the path itself. A
+    // `.` segment is only left in a path without any other segments.
+    if (cover->level_count == 0) {
+      cpj_cover_open(
+        cover, last,
+        cpj_path_get_root_sized(path_style, last->ptr, last->size)
+      );
+    }
+    level_count = cover->level_count;
+    j = cover->levels[level_count - 1].path.size;
+    while ((segment_size =
+              cpj_path_next_segment(path_style, last, &j, &segment)) > 0 &&
+           (segment_size != 1 || *segment != '.')) {
+      if (++level_count <= CPJ_COVER_LEVEL_MAX) {
+        cpj_cover_open(cover, last, j);
+      }
+    }
+
+    // The path itself is the deepest level, unless it is too deep. Then it
+    // is a member of the deepest one.
+    min_level = level_count -
+                (cpj_size_t)(cover->max_waste * (double)(level_count - 1));
+    level = cover->levels + cover->level_count - 1;
+    if (min_level > level->min_level) {
+      level->min_level = min_level;
+    }
+    ++level->cover_count;
+    if (cover->counts) {
+      ++cover->leaf_counts[level_count <= CPJ_COVER_LEVEL_MAX
+                             ? level_count
+                             : CPJ_COVER_LEVEL_MAX + 1];
+    } else {
+      cover->roots[cover->root_count++] = *last;
+    }
+  }
+
+  cpj_cover_close(cover, 0);
+} /* cpj_cover_walk */
+
+cpj_size_t cpj_path_minimal_cover(
+  cpj_path_style_t path_style, const cpj_string_t *paths, cpj_size_t count,
+  cpj_size_t max_roots, double max_waste, cpj_string_t *roots
+)
+{
+  cpj_size_t counts[CPJ_COVER_LEVEL_MAX + 2] = {0};
+  cpj_size_t leaf_counts[CPJ_COVER_LEVEL_MAX + 2] = {0};
+  cpj_size_t leaf_count = 0, i;
+  cpj_cover_t cover;
+
+  cover.path_style = path_style;
+  cover.max_waste = max_waste < 0.0 ? 0.0 : max_waste > 1.0 ? 1.0 : max_waste;
+  cover.level_count = 0;
+  cover.counts = counts;
+  cover.leaf_counts = leaf_counts;
+  cover.merge_level = CPJ_SIZE_MAX;
+  cover.merge_count = 0;
+  cover.max_roots = max_roots;
+  cover.roots = roots;
+  cover.root_count = 0;
+
+  // The first walk counts the directories of the cover for every level the
+  // merge could start at. Merging from a level on needs the directories of
+  // that level, and the topmost paths above it. The counts only grow with the
+  // level, so the deepest one which fits is the last one.
+  cpj_cover_walk(&cover, paths, count);
+  for (i = 1; i <= CPJ_COVER_LEVEL_MAX; ++i) {
+    counts[i] += leaf_count;
+    leaf_count += leaf_counts[i];
+  }
+  counts[CPJ_COVER_LEVEL_MAX + 1] =
+    leaf_count + leaf_counts[CPJ_COVER_LEVEL_MAX + 1];
+  if (counts[CPJ_COVER_LEVEL_MAX + 1] > max_roots) {
+    cover.merge_level = 1;
+    for (i = 1; i <= CPJ_COVER_LEVEL_MAX; ++i) {
+      if (counts[i] <= max_roots) {
+        cover.merge_level = i;
+      }
+    }
+    cover.merge_count = counts[cover.merge_level + 1];
+  }
+
+  // The second walk builds the cover, which merges the directories below
+  // that level first, and then as few directories on it as needed.
+  cover.counts = NULL;
+  cpj_cover_walk(&cover, paths, count);
+  return cover.root_count;
+} /* cpj_path_minimal_cover */
+
+/**
+ * The numbers of the serialized formats are stored in 8 bytes in little endian
+ * order, so they can be read in place regardless of the alignment and the
+ * byte order of the machine.
+ */
+#define CPJ_NUMBER_SIZE 8
+
+static void cpj_number_set(cpj_char_t *data, cpj_size_t value)
+{
+  cpj_size_t i;
+
+  for (i = 0; i < CPJ_NUMBER_SIZE; ++i) {
+    data[i] = (cpj_char_t)((unsigned long long)value >> (i * 8) & 0xff);
+  }
+} /* cpj_number_set */
+
+static cpj_size_t cpj_number_get(const cpj_char_t *data)
+{
+  unsigned long long value = 0;
+  cpj_size_t i;
+
+  for (i = CPJ_NUMBER_SIZE; i > 0; --i) {
+    value = value << 8 | (unsigned char)data[i - 1];
+  }
+  return (cpj_size_t)value;
+} /* cpj_number_get */
+
+/**
+ * A serialized path list starts with a header of the magic bytes, the version
+ * and the path style, and ends with a footer of five numbers: the offset of
+ * the restart table, the number of restarts, the number of paths, the restart
+ * interval and the size of the longest path. The restart table in between
+ * holds the offset of every restart point.
+ */
+#define CPJ_PATH_LIST_HEADER_SIZE 8
+#define CPJ_PATH_LIST_FOOTER_SIZE (5 * CPJ_NUMBER_SIZE)
+
+static const cpj_char_t cpj_path_list_magic[4] = {'C', 'P', 'J', 'L'};
+
+static void cpj_path_list_put(
+  cpj_path_list_writer_t *writer, const cpj_char_t *data, cpj_size_t size
+)
+{
+  if (writer->size < writer->buffer_size) {
+    cpj_size_t fitting = writer->buffer_size - writer->size;
+    memcpy(
+      writer->buffer + writer->size, data, size < fitting ? size : fitting
+    );
+  }
+  writer->size += size;
+} /* cpj_path_list_put */
+
+/**
+ * Writes a number using 7 bits per byte, where the highest bit of a byte marks
+ * that another byte follows.
+ */
+static void
+cpj_path_list_put_varint(cpj_path_list_writer_t *writer, cpj_size_t value)
+{
+  cpj_char_t bytes[(sizeof(cpj_size_t) * 8 + 6) / 7];
+  cpj_size_t size = 0;
+
+  while (value >= 0x80) {
+    bytes[size++] = (cpj_char_t)((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  bytes[size++] = (cpj_char_t)value;
+  cpj_path_list_put(writer, bytes, size);
+} /* cpj_path_list_put_varint */
+
+static void
+cpj_path_list_put_number(cpj_path_list_writer_t *writer, cpj_size_t value)
+{
+  cpj_char_t bytes[CPJ_NUMBER_SIZE];
+
+  cpj_number_set(bytes, value);
+  cpj_path_list_put(writer, bytes, sizeof(bytes));
+} /* cpj_path_list_put_number */
+
+/**
+ * Reads a number written by cpj_path_list_put_varint. Returns false if the
+ * number runs past the end of the data or does not fit.
+ */
+static bool cpj_path_list_get_varint(
+  const cpj_char_t *data, cpj_size_t size, cpj_size_t *offset,
+  cpj_size_t *value
+)
+{
+  unsigned int shift = 0;
+  unsigned char byte;
+
+  *value = 0;
+  do {
+    if (*offset >= size || shift >= sizeof(cpj_size_t) * 8) {
+      return false;
+    }
+    byte = (unsigned char)data[(*offset)++];
+    *value |= (cpj_size_t)(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+
+  return true;
+} /* cpj_path_list_get_varint */
+
+void cpj_path_list_writer_init(
+  cpj_path_list_writer_t *writer, cpj_path_style_t path_style,
+  cpj_size_t restart_interval, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_char_t *previous, cpj_size_t previous_size
+)
+{
+  cpj_char_t header[CPJ_PATH_LIST_HEADER_SIZE] = {0};
+
+  writer->path_style = path_style;
+  writer->buffer = buffer;
+  writer->buffer_size = buffer_size;
+  writer->size = 0;
+  writer->restart_interval = restart_interval > 0 ? restart_interval : 1;
+  writer->count = 0;
+  writer->max_path_size = 0;
+  writer->previous = previous;
+  writer->previous_size = 0;
+  writer->previous_capacity = previous_size;
+
+  memcpy(header, cpj_path_list_magic, sizeof(cpj_path_list_magic));
+  header[4] = CPJ_PATH_LIST_VERSION;
+  header[5] = (cpj_char_t)path_style;
+  cpj_path_list_put(writer, header, sizeof(header));
+} /* cpj_path_list_writer_init */
+
+void cpj_path_list_writer_add(
+  cpj_path_list_writer_t *writer, const cpj_string_t *path
+)
+{
+  cpj_size_t shared_size = 0;
+
+  // The beginning the path shares with the previous one is stored as a
+  // number of characters, which keeps the case of windows paths.
+  if (writer->count % writer->restart_interval != 0) {
+    shared_size = cpj_string_common_size(
+      writer->previous, path->ptr,
+      writer->previous_size < path->size ? writer->previous_size : path->size
+    );
+  }
+  cpj_path_list_put_varint(writer, shared_size);
+  cpj_path_list_put_varint(writer, path->size - shared_size);
+  cpj_path_list_put(writer, path->ptr + shared_size, path->size - shared_size);
+
+  if (path->size > writer->max_path_size) {
+    writer->max_path_size = path->size;
+  }
+  writer->previous_size = path->size < writer->previous_capacity
+                            ? path->size
+                            : writer->previous_capacity;
+  if (shared_size < writer->previous_size) {
+    memcpy(
+      writer->previous + shared_size, path->ptr + shared_size,
+      writer->previous_size - shared_size
+    );
+  }
+  ++writer->count;
+} /* cpj_path_list_writer_add */
+
+cpj_size_t cpj_path_list_writer_finish(cpj_path_list_writer_t *writer)
+{
+  cpj_size_t restart_offset = writer->size, offset, shared_size, size, i;
+  cpj_size_t restart_count =
+    (writer->count + writer->restart_interval - 1) / writer->restart_interval;
+
+  // The offsets of the restart points are found by skipping over the entries,
+  // which is only possible if all of them have been written.
+  if (writer->size > writer->buffer_size) {
+    writer->size +=
+      restart_count * CPJ_NUMBER_SIZE + CPJ_PATH_LIST_FOOTER_SIZE;
+    return writer->size;
+  }
+
+  offset = CPJ_PATH_LIST_HEADER_SIZE;
+  for (i = 0; i < writer->count; ++i) {
+    if (i % writer->restart_interval == 0) {
+      cpj_path_list_put_number(writer, offset);
+    }
+    cpj_path_list_get_varint(
+      writer->buffer, restart_offset, &offset, &shared_size
+    );
+    cpj_path_list_get_varint(writer->buffer, restart_offset, &offset, &size);
+    offset += size;
+  }
+
+  cpj_path_list_put_number(writer, restart_offset);
+  cpj_path_list_put_number(writer, restart_count);
+  cpj_path_list_put_number(writer, writer->count);
+  cpj_path_list_put_number(writer, writer->restart_interval);
+  cpj_path_list_put_number(writer, writer->max_path_size);
+  return writer->size;
+} /* cpj_path_list_writer_finish */
+
+bool cpj_path_list_open(
+  cpj_path_list_t *list, const cpj_char_t *data, cpj_size_t size
+)
+{
+  const cpj_char_t *footer;
+
+  if (size < CPJ_PATH_LIST_HEADER_SIZE + CPJ_PATH_LIST_FOOTER_SIZE ||
+      memcmp(data, cpj_path_list_magic, sizeof(cpj_path_list_magic)) != 0 ||
+      data[4] != CPJ_PATH_LIST_VERSION ||
+      (data[5] != CPJ_STYLE_WINDOWS && data[5] != CPJ_STYLE_UNIX)) {
+    return false;
+  }
+
+  footer = data + size - CPJ_PATH_LIST_FOOTER_SIZE;
+  list->data = data;
+  list->size = cpj_number_get(footer);
+  list->path_style = (cpj_path_style_t)data[5];
+  list->restart_count = cpj_number_get(footer + 8);
+  list->count = cpj_number_get(footer + 16);
+  list->restart_interval = cpj_number_get(footer + 24);
+  list->max_path_size = cpj_number_get(footer + 32);
+
+  // The restart table has to fill the space between the entries and the
+  // footer exactly.
+  if (list->size < CPJ_PATH_LIST_HEADER_SIZE ||
+      list->size > size - CPJ_PATH_LIST_FOOTER_SIZE ||
+      list->restart_interval == 0 ||
+      list->restart_count != list->count / list->restart_interval +
+                               (list->count % list->restart_interval != 0) ||
+      (size - CPJ_PATH_LIST_FOOTER_SIZE - list->size) / CPJ_NUMBER_SIZE !=
+        list->restart_count ||
+      (size - CPJ_PATH_LIST_FOOTER_SIZE - list->size) % CPJ_NUMBER_SIZE != 0) {
+    return false;
+  }
+
+  list->restarts = data + list->size;
+  return true;
+} /* cpj_path_list_open */
+
+bool cpj_path_list_reader_init(
+  cpj_path_list_reader_t *reader, const cpj_path_list_t *list,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  reader->list = list;
+  reader->buffer = buffer;
+  reader->buffer_size = buffer_size;
+  reader->path_size = 0;
+  reader->position = 0;
+  reader->offset = CPJ_PATH_LIST_HEADER_SIZE;
+  if (buffer_size > 0) {
+    buffer[0] = '\0';
+  }
+  return buffer_size > list->max_path_size;
+} /* cpj_path_list_reader_init */
+
+bool cpj_path_list_next(cpj_path_list_reader_t *reader, cpj_string_t *path)
+{
+  const cpj_path_list_t *list = reader->list;
+  cpj_size_t offset = reader->offset, shared_size, size;
+
+  if (reader->position >= list->count ||
+      !cpj_path_list_get_varint(
+        list->data, list->size, &offset, &shared_size
+      ) ||
+      !cpj_path_list_get_varint(list->data, list->size, &offset, &size) ||
+      shared_size > reader->path_size || size > list->size - offset ||
+      size >= reader->buffer_size - shared_size) {
+    return false;
+  }
+
+  memcpy(reader->buffer + shared_size, list->data + offset, size);
+  reader->path_size = shared_size + size;
+  reader->buffer[reader->path_size] = '\0';
+  reader->offset = offset + size;
+  ++reader->position;
+
+  path->ptr = reader->buffer;
+  path->size = reader->path_size;
+  return true;
+} /* cpj_path_list_next */
+
+/**
+ * Moves a reader to a restart point, where the path does not depend on the
+ * previous one.
+ */
+static bool
+cpj_path_list_restart(cpj_path_list_reader_t *reader, cpj_size_t restart)
+{
+  const cpj_path_list_t *list = reader->list;
+  cpj_size_t offset =
+    cpj_number_get(list->restarts + restart * CPJ_NUMBER_SIZE);
+
+  if (offset < CPJ_PATH_LIST_HEADER_SIZE || offset >= list->size) {
+    return false;
+  }
+  reader->offset = offset;
+  reader->position = restart * list->restart_interval;
+  reader->path_size = 0;
+  return true;
+} /* cpj_path_list_restart */
+
+bool cpj_path_list_seek(cpj_path_list_reader_t *reader, cpj_size_t position)
+{
+  const cpj_path_list_t *list = reader->list;
+  cpj_string_t path;
+
+  if (position > list->count) {
+    return false;
+  } else if (position == list->count) {
+    reader->offset = list->size;
+    reader->position = position;
+    return true;
+  }
+
+  if (!cpj_path_list_restart(reader, position / list->restart_interval)) {
+    return false;
+  }
+  while (reader->position < position) {
+    if (!cpj_path_list_next(reader, &path)) {
+      return false;
+    }
+  }
+  return true;
+} /* cpj_path_list_seek */
+
+cpj_size_t
+cpj_path_list_find(cpj_path_list_reader_t *reader, const cpj_string_t *path)
+{
+  const cpj_path_list_t *list = reader->list;
+  cpj_size_t first = 0, last = list->restart_count, middle, offset, size;
+  cpj_size_t previous_offset, shared_size;
+  cpj_string_t restart;
+
+  // Finds the last restart point in front of the path. Its path is stored in
+  // full, so it is compared in place.
+  while (first < last) {
+    middle = first + (last - first) / 2;
+    offset = cpj_number_get(list->restarts + middle * CPJ_NUMBER_SIZE);
+    if (!cpj_path_list_get_varint(
+          list->data, list->size, &offset, &shared_size
+        ) ||
+        !cpj_path_list_get_varint(list->data, list->size, &offset, &size) ||
+        size > list->size - offset) {
+      break;
+    }
+    restart.ptr = list->data + offset;
+    restart.size = size;
+    if (cpj_path_sort_compare(list->path_style, &restart, path) < 0) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+
+  if (first == 0 || !cpj_path_list_restart(reader, first - 1)) {
+    cpj_path_list_seek(reader, 0);
+  }
+
+  // The path which is not in front of the path is decoded once more by the
+  // next read, which works since its shared beginning stays the same.
+  for (;;) {
+    previous_offset = reader->offset;
+    if (!cpj_path_list_next(reader, &restart)) {
+      break;
+    }
+    if (cpj_path_sort_compare(list->path_style, &restart, path) >= 0) {
+      reader->offset = previous_offset;
+      --reader->position;
+      break;
+    }
+  }
+  return reader->position;
+} /* cpj_path_list_find */
+
+/**
+ * A serialized path table starts with a header of the magic bytes, the
+ * version and the path style, followed by the number of paths, the size of the
+ * longest path, the number of levels and nodes of the trie, the number of hash
+ * slots and the size of the strings. The sections follow in this order: the
+ * first node of every level plus the number of nodes, the nodes, the offset
+ * and size of every path, the hash slots and finally the strings.
+ */
+#define CPJ_PATH_TABLE_HEADER_SIZE (8 + 6 * CPJ_NUMBER_SIZE)
+#define CPJ_PATH_TABLE_NODE_SIZE (6 * CPJ_NUMBER_SIZE)
+#define CPJ_PATH_TABLE_PATH_SIZE (2 * CPJ_NUMBER_SIZE)
+
+static const cpj_char_t cpj_path_table_magic[4] = {'C', 'P', 'J', 'T'};
+
+/**
+ * A node of the trie stands for a root or a segment. The children of a node
+ * are next to each other on the next level, and the paths below it are next
+ * to each other as well, since the paths are sorted.
+ */
+typedef struct
+{
+  cpj_size_t name_offset; /**< of the root or segment within the strings */
+  cpj_size_t name_size;
+  cpj_size_t first_child;
+  cpj_size_t child_count;
+  cpj_size_t path_begin;
+  cpj_size_t path_end;
+} cpj_path_table_node_t;
+
+/**
+ * Hashes a path using FNV-1a. Windows paths are hashed the way
+ * cpj_path_is_string_equal compares them, except that only ASCII characters
+ * are folded, so the hash does not depend on the locale.
+ */
+static unsigned long long cpj_path_hash(
+  cpj_path_style_t path_style, const cpj_char_t *ptr, cpj_size_t size
+)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  unsigned char ch;
+  cpj_size_t i;
+
+  for (i = 0; i < size; ++i) {
+    ch = (unsigned char)ptr[i];
+    if (path_style == CPJ_STYLE_WINDOWS) {
+      if (ch == '\\') {
+        ch = '/';
+      } else if (ch >= 'A' && ch <= 'Z') {
+        ch = (unsigned char)(ch - 'A' + 'a');
+      }
+    }
+    hash = (hash ^ ch) * 1099511628211ULL;
+  }
+  return hash;
+} /* cpj_path_hash */
+
+/**
+ * Compares two roots or segments the way cpj_path_sort orders them, which is
+ * the order of the nodes on every level.
+ */
+static int cpj_path_table_compare(
+  cpj_path_style_t path_style, const cpj_char_t *first, cpj_size_t first_size,
+  const cpj_char_t *second, cpj_size_t second_size
+)
+{
+  int a, b;
+  cpj_size_t i;
+
+  for (i = 0; i < first_size && i < second_size; ++i) {
+    a = (unsigned char)first[i];
+    b = (unsigned char)second[i];
+    if (path_style == CPJ_STYLE_WINDOWS) {
+      a = a == '\\' ? '/' : tolower(a);
+      b = b == '\\' ? '/' : tolower(b);
+    }
+    if (a != b) {
+      return a < b ? -1 : 1;
+    }
+  }
+  return first_size < second_size ? -1 : first_size > second_size;
+} /* cpj_path_table_compare */
+
+/**
+ * Counts the levels of a path within the trie, which is one for the root and
+ * one for every segment. A path which is only a `.` has no segments.
+ */
+static cpj_size_t
+cpj_path_table_levels(cpj_path_style_t path_style, const cpj_string_t *path)
+{
+  const cpj_char_t *segment;
+  cpj_size_t i = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t level_count = 1;
+
+  if (path->size == i + 1 && path->ptr[i] == '.') {
+    return level_count;
+  }
+  while (cpj_path_next_segment(path_style, path, &i, &segment) > 0) {
+    ++level_count;
+  }
+  return level_count;
+} /* cpj_path_table_levels */
+
+/**
+ * Moves on to the next path while building a table. Returns false if the path
+ * is equal to the last one, which is skipped. Otherwise the levels of the
+ * path are counted, as well as the levels it shares with the last one, which
+ * already have their nodes.
+ */
+static bool cpj_path_table_next(
+  cpj_path_style_t path_style, const cpj_string_t *path,
+  const cpj_string_t **last, cpj_size_t *level_count, cpj_size_t *shared
+)
+{
+  cpj_size_t last_level_count = *level_count;
+
+  if (*last != NULL && cpj_path_is_string_equal(
+                         path_style, (*last)->ptr, path->ptr, (*last)->size,
+                         path->size
+                       )) {
+    return false;
+  }
+
+  *level_count = cpj_path_table_levels(path_style, path);
+  *shared = 0;
+  if (*last != NULL) {
+    *shared = cpj_path_shared_levels(path_style, *last, path);
+    if (*shared > last_level_count) {
+      *shared = last_level_count;
+    }
+    if (*shared > *level_count) {
+      *shared = *level_count;
+    }
+  }
+  *last = path;
+  return true;
+} /* cpj_path_table_next */
+
+static void cpj_path_table_node_set(
+  cpj_char_t *nodes, cpj_size_t index, cpj_size_t field, cpj_size_t value
+)
+{
+  cpj_number_set(
+    nodes + index * CPJ_PATH_TABLE_NODE_SIZE + field * CPJ_NUMBER_SIZE, value
+  );
+} /* cpj_path_table_node_set */
+
+/**
+ * Adds the nodes of a path which it does not share with the last one, and
+ * extends the ranges of all the nodes of the path. The levels hold the next
+ * free node of every level.
+ */
+static void cpj_path_table_add_nodes(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_size_t position,
+  cpj_size_t string_offset, cpj_size_t level_count, cpj_size_t shared,
+  cpj_char_t *levels, cpj_char_t *nodes
+)
+{
+  const cpj_char_t *segment = path->ptr;
+  cpj_size_t i = cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t segment_size = i, level, node, parent;
+
+  for (level = 0; level < level_count; ++level) {
+    if (level > 0) {
+      segment_size = cpj_path_next_segment(path_style, path, &i, &segment);
+    }
+
+    node = cpj_number_get(levels + level * CPJ_NUMBER_SIZE);
+    if (level >= shared) {
+      cpj_path_table_node_set(
+        nodes, node, 0, string_offset + (cpj_size_t)(segment - path->ptr)
+      );
+      cpj_path_table_node_set(nodes, node, 1, segment_size);
+      cpj_path_table_node_set(
+        nodes, node, 2,
+        cpj_number_get(levels + (level + 1) * CPJ_NUMBER_SIZE)
+      );
+      cpj_path_table_node_set(nodes, node, 3, 0);
+      cpj_path_table_node_set(nodes, node, 4, position);
+      cpj_number_set(levels + level * CPJ_NUMBER_SIZE, ++node);
+
+      if (level > 0) {
+        parent = cpj_number_get(levels + (level - 1) * CPJ_NUMBER_SIZE) - 1;
+        cpj_path_table_node_set(
+          nodes, parent, 3,
+          cpj_number_get(
+            nodes + parent * CPJ_PATH_TABLE_NODE_SIZE + 3 * CPJ_NUMBER_SIZE
+          ) + 1
+        );
+      }
+    }
+    cpj_path_table_node_set(nodes, node - 1, 5, position + 1);
+  }
+} /* cpj_path_table_add_nodes */
+
+cpj_size_t cpj_path_table_build(
+  cpj_path_style_t path_style, const cpj_string_t *paths, cpj_size_t count,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  const cpj_string_t *last = NULL;
+  cpj_size_t path_count = 0, max_path_size = 0, level_count = 0;
+  cpj_size_t node_count = 0, hash_size = 1, string_size = 0, size;
+  cpj_size_t i, level, levels = 0, shared, start, offset, slot, level_size;
+  cpj_char_t *level_data, *nodes, *path_data, *hash, *strings;
+
+  // All the sections are counted first, since the trie needs to know where
+  // every level starts.
+  for (i = 0; i < count; ++i) {
+    if (!cpj_path_table_next(path_style, paths + i, &last, &levels, &shared)) {
+      continue;
+    }
+    ++path_count;
+    string_size += paths[i].size + 1;
+    node_count += levels - shared;
+    if (paths[i].size > max_path_size) {
+      max_path_size = paths[i].size;
+    }
+    if (levels > level_count) {
+      level_count = levels;
+    }
+  }
+  while (hash_size < path_count * 2) {
+    hash_size *= 2;
+  }
+
+  size = CPJ_PATH_TABLE_HEADER_SIZE + (level_count + 1) * CPJ_NUMBER_SIZE +
+         node_count * CPJ_PATH_TABLE_NODE_SIZE +
+         path_count * CPJ_PATH_TABLE_PATH_SIZE + hash_size * CPJ_NUMBER_SIZE +
+         string_size;
+  if (size > buffer_size) {
+    return size;
+  }
+
+  memset(buffer, 0, CPJ_PATH_TABLE_HEADER_SIZE);
+  memcpy(buffer, cpj_path_table_magic, sizeof(cpj_path_table_magic));
+  buffer[4] = CPJ_PATH_TABLE_VERSION;
+  buffer[5] = (cpj_char_t)path_style;
+  cpj_number_set(buffer + 8, path_count);
+  cpj_number_set(buffer + 16, max_path_size);
+  cpj_number_set(buffer + 24, level_count);
+  cpj_number_set(buffer + 32, node_count);
+  cpj_number_set(buffer + 40, hash_size);
+  cpj_number_set(buffer + 48, string_size);
+
+  level_data = buffer + CPJ_PATH_TABLE_HEADER_SIZE;
+  nodes = level_data + (level_count + 1) * CPJ_NUMBER_SIZE;
+  path_data = nodes + node_count * CPJ_PATH_TABLE_NODE_SIZE;
+  hash = path_data + path_count * CPJ_PATH_TABLE_PATH_SIZE;
+  strings = hash + hash_size * CPJ_NUMBER_SIZE;
+  memset(level_data, 0, (level_count + 1) * CPJ_NUMBER_SIZE);
+  memset(hash, 0, hash_size * CPJ_NUMBER_SIZE);
+
+  // The nodes are counted per level, which gives the first node of every
+  // level. The nodes of a level are then added in sort order.
+  last = NULL;
+  for (i = 0; i < count; ++i) {
+    if (cpj_path_table_next(path_style, paths + i, &last, &levels, &shared)) {
+      for (level = shared; level < levels; ++level) {
+        cpj_number_set(
+          level_data + level * CPJ_NUMBER_SIZE,
+          cpj_number_get(level_data + level * CPJ_NUMBER_SIZE) + 1
+        );
+      }
+    }
+  }
+  for (level = 0, start = 0; level <= level_count; ++level) {
+    level_size = cpj_number_get(level_data + level * CPJ_NUMBER_SIZE);
+    cpj_number_set(level_data + level * CPJ_NUMBER_SIZE, start);
+    start += level_size;
+  }
+
+  last = NULL;
+  for (i = 0, offset = 0, path_count = 0; i < count; ++i) {
+    if (!cpj_path_table_next(path_style, paths + i, &last, &levels, &shared)) {
+      continue;
+    }
+
+    memcpy(strings + offset, paths[i].ptr, paths[i].size);
+    strings[offset + paths[i].size] = '\0';
+    cpj_number_set(path_data + path_count * CPJ_PATH_TABLE_PATH_SIZE, offset);
+    cpj_number_set(
+      path_data + path_count * CPJ_PATH_TABLE_PATH_SIZE + CPJ_NUMBER_SIZE,
+      paths[i].size
+    );
+
+    slot =
+      (cpj_size_t)cpj_path_hash(path_style, paths[i].ptr, paths[i].size);
+    while (cpj_number_get(hash + (slot & (hash_size - 1)) * CPJ_NUMBER_SIZE)) {
+      ++slot;
+    }
+    cpj_number_set(
+      hash + (slot & (hash_size - 1)) * CPJ_NUMBER_SIZE, path_count + 1
+    );
+
+    cpj_path_table_add_nodes(
+      path_style, paths + i, path_count, offset, levels, shared, level_data,
+      nodes
+    );
+    offset += paths[i].size + 1;
+    ++path_count;
+  }
+
+  // Every level now holds the first node of the next one, which is moved
+  // back to where the level starts.
+  for (level = level_count; level > 0; --level) {
+    cpj_number_set(
+      level_data + level * CPJ_NUMBER_SIZE,
+      cpj_number_get(level_data + (level - 1) * CPJ_NUMBER_SIZE)
+    );
+  }
+  cpj_number_set(level_data, 0);
+
+  return size;
+} /* cpj_path_table_build */
+
+/**
+ * Places a section of `count` items behind the previous one, if it fits.
+ */
+static bool cpj_path_table_section(
+  const cpj_char_t *data, cpj_size_t size, cpj_size_t *offset,
+  cpj_size_t count, cpj_size_t item_size, const cpj_char_t **section
+)
+{
+  if (count > (size - *offset) / item_size) {
+    return false;
+  }
+  *section = data + *offset;
+  *offset += count * item_size;
+  return true;
+} /* cpj_path_table_section */
+
+bool cpj_path_table_open(
+  cpj_path_table_t *table, const cpj_char_t *data, cpj_size_t size
+)
+{
+  cpj_size_t offset = CPJ_PATH_TABLE_HEADER_SIZE;
+
+  if (size < CPJ_PATH_TABLE_HEADER_SIZE ||
+      memcmp(data, cpj_path_table_magic, sizeof(cpj_path_table_magic)) != 0 ||
+      data[4] != CPJ_PATH_TABLE_VERSION ||
+      (data[5] != CPJ_STYLE_WINDOWS && data[5] != CPJ_STYLE_UNIX)) {
+    return false;
+  }
+
+  table->data = data;
+  table->path_style = (cpj_path_style_t)data[5];
+  table->path_count = cpj_number_get(data + 8);
+  table->max_path_size = cpj_number_get(data + 16);
+  table->level_count = cpj_number_get(data + 24);
+  table->node_count = cpj_number_get(data + 32);
+  table->hash_size = cpj_number_get(data + 40);
+  table->string_size = cpj_number_get(data + 48);
+
+  // The hash slots are found using a mask, so there has to be a power of two
+  // of them.
+  return table->level_count < size && table->hash_size > 0 &&
+         (table->hash_size & (table->hash_size - 1)) == 0 &&
+         cpj_path_table_section(
+           data, size, &offset, table->level_count + 1, CPJ_NUMBER_SIZE,
+           &table->levels
+         ) &&
+         cpj_path_table_section(
+           data, size, &offset, table->node_count, CPJ_PATH_TABLE_NODE_SIZE,
+           &table->nodes
+         ) &&
+         cpj_path_table_section(
+           data, size, &offset, table->path_count, CPJ_PATH_TABLE_PATH_SIZE,
+           &table->paths
+         ) &&
+         cpj_path_table_section(
+           data, size, &offset, table->hash_size, CPJ_NUMBER_SIZE,
+           &table->hash
+         ) &&
+         cpj_path_table_section(
+           data, size, &offset, table->string_size, 1, &table->strings
+         ) &&
+         offset == size;
+} /* cpj_path_table_open */
+
+bool cpj_path_table_get(
+  const cpj_path_table_t *table, cpj_size_t position, cpj_string_t *path
+)
+{
+  const cpj_char_t *entry;
+  cpj_size_t offset, size;
+
+  if (position >= table->path_count) {
+    return false;
+  }
+
+  // The terminator behind the path has to be within the strings as well.
+  entry = table->paths + position * CPJ_PATH_TABLE_PATH_SIZE;
+  offset = cpj_number_get(entry);
+  size = cpj_number_get(entry + CPJ_NUMBER_SIZE);
+  if (offset >= table->string_size || size >= table->string_size - offset) {
+    return false;
+  }
+
+  path->ptr = table->strings + offset;
+  path->size = size;
+  return true;
+} /* cpj_path_table_get */
+
+/**
+ * Reads a node of the trie, which fails if it points outside of the table.
+ */
+static bool cpj_path_table_node_get(
+  const cpj_path_table_t *table, cpj_size_t index, cpj_path_table_node_t *node
+)
+{
+  const cpj_char_t *data = table->nodes + index * CPJ_PATH_TABLE_NODE_SIZE;
+
+  node->name_offset = cpj_number_get(data);
+  node->name_size = cpj_number_get(data + CPJ_NUMBER_SIZE);
+  node->first_child = cpj_number_get(data + 2 * CPJ_NUMBER_SIZE);
+  node->child_count = cpj_number_get(data + 3 * CPJ_NUMBER_SIZE);
+  node->path_begin = cpj_number_get(data + 4 * CPJ_NUMBER_SIZE);
+  node->path_end = cpj_number_get(data + 5 * CPJ_NUMBER_SIZE);
+
+  return node->name_offset <= table->string_size &&
+         node->name_size <= table->string_size - node->name_offset &&
+         node->first_child <= table->node_count &&
+         node->child_count <= table->node_count - node->first_child &&
+         node->path_begin <= node->path_end &&
+         node->path_end <= table->path_count;
+} /* cpj_path_table_node_get */
+
+/**
+ * Finds the node with a name among the nodes from `first` to `last` using a
+ * binary search, since they are sorted.
+ */
+static bool cpj_path_table_find_node(
+  const cpj_path_table_t *table, cpj_size_t first, cpj_size_t last,
+  const cpj_char_t *name, cpj_size_t name_size, cpj_path_table_node_t *node
+)
+{
+  cpj_size_t middle;
+  int result;
+
+  if (last > table->node_count) {
+    return false;
+  }
+  while (first < last) {
+    middle = first + (last - first) / 2;
+    if (!cpj_path_table_node_get(table, middle, node)) {
+      return false;
+    }
+    result = cpj_path_table_compare(
+      table->path_style, table->strings + node->name_offset, node->name_size,
+      name, name_size
+    );
+    if (result == 0) {
+      return true;
+    } else if (result < 0) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return false;
+} /* cpj_path_table_find_node */
+
+/**
+ * Normalizes a path into a buffer the way cpj_path_join_multiple does. A path
+ * which fits into the buffer is normalized in place, which is a lot faster.
+ */
+static cpj_size_t cpj_path_table_normalize(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+)
+{
+  if (path->size >= buffer_size) {
+    return cpj_path_join_multiple(
+      path_style, false, true, path, 1, buffer, buffer_size
+    );
+  }
+  memcpy(buffer, path->ptr, path->size);
+  return cpj_path_normalize_inplace(
+    path_style, buffer, path->size, buffer_size
+  );
+} /* cpj_path_table_normalize */
+
+bool cpj_path_table_lookup(
+  const cpj_path_table_t *table, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_size_t *position
+)
+{
+  cpj_size_t size, slot, value, i;
+  cpj_string_t candidate;
+
+  size =
+    cpj_path_table_normalize(table->path_style, path, buffer, buffer_size);
+  if (size >= buffer_size || size > table->max_path_size) {
+    return false;
+  }
+
+  slot = (cpj_size_t)cpj_path_hash(table->path_style, buffer, size);
+  for (i = 0; i < table->hash_size; ++i, ++slot) {
+    value = cpj_number_get(
+      table->hash + (slot & (table->hash_size - 1)) * CPJ_NUMBER_SIZE
+    );
+    if (value == 0) {
+      break;
+    } else if (cpj_path_table_get(table, value - 1, &candidate) &&
+               cpj_path_is_string_equal(
+                 table->path_style, candidate.ptr, buffer, candidate.size,
+                 size
+               )) {
+      if (position != NULL) {
+        *position = value - 1;
+      }
+      return true;
+    }
+  }
+  return false;
+} /* cpj_path_table_lookup */
+
+cpj_size_t cpj_path_table_descendants_of(
+  const cpj_path_table_t *table, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_size_t *first
+)
+{
+  cpj_path_table_node_t node;
+  cpj_string_t normalized, own;
+  const cpj_char_t *segment;
+  cpj_size_t root_size, segment_size, i;
+
+  *first = 0;
+  normalized.ptr = buffer;
+  normalized.size =
+    cpj_path_table_normalize(table->path_style, path, buffer, buffer_size);
+  if (normalized.size >= buffer_size || table->level_count == 0) {
+    return 0;
+  }
+
+  // The root is looked up on the first level, and every segment among the
+  // children of the previous node.
+  root_size =
+    cpj_path_get_root_sized(table->path_style, buffer, normalized.size);
+  if (!cpj_path_table_find_node(
+        table, cpj_number_get(table->levels),
+        cpj_number_get(table->levels + CPJ_NUMBER_SIZE), buffer, root_size,
+        &node
+      )) {
+    return 0;
+  }
+
+  i = root_size;
+  if (normalized.size != root_size + 1 || buffer[root_size] != '.') {
+    for (;;) {
+      segment_size =
+        cpj_path_next_segment(table->path_style, &normalized, &i, &segment);
+      if (segment_size == 0) {
+        break;
+      }
+      if (!cpj_path_table_find_node(
+            table, node.first_child, node.first_child + node.child_count,
+            segment, segment_size, &node
+          )) {
+        return 0;
+      }
+    }
+  }
+
+  // The path itself comes first if it is part of the table.
+  *first = node.path_begin;
+  if (cpj_path_table_get(table, node.path_begin, &own) &&
+      cpj_path_is_string_equal(
+        table->path_style, own.ptr, normalized.ptr, own.size, normalized.size
+      )) {
+    ++*first;
+  }
+  return node.path_end > *first ? node.path_end - *first : 0;
+} /* cpj_path_table_descendants_of */
+
+/**
+ * Every slot of a name index holds the hash of a name, the offset and size of
+ * the name within the column and the position of its first path. A slot
+ * without a name has a size of 0, since empty names are not indexed.
+ */
+#define CPJ_NAME_SLOT_SIZE 4
+#define CPJ_NAME_KIND_COUNT 3
+
+typedef struct
+{
+  cpj_name_index_t *index;
+  cpj_size_t first_kind;
+  cpj_size_t last_kind;
+} cpj_name_index_kinds_t;
+
+/**
+ * Gets a name of a path from its basename, which fails if the path has no such
+ * name.
+ */
+static bool cpj_name_index_get_name(
+  const cpj_string_t *basename, cpj_size_t kind, cpj_string_t *name
+)
+{
+  cpj_string_t extension;
+
+  *name = *basename;
+  if (kind != CPJ_NAME_BASENAME) {
+    if (!cpj_path_find_extension(basename, &extension)) {
+      return kind == CPJ_NAME_STEM && name->size > 0;
+    } else if (kind == CPJ_NAME_EXTENSION) {
+      *name = extension;
+    } else {
+      name->size = (cpj_size_t)(extension.ptr - name->ptr);
+    }
+  }
+  return name->size > 0;
+} /* cpj_name_index_get_name */
+
+/**
+ * Finds the slot of a name, or the empty slot where it belongs.
+ */
+static cpj_size_t *cpj_name_index_probe(
+  const cpj_name_index_t *index, const cpj_size_t *slots,
+  const cpj_string_t *name, cpj_size_t hash
+)
+{
+  const cpj_size_t *slot;
+  cpj_size_t i;
+
+  for (i = hash;; ++i) {
+    slot = slots + (i & (index->slot_count - 1)) * CPJ_NAME_SLOT_SIZE;
+    if (slot[2] == 0 ||
+        (slot[0] == hash &&
+         cpj_path_is_string_equal(
+           index->path_style, index->paths.data + slot[1], name->ptr, slot[2],
+           name->size
+         ))) {
+      return (cpj_size_t *)slot;
+    }
+  }
+} /* cpj_name_index_probe */
+
+/**
+ * Counts or places the paths of a range of kinds. The basename is the slow
+ * part, so it is only searched once per path for all the kinds.
+ */
+static void cpj_name_index_scan(cpj_name_index_kinds_t build, bool is_counting)
+{
+  cpj_name_index_t *index = build.index;
+  cpj_size_t *slots, *slot, hash, i, kind;
+  cpj_string_t path, basename, name;
+
+  for (i = 0; i < index->paths.count; ++i) {
+    path = cpj_path_column_get(&index->paths, i);
+    cpj_path_get_basename(index->path_style, &path, &basename);
+    for (kind = build.first_kind; kind <= build.last_kind; ++kind) {
+      if (!cpj_name_index_get_name(&basename, kind, &name)) {
+        continue;
+      }
+      slots = index->slots + kind * index->slot_count * CPJ_NAME_SLOT_SIZE;
+      hash = (cpj_size_t)cpj_path_hash(index->path_style, name.ptr, name.size);
+      slot = cpj_name_index_probe(index, slots, &name, hash);
+      if (!is_counting) {
+        index->positions[kind * index->paths.count + slot[3]++] = i;
+        continue;
+      }
+      if (slot[2] == 0) {
+        slot[0] = hash;
+        slot[1] = (cpj_size_t)(name.ptr - index->paths.data);
+        slot[2] = name.size;
+      }
+      ++slot[3];
+    }
+  }
+} /* cpj_name_index_scan */
+
+/**
+ * Indexes a range of kinds. The paths of every name are counted first, which
+ * gives the first position of every name, and then put in place in a second
+ * pass over the paths, so they stay in ascending order.
+ */
+static void cpj_name_index_build_kinds(cpj_name_index_kinds_t build)
+{
+  cpj_name_index_t *index = build.index;
+  cpj_size_t *slots, i, kind, count, first;
+
+  cpj_name_index_scan(build, true);
+  for (kind = build.first_kind; kind <= build.last_kind; ++kind) {
+    slots = index->slots + kind * index->slot_count * CPJ_NAME_SLOT_SIZE;
+    for (i = 0, count = 0; i < index->slot_count; ++i) {
+      first = count;
+      count += slots[i * CPJ_NAME_SLOT_SIZE + 3];
+      slots[i * CPJ_NAME_SLOT_SIZE + 3] = first;
+    }
+    index->position_counts[kind] = count;
+  }
+
+  cpj_name_index_scan(build, false);
+
+  // Every slot now points to the first position of the next one, which is
+  // moved back to where the slot starts.
+  for (kind = build.first_kind; kind <= build.last_kind; ++kind) {
+    slots = index->slots + kind * index->slot_count * CPJ_NAME_SLOT_SIZE;
+    for (i = index->slot_count - 1; i > 0; --i) {
+      slots[i * CPJ_NAME_SLOT_SIZE + 3] =
+        slots[(i - 1) * CPJ_NAME_SLOT_SIZE + 3];
+    }
+    slots[3] = 0;
+  }
+} /* cpj_name_index_build_kinds */
+
+#ifdef CPJ_THREADS
+static void *cpj_name_index_thread(void *argument)
+{
+  cpj_name_index_build_kinds(*(cpj_name_index_kinds_t *)argument);
+  return NULL;
+} /* cpj_name_index_thread */
+#endif
+
+/**
+ * Gets the number of slots of every kind, which keeps the hash tables at
+ * most half full.
+ */
+static cpj_size_t cpj_name_index_slot_count(cpj_size_t count)
+{
+  cpj_size_t slot_count = 1;
+
+  while (slot_count < count * 2) {
+    slot_count *= 2;
+  }
+  return slot_count;
+} /* cpj_name_index_slot_count */
+
+cpj_size_t cpj_name_index_storage_size(cpj_size_t count)
+{
+  return CPJ_NAME_KIND_COUNT *
+         (cpj_name_index_slot_count(count) * CPJ_NAME_SLOT_SIZE + count);
+} /* cpj_name_index_storage_size */
+
+void cpj_name_index_build(
+  cpj_name_index_t *index, cpj_path_style_t path_style,
+  const cpj_string_column_t *paths, cpj_size_t *storage, unsigned int flags
+)
+{
+  cpj_name_index_kinds_t builds[CPJ_NAME_KIND_COUNT];
+#ifdef CPJ_THREADS
+  cpj_size_t i;
+  pthread_t threads[CPJ_NAME_KIND_COUNT];
+  bool has_thread[CPJ_NAME_KIND_COUNT] = {false};
+#endif
+
+  index->path_style = path_style;
+  index->paths = *paths;
+  index->slot_count = cpj_name_index_slot_count(paths->count);
+  index->slots = storage;
+  index->positions = storage + CPJ_NAME_KIND_COUNT * index->slot_count *
+                                 CPJ_NAME_SLOT_SIZE;
+  memset(
+    index->slots, 0,
+    CPJ_NAME_KIND_COUNT * index->slot_count * CPJ_NAME_SLOT_SIZE *
+      sizeof(*index->slots)
+  );
+
+  // The kinds of names do not share anything, so they are indexed on threads
+  // of their own. Otherwise all kinds are indexed at once, which searches the
+  // basename of every path only once.
+  builds[0].index = index;
+  builds[0].first_kind = 0;
+  builds[0].last_kind = CPJ_NAME_KIND_COUNT - 1;
+#ifdef CPJ_THREADS
+  if (flags & CPJ_NAME_INDEX_PARALLEL) {
+    builds[0].last_kind = 0;
+    for (i = 1; i < CPJ_NAME_KIND_COUNT; ++i) {
+      builds[i].index = index;
+      builds[i].first_kind = i;
+      builds[i].last_kind = i;
+      has_thread[i] = pthread_create(
+                        threads + i, NULL, cpj_name_index_thread, builds + i
+                      ) == 0;
+    }
+  }
+#else
+  (void)flags;
+#endif
+
+  cpj_name_index_build_kinds(builds[0]);
+#ifdef CPJ_THREADS
+  for (i = 1; i < CPJ_NAME_KIND_COUNT; ++i) {
+    if (has_thread[i]) {
+      pthread_join(threads[i], NULL);
+    } else if (builds[0].last_kind < i) {
+      cpj_name_index_build_kinds(builds[i]);
+    }
+  }
+#endif
+} /* cpj_name_index_build */
+
+cpj_size_t cpj_name_index_find(
+  const cpj_name_index_t *index, cpj_name_kind_t kind,
+  const cpj_string_t *name, const cpj_size_t **positions
+)
+{
+  const cpj_size_t *slots =
+    index->slots + kind * index->slot_count * CPJ_NAME_SLOT_SIZE;
+  const cpj_size_t *slot, *next;
+  cpj_size_t hash;
+
+  *positions = index->positions + kind * index->paths.count;
+  if (name->size == 0) {
+    return 0;
+  }
+
+  hash = (cpj_size_t)cpj_path_hash(index->path_style, name->ptr, name->size);
+  slot = cpj_name_index_probe(index, slots, name, hash);
+  if (slot[2] == 0) {
+    return 0;
+  }
+
+  // The paths of a name end where the paths of the next slot start.
+  next = slot + CPJ_NAME_SLOT_SIZE;
+  *positions += slot[3];
+  return (next < slots + index->slot_count * CPJ_NAME_SLOT_SIZE
+            ? next[3]
+            : index->position_counts[kind]) -
+         slot[3];
+} /* cpj_name_index_find */
+
+/**
+ * Gets the previous segment of a path before `end`, skipping any separators.
+ * Returns false once only the root is left.
+ */
+static bool cpj_glob_prev_segment(
+  cpj_path_style_t path_style, const cpj_char_t *path, cpj_size_t root_size,
+  cpj_size_t *end, cpj_string_t *segment
+)
+{
+  cpj_size_t start;
+
+  while (*end > root_size &&
+         cpj_path_is_separator(path_style, path[*end - 1])) {
+    --*end;
+  }
+  if (*end == root_size) {
+    return false;
+  }
+
+  start = *end;
+  while (start > root_size &&
+         !cpj_path_is_separator(path_style, path[start - 1])) {
+    --start;
+  }
+  segment->ptr = path + start;
+  segment->size = *end - start;
+  *end = start;
+  return true;
+} /* cpj_glob_prev_segment */
+
+static bool cpj_glob_is_dots(const cpj_string_t *segment, cpj_size_t count)
+{
+  return segment->size == count && segment->ptr[0] == '.' &&
+         (count == 1 || segment->ptr[1] == '.');
+} /* cpj_glob_is_dots */
+
+/**
+ * Walks the segments of a path backwards, the way they would be after the
+ * path has been normalized. Walking backwards means a `..` only has to be
+ * counted, so the segments it removes can be skipped once they are reached.
+ */
+typedef struct
+{
+  const cpj_char_t *path;
+  cpj_size_t root_size;
+  cpj_size_t end;
+  cpj_size_t skip_count;
+} cpj_glob_cursor_t;
+
+static bool cpj_glob_cursor_prev(
+  cpj_path_style_t path_style, cpj_glob_cursor_t *cursor, cpj_string_t *segment
+)
+{
+  while (cpj_glob_prev_segment(
+    path_style, cursor->path, cursor->root_size, &cursor->end, segment
+  )) {
+    if (cpj_glob_is_dots(segment, 2)) {
+      ++cursor->skip_count;
+    } else if (cpj_glob_is_dots(segment, 1)) {
+      continue;
+    } else if (cursor->skip_count > 0) {
+      --cursor->skip_count;
+    } else {
+      return true;
+    }
+  }
+
+  // A relative path keeps the `..` which lead out of it, but an absolute path
+  // can not go above its root.
+  if (cursor->skip_count == 0 || cursor->root_size > 0) {
+    return false;
+  }
+  --cursor->skip_count;
+  segment->ptr = "..";
+  segment->size = 2;
+  return true;
+} /* cpj_glob_cursor_prev */
+
+static bool cpj_glob_char_in_range(
+  cpj_path_style_t path_style, cpj_char_t ch, cpj_char_t low, cpj_char_t high
+)
+{
+  unsigned char c = (unsigned char)ch;
+
+  if (c >= (unsigned char)low && c <= (unsigned char)high) {
+    return true;
+  }
+  if (path_style == CPJ_STYLE_UNIX) {
+    return false;
+  }
+  c = (unsigned char)(isupper(c) ? tolower(c) : toupper(c));
+  return c >= (unsigned char)low && c <= (unsigned char)high;
+} /* cpj_glob_char_in_range */
+
+/**
+ * Matches a single character against the pattern at `pos`, which is either a
+ * `?`, a set or a plain character. Receives the position after it in `next`.
+ * A `[` without a closing `]` is a plain character.
+ */
+static bool cpj_glob_char_match(
+  cpj_path_style_t path_style, const cpj_string_t *pattern, cpj_size_t pos,
+  cpj_char_t ch, cpj_size_t *next
+)
+{
+  const cpj_char_t *p = pattern->ptr;
+  cpj_size_t i = pos + 1, first;
+  bool is_negated, is_matched = false;
+  cpj_char_t low;
+
+  *next = pos + 1;
+  if (p[pos] == '?') {
+    return true;
+  } else if (p[pos] == '[') {
+    is_negated = i < pattern->size && (p[i] == '!' || p[i] == '^');
+    i += is_negated;
+
+    // A `]` right at the start of the set is part of it.
+    for (first = i; i < pattern->size && (p[i] != ']' || i == first); ++i) {
+      low = p[i];
+      if (i + 2 < pattern->size && p[i + 1] == '-' && p[i + 2] != ']') {
+        i += 2;
+      }
+      is_matched |= cpj_glob_char_in_range(path_style, ch, low, p[i]);
+    }
+    if (i < pattern->size) {
+      *next = i + 1;
+      return is_matched != is_negated;
+    }
+  }
+
+  return p[pos] == ch ||
+         (path_style == CPJ_STYLE_WINDOWS &&
+          tolower((unsigned char)p[pos]) == tolower((unsigned char)ch));
+} /* cpj_glob_char_match */
+
+/**
+ * Matches a segment against a segment of the pattern. A `*` first matches
+ * nothing and takes one more character whenever the rest does not match,
+ * which only ever has to go back to the last `*`.
+ */
+static bool cpj_glob_segment_match(
+  cpj_path_style_t path_style, const cpj_glob_segment_t *pattern,
+  const cpj_string_t *segment
+)
+{
+  cpj_size_t p = 0, s = 0, star_p = CPJ_SIZE_MAX, star_s = 0, next;
+
+  if (pattern->type == CPJ_GLOB_ANY) {
+    return true;
+  } else if (pattern->type == CPJ_GLOB_LITERAL) {
+    return cpj_path_is_string_equal(
+      path_style, pattern->name.ptr, segment->ptr, pattern->name.size,
+      segment->size
+    );
+  }
+
+  while (s < segment->size) {
+    if (p < pattern->name.size && pattern->name.ptr[p] == '*') {
+      star_p = ++p;
+      star_s = s;
+    } else if (p < pattern->name.size &&
+               cpj_glob_char_match(
+                 path_style, &pattern->name, p, segment->ptr[s], &next
+               )) {
+      p = next;
+      ++s;
+    } else if (star_p != CPJ_SIZE_MAX) {
+      p = star_p;
+      s = ++star_s;
+    } else {
+      return false;
+    }
+  }
+
+  while (p < pattern->name.size && pattern->name.ptr[p] == '*') {
+    ++p;
+  }
+  return p == pattern->name.size;
+} /* cpj_glob_segment_match */
+
+static bool cpj_glob_is_special(cpj_char_t ch)
+{
+  return ch == '*' || ch == '?' || ch == '[';
+} /* cpj_glob_is_special */
+
+static cpj_glob_segment_type_t
+cpj_glob_segment_type(const cpj_string_t *segment)
+{
+  cpj_size_t i;
+
+  if (segment->size == 1 && segment->ptr[0] == '*') {
+    return CPJ_GLOB_ANY;
+  } else if (segment->size == 2 && segment->ptr[0] == '*' &&
+             segment->ptr[1] == '*') {
+    return CPJ_GLOB_RECURSIVE;
+  }
+  for (i = 0; i < segment->size; ++i) {
+    if (cpj_glob_is_special(segment->ptr[i])) {
+      return CPJ_GLOB_WILDCARD;
+    }
+  }
+  return CPJ_GLOB_LITERAL;
+} /* cpj_glob_segment_type */
+
+/**
+ * Puts a segment in front of the segments compiled so far, unless `end` is
+ * NULL which only counts it.
+ */
+static void cpj_glob_push_front(
+  cpj_glob_segment_t **end, cpj_glob_segment_type_t type,
+  const cpj_string_t *name, cpj_size_t *count
+)
+{
+  ++*count;
+  if (*end != NULL) {
+    --*end;
+    (*end)->type = type;
+    (*end)->name = *name;
+  }
+} /* cpj_glob_push_front */
+
+/**
+ * Compiles the pattern backwards, the same way cpj_glob_cursor_prev walks a
+ * path. The only difference is that a `..` can not remove a `**`, since it
+ * is not known how many segments the `**` will match.
+ */
+static cpj_size_t cpj_glob_compile_segments(
+  const cpj_glob_t *glob, const cpj_string_t *pattern, cpj_glob_segment_t *end
+)
+{
+  static const cpj_string_t dots = {"..", 2};
+  cpj_glob_segment_type_t type, previous_type = CPJ_GLOB_LITERAL;
+  cpj_size_t position = pattern->size, skip_count = 0, count = 0;
+  cpj_string_t segment;
+
+  while (cpj_glob_prev_segment(
+    glob->path_style, pattern->ptr, glob->root.size, &position, &segment
+  )) {
+    type = cpj_glob_segment_type(&segment);
+    if (cpj_glob_is_dots(&segment, 2)) {
+      ++skip_count;
+      continue;
+    } else if (cpj_glob_is_dots(&segment, 1)) {
+      continue;
+    } else if (skip_count > 0 && type != CPJ_GLOB_RECURSIVE) {
+      --skip_count;
+      continue;
+    }
+
+    for (; skip_count > 0; --skip_count) {
+      cpj_glob_push_front(&end, CPJ_GLOB_LITERAL, &dots, &count);
+      previous_type = CPJ_GLOB_LITERAL;
+    }
+
+    // Any number of segments followed by any number of segments is still any
+    // number of segments.
+    if (type != CPJ_GLOB_RECURSIVE || previous_type != CPJ_GLOB_RECURSIVE) {
+      cpj_glob_push_front(&end, type, &segment, &count);
+    }
+    previous_type = type;
+  }
+
+  if (glob->root.size == 0) {
+    for (; skip_count > 0; --skip_count) {
+      cpj_glob_push_front(&end, CPJ_GLOB_LITERAL, &dots, &count);
+    }
+  }
+  return count;
+} /* cpj_glob_compile_segments */
+
+cpj_size_t cpj_glob_compile(
+  cpj_glob_t *glob, cpj_path_style_t path_style, const cpj_string_t *pattern,
+  cpj_glob_segment_t *segments, cpj_size_t segment_capacity
+)
+{
+  glob->path_style = path_style;
+  glob->root.ptr = pattern->ptr;
+  glob->root.size =
+    cpj_path_get_root_sized(path_style, pattern->ptr, pattern->size);
+  glob->segments = segments;
+  glob->segment_count = cpj_glob_compile_segments(glob, pattern, NULL);
+
+  // The segments are compiled from the back, so they can only be written once
+  // it is known where the first one goes.
+  if (segments != NULL && glob->segment_count <= segment_capacity) {
+    cpj_glob_compile_segments(
+      glob, pattern, segments + glob->segment_count
+    );
+  }
+  return glob->segment_count;
+} /* cpj_glob_compile */
+
+/**
+ * Matches the segments of a path, which are left before the cursor, against
+ * the segments of a glob. If `is_trailing_required` is set, a trailing `**`
+ * has to match at least one segment.
+ */
+static bool cpj_glob_match_cursor(
+  const cpj_glob_t *glob, cpj_glob_cursor_t cursor, bool is_trailing_required
+)
+{
+  cpj_glob_cursor_t star_cursor;
+  cpj_size_t pattern_pos = glob->segment_count, star_pos = CPJ_SIZE_MAX;
+  cpj_string_t segment;
+
+  // A trailing `**` which matches at least one segment is the same as one
+  // which matches any number of segments followed by the last segment.
+  if (is_trailing_required && pattern_pos > 0 &&
+      glob->segments[pattern_pos - 1].type == CPJ_GLOB_RECURSIVE &&
+      !cpj_glob_cursor_prev(glob->path_style, &cursor, &segment)) {
+    return false;
+  }
+  star_cursor = cursor;
+
+  // The segments are matched from the back. A `**` first matches no segments
+  // at all and takes one more segment whenever the segments after it do not
+  // match, which only ever has to go back to the last `**`.
+  for (;;) {
+    while (pattern_pos > 0 &&
+           glob->segments[pattern_pos - 1].type == CPJ_GLOB_RECURSIVE) {
+      star_pos = --pattern_pos;
+      star_cursor = cursor;
+    }
+
+    if (!cpj_glob_cursor_prev(glob->path_style, &cursor, &segment)) {
+      return pattern_pos == 0;
+    } else if (pattern_pos > 0 &&
+               cpj_glob_segment_match(
+                 glob->path_style, glob->segments + pattern_pos - 1, &segment
+               )) {
+      --pattern_pos;
+    } else if (star_pos != CPJ_SIZE_MAX &&
+               cpj_glob_cursor_prev(
+                 glob->path_style, &star_cursor, &segment
+               )) {
+      cursor = star_cursor;
+      pattern_pos = star_pos;
+    } else {
+      return false;
+    }
+  }
+} /* cpj_glob_match_cursor */
+
+bool cpj_glob_match(const cpj_glob_t *glob, const cpj_string_t *path)
+{
+  cpj_glob_cursor_t cursor;
+
+  cursor.path = path->ptr;
+  cursor.root_size =
+    cpj_path_get_root_sized(glob->path_style, path->ptr, path->size);
+  cursor.end = path->size;
+  cursor.skip_count = 0;
+  return cpj_path_is_string_equal(
+           glob->path_style, glob->root.ptr, path->ptr, glob->root.size,
+           cursor.root_size
+         ) &&
+         cpj_glob_match_cursor(glob, cursor, false);
+} /* cpj_glob_match */
+
+/**
+ * Parses a line of a gitignore file into its pattern and flags, which fails
+ * for empty lines and comments. Trailing spaces are removed and a leading
+ * separator only anchors the pattern.
+ */
+static bool cpj_pattern_parse(
+  cpj_path_style_t path_style, const cpj_string_t *line, cpj_string_t *pattern,
+  unsigned int *flags
+)
+{
+  const cpj_char_t *ptr = line->ptr;
+  cpj_size_t size = line->size, i;
+
+  *flags = 0;
+  while (size > 0 && ptr[size - 1] == ' ') {
+    --size;
+  }
+  if (size == 0 || ptr[0] == '#') {
+    return false;
+  }
+
+  if (ptr[0] == '!') {
+    *flags |= CPJ_PATTERN_NEGATED;
+    ++ptr;
+    --size;
+  } else if (path_style == CPJ_STYLE_UNIX && size > 1 && ptr[0] == '\\' &&
+             (ptr[1] == '#' || ptr[1] == '!')) {
+    ++ptr;
+    --size;
+  }
+
+  if (size > 0 && cpj_path_is_separator(path_style, ptr[size - 1])) {
+    *flags |= CPJ_PATTERN_DIRECTORY;
+    while (size > 0 && cpj_path_is_separator(path_style, ptr[size - 1])) {
+      --size;
+    }
+  }
+  for (i = 0; i < size; ++i) {
+    if (cpj_path_is_separator(path_style, ptr[i])) {
+      *flags |= CPJ_PATTERN_ANCHORED;
+      break;
+    }
+  }
+  while (size > 0 && cpj_path_is_separator(path_style, ptr[0])) {
+    ++ptr;
+    --size;
+  }
+
+  pattern->ptr = ptr;
+  pattern->size = size;
+  return size > 0;
+} /* cpj_pattern_parse */
+
+#define CPJ_PATTERN_PREFIX_SIZE 4
+#define CPJ_PATTERN_KEYS                                                       \
+  (CPJ_PATTERN_BASENAME | CPJ_PATTERN_EXTENSION | CPJ_PATTERN_PREFIX)
+
+/**
+ * Chooses how a compiled rule is found, which depends on its last segment. A
+ * literal segment is looked up by the basename, a `*` followed by a literal
+ * extension by the extension and any other segment starting with literal
+ * characters by those characters. All other rules are generic and matched
+ * one by one.
+ */
+static void cpj_pattern_classify(cpj_pattern_rule_t *rule)
+{
+  const cpj_glob_segment_t *segment =
+    rule->glob.segments + rule->glob.segment_count - 1;
+  cpj_size_t i;
+
+  rule->depth = 0;
+  rule->is_exact = true;
+  for (i = 0; i < rule->glob.segment_count; ++i) {
+    if (rule->glob.segments[i].type == CPJ_GLOB_RECURSIVE) {
+      rule->is_exact = false;
+    } else {
+      ++rule->depth;
+    }
+  }
+
+  // A trailing `**` matches what is inside of a directory, but not the
+  // directory itself.
+  rule->key = segment->name;
+  if (segment->type == CPJ_GLOB_RECURSIVE) {
+    ++rule->depth;
+    rule->key.size = 0;
+    return;
+  } else if (segment->type == CPJ_GLOB_LITERAL) {
+    rule->flags |= CPJ_PATTERN_BASENAME;
+    return;
+  }
+
+  // The literal beginning of a segment is used as key, but at most the first
+  // few characters of it so only a few lookups are needed for every path.
+  i = 0;
+  while (i < CPJ_PATTERN_PREFIX_SIZE &&
+         !cpj_glob_is_special(segment->name.ptr[i])) {
+    ++i;
+  }
+  if (i > 0) {
+    rule->flags |= CPJ_PATTERN_PREFIX;
+    rule->key.size = i;
+    return;
+  }
+
+  rule->key.size = 0;
+  if (segment->name.size < 2 || segment->name.ptr[0] != '*' ||
+      segment->name.ptr[1] != '.') {
+    return;
+  }
+  for (i = 2; i < segment->name.size; ++i) {
+    if (cpj_glob_is_special(segment->name.ptr[i]) ||
+        segment->name.ptr[i] == '.') {
+      return;
+    }
+  }
+  rule->flags |= CPJ_PATTERN_EXTENSION;
+  rule->key.ptr = segment->name.ptr + 1;
+  rule->key.size = segment->name.size - 1;
+} /* cpj_pattern_classify */
+
+static cpj_size_t cpj_pattern_hash(
+  cpj_path_style_t path_style, const cpj_string_t *key, unsigned int kind
+)
+{
+  return (cpj_size_t)cpj_path_hash(path_style, key->ptr, key->size) + kind;
+} /* cpj_pattern_hash */
+
+cpj_size_t cpj_patternset_compile(
+  cpj_patternset_t *set, cpj_path_style_t path_style,
+  const cpj_string_t *patterns, cpj_size_t pattern_count,
+  cpj_pattern_rule_t *rules, cpj_glob_segment_t *segments,
+  cpj_size_t segment_capacity
+)
+{
+  cpj_pattern_rule_t *rule;
+  cpj_string_t pattern;
+  cpj_size_t i, bucket, segment_count = 0;
+  unsigned int flags;
+  cpj_glob_t glob;
+
+  set->path_style = path_style;
+  set->rules = rules;
+  set->rule_count = 0;
+  set->last_generic = 0;
+  for (i = 0; i < pattern_count; ++i) {
+    if (cpj_pattern_parse(path_style, patterns + i, &pattern, &flags)) {
+      segment_count += cpj_glob_compile(&glob, path_style, &pattern, NULL, 0);
+    }
+  }
+  if (segment_count > segment_capacity) {
+    return segment_count;
+  }
+
+  // Patterns without any segment, like `.`, can never match.
+  for (i = 0; i < pattern_count; ++i) {
+    rule = rules + set->rule_count;
+    if (!cpj_pattern_parse(path_style, patterns + i, &pattern, &flags) ||
+        cpj_glob_compile(
+          &rule->glob, path_style, &pattern, segments, segment_capacity
+        ) == 0) {
+      continue;
+    }
+    segments += rule->glob.segment_count;
+    segment_capacity -= rule->glob.segment_count;
+    rule->flags = flags;
+    cpj_pattern_classify(rule);
+    ++set->rule_count;
+  }
+
+  // The rules of a bucket are chained from the last one to the first, so the
+  // first rule which matches is the one which decides.
+  for (i = 0; i < set->rule_count; ++i) {
+    rules[i].bucket = 0;
+  }
+  for (i = 0; i < set->rule_count; ++i) {
+    rule = rules + i;
+    if (rule->key.size == 0) {
+      rule->hash = 0;
+      rule->next = set->last_generic;
+      set->last_generic = i + 1;
+      continue;
+    }
+    rule->hash = cpj_pattern_hash(
+      path_style, &rule->key, rule->flags & CPJ_PATTERN_KEYS
+    );
+    bucket = rule->hash % set->rule_count;
+    rule->next = rules[bucket].bucket;
+    rules[bucket].bucket = i + 1;
+  }
+
+  return segment_count;
+} /* cpj_patternset_compile */
+
+/**
+ * A path or one of its parents which is matched against a pattern set. The
+ * cursor holds the segments of the path, the last one being the basename.
+ */
+typedef struct
+{
+  cpj_glob_cursor_t cursor;
+  cpj_string_t basename;
+  cpj_size_t depth;
+  bool is_directory;
+} cpj_pattern_subject_t;
+
+/**
+ * Matches a rule against a path. The key of a rule which has been looked up
+ * is already known to match.
+ */
+static bool cpj_pattern_rule_match(
+  const cpj_pattern_rule_t *rule, const cpj_pattern_subject_t *subject
+)
+{
+  if ((rule->flags & CPJ_PATTERN_DIRECTORY) && !subject->is_directory) {
+    return false;
+  } else if (rule->flags & CPJ_PATTERN_ANCHORED) {
+    return subject->depth >= rule->depth &&
+           (!rule->is_exact || subject->depth == rule->depth) &&
+           cpj_glob_match_cursor(&rule->glob, subject->cursor, true);
+  }
+  return (rule->flags & (CPJ_PATTERN_BASENAME | CPJ_PATTERN_EXTENSION)) ||
+         cpj_glob_segment_match(
+           rule->glob.path_style, rule->glob.segments, &subject->basename
+         );
+} /* cpj_pattern_rule_match */
+
+/**
+ * Looks up the last rule with a key which matches the path and comes after
+ * the rule found so far. Returns the rule plus one, or `found` if there is
+ * none.
+ */
+static cpj_size_t cpj_patternset_lookup(
+  const cpj_patternset_t *set, unsigned int kind, const cpj_string_t *key,
+  const cpj_pattern_subject_t *subject, cpj_size_t found
+)
+{
+  const cpj_pattern_rule_t *rule;
+  cpj_size_t i, hash = cpj_pattern_hash(set->path_style, key, kind);
+
+  for (i = set->rules[hash % set->rule_count].bucket; i > found;
+       i = rule->next) {
+    rule = set->rules + i - 1;
+    if (rule->hash == hash && (rule->flags & kind) &&
+        cpj_path_is_string_equal(
+          set->path_style, rule->key.ptr, key->ptr, rule->key.size, key->size
+        ) &&
+        cpj_pattern_rule_match(rule, subject)) {
+      return i;
+    }
+  }
+  return found;
+} /* cpj_patternset_lookup */
+
+/**
+ * Finds the last rule which matches a path, which returns the rule plus one or
+ * 0 if there is none. Every lookup only has to try the rules after the one
+ * which has been found so far.
+ */
+static cpj_size_t cpj_patternset_find(
+  const cpj_patternset_t *set, const cpj_pattern_subject_t *subject
+)
+{
+  const cpj_pattern_rule_t *rule;
+  cpj_string_t key;
+  cpj_size_t i, found;
+
+  found = cpj_patternset_lookup(
+    set, CPJ_PATTERN_BASENAME, &subject->basename, subject, 0
+  );
+  if (cpj_path_find_extension(&subject->basename, &key)) {
+    found =
+      cpj_patternset_lookup(set, CPJ_PATTERN_EXTENSION, &key, subject, found);
+  }
+  key.ptr = subject->basename.ptr;
+  for (key.size = 1; key.size <= CPJ_PATTERN_PREFIX_SIZE &&
+                     key.size <= subject->basename.size;
+       ++key.size) {
+    found =
+      cpj_patternset_lookup(set, CPJ_PATTERN_PREFIX, &key, subject, found);
+  }
+
+  for (i = set->last_generic; i > found; i = rule->next) {
+    rule = set->rules + i - 1;
+    if (cpj_pattern_rule_match(rule, subject)) {
+      return i;
+    }
+  }
+  return found;
+} /* cpj_patternset_find */
+
+cpj_pattern_verdict_t cpj_patternset_match(
+  const cpj_patternset_t *set, const cpj_string_t *path, bool is_directory
+)
+{
+  cpj_pattern_subject_t subject;
+  cpj_glob_cursor_t parent;
+  cpj_size_t depth = 0, found, last = 0;
+
+  if (set->rule_count == 0) {
+    return CPJ_PATTERN_UNMATCHED;
+  }
+
+  subject.cursor.path = path->ptr;
+  subject.cursor.root_size =
+    cpj_path_get_root_sized(set->path_style, path->ptr, path->size);
+  subject.cursor.end = path->size;
+  subject.cursor.skip_count = 0;
+  parent = subject.cursor;
+  while (cpj_glob_cursor_prev(set->path_style, &parent, &subject.basename)) {
+    ++depth;
+  }
+
+  // Every parent is matched as a directory on the way up, and an ignored
+  // parent ignores the path no matter what matches the path itself.
+  for (subject.depth = depth; subject.depth > 0; --subject.depth) {
+    parent = subject.cursor;
+    cpj_glob_cursor_prev(set->path_style, &parent, &subject.basename);
+    subject.is_directory = is_directory || subject.depth < depth;
+    found = cpj_patternset_find(set, &subject);
+    if (subject.depth == depth) {
+      last = found;
+    } else if (found > 0 &&
+               !(set->rules[found - 1].flags & CPJ_PATTERN_NEGATED)) {
+      return CPJ_PATTERN_IGNORED;
+    }
+    subject.cursor = parent;
+  }
+
+  if (last == 0) {
+    return CPJ_PATTERN_UNMATCHED;
+  }
+  return set->rules[last - 1].flags & CPJ_PATTERN_NEGATED
+           ? CPJ_PATTERN_INCLUDED
+           : CPJ_PATTERN_IGNORED;
+} /* cpj_patternset_match */
+
+cpj_size_t cpj_path_change_root(
+  cpj_path_style_t path_style, const cpj_string_t *path,
+  const cpj_string_t *new_root, cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  cpj_size_t root_length =
+    cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_string_t paths[2];
+  paths[0] = *new_root;
+  paths[1].ptr = path->ptr + root_length;
+  paths[1].size = path->size - root_length;
+  return cpj_path_join_multiple(
+    path_style, false, true, paths, 2, buffer, buffer_size
+  );
+}
+
+cpj_size_t cpj_path_get_intersection(
+  cpj_path_style_t path_style, const cpj_string_t *path_base,
+  const cpj_string_t *path_other
+)
+{
+  cpj_path_intersection_t intersection =
+    cpj_path_get_intersection_segments(path_style, path_base, path_other, 1);
+  cpj_segment_iterator_t
+    it_base = cpj_path_interator_init(path_style, false, true, path_base, 1);
+  cpj_size_t k;
+  if (intersection.equal_segment == 0) {
+    return 0;
+  }
+  for (k = intersection.segment_count_base; k >= intersection.equal_segment;) {
+    k -= 1;
+    cpj_path_get_prev_segment(path_style, &it_base);
+  }
+  cpj_string_t segment = cpj_path_get_segment(&it_base);
+  return segment.ptr - path_base->ptr + segment.size;
+}
+
+cpj_size_t cpj_path_change_basename(
+  cpj_path_style_t path_style, const cpj_string_t *path,
+  const cpj_string_t *new_basename, cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  cpj_string_t paths[2] = {*path, *new_basename};
+  cpj_string_t basename;
+  cpj_size_t root_length =
+    cpj_path_get_root_sized(path_style, path->ptr, path->size);
+  cpj_size_t i, size, buffer_index;
+  bool has_separator;
+  bool is_plain_basename = new_basename->size > 0 &&
+                           !cpj_path_is_dot_segment(
+                             new_basename->ptr, new_basename->size
+                           );
+  for (i = 0; is_plain_basename && i < new_basename->size; ++i) {
+    is_plain_basename =
+      !cpj_path_is_separator(path_style, new_basename->ptr[i]);
+  }
+
+  if (!is_plain_basename) {
+    // First we try to get the last segment. We may only have a root without
+    // any segments, in which case we will create one.
+    cpj_path_get_basename(path_style, path, &basename);
+    paths[0].size -= basename.size;
+    return cpj_path_join_multiple(
+      path_style, true, true, paths, 2, buffer, buffer_size
+    );
+  }
+
+  // The last segment is cut off the path, along with any separators behind
+  // it. A plain basename is never changed by the normalization, so it is
+  // appended to the normalized rest of the path as it is, and replaces the
+  // `.` placeholder of an empty directory.
+  paths[0].size = path->size;
+  while (paths[0].size > root_length &&
+         cpj_path_is_separator(path_style, path->ptr[paths[0].size - 1])) {
+    --paths[0].size;
+  }
+  while (paths[0].size > root_length &&
+         !cpj_path_is_separator(path_style, path->ptr[paths[0].size - 1])) {
+    --paths[0].size;
+  }
+  if (buffer && buffer_size > path->size + new_basename->size + 2) {
+    // The rest is normalized into the buffer within a single pass.
+    size = cpj_path_normalize_forward(
+      path_style, path->ptr, paths[0].size, buffer, &root_length
+    );
+    i = cpj_path_normalized_basename(path_style, buffer, size, root_length);
+    if (size - i == 1 && buffer[i] == '.') {
+      size = i;
+    } else if (size > root_length) {
+      buffer[size++] = path_style == CPJ_STYLE_UNIX ? '/' : '\\';
+    }
+    memcpy(buffer + size, new_basename->ptr, new_basename->size);
+    size += new_basename->size;
+    buffer[size] = '\0';
+    return size;
+  }
+
+  // The buffer might not hold the result, so the size is calculated first.
+  // The rest is joined into the buffer, which truncates it if necessary, and
+  // the basename is written behind it from back to front.
+  size = cpj_path_normalized_size(
+    path_style, path->ptr, paths[0].size, &root_length, &basename
+  );
+  has_separator = false;
+  if (basename.size == 1 && basename.ptr[0] == '.') {
+    --size;
+  } else if (size > root_length) {
+    has_separator = true;
+    ++size;
+  }
+  size += new_basename->size;
+  if (buffer && buffer_size > 0) {
+    cpj_path_join_multiple(
+      path_style, true, true, paths, 1, buffer, buffer_size
+    );
+    buffer_index = size + 1;
+    cpj_path_push_front_char(
+      path_style, buffer, buffer_size, &buffer_index, '\0'
+    );
+    cpj_path_push_front_string(
+      path_style, buffer, buffer_size, &buffer_index, new_basename
+    );
+    if (has_separator) {
+      cpj_path_push_front_char(
+        path_style, buffer, buffer_size, &buffer_index, '/'
+      );
+    }
+  }
+  return size;
+}
+
+bool cpj_path_get_extension(
+  cpj_path_style_t path_style, const cpj_string_t *path, cpj_string_t *extension
+)
+{
+  cpj_string_t basename;
+  // First we try to get the last segment. We may only have a root without any
+  // segments, in which case we will create one.
+  cpj_path_get_basename(path_style, path, &basename);
+
+  // We get the last segment of the path. The last segment will contain the
+  // extension if there is any.
+  return cpj_path_find_extension(&basename, extension);
+}
+
+cpj_size_t
+cpj_path_get_dirname(cpj_path_style_t path_style, const cpj_string_t *path)
+{
+  cpj_string_t basename;
+  // First we try to get the last segment. We may only have a root without any
+  // segments, in which case we will create one.
+  cpj_path_get_basename(path_style, path, &basename);
+
+  // We can now return the length from the beginning of the string up to the
+  // beginning of the last segment.
+  return basename.ptr ? (cpj_size_t)(basename.ptr - path->ptr) : path->size;
+}
+
+cpj_size_t cpj_path_change_extension(
+  cpj_path_style_t path_style, const cpj_string_t *path,
+  const cpj_string_t *new_extension, cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  bool new_extention_start_with_dot = new_extension->size > 0 &&
+                                      new_extension->ptr[0] == '.';
+  if (cpj_path_get_root_sized(path_style, path->ptr, path->size) ==
+      path->size) {
+    cpj_size_t buffer_size_needed = path->size + new_extension->size + 1;
+    if (!new_extention_start_with_dot) {
+      buffer_size_needed += 1;
+    }
+    cpj_size_t buffer_index = buffer_size_needed;
+    cpj_path_push_front_char(
+      path_style, buffer, buffer_size, &buffer_index, '\0'
+    );
+    cpj_path_push_front_string(
+      path_style, buffer, buffer_size, &buffer_index, new_extension
+    );
+    if (!new_extention_start_with_dot) {
+      cpj_path_push_front_char(
+        path_style, buffer, buffer_size, &buffer_index, '.'
+      );
+    }
+    cpj_path_push_front_string(
+      path_style, buffer, buffer_size, &buffer_index, path
+    );
+    return buffer_size_needed - 1;
+  } else if (buffer && buffer_size > path->size + new_extension->size + 3) {
+    // The path is normalized into the buffer within a single pass, and the
+    // extension of the last segment is replaced afterwards.
+    cpj_string_t extension = *new_extension;
+    cpj_size_t root_length;
+    cpj_size_t size = cpj_path_normalize_forward(
+      path_style, path->ptr, path->size, buffer, &root_length
+    );
+    cpj_size_t basename_index =
+      cpj_path_normalized_basename(path_style, buffer, size, root_length);
+    if (new_extention_start_with_dot) {
+      extension.ptr += 1;
+      extension.size -= 1;
+    }
+    if (!cpj_path_is_dot_segment(
+          buffer + basename_index, size - basename_index
+        )) {
+      cpj_size_t i;
+      for (i = size; i > basename_index; --i) {
+        if (buffer[i - 1] == '.') {
+          size = i - 1;
+          break;
+        }
+      }
+    } else if (extension.size > 0 && size - basename_index == 1) {
+      // The extension is used as the basename in place of the `.`
+      // placeholder.
+      size = basename_index;
+    } else if (extension.size > 0) {
+      // The extension is used as a basename within the parent directory.
+      buffer[size++] = path_style == CPJ_STYLE_UNIX ? '/' : '\\';
+    }
+    if (extension.size > 0) {
+      buffer[size++] = '.';
+      memcpy(buffer + size, extension.ptr, extension.size);
+      size += extension.size;
+    } else if (size == basename_index && size > root_length) {
+      // Removing the extension of a name like `.hidden` leaves the parent
+      // directory behind, which is written without the separator.
+      --size;
+    } else if (size == root_length &&
+               (size == 0 ||
+                !cpj_path_is_separator(path_style, buffer[size - 1]))) {
+      buffer[size++] = '.';
+    }
+    buffer[size] = '\0';
+    return size;
+  } else {
+    // The buffer might not hold the result, so its size is calculated with
+    // the same edits first. The path is joined into the buffer, which
+    // truncates it if necessary, and the extension is written behind the
+    // part which is kept from back to front.
+    cpj_string_t extension = *new_extension;
+    cpj_string_t basename;
+    cpj_size_t root_length, basename_index, buffer_index, i;
+    cpj_size_t size = cpj_path_normalized_size(
+      path_style, path->ptr, path->size, &root_length, &basename
+    );
+    bool has_separator = false, has_dot = false;
+    basename_index = size - basename.size;
+    if (new_extention_start_with_dot) {
+      extension.ptr += 1;
+      extension.size -= 1;
+    }
+    if (!cpj_path_is_dot_segment(basename.ptr, basename.size)) {
+      for (i = basename.size; i > 0; --i) {
+        if (basename.ptr[i - 1] == '.') {
+          size -= basename.size - i + 1;
+          break;
+        }
+      }
+    } else if (extension.size > 0 && basename.size == 1) {
+      --size;
+    } else if (extension.size > 0) {
+      has_separator = true;
+    }
+    if (extension.size > 0) {
+      has_dot = true;
+    } else if (size == basename_index && size > root_length) {
+      --size;
+    } else if (size == root_length &&
+               (size == 0 ||
+                !cpj_path_is_separator(path_style, path->ptr[size - 1]))) {
+      has_dot = true;
+    }
+    size += extension.size + (has_separator ? 1 : 0) + (has_dot ? 1 : 0);
+    if (buffer && buffer_size > 0) {
+      cpj_path_join_multiple(
+        path_style, true, true, path, 1, buffer, buffer_size
+      );
+      buffer_index = size + 1;
+      cpj_path_push_front_char(
+        path_style, buffer, buffer_size, &buffer_index, '\0'
+      );
+      cpj_path_push_front_string(
+        path_style, buffer, buffer_size, &buffer_index, &extension
+      );
+      if (has_dot) {
+        cpj_path_push_front_char(
+          path_style, buffer, buffer_size, &buffer_index, '.'
+        );
+      }
+      if (has_separator) {
+        cpj_path_push_front_char(
+          path_style, buffer, buffer_size, &buffer_index, '/'
+        );
+      }
+    }
+    return size;
+  }
+}
+
+cpj_path_style_t cpj_path_guess_style(const cpj_string_t *path)
+{
+  const cpj_char_t *c;
+  const cpj_char_t *end = path->ptr + path->size;
+  cpj_size_t root_length;
   cpj_string_t basename;
 
-  // First we determine the root. Only windows roots can be longer than a single
-  // slash, so if we can determine that it starts with something like "C:", we
-  // know that this is a windows path.
-  root_length = cpj_path_get_root_windows(path->ptr);
-  if (root_length > 1) {
-    return CPJ_STYLE_WINDOWS;
+  // First we determine the root. Only windows roots can be longer than a single
+  // slash, so if we can determine that it starts with something like "C:", we
+  // know that this is a windows path.
+  root_length = cpj_path_get_root_windows(path->ptr, path->size);
+  if (root_length > 1) {
+    return CPJ_STYLE_WINDOWS;
+  }
+
+  // Next we check for slashes. Windows uses backslashes, while unix uses
+  // forward slashes. Windows actually supports both, but our best guess is to
+  // assume windows with backslashes and unix with forward slashes.
+  for (c = path->ptr; c < end && *c; ++c) {
+    if (*c == '\\') {
+      return CPJ_STYLE_WINDOWS;
+    }
+  }
+
+  for (c = path->ptr; c < end && *c; ++c) {
+    if (*c == '/') {
+      return CPJ_STYLE_UNIX;
+    }
+  }
+
+  // This path does not have any slashes. We grab the last segment (which
+  // actually must be the first one), and determine whether the segment starts
+  // with a dot. A dot is a hidden folder or file in the UNIX world, in that
+  // case we assume the path to have UNIX style.
+  cpj_path_get_basename(CPJ_STYLE_UNIX, path, &basename);
+  if (basename.ptr == NULL) {
+    // We couldn't find any segments, so we default to a UNIX path style since
+    // there is no way to make any assumptions.
+    return CPJ_STYLE_UNIX;
+  }
+
+  if (*basename.ptr == '.') {
+    return CPJ_STYLE_UNIX;
+  }
+
+  // And finally we check whether the last segment contains a dot. If it
+  // contains a dot, that might be an extension. Windows is more likely to have
+  // file names with extensions, so our guess would be windows.
+  for (c = basename.ptr; c < basename.ptr + basename.size && *c; ++c) {
+    if (*c == '.') {
+      return CPJ_STYLE_WINDOWS;
+    }
+  }
+
+  // All our checks failed, so we will return a default value which is currently
+  // UNIX.
+  return CPJ_STYLE_UNIX;
+}
+
+/**
+ * A path which has been parsed into its segments by a pipeline. The segments
+ * point into the path or into the arguments of the stages. The extensions
+ * which have been added by CPJ_PIPELINE_CHANGE_EXTENSION are stored right
+ * behind the segments. They belong to the last segment, and each of them is
+ * written with a '.' in front of it.
+ */
+typedef struct
+{
+  cpj_string_t root;
+  bool root_is_absolute;
+  cpj_string_t *segments; /**< CPJ_PIPELINE_SEGMENT_MAX entries */
+  cpj_size_t segment_count;
+  cpj_size_t extension_count;
+  bool is_overflow;
+} cpj_pipeline_path_t;
+
+static void
+cpj_pipeline_path_init(cpj_pipeline_path_t *path, cpj_string_t *segments)
+{
+  path->root.ptr = CPJ_ZSTR_LITERAL("");
+  path->root.size = 0;
+  path->root_is_absolute = false;
+  path->segments = segments;
+  path->segment_count = 0;
+  path->extension_count = 0;
+  path->is_overflow = false;
+} /* cpj_pipeline_path_init */
+
+/**
+ * Appends a segment or an extension to the path as it is. Segments may only be
+ * appended as long as the path has no extensions.
+ */
+static void cpj_pipeline_path_append(
+  cpj_pipeline_path_t *path, const cpj_char_t *str, cpj_size_t size,
+  bool is_extension
+)
+{
+  cpj_string_t *entry;
+  if (path->segment_count + path->extension_count >= CPJ_PIPELINE_SEGMENT_MAX) {
+    path->is_overflow = true;
+    return;
+  }
+  if (is_extension) {
+    entry = path->segments + path->segment_count + path->extension_count++;
+  } else {
+    assert(path->extension_count == 0);
+    entry = path->segments + path->segment_count++;
+  }
+  entry->ptr = str;
+  entry->size = size;
+} /* cpj_pipeline_path_append */
+
+/**
+ * Pushes a segment onto the path, a ".." segment removes the last segment
+ * instead if there is any.
+ */
+static void cpj_pipeline_path_push(
+  cpj_pipeline_path_t *path, const cpj_char_t *segment, cpj_size_t segment_size
+)
+{
+  if (segment_size == 2 && segment[0] == '.' && segment[1] == '.') {
+    if (path->segment_count > 0 &&
+        !cpj_path_is_dot_segment(
+          path->segments[path->segment_count - 1].ptr,
+          path->segments[path->segment_count - 1].size
+        )) {
+      --path->segment_count;
+      return;
+    }
+    if (path->root_is_absolute) {
+      return;
+    }
+  }
+  cpj_pipeline_path_append(path, segment, segment_size, false);
+} /* cpj_pipeline_path_push */
+
+/**
+ * Parses a string and pushes its segments onto the path. The root is only
+ * detected for the first string of a path, the root of any further string is
+ * treated like a segment, the same way cpj_path_join_multiple does.
+ */
+static void cpj_pipeline_path_parse(
+  cpj_path_style_t path_style, cpj_pipeline_path_t *path,
+  const cpj_string_t *str, bool with_root
+)
+{
+  cpj_size_t i = 0;
+  if (with_root) {
+    path->root.ptr = str->ptr;
+    path->root.size = cpj_path_get_root_sized(path_style, str->ptr, str->size);
+    path->root_is_absolute =
+      path->root.size > 0 &&
+      cpj_path_is_separator(path_style, str->ptr[path->root.size - 1]);
+    i = path->root.size;
+  }
+  while (i < str->size) {
+    cpj_size_t segment_start;
+    while (i < str->size && cpj_path_is_separator(path_style, str->ptr[i])) {
+      ++i;
+    }
+    segment_start = i;
+    while (i < str->size && !cpj_path_is_separator(path_style, str->ptr[i])) {
+      ++i;
+    }
+    if (i > segment_start &&
+        !(i - segment_start == 1 && str->ptr[segment_start] == '.')) {
+      cpj_pipeline_path_push(path, str->ptr + segment_start, i - segment_start);
+    }
+  }
+} /* cpj_pipeline_path_parse */
+
+/**
+ * Pushes the segments and the extensions of another path onto the path. The
+ * root of the other path is pushed as a segment if `with_root` is set.
+ */
+static void cpj_pipeline_path_push_path(
+  cpj_pipeline_path_t *path, const cpj_pipeline_path_t *other, bool with_root
+)
+{
+  cpj_size_t i;
+  if (with_root && other->root.size > 0) {
+    cpj_pipeline_path_push(path, other->root.ptr, other->root.size);
+  }
+  for (i = 0; i < other->segment_count; ++i) {
+    if (i + 1 == other->segment_count && other->extension_count > 0) {
+      // The segment is part of a name like `..ktx2`, it is no ".." segment.
+      cpj_pipeline_path_append(
+        path, other->segments[i].ptr, other->segments[i].size, false
+      );
+    } else {
+      cpj_pipeline_path_push(
+        path, other->segments[i].ptr, other->segments[i].size
+      );
+    }
+  }
+  for (; i < other->segment_count + other->extension_count; ++i) {
+    cpj_pipeline_path_append(
+      path, other->segments[i].ptr, other->segments[i].size, true
+    );
+  }
+} /* cpj_pipeline_path_push_path */
+
+/**
+ * Counts the components of the path the same way cpj_path_get_relative does,
+ * where the root and the `.` of a path without segments are components as
+ * well.
+ */
+static cpj_size_t
+cpj_pipeline_path_component_count(const cpj_pipeline_path_t *path)
+{
+  cpj_size_t count = path->segment_count;
+  if (count == 0 && !path->root_is_absolute) {
+    count = 1;
+  }
+  return path->root.size > 0 ? count + 1 : count;
+} /* cpj_pipeline_path_component_count */
+
+/**
+ * Gets a character of a component of the path, where the extensions are part
+ * of the last segment. The index must be within the component.
+ */
+static cpj_char_t cpj_pipeline_path_component_char(
+  const cpj_pipeline_path_t *path, const cpj_string_t *component,
+  bool has_extensions, cpj_size_t index
+)
+{
+  cpj_size_t i;
+  if (index < component->size) {
+    return component->ptr[index];
+  }
+  index -= component->size;
+  for (i = 0; has_extensions && i < path->extension_count; ++i) {
+    const cpj_string_t *extension = path->segments + path->segment_count + i;
+    if (index == 0) {
+      return '.';
+    } else if (index <= extension->size) {
+      return extension->ptr[index - 1];
+    }
+    index -= extension->size + 1;
+  }
+  return '\0';
+} /* cpj_pipeline_path_component_char */
+
+/**
+ * Gets a component of the path. The extensions are not part of the returned
+ * string, the size of the full component is returned instead.
+ */
+static cpj_size_t cpj_pipeline_path_get_component(
+  const cpj_pipeline_path_t *path, cpj_size_t index, cpj_string_t *component,
+  bool *has_extensions
+)
+{
+  cpj_size_t size, i;
+  *has_extensions = false;
+  if (path->root.size > 0) {
+    if (index == 0) {
+      *component = path->root;
+      return component->size;
+    }
+    --index;
+  }
+  if (path->segment_count == 0) {
+    component->ptr = CPJ_ZSTR_LITERAL(".");
+    component->size = 1;
+    return component->size;
+  }
+  *component = path->segments[index];
+  size = component->size;
+  if (index + 1 == path->segment_count && path->extension_count > 0) {
+    *has_extensions = true;
+    for (i = 0; i < path->extension_count; ++i) {
+      size += path->segments[path->segment_count + i].size + 1;
+    }
+  }
+  return size;
+} /* cpj_pipeline_path_get_component */
+
+/**
+ * Counts the leading components which are equal within both paths.
+ */
+static cpj_size_t cpj_pipeline_path_get_intersection(
+  cpj_path_style_t path_style, const cpj_pipeline_path_t *path_base,
+  const cpj_pipeline_path_t *path_other
+)
+{
+  cpj_size_t count_base = cpj_pipeline_path_component_count(path_base);
+  cpj_size_t count_other = cpj_pipeline_path_component_count(path_other);
+  cpj_size_t equal_count = 0;
+  for (; equal_count < count_base && equal_count < count_other;
+       ++equal_count) {
+    cpj_string_t base, other;
+    bool base_has_extensions, other_has_extensions;
+    cpj_size_t k, size = cpj_pipeline_path_get_component(
+                    path_base, equal_count, &base, &base_has_extensions
+                  );
+    if (size != cpj_pipeline_path_get_component(
+                  path_other, equal_count, &other, &other_has_extensions
+                )) {
+      break;
+    }
+    if (!base_has_extensions && !other_has_extensions) {
+      if (!cpj_path_is_string_equal(
+            path_style, base.ptr, other.ptr, base.size, other.size
+          )) {
+        break;
+      }
+      continue;
+    }
+    for (k = 0; k < size; ++k) {
+      int a = cpj_pipeline_path_component_char(
+        path_base, &base, base_has_extensions, k
+      );
+      int b = cpj_pipeline_path_component_char(
+        path_other, &other, other_has_extensions, k
+      );
+      if (path_style == CPJ_STYLE_WINDOWS ? tolower(a) != tolower(b) : a != b) {
+        break;
+      }
+    }
+    if (k < size) {
+      break;
+    }
+  }
+  return equal_count;
+} /* cpj_pipeline_path_get_intersection */
+
+static void cpj_pipeline_path_change_extension(
+  cpj_pipeline_path_t *path, const cpj_string_t *new_extension
+)
+{
+  cpj_string_t extension = *new_extension;
+  cpj_string_t *last = path->segment_count > 0
+                         ? path->segments + path->segment_count - 1
+                         : NULL;
+  if (extension.size > 0 && extension.ptr[0] == '.') {
+    extension.ptr += 1;
+    extension.size -= 1;
+  }
+  if (last && (path->extension_count > 0 ||
+               !cpj_path_is_dot_segment(last->ptr, last->size))) {
+    // The basename is cut off at its last '.', which is either within the last
+    // extension or within the segment itself.
+    cpj_string_t *cut = path->extension_count > 0
+                          ? last + path->extension_count
+                          : last;
+    cpj_size_t i = cut->size;
+    while (i > 0 && cut->ptr[i - 1] != '.') {
+      --i;
+    }
+    if (i > 0) {
+      cut->size = i - 1;
+    } else if (path->extension_count > 0) {
+      --path->extension_count;
+    }
+    if (extension.size == 0 && path->extension_count == 0 &&
+        (last->size == 0 || cpj_path_is_dot_segment(last->ptr, last->size))) {
+      // Nothing is left of a basename like `.hidden`, or a name like `...`
+      // has become a `.` or ".." segment, which is resolved right away.
+      cpj_string_t segment = *last;
+      --path->segment_count;
+      if (segment.size == 2) {
+        cpj_pipeline_path_push(path, segment.ptr, segment.size);
+      }
+    }
+  } else if (extension.size > 0) {
+    // The extension is used as a basename within the directory.
+    cpj_pipeline_path_append(path, CPJ_ZSTR_LITERAL(""), 0, false);
+  }
+  if (extension.size > 0) {
+    cpj_pipeline_path_append(path, extension.ptr, extension.size, true);
+  }
+} /* cpj_pipeline_path_change_extension */
+
+static void cpj_pipeline_write(
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *buffer_index,
+  const cpj_char_t *str, cpj_size_t size
+)
+{
+  if (*buffer_index < buffer_size) {
+    cpj_size_t copy_size = buffer_size - *buffer_index;
+    memcpy(buffer + *buffer_index, str, copy_size < size ? copy_size : size);
+  }
+  *buffer_index += size;
+} /* cpj_pipeline_write */
+
+static cpj_size_t cpj_pipeline_path_write(
+  cpj_path_style_t path_style, const cpj_pipeline_path_t *path,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  const cpj_char_t *separator = path_style == CPJ_STYLE_UNIX
+                                  ? CPJ_ZSTR_LITERAL("/")
+                                  : CPJ_ZSTR_LITERAL("\\");
+  cpj_size_t buffer_index = 0;
+  cpj_size_t i;
+
+  for (i = 0; i < path->root.size; ++i) {
+    cpj_pipeline_write(
+      buffer, buffer_size, &buffer_index,
+      cpj_path_is_separator(path_style, path->root.ptr[i])
+        ? separator
+        : path->root.ptr + i,
+      1
+    );
+  }
+  for (i = 0; i < path->segment_count; ++i) {
+    if (i > 0) {
+      cpj_pipeline_write(buffer, buffer_size, &buffer_index, separator, 1);
+    }
+    cpj_pipeline_write(
+      buffer, buffer_size, &buffer_index, path->segments[i].ptr,
+      path->segments[i].size
+    );
+  }
+  for (; i < path->segment_count + path->extension_count; ++i) {
+    cpj_pipeline_write(
+      buffer, buffer_size, &buffer_index, CPJ_ZSTR_LITERAL("."), 1
+    );
+    cpj_pipeline_write(
+      buffer, buffer_size, &buffer_index, path->segments[i].ptr,
+      path->segments[i].size
+    );
+  }
+  if (path->segment_count == 0 && !path->root_is_absolute) {
+    cpj_pipeline_write(
+      buffer, buffer_size, &buffer_index, CPJ_ZSTR_LITERAL("."), 1
+    );
+  }
+
+  if (buffer_index < buffer_size) {
+    buffer[buffer_index] = '\0';
+  } else if (buffer_size > 0) {
+    buffer[buffer_size - 1] = '\0';
+  }
+  return buffer_index;
+} /* cpj_pipeline_path_write */
+
+/**
+ * The segment storage of the paths which take part in a pipeline run. The
+ * paths are swapped whenever a stage builds a new path out of an old one.
+ */
+typedef struct
+{
+  cpj_string_t segments[3][CPJ_PIPELINE_SEGMENT_MAX];
+  cpj_pipeline_path_t path;
+  cpj_pipeline_path_t other;
+  cpj_pipeline_path_t base;
+} cpj_pipeline_state_t;
+
+static void
+cpj_pipeline_path_swap(cpj_pipeline_path_t *a, cpj_pipeline_path_t *b)
+{
+  cpj_pipeline_path_t tmp = *a;
+  *a = *b;
+  *b = tmp;
+} /* cpj_pipeline_path_swap */
+
+static void cpj_pipeline_change_root(
+  const cpj_pipeline_t *pipeline, cpj_pipeline_state_t *state,
+  const cpj_string_t *new_root
+)
+{
+  cpj_pipeline_path_init(&state->other, state->other.segments);
+  cpj_pipeline_path_parse(
+    pipeline->path_style, &state->other, new_root, true
+  );
+  cpj_pipeline_path_push_path(&state->other, &state->path, false);
+  cpj_pipeline_path_swap(&state->path, &state->other);
+} /* cpj_pipeline_change_root */
+
+static void cpj_pipeline_get_relative(
+  const cpj_pipeline_t *pipeline, cpj_pipeline_state_t *state,
+  const cpj_string_t *base_directory
+)
+{
+  cpj_size_t equal_count, i;
+  cpj_pipeline_path_init(&state->base, state->base.segments);
+  cpj_pipeline_path_parse(
+    pipeline->path_style, &state->base, base_directory, true
+  );
+  equal_count = cpj_pipeline_path_get_intersection(
+    pipeline->path_style, &state->base, &state->path
+  );
+  if (equal_count == 0) {
+    // The paths have nothing in common, so both of them are resolved against
+    // the current directory. The path stays resolved if they still have
+    // nothing in common. Like in cpj_path_join_multiple, any root replaces the
+    // current directory, even a drive-relative one like `C:`.
+    if (state->path.root.size == 0) {
+      cpj_pipeline_path_init(&state->other, state->other.segments);
+      cpj_pipeline_path_parse(
+        pipeline->path_style, &state->other, &pipeline->cwd_directory, true
+      );
+      cpj_pipeline_path_push_path(&state->other, &state->path, false);
+      cpj_pipeline_path_swap(&state->path, &state->other);
+    }
+    if (state->base.root.size == 0) {
+      cpj_pipeline_path_init(&state->other, state->other.segments);
+      cpj_pipeline_path_parse(
+        pipeline->path_style, &state->other, &pipeline->cwd_directory, true
+      );
+      cpj_pipeline_path_parse(
+        pipeline->path_style, &state->other, base_directory, false
+      );
+      cpj_pipeline_path_swap(&state->base, &state->other);
+    }
+    equal_count = cpj_pipeline_path_get_intersection(
+      pipeline->path_style, &state->base, &state->path
+    );
+    if (equal_count == 0) {
+      return;
+    }
+  }
+
+  // The relative path climbs up from the base to the common components and
+  // continues with the rest of the path.
+  cpj_pipeline_path_init(&state->other, state->other.segments);
+  for (i = cpj_pipeline_path_component_count(&state->base); i > equal_count;
+       --i) {
+    cpj_pipeline_path_append(&state->other, CPJ_ZSTR_ARG(".."), false);
+  }
+  i = state->path.root.size > 0 ? equal_count - 1 : equal_count;
+  if (i < state->path.segment_count) {
+    for (; i < state->path.segment_count; ++i) {
+      cpj_pipeline_path_append(
+        &state->other, state->path.segments[i].ptr,
+        state->path.segments[i].size, false
+      );
+    }
+    for (; i < state->path.segment_count + state->path.extension_count; ++i) {
+      cpj_pipeline_path_append(
+        &state->other, state->path.segments[i].ptr,
+        state->path.segments[i].size, true
+      );
+    }
+  }
+  cpj_pipeline_path_swap(&state->path, &state->other);
+} /* cpj_pipeline_get_relative */
+
+cpj_size_t cpj_pipeline_run(
+  const cpj_pipeline_t *pipeline, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+)
+{
+  cpj_pipeline_state_t state;
+  cpj_size_t i;
+
+  cpj_pipeline_path_init(&state.path, state.segments[0]);
+  cpj_pipeline_path_init(&state.other, state.segments[1]);
+  cpj_pipeline_path_init(&state.base, state.segments[2]);
+
+  // The path is parsed once, which normalizes it as well. The stages work on
+  // the segments from there on, and the result is written at the very end.
+  cpj_pipeline_path_parse(pipeline->path_style, &state.path, path, true);
+  for (i = 0; i < pipeline->stage_count; ++i) {
+    const cpj_pipeline_stage_t *stage = pipeline->stages + i;
+    switch (stage->type) {
+    case CPJ_PIPELINE_CHANGE_ROOT:
+      cpj_pipeline_change_root(pipeline, &state, &stage->argument);
+      break;
+    case CPJ_PIPELINE_CHANGE_EXTENSION:
+      cpj_pipeline_path_change_extension(&state.path, &stage->argument);
+      break;
+    case CPJ_PIPELINE_GET_RELATIVE:
+      cpj_pipeline_get_relative(pipeline, &state, &stage->argument);
+      break;
+    default:
+      // The path has already been normalized by parsing it.
+      break;
+    }
+    if (state.path.is_overflow || state.other.is_overflow ||
+        state.base.is_overflow) {
+      break;
+    }
+  }
+
+  if (state.path.is_overflow || state.other.is_overflow ||
+      state.base.is_overflow) {
+    if (buffer_size > 0) {
+      buffer[0] = '\0';
+    }
+    return 0;
+  }
+  return cpj_pipeline_path_write(
+    pipeline->path_style, &state.path, buffer, buffer_size
+  );
+} /* cpj_pipeline_run */
+
+/**
+ * Hashes a component of a path on top of the hash of the components in front
+ * of it. Components which are equal according to cpj_path_is_string_equal
+ * have the same hash.
+ */
+static cpj_size_t cpj_rebase_hash(
+  cpj_path_style_t path_style, cpj_size_t hash, const cpj_string_t *component
+)
+{
+  cpj_size_t i;
+  for (i = 0; i < component->size; ++i) {
+    unsigned char ch = (unsigned char)component->ptr[i];
+    if (path_style == CPJ_STYLE_WINDOWS) {
+      ch = cpj_path_is_separator(path_style, (cpj_char_t)ch)
+             ? (unsigned char)'/'
+             : (unsigned char)tolower(ch);
+    }
+    hash = (hash ^ ch) * 16777619u;
+  }
+  // The end of the component is hashed as well, so that the components `ab`
+  // `c` do not collide with the components `a` `bc`.
+  return (hash ^ 0x100u) * 16777619u;
+} /* cpj_rebase_hash */
+
+static cpj_size_t cpj_rebase_component_count(const cpj_pipeline_path_t *path)
+{
+  return path->root.size > 0 ? path->segment_count + 1 : path->segment_count;
+} /* cpj_rebase_component_count */
+
+/**
+ * Checks whether the leading components of the path are the components of the
+ * prefix.
+ */
+static bool cpj_rebase_starts_with(
+  cpj_path_style_t path_style, const cpj_pipeline_path_t *path,
+  const cpj_pipeline_path_t *prefix
+)
+{
+  cpj_size_t count = cpj_rebase_component_count(prefix);
+  cpj_size_t i;
+  if (count > cpj_rebase_component_count(path)) {
+    return false;
+  }
+  for (i = 0; i < count; ++i) {
+    cpj_string_t path_component, prefix_component;
+    bool has_extensions;
+    cpj_pipeline_path_get_component(path, i, &path_component, &has_extensions);
+    cpj_pipeline_path_get_component(
+      prefix, i, &prefix_component, &has_extensions
+    );
+    if (!cpj_path_is_string_equal(
+          path_style, path_component.ptr, prefix_component.ptr,
+          path_component.size, prefix_component.size
+        )) {
+      return false;
+    }
+  }
+  return true;
+} /* cpj_rebase_starts_with */
+
+/**
+ * Finds the rule whose old prefix are the leading components of the path. The
+ * hash is the hash of those components, and the old prefix of the rule is
+ * parsed into `prefix` to compare it.
+ */
+static const cpj_rebase_rule_t *cpj_rebase_find(
+  const cpj_rebase_t *rebase, cpj_path_style_t path_style, cpj_size_t hash,
+  cpj_size_t component_count, const cpj_pipeline_path_t *path,
+  cpj_pipeline_path_t *prefix
+)
+{
+  cpj_size_t mask = rebase->slot_count - 1;
+  cpj_size_t i;
+  for (i = hash & mask; rebase->slots[i].rule; i = (i + 1) & mask) {
+    const cpj_rebase_slot_t *slot = rebase->slots + i;
+    if (slot->hash != hash || slot->component_count != component_count ||
+        slot->rule->from_style != path_style) {
+      continue;
+    }
+    cpj_pipeline_path_init(prefix, prefix->segments);
+    cpj_pipeline_path_parse(
+      path_style, prefix, &slot->rule->from_prefix, true
+    );
+    if (cpj_rebase_starts_with(path_style, path, prefix)) {
+      return slot->rule;
+    }
+  }
+  return NULL;
+} /* cpj_rebase_find */
+
+bool cpj_rebase_init(
+  cpj_rebase_t *rebase, const cpj_rebase_rule_t *rules, cpj_size_t rule_count,
+  cpj_rebase_slot_t *slots, cpj_size_t slot_count
+)
+{
+  cpj_pipeline_state_t state;
+  cpj_size_t i, k;
+
+  if (slot_count <= rule_count || (slot_count & (slot_count - 1)) != 0) {
+    return false;
+  }
+  rebase->rules = rules;
+  rebase->rule_count = rule_count;
+  rebase->slots = slots;
+  rebase->slot_count = slot_count;
+  rebase->max_component_count = 0;
+  rebase->max_prefix_size = 0;
+  for (i = 0; i < slot_count; ++i) {
+    slots[i].rule = NULL;
+  }
+
+  for (i = 0; i < rule_count; ++i) {
+    const cpj_rebase_rule_t *rule = rules + i;
+    cpj_size_t hash = (cpj_size_t)2166136261u ^ (cpj_size_t)rule->from_style;
+    cpj_size_t component_count;
+    cpj_pipeline_path_init(&state.path, state.segments[0]);
+    cpj_pipeline_path_init(&state.other, state.segments[1]);
+    cpj_pipeline_path_parse(
+      rule->from_style, &state.path, &rule->from_prefix, true
+    );
+    component_count = cpj_rebase_component_count(&state.path);
+    if (state.path.is_overflow || component_count == 0) {
+      return false;
+    }
+    for (k = 0; k < component_count; ++k) {
+      cpj_string_t component;
+      bool has_extensions;
+      cpj_pipeline_path_get_component(
+        &state.path, k, &component, &has_extensions
+      );
+      hash = cpj_rebase_hash(rule->from_style, hash, &component);
+    }
+
+    // A rule with the same old prefix as an earlier one is dropped.
+    if (!cpj_rebase_find(
+          rebase, rule->from_style, hash, component_count, &state.path,
+          &state.other
+        )) {
+      cpj_size_t slot = hash & (slot_count - 1);
+      while (slots[slot].rule) {
+        slot = (slot + 1) & (slot_count - 1);
+      }
+      slots[slot].rule = rule;
+      slots[slot].hash = hash;
+      slots[slot].component_count = component_count;
+    }
+    if (component_count > rebase->max_component_count) {
+      rebase->max_component_count = component_count;
+    }
+    if (rule->to_prefix.size > rebase->max_prefix_size) {
+      rebase->max_prefix_size = rule->to_prefix.size;
+    }
+  }
+  return true;
+} /* cpj_rebase_init */
+
+cpj_size_t cpj_path_rebase(
+  const cpj_rebase_t *rebase, cpj_path_style_t path_style,
+  const cpj_string_t *path, cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  cpj_pipeline_state_t state;
+  cpj_size_t hashes[CPJ_PIPELINE_SEGMENT_MAX + 1];
+  cpj_size_t hash = (cpj_size_t)2166136261u ^ (cpj_size_t)path_style;
+  const cpj_rebase_rule_t *rule = NULL;
+  cpj_size_t component_count, k;
+
+  cpj_pipeline_path_init(&state.path, state.segments[0]);
+  cpj_pipeline_path_init(&state.other, state.segments[1]);
+  cpj_pipeline_path_init(&state.base, state.segments[2]);
+  cpj_pipeline_path_parse(path_style, &state.path, path, true);
+  if (state.path.is_overflow) {
+    if (buffer_size > 0) {
+      buffer[0] = '\0';
+    }
+    return 0;
+  }
+
+  // The hashes of all the leading components are calculated at once, and
+  // looked up starting with the longest one. That takes one lookup per
+  // component, no matter how many rules there are.
+  component_count = cpj_rebase_component_count(&state.path);
+  if (component_count > rebase->max_component_count) {
+    component_count = rebase->max_component_count;
+  }
+  for (k = 0; k < component_count; ++k) {
+    cpj_string_t component;
+    bool has_extensions;
+    cpj_pipeline_path_get_component(
+      &state.path, k, &component, &has_extensions
+    );
+    hash = cpj_rebase_hash(path_style, hash, &component);
+    hashes[k] = hash;
+  }
+  for (k = component_count; k > 0 && !rule; --k) {
+    rule = cpj_rebase_find(
+      rebase, path_style, hashes[k - 1], k, &state.path, &state.base
+    );
+  }
+  if (!rule) {
+    return cpj_pipeline_path_write(
+      path_style, &state.path, buffer, buffer_size
+    );
+  }
+
+  // The new prefix is followed by the rest of the segments.
+  cpj_pipeline_path_init(&state.other, state.segments[1]);
+  cpj_pipeline_path_parse(rule->to_style, &state.other, &rule->to_prefix, true);
+  k = state.base.segment_count;
+  for (; k < state.path.segment_count; ++k) {
+    cpj_pipeline_path_push(
+      &state.other, state.path.segments[k].ptr, state.path.segments[k].size
+    );
+  }
+  if (state.other.is_overflow) {
+    if (buffer_size > 0) {
+      buffer[0] = '\0';
+    }
+    return 0;
+  }
+  return cpj_pipeline_path_write(
+    rule->to_style, &state.other, buffer, buffer_size
+  );
+} /* cpj_path_rebase */
+
+typedef enum
+{
+  CPJ_COLUMN_NORMALIZE,
+  CPJ_COLUMN_JOIN,
+  CPJ_COLUMN_RELATIVE,
+  CPJ_COLUMN_CHANGE_EXTENSION,
+  CPJ_COLUMN_PIPELINE,
+  CPJ_COLUMN_REBASE
+} cpj_column_operation_t;
+
+/**
+ * The operation applied to each path of a column, with the arguments shared by
+ * all the paths.
+ */
+typedef struct
+{
+  cpj_column_operation_t operation;
+  cpj_path_style_t path_style;
+  const cpj_string_t *cwd_directory; /**< only used by CPJ_COLUMN_RELATIVE */
+  const cpj_string_t *argument; /**< base path or extension, if needed */
+  const cpj_pipeline_t *pipeline; /**< only used by CPJ_COLUMN_PIPELINE */
+  const cpj_rebase_t *rebase; /**< only used by CPJ_COLUMN_REBASE */
+} cpj_column_context_t;
+
+/**
+ * Computes the part of the upper bound which is shared by all the paths of a
+ * column, so that the bound of each path only adds its own size.
+ */
+static cpj_size_t
+cpj_path_column_shared_size(const cpj_column_context_t *context)
+{
+  const cpj_string_t path_empty = {CPJ_ZSTR_ARG("")};
+  switch (context->operation) {
+  case CPJ_COLUMN_JOIN: {
+    const cpj_string_t paths[] = {*context->argument, path_empty};
+    return cpj_path_join_max_size(paths, 2);
+  }
+  case CPJ_COLUMN_RELATIVE:
+    return cpj_path_relative_max_size(
+      context->cwd_directory, context->argument, &path_empty
+    );
+  case CPJ_COLUMN_CHANGE_EXTENSION:
+    // The extension and the '.' in front of it, plus a possible '.' for an
+    // empty result.
+    return context->argument->size + 2;
+  case CPJ_COLUMN_PIPELINE: {
+    // Each stage adds at most the same amount as the function of the same
+    // name, on top of the '.' of an empty path.
+    const cpj_pipeline_t *pipeline = context->pipeline;
+    cpj_size_t shared_size = cpj_path_join_max_size(&path_empty, 1);
+    cpj_size_t i;
+    for (i = 0; i < pipeline->stage_count; ++i) {
+      const cpj_string_t *argument = &pipeline->stages[i].argument;
+      if (pipeline->stages[i].type == CPJ_PIPELINE_CHANGE_ROOT) {
+        const cpj_string_t paths[] = {*argument, path_empty};
+        shared_size += cpj_path_join_max_size(paths, 2);
+      } else if (pipeline->stages[i].type == CPJ_PIPELINE_CHANGE_EXTENSION) {
+        shared_size += argument->size + 2;
+      } else if (pipeline->stages[i].type == CPJ_PIPELINE_GET_RELATIVE) {
+        shared_size += cpj_path_relative_max_size(
+          &pipeline->cwd_directory, argument, &path_empty
+        );
+      }
+    }
+    return shared_size;
+  }
+  case CPJ_COLUMN_REBASE:
+    // The new prefix replaces a part of the path, it may need a '.' if it
+    // has no segments and a separator in front of the rest of the path.
+    return context->rebase->max_prefix_size + 2;
+  default:
+    return cpj_path_join_max_size(&path_empty, 1);
+  }
+} /* cpj_path_column_shared_size */
+
+static cpj_size_t cpj_path_column_apply_one(
+  const cpj_column_context_t *context, const cpj_string_t *path,
+  cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  switch (context->operation) {
+  case CPJ_COLUMN_JOIN: {
+    const cpj_string_t paths[] = {*context->argument, *path};
+    return cpj_path_join_multiple(
+      context->path_style, false, true, paths, 2, buffer, buffer_size
+    );
+  }
+  case CPJ_COLUMN_RELATIVE:
+    return cpj_path_get_relative(
+      context->path_style, context->cwd_directory, context->argument, path,
+      buffer, buffer_size
+    );
+  case CPJ_COLUMN_CHANGE_EXTENSION:
+    return cpj_path_change_extension(
+      context->path_style, path, context->argument, buffer, buffer_size
+    );
+  case CPJ_COLUMN_PIPELINE:
+    return cpj_pipeline_run(context->pipeline, path, buffer, buffer_size);
+  case CPJ_COLUMN_REBASE:
+    return cpj_path_rebase(
+      context->rebase, context->path_style, path, buffer, buffer_size
+    );
+  default:
+    return cpj_path_join_multiple(
+      context->path_style, false, true, path, 1, buffer, buffer_size
+    );
+  }
+} /* cpj_path_column_apply_one */
+
+static cpj_size_t cpj_path_column_apply(
+  const cpj_column_context_t *context, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+)
+{
+  cpj_size_t shared_size = cpj_path_column_shared_size(context);
+  cpj_size_t buffer_index = 0;
+  cpj_size_t i;
+
+  if (!buffer) {
+    // The upper bound only looks at the sizes, the paths are not parsed. The
+    // result of each path fits into its own size plus the shared size.
+    cpj_size_t buffer_size_needed = 1;
+    buffer_size_needed += paths->offsets[paths->count] - paths->offsets[0];
+    buffer_size_needed += shared_size * paths->count;
+    return buffer_size_needed;
+  }
+
+  offsets[0] = 0;
+  for (i = 0; i < paths->count; ++i) {
+    cpj_string_t path;
+    path.ptr = paths->data + paths->offsets[i];
+    path.size = paths->offsets[i + 1] - paths->offsets[i];
+    // Each result is written right behind the previous one, overwriting its
+    // '\0' terminator. Once the buffer is exhausted only the sizes are
+    // calculated.
+    if (buffer_index < buffer_size) {
+      buffer_index += cpj_path_column_apply_one(
+        context, &path, buffer + buffer_index, buffer_size - buffer_index
+      );
+    } else {
+      buffer_index += cpj_path_column_apply_one(context, &path, NULL, 0);
+    }
+    offsets[i + 1] = buffer_index;
+  }
+  if (buffer_size > 0 && buffer_index < buffer_size) {
+    buffer[buffer_index] = '\0';
+  } else if (buffer_size > 0) {
+    buffer[buffer_size - 1] = '\0';
+  }
+  return buffer_index;
+} /* cpj_path_column_apply */
+
+cpj_size_t cpj_path_normalize_column(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+)
+{
+  cpj_column_context_t context = {0};
+  context.operation = CPJ_COLUMN_NORMALIZE;
+  context.path_style = path_style;
+  return cpj_path_column_apply(
+    &context, paths, buffer, buffer_size, offsets
+  );
+} /* cpj_path_normalize_column */
+
+cpj_size_t cpj_path_join_column(
+  cpj_path_style_t path_style, const cpj_string_t *base,
+  const cpj_string_column_t *paths, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *offsets
+)
+{
+  cpj_column_context_t context = {0};
+  context.operation = CPJ_COLUMN_JOIN;
+  context.path_style = path_style;
+  context.argument = base;
+  return cpj_path_column_apply(
+    &context, paths, buffer, buffer_size, offsets
+  );
+} /* cpj_path_join_column */
+
+cpj_size_t cpj_path_get_relative_column(
+  cpj_path_style_t path_style, const cpj_string_t *cwd_directory,
+  const cpj_string_t *base_directory, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+)
+{
+  cpj_column_context_t context = {0};
+  context.operation = CPJ_COLUMN_RELATIVE;
+  context.path_style = path_style;
+  context.cwd_directory = cwd_directory;
+  context.argument = base_directory;
+  return cpj_path_column_apply(
+    &context, paths, buffer, buffer_size, offsets
+  );
+} /* cpj_path_get_relative_column */
+
+cpj_size_t cpj_path_change_extension_column(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths,
+  const cpj_string_t *new_extension, cpj_char_t *buffer,
+  cpj_size_t buffer_size, cpj_size_t *offsets
+)
+{
+  cpj_column_context_t context = {0};
+  context.operation = CPJ_COLUMN_CHANGE_EXTENSION;
+  context.path_style = path_style;
+  context.argument = new_extension;
+  return cpj_path_column_apply(
+    &context, paths, buffer, buffer_size, offsets
+  );
+} /* cpj_path_change_extension_column */
+
+void cpj_path_guess_style_column(
+  const cpj_string_column_t *paths, cpj_path_style_t *styles
+)
+{
+  cpj_size_t i;
+  for (i = 0; i < paths->count; ++i) {
+    cpj_string_t path;
+    path.ptr = paths->data + paths->offsets[i];
+    path.size = paths->offsets[i + 1] - paths->offsets[i];
+    styles[i] = cpj_path_guess_style(&path);
+  }
+} /* cpj_path_guess_style_column */
+
+cpj_size_t cpj_pipeline_run_column(
+  const cpj_pipeline_t *pipeline, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets
+)
+{
+  cpj_column_context_t context = {0};
+  context.operation = CPJ_COLUMN_PIPELINE;
+  context.path_style = pipeline->path_style;
+  context.pipeline = pipeline;
+  return cpj_path_column_apply(
+    &context, paths, buffer, buffer_size, offsets
+  );
+} /* cpj_pipeline_run_column */
+
+cpj_size_t cpj_path_rebase_column(
+  const cpj_rebase_t *rebase, cpj_path_style_t path_style,
+  const cpj_string_column_t *paths, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *offsets
+)
+{
+  cpj_column_context_t context = {0};
+  context.operation = CPJ_COLUMN_REBASE;
+  context.path_style = path_style;
+  context.rebase = rebase;
+  return cpj_path_column_apply(
+    &context, paths, buffer, buffer_size, offsets
+  );
+} /* cpj_path_rebase_column */
+
+/**
+ * Checks whether a path contains "..", without looking at the separators.
+ * This lets memchr skip over the bulk of the path.
+ */
+static bool cpj_path_has_dot_dot(const cpj_string_t *path)
+{
+  const cpj_char_t *end = path->ptr + path->size;
+  const cpj_char_t *dot = path->ptr;
+  while (dot < end &&
+         (dot = memchr(dot, '.', (cpj_size_t)(end - dot))) != NULL) {
+    if (++dot < end && *dot == '.') {
+      return true;
+    }
+  }
+  return false;
+} /* cpj_path_has_dot_dot */
+
+cpj_size_t cpj_path_escapes_root_column(
+  cpj_path_style_t path_style, const cpj_string_column_t *paths, bool *escapes
+)
+{
+  cpj_size_t escape_count = 0;
+  cpj_size_t i;
+  for (i = 0; i < paths->count; ++i) {
+    cpj_string_t path;
+    bool escape;
+    path.ptr = paths->data + paths->offsets[i];
+    path.size = paths->offsets[i + 1] - paths->offsets[i];
+    escape = cpj_path_has_dot_dot(&path) &&
+             cpj_path_escapes_root(path_style, &path);
+    if (escapes) {
+      escapes[i] = escape;
+    }
+    escape_count += escape ? 1 : 0;
+  }
+  return escape_count;
+} /* cpj_path_escapes_root_column */
+
+cpj_sanitize_status_t cpj_sanitizer_run(
+  const cpj_sanitizer_t *sanitizer, const cpj_string_t *entry,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *size
+)
+{
+  cpj_path_style_t path_style = sanitizer->path_style;
+  const cpj_string_t *destination = &sanitizer->destination;
+  cpj_char_t separator = path_style == CPJ_STYLE_UNIX ? '/' : '\\';
+  cpj_sanitize_status_t status = CPJ_SANITIZE_OK;
+  const cpj_char_t *segment;
+  cpj_size_t segment_size, i = 0, buffer_index, depth = 0;
+  bool needs_separator, fits = destination->size < buffer_size;
+
+  if (entry->size > 0 && memchr(entry->ptr, '\0', entry->size)) {
+    status = CPJ_SANITIZE_INVALID;
+  } else if (cpj_path_get_root_sized(path_style, entry->ptr, entry->size) > 0) {
+    status = CPJ_SANITIZE_ABSOLUTE;
+  }
+
+  if (fits && status == CPJ_SANITIZE_OK) {
+    memcpy(buffer, destination->ptr, destination->size);
+  }
+  needs_separator = destination->size > 0 &&
+                    !cpj_path_is_separator(
+                      path_style, destination->ptr[destination->size - 1]
+                    );
+
+  // The name is validated and written in the same pass. A ".." segment moves
+  // back to the separator in front of the last written segment, which is
+  // never in front of the destination.
+  buffer_index = destination->size;
+  while (status == CPJ_SANITIZE_OK) {
+    segment_size = cpj_path_next_segment(path_style, entry, &i, &segment);
+    if (segment_size == 0) {
+      break;
+    } else if (segment_size == 1 && segment[0] == '.') {
+      continue;
+    } else if (segment_size == 2 && segment[0] == '.' && segment[1] == '.') {
+      if (depth == 0) {
+        status = CPJ_SANITIZE_ESCAPE;
+        break;
+      }
+      --depth;
+      while (fits && buffer_index > destination->size &&
+             buffer[buffer_index - 1] != separator) {
+        --buffer_index;
+      }
+      if (fits && buffer_index > destination->size) {
+        --buffer_index;
+      }
+      continue;
+    }
+
+    if (depth > 0 || needs_separator) {
+      if (fits && buffer_index + 1 < buffer_size) {
+        buffer[buffer_index] = separator;
+      } else {
+        fits = false;
+      }
+      ++buffer_index;
+    }
+    if (fits && buffer_index + segment_size < buffer_size) {
+      memcpy(buffer + buffer_index, segment, segment_size);
+    } else {
+      fits = false;
+    }
+    buffer_index += segment_size;
+    ++depth;
+  }
+
+  if (status == CPJ_SANITIZE_OK && buffer_index == 0) {
+    // Neither the destination nor the name have any segments.
+    if (fits && buffer_size > 1) {
+      buffer[buffer_index] = '.';
+    } else {
+      fits = false;
+    }
+    ++buffer_index;
+  }
+  if (status == CPJ_SANITIZE_OK && !fits) {
+    status = CPJ_SANITIZE_TOO_LONG;
+  }
+
+  if (status != CPJ_SANITIZE_OK) {
+    buffer_index = 0;
+  }
+  if (buffer_size > 0) {
+    buffer[buffer_index] = '\0';
+  }
+  if (size) {
+    *size = buffer_index;
+  }
+  return status;
+} /* cpj_sanitizer_run */
+
+cpj_size_t cpj_sanitizer_run_column(
+  const cpj_sanitizer_t *sanitizer, const cpj_string_column_t *paths,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *offsets,
+  cpj_sanitize_status_t *statuses
+)
+{
+  cpj_size_t buffer_index = 0;
+  cpj_size_t i;
+
+  if (!buffer) {
+    // Each output path fits into the destination, a separator and the name.
+    cpj_size_t buffer_size_needed = 1;
+    buffer_size_needed += paths->offsets[paths->count] - paths->offsets[0];
+    buffer_size_needed += (sanitizer->destination.size + 1) * paths->count;
+    return buffer_size_needed;
+  }
+
+  if (buffer_size > 0) {
+    buffer[0] = '\0';
+  }
+  offsets[0] = 0;
+  for (i = 0; i < paths->count; ++i) {
+    cpj_string_t path;
+    cpj_size_t size = 0;
+    path.ptr = paths->data + paths->offsets[i];
+    path.size = paths->offsets[i + 1] - paths->offsets[i];
+    // Each output path overwrites the '\0' terminator of the previous one.
+    statuses[i] = cpj_sanitizer_run(
+      sanitizer, &path, buffer + buffer_index, buffer_size - buffer_index,
+      &size
+    );
+    buffer_index += size;
+    offsets[i + 1] = buffer_index;
+  }
+  return buffer_index;
+} /* cpj_sanitizer_run_column */
+
+static bool cpj_path_builder_is_absolute(const cpj_path_builder_t *builder)
+{
+  return builder->root_size > 0 &&
+         cpj_path_is_separator(
+           builder->path_style, builder->buffer[builder->root_size - 1]
+         );
+} /* cpj_path_builder_is_absolute */
+
+/**
+ * Terminates the path behind its last segment. A path without segments is
+ * `.`, unless its root is absolute.
+ */
+static void cpj_path_builder_terminate(cpj_path_builder_t *builder)
+{
+  builder->size = builder->segment_count > 0
+                    ? builder->segment_ends[builder->segment_count - 1]
+                    : builder->root_size;
+  if (builder->segment_count == 0 && !cpj_path_builder_is_absolute(builder)) {
+    builder->buffer[builder->size++] = '.';
+  }
+  builder->buffer[builder->size] = '\0';
+} /* cpj_path_builder_terminate */
+
+static bool cpj_path_builder_append(
+  cpj_path_builder_t *builder, const cpj_char_t *name, cpj_size_t size
+)
+{
+  cpj_size_t start = builder->root_size;
+
+  if (builder->segment_count > 0) {
+    start = builder->segment_ends[builder->segment_count - 1] + 1;
+  }
+  if (builder->segment_count == builder->segment_capacity ||
+      start + size >= builder->buffer_size) {
+    return false;
+  }
+
+  if (builder->segment_count > 0) {
+    builder->buffer[start - 1] =
+      builder->path_style == CPJ_STYLE_UNIX ? '/' : '\\';
+  }
+  memcpy(builder->buffer + start, name, size);
+  builder->segment_ends[builder->segment_count++] = start + size;
+  cpj_path_builder_terminate(builder);
+  return true;
+} /* cpj_path_builder_append */
+
+bool cpj_path_builder_init(
+  cpj_path_builder_t *builder, cpj_path_style_t path_style,
+  const cpj_string_t *path, cpj_char_t *buffer, cpj_size_t buffer_size,
+  cpj_size_t *segment_ends, cpj_size_t segment_capacity
+)
+{
+  cpj_size_t size, start, i;
+
+  size = cpj_path_join_multiple(
+    path_style, false, true, path, 1, buffer, buffer_size
+  );
+  if (size >= buffer_size) {
+    return false;
+  }
+
+  builder->path_style = path_style;
+  builder->buffer = buffer;
+  builder->buffer_size = buffer_size;
+  builder->segment_ends = segment_ends;
+  builder->segment_capacity = segment_capacity;
+  builder->root_size = cpj_path_get_root_sized(path_style, buffer, size);
+  builder->segment_count = 0;
+  builder->parent_count = 0;
+  builder->size = size;
+
+  // The normalized path has single separators and no trailing one, so every
+  // separator behind the root ends a segment.
+  if (size == builder->root_size + 1 && buffer[builder->root_size] == '.') {
+    return true;
+  }
+  for (i = start = builder->root_size; i <= size; ++i) {
+    if (i < size && !cpj_path_is_separator(path_style, buffer[i])) {
+      continue;
+    } else if (i == start) {
+      break;
+    } else if (builder->segment_count == segment_capacity) {
+      return false;
+    }
+    if (builder->parent_count == builder->segment_count && i - start == 2 &&
+        buffer[start] == '.' && buffer[start + 1] == '.') {
+      ++builder->parent_count;
+    }
+    segment_ends[builder->segment_count++] = i;
+    start = i + 1;
+  }
+  return true;
+} /* cpj_path_builder_init */
+
+bool cpj_path_builder_push_segment(
+  cpj_path_builder_t *builder, const cpj_string_t *name
+)
+{
+  cpj_size_t i;
+
+  for (i = 0; i < name->size; ++i) {
+    if (cpj_path_is_separator(builder->path_style, name->ptr[i])) {
+      return false;
+    }
+  }
+
+  if (name->size == 0 || cpj_glob_is_dots(name, 1)) {
+    return true;
+  } else if (!cpj_glob_is_dots(name, 2)) {
+    return cpj_path_builder_append(builder, name->ptr, name->size);
+  } else if (builder->segment_count > builder->parent_count) {
+    --builder->segment_count;
+    cpj_path_builder_terminate(builder);
+    return true;
+  } else if (cpj_path_builder_is_absolute(builder)) {
+    return true;
+  } else if (!cpj_path_builder_append(builder, "..", 2)) {
+    return false;
+  }
+  ++builder->parent_count;
+  return true;
+} /* cpj_path_builder_push_segment */
+
+bool cpj_path_builder_pop_segment(cpj_path_builder_t *builder)
+{
+  if (builder->segment_count == 0) {
+    return false;
+  }
+  cpj_path_builder_truncate(builder, builder->segment_count - 1);
+  return true;
+} /* cpj_path_builder_pop_segment */
+
+bool cpj_path_builder_push_relative(
+  cpj_path_builder_t *builder, const cpj_string_t *path
+)
+{
+  cpj_glob_cursor_t cursor;
+  cpj_string_t segment;
+  cpj_size_t kept_count = 0, kept_size = 0, parent_count = 0;
+  cpj_size_t removed_count, count, size, index;
+  cpj_char_t separator = builder->path_style == CPJ_STYLE_UNIX ? '/' : '\\';
+
+  if (cpj_path_get_root_sized(builder->path_style, path->ptr, path->size) >
+      0) {
+    return false;
+  }
+
+  // Walking the relative path backwards tells which of its segments remain
+  // and how many segments of the path its leading `..` remove, before
+  // anything is written.
+  cursor.path = path->ptr;
+  cursor.root_size = 0;
+  cursor.end = path->size;
+  cursor.skip_count = 0;
+  while (cpj_glob_cursor_prev(builder->path_style, &cursor, &segment)) {
+    if (cpj_glob_is_dots(&segment, 2)) {
+      ++parent_count;
+    } else {
+      ++kept_count;
+      kept_size += segment.size;
+    }
+  }
+  if (kept_count == 0 && parent_count == 0) {
+    return true;
+  }
+
+  removed_count = builder->segment_count - builder->parent_count;
+  if (parent_count < removed_count) {
+    removed_count = parent_count;
+  }
+  parent_count -= removed_count;
+  if (cpj_path_builder_is_absolute(builder)) {
+    parent_count = 0;
+  }
+
+  count = builder->segment_count - removed_count;
+  size = count > 0 ? builder->segment_ends[count - 1] + 1 : builder->root_size;
+  size += parent_count * 3 + kept_size + kept_count;
+  if (count + parent_count + kept_count > builder->segment_capacity ||
+      size > builder->buffer_size) {
+    return false;
+  }
+
+  // The `..` which lead out of a relative path come first, the remaining
+  // segments are written backwards into their places behind them.
+  builder->segment_count = count;
+  cpj_path_builder_terminate(builder);
+  for (; parent_count > 0; --parent_count) {
+    cpj_path_builder_append(builder, "..", 2);
+    ++builder->parent_count;
+  }
+  if (kept_count == 0) {
+    return true;
+  }
+
+  index = builder->segment_count + kept_count;
+  size = (builder->segment_count > 0
+            ? builder->segment_ends[builder->segment_count - 1] + 1
+            : builder->root_size) +
+         kept_size + kept_count - 1;
+  builder->segment_count = index;
+  builder->size = size;
+  builder->buffer[size] = '\0';
+  cursor.end = path->size;
+  cursor.skip_count = 0;
+  while (index > builder->segment_count - kept_count) {
+    cpj_glob_cursor_prev(builder->path_style, &cursor, &segment);
+    builder->segment_ends[--index] = size;
+    size -= segment.size;
+    memcpy(builder->buffer + size, segment.ptr, segment.size);
+    if (index > 0) {
+      builder->buffer[--size] = separator;
+    }
+  }
+  return true;
+} /* cpj_path_builder_push_relative */
+
+void cpj_path_builder_truncate(
+  cpj_path_builder_t *builder, cpj_size_t segment_count
+)
+{
+  if (segment_count >= builder->segment_count) {
+    return;
+  }
+  builder->segment_count = segment_count;
+  if (builder->parent_count > segment_count) {
+    builder->parent_count = segment_count;
+  }
+  cpj_path_builder_terminate(builder);
+} /* cpj_path_builder_truncate */
+
+#ifdef __linux__
+#define CPJ_WALK_BUFFER_SIZE 8192
+#define CPJ_WALK_PATH_AVERAGE 64
+#define CPJ_WALK_ALIGNMENT _Alignof(max_align_t)
+
+// Every directory adds a separator and a name to the path, so no more of them
+// fit into PATH_MAX.
+#define CPJ_WALK_SUSPENDED_MAX (PATH_MAX / 2 + 1)
+
+/**
+ * An entry as returned by getdents64, which older versions of glibc do not
+ * declare.
+ */
+typedef struct
+{
+  uint64_t inode;
+  int64_t offset;
+  unsigned short record_size;
+  unsigned char type;
+  cpj_char_t name[];
+} cpj_walk_dirent_t;
+
+/**
+ * A directory which is being read, with the entries of the last getdents64
+ * call in its buffer.
+ */
+typedef struct
+{
+  int fd;
+  bool is_truncated; /**< whether ENAMETOOLONG has been passed */
+  cpj_size_t depth;
+  cpj_size_t name_size;
+  cpj_size_t path_size;
+  int64_t offset; /**< of the entry after the last one visited */
+  cpj_size_t position;
+  cpj_size_t size;
+  cpj_char_t buffer[CPJ_WALK_BUFFER_SIZE];
+} cpj_walk_level_t;
+
+/**
+ * A directory which has been closed to make room for a deeper one, like nftw
+ * does. It is reopened by its path, which is a prefix of the current path,
+ * and read on from its offset once the deeper directories are done.
+ */
+typedef struct
+{
+  bool is_truncated;
+  cpj_size_t depth;
+  cpj_size_t name_size;
+  cpj_size_t path_size;
+  int64_t offset;
+} cpj_walk_suspended_t;
+
+/**
+ * A directory which has been handed out. It is opened relative to the root by
+ * whichever worker takes it.
+ */
+typedef struct
+{
+  cpj_size_t depth;
+  cpj_size_t name_size;
+  cpj_size_t path_size;
+  cpj_char_t path[PATH_MAX];
+} cpj_walk_task_t;
+
+typedef struct cpj_walk_state cpj_walk_state_t;
+
+/**
+ * The part of the storage which belongs to a single thread. The levels are a
+ * ring, whose oldest directory is suspended once it is full. The tasks are a
+ * ring as well, which the worker takes from at the back and others at the
+ * front.
+ */
+typedef struct
+{
+  cpj_walk_state_t *state;
+  cpj_walk_level_t *levels;
+  cpj_size_t level_first;
+  cpj_size_t level_count;
+  cpj_walk_suspended_t *suspended;
+  cpj_size_t suspended_count;
+  cpj_walk_task_t *tasks;
+  cpj_size_t task_first;
+  cpj_size_t task_count;
+  cpj_walk_entry_t *entries;
+  cpj_size_t entry_count;
+  cpj_char_t *batch;
+  cpj_size_t batch_size;
+  bool is_stopped;
+#ifdef CPJ_THREADS
+  pthread_t thread;
+  bool has_thread;
+#endif
+  cpj_size_t path_size;
+  cpj_char_t path[PATH_MAX];
+} cpj_walk_worker_t;
+
+struct cpj_walk_state
+{
+  cpj_walk_t options;
+  cpj_walk_worker_t *workers;
+  cpj_size_t worker_count;
+  int root_fd;
+  cpj_size_t root_size; /**< of the root and its separator in every path */
+  cpj_size_t pending;   /**< tasks which have been handed out and not done */
+  cpj_size_t idle_count;
+  bool is_stopped;
+#ifdef CPJ_THREADS
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+#endif
+};
+
+static cpj_walk_t cpj_walk_get_options(const cpj_walk_t *walk)
+{
+  cpj_walk_t options = *walk;
+
+  if (options.thread_count == 0) {
+    options.thread_count = 1;
+  }
+  if (options.level_count == 0) {
+    options.level_count = 16;
+  }
+  if (options.task_count == 0) {
+    options.task_count = 16;
+  }
+  if (options.batch_size == 0) {
+    options.batch_size = 256;
+  }
+  return options;
+} /* cpj_walk_get_options */
+
+static cpj_size_t cpj_walk_align(cpj_size_t size)
+{
+  return (size + CPJ_WALK_ALIGNMENT - 1) / CPJ_WALK_ALIGNMENT *
+         CPJ_WALK_ALIGNMENT;
+} /* cpj_walk_align */
+
+static cpj_size_t cpj_walk_get_batch_capacity(const cpj_walk_t *options)
+{
+  // Any single path fits into an empty batch.
+  return options->batch_size * CPJ_WALK_PATH_AVERAGE + PATH_MAX;
+} /* cpj_walk_get_batch_capacity */
+
+static cpj_size_t cpj_walk_get_worker_size(const cpj_walk_t *options)
+{
+  return cpj_walk_align(sizeof(cpj_walk_worker_t)) +
+         cpj_walk_align(options->level_count * sizeof(cpj_walk_level_t)) +
+         cpj_walk_align(CPJ_WALK_SUSPENDED_MAX * sizeof(cpj_walk_suspended_t)) +
+         cpj_walk_align(options->task_count * sizeof(cpj_walk_task_t)) +
+         cpj_walk_align(options->batch_size * sizeof(cpj_walk_entry_t)) +
+         cpj_walk_align(cpj_walk_get_batch_capacity(options));
+} /* cpj_walk_get_worker_size */
+
+static void *cpj_walk_carve(cpj_char_t **next, cpj_size_t size)
+{
+  void *result = *next;
+
+  *next += cpj_walk_align(size);
+  return result;
+} /* cpj_walk_carve */
+
+static void cpj_walk_lock(cpj_walk_state_t *state)
+{
+#ifdef CPJ_THREADS
+  pthread_mutex_lock(&state->mutex);
+#else
+  (void)state;
+#endif
+} /* cpj_walk_lock */
+
+static void cpj_walk_unlock(cpj_walk_state_t *state)
+{
+#ifdef CPJ_THREADS
+  pthread_mutex_unlock(&state->mutex);
+#else
+  (void)state;
+#endif
+} /* cpj_walk_unlock */
+
+static void cpj_walk_wake(cpj_walk_state_t *state, bool is_everyone)
+{
+#ifdef CPJ_THREADS
+  if (is_everyone) {
+    pthread_cond_broadcast(&state->condition);
+  } else {
+    pthread_cond_signal(&state->condition);
+  }
+#else
+  (void)state;
+  (void)is_everyone;
+#endif
+} /* cpj_walk_wake */
+
+static void cpj_walk_flush(cpj_walk_worker_t *worker)
+{
+  cpj_walk_state_t *state = worker->state;
+  bool is_stopped;
+
+  cpj_walk_lock(state);
+  is_stopped = state->is_stopped;
+  cpj_walk_unlock(state);
+
+  if (!is_stopped && worker->entry_count > 0 &&
+      !state->options.callback(
+        state->options.context, worker->entries, worker->entry_count
+      )) {
+    is_stopped = true;
+    cpj_walk_lock(state);
+    state->is_stopped = true;
+    cpj_walk_wake(state, true);
+    cpj_walk_unlock(state);
+  }
+  worker->is_stopped = is_stopped;
+  worker->entry_count = 0;
+  worker->batch_size = 0;
+} /* cpj_walk_flush */
+
+/**
+ * Adds the current path to the batch, which is passed to the callback first
+ * if the path does not fit.
+ */
+static void cpj_walk_emit(
+  cpj_walk_worker_t *worker, cpj_walk_type_t type, cpj_size_t name_size,
+  cpj_size_t depth, int error
+)
+{
+  const cpj_walk_t *options = &worker->state->options;
+  cpj_walk_entry_t *entry;
+  cpj_char_t *path;
+
+  if (worker->entry_count == options->batch_size ||
+      worker->batch_size + worker->path_size >=
+        cpj_walk_get_batch_capacity(options)) {
+    cpj_walk_flush(worker);
+  }
+
+  path = worker->batch + worker->batch_size;
+  memcpy(path, worker->path, worker->path_size + 1);
+  worker->batch_size += worker->path_size + 1;
+  entry = worker->entries + worker->entry_count++;
+  entry->path.ptr = path;
+  entry->path.size = worker->path_size;
+  entry->name.ptr = path + worker->path_size - name_size;
+  entry->name.size = name_size;
+  entry->depth = depth;
+  entry->type = type;
+  entry->error = error;
+} /* cpj_walk_emit */
+
+/**
+ * Appends a name to the current path. Every path starts with the normalized
+ * root and a separator, so only the names are appended from there on.
+ */
+static bool cpj_walk_push_name(
+  cpj_walk_worker_t *worker, const cpj_char_t *name, cpj_size_t name_size
+)
+{
+  cpj_size_t size = worker->path_size;
+  bool has_separator = size > worker->state->root_size;
+
+  if (size + has_separator + name_size >= PATH_MAX) {
+    return false;
+  }
+  if (has_separator) {
+    worker->path[size++] = '/';
+  }
+  memcpy(worker->path + size, name, name_size);
+  size += name_size;
+  worker->path[size] = '\0';
+  worker->path_size = size;
+  return true;
+} /* cpj_walk_push_name */
+
+/**
+ * Hands out the current path as a task for other threads, but only if one of
+ * them is idle, or if it is forced like for the root.
+ */
+static bool cpj_walk_hand_out(
+  cpj_walk_worker_t *worker, cpj_size_t depth, cpj_size_t name_size,
+  bool is_forced
+)
+{
+  cpj_walk_state_t *state = worker->state;
+  cpj_size_t capacity = state->options.task_count;
+  cpj_walk_task_t *task;
+  bool is_handed_out = false;
+
+  cpj_walk_lock(state);
+  if ((is_forced || state->idle_count > 0) &&
+      worker->task_count < capacity) {
+    task = worker->tasks + (worker->task_first + worker->task_count) % capacity;
+    task->depth = depth;
+    task->name_size = name_size;
+    task->path_size = worker->path_size;
+    memcpy(task->path, worker->path, worker->path_size + 1);
+    ++worker->task_count;
+    ++state->pending;
+    cpj_walk_wake(state, false);
+    is_handed_out = true;
+  }
+  cpj_walk_unlock(state);
+  return is_handed_out;
+} /* cpj_walk_hand_out */
+
+/**
+ * Takes the newest task of the worker itself, or the oldest one of another
+ * worker, which is the one closest to the root. Waits for a task as long as
+ * some are still being worked on.
+ */
+static bool cpj_walk_take(
+  cpj_walk_worker_t *worker, cpj_size_t *depth, cpj_size_t *name_size
+)
+{
+  cpj_walk_state_t *state = worker->state;
+  cpj_size_t capacity = state->options.task_count;
+  cpj_size_t index = (cpj_size_t)(worker - state->workers), i;
+  cpj_walk_worker_t *other;
+  cpj_walk_task_t *task = NULL;
+
+  cpj_walk_lock(state);
+  while (!state->is_stopped && state->pending > 0) {
+    if (worker->task_count > 0) {
+      --worker->task_count;
+      task = worker->tasks +
+             (worker->task_first + worker->task_count) % capacity;
+      break;
+    }
+    for (i = 1; i < state->worker_count && !task; ++i) {
+      other = state->workers + (index + i) % state->worker_count;
+      if (other->task_count > 0) {
+        task = other->tasks + other->task_first;
+        other->task_first = (other->task_first + 1) % capacity;
+        --other->task_count;
+      }
+    }
+    if (task) {
+      break;
+    } else if (worker->entry_count > 0) {
+      // The entries found so far are passed on before waiting.
+      cpj_walk_unlock(state);
+      cpj_walk_flush(worker);
+      cpj_walk_lock(state);
+      continue;
+    }
+#ifdef CPJ_THREADS
+    ++state->idle_count;
+    pthread_cond_wait(&state->condition, &state->mutex);
+    --state->idle_count;
+#else
+    break;
+#endif
+  }
+
+  if (task) {
+    *depth = task->depth;
+    *name_size = task->name_size;
+    worker->path_size = task->path_size;
+    memcpy(worker->path, task->path, task->path_size + 1);
+  }
+  cpj_walk_unlock(state);
+  return task != NULL;
+} /* cpj_walk_take */
+
+static void cpj_walk_done(cpj_walk_state_t *state)
+{
+  cpj_walk_lock(state);
+  if (--state->pending == 0) {
+    cpj_walk_wake(state, true);
+  }
+  cpj_walk_unlock(state);
+} /* cpj_walk_done */
+
+/**
+ * Closes the oldest directory on the stack of levels, which is the one closest
+ * to the root, to make room for another one.
+ */
+static void cpj_walk_suspend(cpj_walk_worker_t *worker)
+{
+  cpj_walk_level_t *level = worker->levels + worker->level_first;
+  cpj_walk_suspended_t *suspended =
+    worker->suspended + worker->suspended_count++;
+
+  suspended->is_truncated = level->is_truncated;
+  suspended->depth = level->depth;
+  suspended->name_size = level->name_size;
+  suspended->path_size = level->path_size;
+  suspended->offset = level->offset;
+  close(level->fd);
+  worker->level_first =
+    (worker->level_first + 1) % worker->state->options.level_count;
+  --worker->level_count;
+} /* cpj_walk_suspend */
+
+/**
+ * Pushes an opened directory onto the stack of levels, suspending the oldest
+ * one if the stack is full.
+ */
+static cpj_walk_level_t *cpj_walk_push_level(
+  cpj_walk_worker_t *worker, int fd, cpj_size_t name_size, cpj_size_t depth
+)
+{
+  cpj_size_t capacity = worker->state->options.level_count;
+  cpj_walk_level_t *level;
+
+  if (worker->level_count == capacity) {
+    cpj_walk_suspend(worker);
+  }
+  level =
+    worker->levels + (worker->level_first + worker->level_count++) % capacity;
+  level->fd = fd;
+  level->is_truncated = false;
+  level->depth = depth;
+  level->name_size = name_size;
+  level->path_size = worker->path_size;
+  level->offset = 0;
+  level->position = 0;
+  level->size = 0;
+  return level;
+} /* cpj_walk_push_level */
+
+/**
+ * Opens the directory of the current path and passes it on, unless it is the
+ * root. The directory is read next, before the rest of its parent.
+ */
+static void cpj_walk_open(
+  cpj_walk_worker_t *worker, int parent_fd, const cpj_char_t *name,
+  cpj_size_t name_size, cpj_size_t depth
+)
+{
+  int fd, error = 0;
+
+  fd = openat(
+    parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC
+  );
+  if (fd < 0) {
+    error = errno;
+  }
+  if (depth > 0) {
+    cpj_walk_emit(worker, CPJ_WALK_DIRECTORY, name_size, depth, error);
+  }
+  if (error == 0) {
+    cpj_walk_push_level(worker, fd, name_size, depth);
+  }
+} /* cpj_walk_open */
+
+/**
+ * Reopens the newest suspended directory by its path, and continues reading
+ * it where it stopped. A directory which can not be reopened is passed again
+ * with the errno of the failure.
+ */
+static void cpj_walk_resume(cpj_walk_worker_t *worker)
+{
+  cpj_walk_state_t *state = worker->state;
+  cpj_walk_suspended_t *suspended =
+    worker->suspended + --worker->suspended_count;
+  cpj_walk_level_t *level;
+  int fd;
+
+  worker->path_size = suspended->path_size;
+  worker->path[worker->path_size] = '\0';
+  fd = openat(
+    state->root_fd,
+    worker->path_size > state->root_size ? worker->path + state->root_size
+                                         : ".",
+    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC
+  );
+  if (fd >= 0 && lseek(fd, (off_t)suspended->offset, SEEK_SET) < 0) {
+    close(fd);
+    fd = -1;
+  }
+  if (fd < 0) {
+    if (suspended->depth > 0) {
+      cpj_walk_emit(
+        worker, CPJ_WALK_DIRECTORY, suspended->name_size, suspended->depth,
+        errno
+      );
+    }
+    return;
+  }
+
+  level = cpj_walk_push_level(
+    worker, fd, suspended->name_size, suspended->depth
+  );
+  level->is_truncated = suspended->is_truncated;
+  level->offset = suspended->offset;
+} /* cpj_walk_resume */
+
+static cpj_walk_type_t cpj_walk_get_type(
+  const cpj_walk_level_t *level, const cpj_walk_dirent_t *dirent
+)
+{
+  struct stat status;
+
+  switch (dirent->type) {
+  case DT_REG:
+    return CPJ_WALK_FILE;
+  case DT_DIR:
+    return CPJ_WALK_DIRECTORY;
+  case DT_LNK:
+    return CPJ_WALK_SYMLINK;
+  case DT_UNKNOWN:
+    break;
+  default:
+    return CPJ_WALK_OTHER;
+  }
+
+  // Some file systems do not store the type along with the name.
+  if (fstatat(level->fd, dirent->name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+    return CPJ_WALK_OTHER;
+  } else if (S_ISREG(status.st_mode)) {
+    return CPJ_WALK_FILE;
+  } else if (S_ISDIR(status.st_mode)) {
+    return CPJ_WALK_DIRECTORY;
+  } else if (S_ISLNK(status.st_mode)) {
+    return CPJ_WALK_SYMLINK;
+  }
+  return CPJ_WALK_OTHER;
+} /* cpj_walk_get_type */
+
+/**
+ * Matches the current path against the pattern set. Its parents have all been
+ * matched on the way down, since an ignored directory is not read at all.
+ */
+static bool cpj_walk_is_ignored(
+  const cpj_walk_worker_t *worker, cpj_size_t name_size, cpj_size_t depth,
+  cpj_walk_type_t type
+)
+{
+  const cpj_patternset_t *set = worker->state->options.patterns;
+  cpj_pattern_subject_t subject;
+  cpj_size_t found;
+
+  if (set->rule_count == 0) {
+    return false;
+  }
+
+  subject.cursor.path = worker->path + worker->state->root_size;
+  subject.cursor.root_size = 0;
+  subject.cursor.end = worker->path_size - worker->state->root_size;
+  subject.cursor.skip_count = 0;
+  subject.basename.ptr = worker->path + worker->path_size - name_size;
+  subject.basename.size = name_size;
+  subject.depth = depth;
+  subject.is_directory = type == CPJ_WALK_DIRECTORY;
+  found = cpj_patternset_find(set, &subject);
+  return found > 0 && !(set->rules[found - 1].flags & CPJ_PATTERN_NEGATED);
+} /* cpj_walk_is_ignored */
+
+static void cpj_walk_visit(
+  cpj_walk_worker_t *worker, cpj_walk_level_t *level,
+  const cpj_walk_dirent_t *dirent
+)
+{
+  const cpj_walk_t *options = &worker->state->options;
+  cpj_size_t name_size = strlen(dirent->name), depth = level->depth + 1;
+  cpj_walk_type_t type;
+
+  worker->path_size = level->path_size;
+  if (!cpj_walk_push_name(worker, dirent->name, name_size)) {
+    worker->path[worker->path_size] = '\0';
+    if (!level->is_truncated) {
+      level->is_truncated = true;
+      cpj_walk_emit(
+        worker, CPJ_WALK_DIRECTORY, level->name_size, level->depth,
+        ENAMETOOLONG
+      );
+    }
+    return;
+  }
+
+  type = cpj_walk_get_type(level, dirent);
+  if (options->patterns &&
+      cpj_walk_is_ignored(worker, name_size, depth, type)) {
+    return;
+  } else if (type != CPJ_WALK_DIRECTORY) {
+    cpj_walk_emit(worker, type, name_size, depth, 0);
+    return;
+  }
+
+  // A directory is read right away, unless another thread is waiting for
+  // work.
+  if (!cpj_walk_hand_out(worker, depth, name_size, false)) {
+    cpj_walk_open(worker, level->fd, dirent->name, name_size, depth);
+  }
+} /* cpj_walk_visit */
+
+/**
+ * Reads the directories on the stack of levels until all of them are done,
+ * visiting the entries of the deepest one first. Suspended directories are
+ * resumed once the ones above them are done.
+ */
+static void cpj_walk_read(cpj_walk_worker_t *worker)
+{
+  cpj_size_t capacity = worker->state->options.level_count;
+  const cpj_walk_dirent_t *dirent;
+  cpj_walk_level_t *level;
+  long size;
+
+  for (;;) {
+    if (worker->level_count == 0 && worker->suspended_count > 0 &&
+        !worker->is_stopped) {
+      cpj_walk_resume(worker);
+      continue;
+    } else if (worker->level_count == 0) {
+      worker->suspended_count = 0;
+      break;
+    }
+    level = worker->levels +
+            (worker->level_first + worker->level_count - 1) % capacity;
+    if (level->position == level->size) {
+      size = worker->is_stopped ? 0
+                                : syscall(
+                                    SYS_getdents64, level->fd, level->buffer,
+                                    sizeof(level->buffer)
+                                  );
+      if (size < 0 && level->depth > 0) {
+        worker->path_size = level->path_size;
+        worker->path[worker->path_size] = '\0';
+        cpj_walk_emit(
+          worker, CPJ_WALK_DIRECTORY, level->name_size, level->depth, errno
+        );
+      }
+      if (size <= 0) {
+        close(level->fd);
+        --worker->level_count;
+        continue;
+      }
+      level->position = 0;
+      level->size = (cpj_size_t)size;
+    }
+
+    dirent = (const cpj_walk_dirent_t *)(level->buffer + level->position);
+    level->position += dirent->record_size;
+    level->offset = dirent->offset;
+    if (dirent->name[0] == '.' &&
+        (dirent->name[1] == '\0' ||
+         (dirent->name[1] == '.' && dirent->name[2] == '\0'))) {
+      continue;
+    }
+    cpj_walk_visit(worker, level, dirent);
+  }
+} /* cpj_walk_read */
+
+static void cpj_walk_work(cpj_walk_worker_t *worker)
+{
+  cpj_walk_state_t *state = worker->state;
+  cpj_size_t depth, name_size;
+
+  while (cpj_walk_take(worker, &depth, &name_size)) {
+    cpj_walk_open(
+      worker, state->root_fd,
+      worker->path_size > state->root_size ? worker->path + state->root_size
+                                           : ".",
+      name_size, depth
+    );
+    cpj_walk_read(worker);
+    cpj_walk_done(state);
+  }
+  cpj_walk_flush(worker);
+} /* cpj_walk_work */
+
+#ifdef CPJ_THREADS
+static void *cpj_walk_thread(void *worker)
+{
+  cpj_walk_work(worker);
+  return NULL;
+} /* cpj_walk_thread */
+#endif
+
+cpj_size_t cpj_walk_storage_size(const cpj_walk_t *walk)
+{
+  cpj_walk_t options = cpj_walk_get_options(walk);
+
+  return options.thread_count * cpj_walk_get_worker_size(&options);
+} /* cpj_walk_storage_size */
+
+bool cpj_walk(const cpj_walk_t *walk, const cpj_char_t *root, void *storage)
+{
+  cpj_walk_state_t state;
+  cpj_walk_worker_t *worker;
+  cpj_char_t *next = storage;
+  cpj_string_t string;
+  cpj_size_t i, size;
+
+  state.options = cpj_walk_get_options(walk);
+  state.worker_count = 1;
+#ifdef CPJ_THREADS
+  if (state.options.flags & CPJ_WALK_PARALLEL) {
+    state.worker_count = state.options.thread_count;
+  }
+#endif
+  state.pending = 0;
+  state.idle_count = 0;
+  state.is_stopped = false;
+  state.workers =
+    cpj_walk_carve(&next, state.worker_count * sizeof(*state.workers));
+  for (i = 0; i < state.worker_count; ++i) {
+    worker = state.workers + i;
+    worker->state = &state;
+    worker->levels = cpj_walk_carve(
+      &next, state.options.level_count * sizeof(*worker->levels)
+    );
+    worker->level_first = 0;
+    worker->level_count = 0;
+    worker->suspended = cpj_walk_carve(
+      &next, CPJ_WALK_SUSPENDED_MAX * sizeof(*worker->suspended)
+    );
+    worker->suspended_count = 0;
+    worker->tasks = cpj_walk_carve(
+      &next, state.options.task_count * sizeof(*worker->tasks)
+    );
+    worker->task_first = 0;
+    worker->task_count = 0;
+    worker->entries = cpj_walk_carve(
+      &next, state.options.batch_size * sizeof(*worker->entries)
+    );
+    worker->entry_count = 0;
+    worker->batch = cpj_walk_carve(
+      &next, cpj_walk_get_batch_capacity(&state.options)
+    );
+    worker->batch_size = 0;
+    worker->is_stopped = false;
+  }
+
+  // The paths of all entries start with the normalized root, which is left
+  // out entirely if it is the current directory.
+  worker = state.workers;
+  string.ptr = root;
+  string.size = strlen(root);
+  size = cpj_path_join_multiple(
+    CPJ_STYLE_UNIX, false, true, &string, 1, worker->path, PATH_MAX
+  );
+  if (size + 1 >= PATH_MAX) {
+    errno = ENAMETOOLONG;
+    return false;
+  } else if (size == 1 && worker->path[0] == '.') {
+    size = 0;
+  } else if (worker->path[size - 1] != '/') {
+    worker->path[size++] = '/';
+  }
+  worker->path[size] = '\0';
+  worker->path_size = size;
+  state.root_size = size;
+
+  state.root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (state.root_fd < 0) {
+    return false;
+  }
+
+#ifdef CPJ_THREADS
+  pthread_mutex_init(&state.mutex, NULL);
+  pthread_cond_init(&state.condition, NULL);
+#endif
+  cpj_walk_hand_out(worker, 0, 0, true);
+#ifdef CPJ_THREADS
+  for (i = 1; i < state.worker_count; ++i) {
+    worker = state.workers + i;
+    worker->has_thread =
+      pthread_create(&worker->thread, NULL, cpj_walk_thread, worker) == 0;
+  }
+#endif
+
+  cpj_walk_work(state.workers);
+#ifdef CPJ_THREADS
+  for (i = 1; i < state.worker_count; ++i) {
+    if (state.workers[i].has_thread) {
+      pthread_join(state.workers[i].thread, NULL);
+    }
+  }
+  pthread_cond_destroy(&state.condition);
+  pthread_mutex_destroy(&state.mutex);
+#endif
+  close(state.root_fd);
+  return true;
+} /* cpj_walk */
+#else
+cpj_size_t cpj_walk_storage_size(const cpj_walk_t *walk)
+{
+  (void)walk;
+  return 0;
+} /* cpj_walk_storage_size */
+
+bool cpj_walk(const cpj_walk_t *walk, const cpj_char_t *root, void *storage)
+{
+  (void)walk;
+  (void)root;
+  (void)storage;
+  errno = ENOSYS;
+  return false;
+} /* cpj_walk */
+#endif
+
+#ifndef _WIN32
+#define CPJ_FS_SLOT_SIZE 7
+#define CPJ_FS_SEGMENT_MAX 256
+#define CPJ_FS_LINK_MAX 40
+
+/**
+ * The fields of a slot of the cache. The prefix is stored at the offset, and
+ * the target of a link right behind it.
+ */
+enum
+{
+  CPJ_FS_SLOT_GENERATION,
+  CPJ_FS_SLOT_HASH,
+  CPJ_FS_SLOT_OFFSET,
+  CPJ_FS_SLOT_SIZE_KEY,
+  CPJ_FS_SLOT_SIZE_TARGET,
+  CPJ_FS_SLOT_KIND,
+  CPJ_FS_SLOT_ERROR
+};
+
+typedef enum
+{
+  CPJ_FS_DIRECTORY,
+  CPJ_FS_OTHER,
+  CPJ_FS_LINK,
+  CPJ_FS_MISSING
+} cpj_fs_kind_t;
+
+/**
+ * What is known about a prefix, either from the cache or from probing it.
+ */
+typedef struct
+{
+  cpj_fs_kind_t kind;
+  int error;
+  cpj_size_t target_size;
+  cpj_char_t target[PATH_MAX];
+} cpj_fs_probe_t;
+
+static cpj_size_t cpj_fs_hash(
+  cpj_size_t hash, const cpj_char_t *name, cpj_size_t size
+)
+{
+  cpj_size_t i;
+
+  // The hash of a prefix continues with the hash of its parent, so every
+  // segment is only hashed once.
+  hash = (hash ^ (unsigned char)'/') * 0x100000001b3ULL;
+  for (i = 0; i < size; ++i) {
+    hash = (hash ^ (unsigned char)name[i]) * 0x100000001b3ULL;
+  }
+  return hash;
+} /* cpj_fs_hash */
+
+static cpj_size_t cpj_fs_cache_slot_count(cpj_size_t entry_count)
+{
+  cpj_size_t slot_count = 8;
+
+  while (slot_count < entry_count * 2) {
+    slot_count *= 2;
+  }
+  return slot_count;
+} /* cpj_fs_cache_slot_count */
+
+static cpj_size_t cpj_fs_cache_lock_size(void)
+{
+#ifdef CPJ_THREADS
+  return (sizeof(pthread_mutex_t) + sizeof(cpj_size_t) - 1) /
+         sizeof(cpj_size_t) * sizeof(cpj_size_t);
+#else
+  return 0;
+#endif
+} /* cpj_fs_cache_lock_size */
+
+static void cpj_fs_cache_lock(cpj_fs_cache_t *cache)
+{
+#ifdef CPJ_THREADS
+  pthread_mutex_lock(cache->lock);
+#else
+  (void)cache;
+#endif
+} /* cpj_fs_cache_lock */
+
+static void cpj_fs_cache_unlock(cpj_fs_cache_t *cache)
+{
+#ifdef CPJ_THREADS
+  pthread_mutex_unlock(cache->lock);
+#else
+  (void)cache;
+#endif
+} /* cpj_fs_cache_unlock */
+
+/**
+ * Finds the slot of a prefix, or the empty slot it would be stored in. Slots
+ * of an older generation are empty.
+ */
+static cpj_size_t *cpj_fs_cache_find(
+  const cpj_fs_cache_t *cache, const cpj_char_t *key, cpj_size_t size,
+  cpj_size_t hash
+)
+{
+  cpj_size_t index = hash & (cache->slot_count - 1), *slot;
+
+  for (;; index = (index + 1) & (cache->slot_count - 1)) {
+    slot = cache->slots + index * CPJ_FS_SLOT_SIZE;
+    if (slot[CPJ_FS_SLOT_GENERATION] != cache->generation ||
+        (slot[CPJ_FS_SLOT_HASH] == hash &&
+         slot[CPJ_FS_SLOT_SIZE_KEY] == size &&
+         memcmp(cache->data + slot[CPJ_FS_SLOT_OFFSET], key, size) == 0)) {
+      return slot;
+    }
+  }
+} /* cpj_fs_cache_find */
+
+static bool cpj_fs_cache_get(
+  cpj_fs_cache_t *cache, const cpj_char_t *key, cpj_size_t size,
+  cpj_size_t hash, cpj_fs_probe_t *probe
+)
+{
+  const cpj_size_t *slot;
+  bool is_found;
+
+  cpj_fs_cache_lock(cache);
+  slot = cpj_fs_cache_find(cache, key, size, hash);
+  is_found = slot[CPJ_FS_SLOT_GENERATION] == cache->generation;
+  if (is_found) {
+    probe->kind = (cpj_fs_kind_t)slot[CPJ_FS_SLOT_KIND];
+    probe->error = (int)slot[CPJ_FS_SLOT_ERROR];
+    probe->target_size = slot[CPJ_FS_SLOT_SIZE_TARGET];
+    memcpy(
+      probe->target, cache->data + slot[CPJ_FS_SLOT_OFFSET] + size,
+      probe->target_size
+    );
+    probe->target[probe->target_size] = '\0';
+  }
+  cpj_fs_cache_unlock(cache);
+  return is_found;
+} /* cpj_fs_cache_get */
+
+static void cpj_fs_cache_start_generation(cpj_fs_cache_t *cache)
+{
+  ++cache->generation;
+  cache->entry_count = 0;
+  cache->data_size = 0;
+} /* cpj_fs_cache_start_generation */
+
+static void cpj_fs_cache_put(
+  cpj_fs_cache_t *cache, const cpj_char_t *key, cpj_size_t size,
+  cpj_size_t hash, const cpj_fs_probe_t *probe
+)
+{
+  cpj_size_t *slot;
+
+  cpj_fs_cache_lock(cache);
+  ++cache->probe_count;
+  if ((cache->entry_count + 1) * 2 > cache->slot_count ||
+      cache->data_size + size + probe->target_size > cache->data_capacity) {
+    cpj_fs_cache_start_generation(cache);
+  }
+
+  // Another thread might have probed the same prefix in the meantime, and an
+  // entry which does not even fit into an empty cache is not stored at all.
+  slot = cpj_fs_cache_find(cache, key, size, hash);
+  if (slot[CPJ_FS_SLOT_GENERATION] != cache->generation &&
+      size + probe->target_size <= cache->data_capacity) {
+    slot[CPJ_FS_SLOT_GENERATION] = cache->generation;
+    slot[CPJ_FS_SLOT_HASH] = hash;
+    slot[CPJ_FS_SLOT_OFFSET] = cache->data_size;
+    slot[CPJ_FS_SLOT_SIZE_KEY] = size;
+    slot[CPJ_FS_SLOT_SIZE_TARGET] = probe->target_size;
+    slot[CPJ_FS_SLOT_KIND] = probe->kind;
+    slot[CPJ_FS_SLOT_ERROR] = (cpj_size_t)probe->error;
+    memcpy(cache->data + cache->data_size, key, size);
+    memcpy(cache->data + cache->data_size + size, probe->target,
+      probe->target_size);
+    cache->data_size += size + probe->target_size;
+    ++cache->entry_count;
+  }
+  cpj_fs_cache_unlock(cache);
+} /* cpj_fs_cache_put */
+
+static void cpj_fs_probe(const cpj_char_t *path, cpj_fs_probe_t *probe)
+{
+  struct stat status;
+  ssize_t size;
+
+  probe->kind = CPJ_FS_MISSING;
+  probe->error = 0;
+  probe->target_size = 0;
+  if (lstat(path, &status) != 0) {
+    probe->error = errno;
+  } else if (S_ISDIR(status.st_mode)) {
+    probe->kind = CPJ_FS_DIRECTORY;
+  } else if (!S_ISLNK(status.st_mode)) {
+    probe->kind = CPJ_FS_OTHER;
+  } else if ((size = readlink(path, probe->target, PATH_MAX)) < 0) {
+    probe->error = errno;
+  } else if (size == 0 || size >= PATH_MAX) {
+    probe->error = size == 0 ? ENOENT : ENAMETOOLONG;
+  } else {
+    probe->kind = CPJ_FS_LINK;
+    probe->target_size = (cpj_size_t)size;
+  }
+  probe->target[probe->target_size] = '\0';
+} /* cpj_fs_probe */
+
+cpj_size_t
+cpj_fs_cache_storage_size(cpj_size_t entry_count, cpj_size_t data_size)
+{
+  return cpj_fs_cache_lock_size() +
+         cpj_fs_cache_slot_count(entry_count) * CPJ_FS_SLOT_SIZE *
+           sizeof(cpj_size_t) +
+         data_size;
+} /* cpj_fs_cache_storage_size */
+
+void cpj_fs_cache_init(
+  cpj_fs_cache_t *cache, void *storage, cpj_size_t entry_count,
+  cpj_size_t data_size
+)
+{
+  cpj_char_t *next = storage;
+
+  cache->lock = next;
+#ifdef CPJ_THREADS
+  pthread_mutex_init(cache->lock, NULL);
+#endif
+  next += cpj_fs_cache_lock_size();
+  cache->slots = (cpj_size_t *)next;
+  cache->slot_count = cpj_fs_cache_slot_count(entry_count);
+  memset(
+    cache->slots, 0,
+    cache->slot_count * CPJ_FS_SLOT_SIZE * sizeof(*cache->slots)
+  );
+  cache->data = next + cache->slot_count * CPJ_FS_SLOT_SIZE *
+                         sizeof(*cache->slots);
+  cache->data_capacity = data_size;
+  cache->data_size = 0;
+  cache->entry_count = 0;
+  cache->generation = 1;
+  cache->probe_count = 0;
+} /* cpj_fs_cache_init */
+
+void cpj_fs_cache_invalidate(cpj_fs_cache_t *cache)
+{
+  cpj_fs_cache_lock(cache);
+  cpj_fs_cache_start_generation(cache);
+  cpj_fs_cache_unlock(cache);
+} /* cpj_fs_cache_invalidate */
+
+/**
+ * Replaces the resolved part of the pending path by the target of a link.
+ */
+static bool cpj_fs_expand(
+  cpj_char_t *pending, const cpj_fs_probe_t *probe, const cpj_char_t *rest,
+  cpj_size_t rest_size
+)
+{
+  if (probe->target_size + rest_size >= PATH_MAX) {
+    return false;
+  }
+  memmove(pending + probe->target_size, rest, rest_size);
+  memcpy(pending, probe->target, probe->target_size);
+  pending[probe->target_size + rest_size] = '\0';
+  return true;
+} /* cpj_fs_expand */
+
+cpj_size_t cpj_fs_resolve(
+  cpj_fs_cache_t *cache, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+)
+{
+  static const cpj_string_t root = {"/", 1};
+  cpj_size_t ends[CPJ_FS_SEGMENT_MAX], hashes[CPJ_FS_SEGMENT_MAX + 1];
+  cpj_char_t pending[PATH_MAX], resolved[PATH_MAX];
+  cpj_size_t position = 0, size = 0, link_count = 0;
+  cpj_path_builder_t builder;
+  cpj_string_t rest, name;
+  cpj_fs_probe_t probe;
+
+  if (path->size == 0) {
+    errno = ENOENT;
+    return 0;
+  } else if (path->ptr[0] != '/') {
+    if (!getcwd(pending, PATH_MAX)) {
+      return 0;
+    }
+    size = strlen(pending);
+    pending[size++] = '/';
+  }
+  if (size + path->size >= PATH_MAX) {
+    errno = ENAMETOOLONG;
+    return 0;
+  }
+  memcpy(pending + size, path->ptr, path->size);
+  size += path->size;
+  pending[size] = '\0';
+
+  // The resolved prefix never contains a link, so a `..` simply removes its
+  // last segment. Every other segment is looked up before going on.
+  cpj_path_builder_init(
+    &builder, CPJ_STYLE_UNIX, &root, resolved, sizeof(resolved), ends,
+    CPJ_FS_SEGMENT_MAX
+  );
+  hashes[0] = 0xcbf29ce484222325ULL;
+  rest.ptr = pending;
+  rest.size = size;
+  while ((name.size = cpj_path_next_segment(
+            CPJ_STYLE_UNIX, &rest, &position, &name.ptr
+          )) > 0) {
+    if (cpj_glob_is_dots(&name, 1)) {
+      continue;
+    } else if (cpj_glob_is_dots(&name, 2)) {
+      cpj_path_builder_pop_segment(&builder);
+      continue;
+    } else if (!cpj_path_builder_push_segment(&builder, &name)) {
+      errno = ENAMETOOLONG;
+      return 0;
+    }
+
+    hashes[builder.segment_count] = cpj_fs_hash(
+      hashes[builder.segment_count - 1], name.ptr, name.size
+    );
+    if (!cpj_fs_cache_get(
+          cache, resolved, builder.size, hashes[builder.segment_count], &probe
+        )) {
+      cpj_fs_probe(resolved, &probe);
+      cpj_fs_cache_put(
+        cache, resolved, builder.size, hashes[builder.segment_count], &probe
+      );
+    }
+
+    if (probe.kind == CPJ_FS_MISSING) {
+      errno = probe.error;
+      return 0;
+    } else if (probe.kind == CPJ_FS_OTHER && position < rest.size) {
+      errno = ENOTDIR;
+      return 0;
+    } else if (probe.kind == CPJ_FS_LINK) {
+      // The target continues where the link was, or at the root if it is
+      // absolute.
+      if (++link_count > CPJ_FS_LINK_MAX) {
+        errno = ELOOP;
+        return 0;
+      }
+      cpj_path_builder_pop_segment(&builder);
+      if (probe.target[0] == '/') {
+        cpj_path_builder_truncate(&builder, 0);
+      }
+      // The rest keeps its leading separator, a trailing one still requires
+      // the target to be a directory.
+      if (!cpj_fs_expand(
+            pending, &probe, pending + position, rest.size - position
+          )) {
+        errno = ENAMETOOLONG;
+        return 0;
+      }
+      rest.size = probe.target_size + rest.size - position;
+      position = 0;
+    }
+  }
+
+  if (builder.size < buffer_size) {
+    memcpy(buffer, resolved, builder.size + 1);
+  }
+  return builder.size;
+} /* cpj_fs_resolve */
+#else
+cpj_size_t
+cpj_fs_cache_storage_size(cpj_size_t entry_count, cpj_size_t data_size)
+{
+  (void)entry_count;
+  return data_size;
+} /* cpj_fs_cache_storage_size */
+
+void cpj_fs_cache_init(
+  cpj_fs_cache_t *cache, void *storage, cpj_size_t entry_count,
+  cpj_size_t data_size
+)
+{
+  (void)entry_count;
+  memset(cache, 0, sizeof(*cache));
+  cache->data = storage;
+  cache->data_capacity = data_size;
+} /* cpj_fs_cache_init */
+
+void cpj_fs_cache_invalidate(cpj_fs_cache_t *cache)
+{
+  ++cache->generation;
+} /* cpj_fs_cache_invalidate */
+
+cpj_size_t cpj_fs_resolve(
+  cpj_fs_cache_t *cache, const cpj_string_t *path, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+)
+{
+  (void)cache;
+  (void)path;
+  (void)buffer;
+  (void)buffer_size;
+  errno = ENOSYS;
+  return 0;
+} /* cpj_fs_resolve */
+#endif
+
+#ifndef _WIN32
+#define CPJ_FS_STAT_BATCH_SIZE 256
+#define CPJ_FS_STAT_THREAD_MAX 64
+#define CPJ_FS_STAT_RING_SIZE 64
+#define CPJ_FS_STAT_RING_DATA_SIZE 16384
+
+#ifdef O_PATH
+#define CPJ_FS_DIRECTORY_FLAGS (O_PATH | O_DIRECTORY | O_CLOEXEC)
+#else
+#define CPJ_FS_DIRECTORY_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+#endif
+
+#ifdef __APPLE__
+#define CPJ_FS_MTIME(status) ((status).st_mtimespec)
+#else
+#define CPJ_FS_MTIME(status) ((status).st_mtim)
+#endif
+
+/**
+ * The state shared by all threads of cpj_fs_stat_column, which take batches
+ * of paths in order.
+ */
+typedef struct
+{
+  const cpj_string_column_t *paths;
+  const cpj_fs_stat_column_t *results;
+  int flags;
+  bool is_ring_allowed;
+  cpj_size_t next;
+  cpj_size_t found_count;
+#ifdef CPJ_THREADS
+  pthread_mutex_t lock;
+#endif
+} cpj_fs_stat_state_t;
+
+static cpj_size_t
+cpj_fs_stat_get_name_start(const cpj_char_t *path, cpj_size_t size)
+{
+  while (size > 0 && path[size - 1] != '/') {
+    --size;
+  }
+  return size;
+} /* cpj_fs_stat_get_name_start */
+
+/**
+ * Opens the directory of the path at `index`, or returns -1 if the path after
+ * it is in another directory.
+ */
+static int cpj_fs_stat_open_directory(
+  const cpj_fs_stat_state_t *state, cpj_size_t index, cpj_size_t last,
+  cpj_size_t name_start
+)
+{
+  const cpj_char_t *data = state->paths->data;
+  const cpj_size_t *offsets = state->paths->offsets;
+  const cpj_char_t *path = data + offsets[index];
+  cpj_size_t next_size;
+  cpj_char_t buffer[PATH_MAX];
+
+  // A directory is only opened if the next path is in it as well, since
+  // opening it costs as much as probing a path.
+  if (name_start == 0 || name_start >= offsets[index + 1] - offsets[index] ||
+      index + 1 >= last || name_start >= PATH_MAX) {
+    return -1;
+  }
+  next_size = offsets[index + 2] - offsets[index + 1];
+  if (next_size <= name_start ||
+      cpj_fs_stat_get_name_start(data + offsets[index + 1], next_size) !=
+        name_start ||
+      memcmp(data + offsets[index + 1], path, name_start) != 0) {
+    return -1;
+  }
+  memcpy(buffer, path, name_start);
+  buffer[name_start] = '\0';
+  return open(buffer, CPJ_FS_DIRECTORY_FLAGS);
+} /* cpj_fs_stat_open_directory */
+
+static void cpj_fs_stat_write(
+  const cpj_fs_stat_column_t *results, cpj_size_t index, int error,
+  unsigned int mode, unsigned long long size, long long mtime
+)
+{
+  cpj_walk_type_t type = CPJ_WALK_OTHER;
+
+  if (error == 0 && S_ISDIR(mode)) {
+    type = CPJ_WALK_DIRECTORY;
+  } else if (error == 0 && S_ISREG(mode)) {
+    type = CPJ_WALK_FILE;
+  } else if (error == 0 && S_ISLNK(mode)) {
+    type = CPJ_WALK_SYMLINK;
+  }
+  if (results->errors) {
+    results->errors[index] = error;
+  }
+  if (results->types) {
+    results->types[index] = type;
+  }
+  if (results->sizes) {
+    results->sizes[index] = error == 0 ? size : 0;
+  }
+  if (results->mtimes) {
+    results->mtimes[index] = error == 0 ? mtime : 0;
+  }
+} /* cpj_fs_stat_write */
+
+/**
+ * Probes the paths from `first` up to `last` using fstatat, and returns how
+ * many of them have been found.
+ */
+static cpj_size_t
+cpj_fs_stat_range(cpj_fs_stat_state_t *state, cpj_size_t first, cpj_size_t last)
+{
+  const cpj_char_t *data = state->paths->data, *directory = NULL;
+  const cpj_size_t *offsets = state->paths->offsets;
+  cpj_size_t i, size, name_start, directory_size = 0;
+  cpj_size_t found_count = 0;
+  cpj_char_t buffer[PATH_MAX];
+  const cpj_char_t *path;
+  struct stat status;
+  int directory_fd = -1, fd, error;
+
+  for (i = first; i < last; ++i) {
+    path = data + offsets[i];
+    size = offsets[i + 1] - offsets[i];
+    name_start = cpj_fs_stat_get_name_start(path, size);
+    if (directory_fd >= 0 &&
+        (name_start != directory_size ||
+         memcmp(path, directory, directory_size) != 0)) {
+      close(directory_fd);
+      directory_fd = -1;
+    }
+    if (directory_fd < 0) {
+      directory_fd = cpj_fs_stat_open_directory(state, i, last, name_start);
+      directory = path;
+      directory_size = name_start;
+    }
+
+    fd = directory_fd >= 0 && name_start < size ? directory_fd : AT_FDCWD;
+    if (fd == AT_FDCWD) {
+      name_start = 0;
+    }
+    error = 0;
+    if (size - name_start >= PATH_MAX) {
+      error = ENAMETOOLONG;
+    } else {
+      memcpy(buffer, path + name_start, size - name_start);
+      buffer[size - name_start] = '\0';
+      if (fstatat(fd, buffer, &status, state->flags) != 0) {
+        error = errno;
+      }
+    }
+    if (error == 0) {
+      cpj_fs_stat_write(
+        state->results, i, 0, (unsigned int)status.st_mode,
+        (unsigned long long)status.st_size,
+        (long long)CPJ_FS_MTIME(status).tv_sec * 1000000000LL +
+          CPJ_FS_MTIME(status).tv_nsec
+      );
+      ++found_count;
+    } else {
+      cpj_fs_stat_write(state->results, i, error, 0, 0, 0);
+    }
   }
 
-  // Next we check for slashes. Windows uses backslashes, while unix uses
-  // forward slashes. Windows actually supports both, but our best guess is to
-  // assume windows with backslashes and unix with forward slashes.
-  for (c = path->ptr; *c; ++c) {
-    if (*c == '\\') {
-      return CPJ_STYLE_WINDOWS;
+  if (directory_fd >= 0) {
+    close(directory_fd);
+  }
+  return found_count;
+} /* cpj_fs_stat_range */
+
+#ifdef CPJ_FS_IO_URING
+/**
+ * An io_uring instance, which is driven by the raw system calls on the rings
+ * mapped from the kernel.
+ */
+typedef struct
+{
+  int fd;
+  unsigned int *sq_tail, *sq_array, sq_mask;
+  unsigned int *cq_head, *cq_tail, cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ring, *cq_ring;
+  size_t sq_ring_size, cq_ring_size, sqes_size;
+} cpj_fs_ring_t;
+
+/**
+ * The requests which are in flight at once. Their names, results and
+ * directories have to stay valid until all of them completed.
+ */
+typedef struct
+{
+  struct statx statuses[CPJ_FS_STAT_RING_SIZE];
+  cpj_size_t indices[CPJ_FS_STAT_RING_SIZE];
+  int directory_fds[CPJ_FS_STAT_RING_SIZE];
+  cpj_char_t data[CPJ_FS_STAT_RING_DATA_SIZE];
+  cpj_size_t count, directory_count, data_size;
+} cpj_fs_ring_window_t;
+
+static void cpj_fs_ring_destroy(cpj_fs_ring_t *ring)
+{
+  if (ring->sqes != MAP_FAILED) {
+    munmap(ring->sqes, ring->sqes_size);
+  }
+  if (ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+  if (ring->sq_ring != MAP_FAILED) {
+    munmap(ring->sq_ring, ring->sq_ring_size);
+  }
+  close(ring->fd);
+} /* cpj_fs_ring_destroy */
+
+/**
+ * Sets up a ring. This fails if the kernel does not support IORING_OP_STATX,
+ * or if io_uring is denied with ENOSYS or EPERM, for instance by a seccomp
+ * filter or by the io_uring_disabled sysctl.
+ */
+static bool cpj_fs_ring_init(cpj_fs_ring_t *ring)
+{
+  union
+  {
+    struct io_uring_probe probe;
+    unsigned char bytes[sizeof(struct io_uring_probe) +
+                        256 * sizeof(struct io_uring_probe_op)];
+  } probe;
+  struct io_uring_params params;
+  char *sq_ring, *cq_ring;
+
+  memset(&params, 0, sizeof(params));
+  ring->fd = (int)syscall(__NR_io_uring_setup, CPJ_FS_STAT_RING_SIZE, &params);
+  if (ring->fd < 0) {
+    return false;
+  }
+  ring->sq_ring = ring->cq_ring = ring->sqes = MAP_FAILED;
+  memset(&probe, 0, sizeof(probe));
+  if (syscall(
+        __NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, &probe, 256
+      ) < 0 ||
+      probe.probe.last_op < IORING_OP_STATX ||
+      !(probe.probe.ops[IORING_OP_STATX].flags & IO_URING_OP_SUPPORTED)) {
+    cpj_fs_ring_destroy(ring);
+    return false;
+  }
+
+  // Since Linux 5.4 both rings are mapped at once.
+  ring->sq_ring_size =
+    params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  ring->cq_ring_size =
+    params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) &&
+      ring->cq_ring_size > ring->sq_ring_size) {
+    ring->sq_ring_size = ring->cq_ring_size;
+  }
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sq_ring = mmap(
+    NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd,
+    IORING_OFF_SQ_RING
+  );
+  if (ring->sq_ring != MAP_FAILED &&
+      (params.features & IORING_FEAT_SINGLE_MMAP)) {
+    ring->cq_ring = ring->sq_ring;
+  } else if (ring->sq_ring != MAP_FAILED) {
+    ring->cq_ring = mmap(
+      NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd,
+      IORING_OFF_CQ_RING
+    );
+  }
+  if (ring->cq_ring != MAP_FAILED) {
+    ring->sqes = mmap(
+      NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd,
+      IORING_OFF_SQES
+    );
+  }
+  if (ring->sqes == MAP_FAILED) {
+    cpj_fs_ring_destroy(ring);
+    return false;
+  }
+
+  sq_ring = ring->sq_ring;
+  cq_ring = ring->cq_ring;
+  ring->sq_tail = (unsigned int *)(sq_ring + params.sq_off.tail);
+  ring->sq_array = (unsigned int *)(sq_ring + params.sq_off.array);
+  ring->sq_mask = *(unsigned int *)(sq_ring + params.sq_off.ring_mask);
+  ring->cq_head = (unsigned int *)(cq_ring + params.cq_off.head);
+  ring->cq_tail = (unsigned int *)(cq_ring + params.cq_off.tail);
+  ring->cq_mask = *(unsigned int *)(cq_ring + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+  return true;
+} /* cpj_fs_ring_init */
+
+/**
+ * Submits the requests of the window and waits for them, and adds the number
+ * of paths which have been found. Returns false if the ring fails, in which
+ * case it has to be destroyed. Requests which the kernel already took are
+ * still waited for, so it does not write into the window later on.
+ */
+static bool cpj_fs_ring_flush(
+  cpj_fs_ring_t *ring, cpj_fs_ring_window_t *window,
+  cpj_fs_stat_state_t *state, cpj_size_t *found_count
+)
+{
+  const struct io_uring_cqe *cqe;
+  const struct statx *status;
+  cpj_size_t submit_count = 0, complete_count = 0, i;
+  unsigned int head, tail;
+  bool is_failed = false;
+  long result;
+
+  // The requests have been written behind the tail, which is moved once all
+  // of them are in place.
+  __atomic_store_n(
+    ring->sq_tail, *ring->sq_tail + (unsigned int)window->count,
+    __ATOMIC_RELEASE
+  );
+  while (complete_count < (is_failed ? submit_count : window->count)) {
+    result = syscall(
+      __NR_io_uring_enter, ring->fd,
+      is_failed ? 0U : (unsigned int)(window->count - submit_count), 1U,
+      IORING_ENTER_GETEVENTS, NULL, 0
+    );
+    if (result > 0) {
+      submit_count += (cpj_size_t)result;
+    } else if (result < 0 && errno != EINTR) {
+      is_failed = true;
+    }
+
+    head = *ring->cq_head;
+    tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head, ++complete_count) {
+      cqe = ring->cqes + (head & ring->cq_mask);
+      i = (cpj_size_t)cqe->user_data;
+      status = window->statuses + i;
+      if (cqe->res < 0) {
+        cpj_fs_stat_write(state->results, window->indices[i], -cqe->res, 0, 0,
+          0);
+        continue;
+      }
+      cpj_fs_stat_write(
+        state->results, window->indices[i], 0, status->stx_mode,
+        status->stx_size,
+        (long long)status->stx_mtime.tv_sec * 1000000000LL +
+          status->stx_mtime.tv_nsec
+      );
+      ++*found_count;
     }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
   }
 
-  for (c = path->ptr; *c; ++c) {
-    if (*c == '/') {
-      return CPJ_STYLE_UNIX;
+  for (i = 0; i < window->directory_count; ++i) {
+    close(window->directory_fds[i]);
+  }
+  window->count = 0;
+  window->directory_count = 0;
+  window->data_size = 0;
+  return !is_failed;
+} /* cpj_fs_ring_flush */
+
+/**
+ * Probes the paths from `first` up to `last` like cpj_fs_stat_range does, but
+ * using IORING_OP_STATX requests which are submitted in windows, so a whole
+ * window costs a single system call. Returns the number of paths which have
+ * been found, or CPJ_SIZE_MAX if the ring failed.
+ */
+static cpj_size_t cpj_fs_ring_range(
+  cpj_fs_ring_t *ring, cpj_fs_ring_window_t *window,
+  cpj_fs_stat_state_t *state, cpj_size_t first, cpj_size_t last
+)
+{
+  const cpj_char_t *data = state->paths->data, *directory = NULL;
+  const cpj_size_t *offsets = state->paths->offsets;
+  cpj_size_t i, size, name_start, directory_size = 0, found_count = 0;
+  struct io_uring_sqe *sqe;
+  const cpj_char_t *path;
+  int directory_fd = -1, fd;
+  unsigned int position;
+
+  window->count = 0;
+  window->directory_count = 0;
+  window->data_size = 0;
+  for (i = first; i < last; ++i) {
+    path = data + offsets[i];
+    size = offsets[i + 1] - offsets[i];
+    name_start = cpj_fs_stat_get_name_start(path, size);
+    if (size >= PATH_MAX) {
+      cpj_fs_stat_write(state->results, i, ENAMETOOLONG, 0, 0, 0);
+      continue;
+    } else if (window->count == CPJ_FS_STAT_RING_SIZE ||
+               window->data_size + size >= CPJ_FS_STAT_RING_DATA_SIZE) {
+      if (!cpj_fs_ring_flush(ring, window, state, &found_count)) {
+        return CPJ_SIZE_MAX;
+      }
+      directory_fd = -1;
+    }
+
+    // The directories are closed by the flush, once nothing refers to them.
+    if (directory_fd >= 0 &&
+        (name_start != directory_size ||
+         memcmp(path, directory, directory_size) != 0)) {
+      directory_fd = -1;
     }
+    if (directory_fd < 0) {
+      directory_fd = cpj_fs_stat_open_directory(state, i, last, name_start);
+      directory = path;
+      directory_size = name_start;
+      if (directory_fd >= 0) {
+        window->directory_fds[window->directory_count++] = directory_fd;
+      }
+    }
+    fd = directory_fd >= 0 && name_start < size ? directory_fd : AT_FDCWD;
+    if (fd == AT_FDCWD) {
+      name_start = 0;
+    }
+
+    memcpy(window->data + window->data_size, path + name_start,
+      size - name_start);
+    window->data[window->data_size + size - name_start] = '\0';
+    position = (*ring->sq_tail + (unsigned int)window->count) & ring->sq_mask;
+    sqe = ring->sqes + position;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long long)(uintptr_t)(window->data +
+                                                window->data_size);
+    sqe->len = STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME;
+    sqe->off = (unsigned long long)(uintptr_t)(window->statuses +
+                                               window->count);
+    sqe->statx_flags = (unsigned int)state->flags;
+    sqe->user_data = window->count;
+    ring->sq_array[position] = position;
+    window->indices[window->count++] = i;
+    window->data_size += size - name_start + 1;
   }
 
-  // This path does not have any slashes. We grab the last segment (which
-  // actually must be the first one), and determine whether the segment starts
-  // with a dot. A dot is a hidden folder or file in the UNIX world, in that
-  // case we assume the path to have UNIX style.
-  cpj_path_get_basename(CPJ_STYLE_UNIX, path, &basename);
-  if (basename.ptr == NULL) {
-    // We couldn't find any segments, so we default to a UNIX path style since
-    // there is no way to make any assumptions.
-    return CPJ_STYLE_UNIX;
+  if (window->count > 0 &&
+      !cpj_fs_ring_flush(ring, window, state, &found_count)) {
+    return CPJ_SIZE_MAX;
   }
+  return found_count;
+} /* cpj_fs_ring_range */
+#endif
 
-  if (*basename.ptr == '.') {
-    return CPJ_STYLE_UNIX;
+static void *cpj_fs_stat_thread(void *context)
+{
+  cpj_fs_stat_state_t *state = context;
+  cpj_size_t first, last, found_count = 0;
+#ifdef CPJ_FS_IO_URING
+  cpj_fs_ring_window_t window;
+  cpj_fs_ring_t ring;
+  bool has_ring = state->is_ring_allowed && cpj_fs_ring_init(&ring);
+#endif
+
+  for (;;) {
+#ifdef CPJ_THREADS
+    pthread_mutex_lock(&state->lock);
+#endif
+    first = state->next;
+    state->next += first < state->paths->count ? CPJ_FS_STAT_BATCH_SIZE : 0;
+    state->found_count += found_count;
+#ifdef CPJ_THREADS
+    pthread_mutex_unlock(&state->lock);
+#endif
+    if (first >= state->paths->count) {
+      break;
+    }
+    last = state->paths->count - first < CPJ_FS_STAT_BATCH_SIZE
+             ? state->paths->count
+             : first + CPJ_FS_STAT_BATCH_SIZE;
+    found_count = CPJ_SIZE_MAX;
+#ifdef CPJ_FS_IO_URING
+    // A ring which failed is given up, and its batch is probed again.
+    if (has_ring) {
+      found_count = cpj_fs_ring_range(&ring, &window, state, first, last);
+      if (found_count == CPJ_SIZE_MAX) {
+        cpj_fs_ring_destroy(&ring);
+        has_ring = false;
+      }
+    }
+#endif
+    if (found_count == CPJ_SIZE_MAX) {
+      found_count = cpj_fs_stat_range(state, first, last);
+    }
   }
 
-  // And finally we check whether the last segment contains a dot. If it
-  // contains a dot, that might be an extension. Windows is more likely to have
-  // file names with extensions, so our guess would be windows.
-  for (c = basename.ptr; *c; ++c) {
-    if (*c == '.') {
-      return CPJ_STYLE_WINDOWS;
+#ifdef CPJ_FS_IO_URING
+  if (has_ring) {
+    cpj_fs_ring_destroy(&ring);
+  }
+#endif
+  return NULL;
+} /* cpj_fs_stat_thread */
+
+cpj_size_t cpj_fs_stat_column(
+  const cpj_string_column_t *paths, unsigned int flags,
+  const cpj_fs_stat_column_t *results
+)
+{
+  cpj_fs_stat_state_t state;
+#ifdef CPJ_THREADS
+  pthread_t threads[CPJ_FS_STAT_THREAD_MAX];
+  bool has_thread[CPJ_FS_STAT_THREAD_MAX];
+  cpj_size_t i, thread_count = 1;
+  long cpu_count;
+#endif
+
+  state.paths = paths;
+  state.results = results;
+  state.flags = (flags & CPJ_FS_STAT_NO_FOLLOW) ? AT_SYMLINK_NOFOLLOW : 0;
+  state.is_ring_allowed = !(flags & CPJ_FS_STAT_NO_RING);
+  state.next = 0;
+  state.found_count = 0;
+#ifdef CPJ_THREADS
+  if (flags & CPJ_FS_STAT_PARALLEL) {
+    cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = cpu_count > 1 ? (cpj_size_t)cpu_count : 1;
+    if (thread_count > CPJ_FS_STAT_THREAD_MAX) {
+      thread_count = CPJ_FS_STAT_THREAD_MAX;
+    }
+    if (thread_count > paths->count / CPJ_FS_STAT_BATCH_SIZE) {
+      thread_count = paths->count / CPJ_FS_STAT_BATCH_SIZE + 1;
     }
   }
+  pthread_mutex_init(&state.lock, NULL);
+  for (i = 1; i < thread_count; ++i) {
+    has_thread[i] =
+      pthread_create(threads + i, NULL, cpj_fs_stat_thread, &state) == 0;
+  }
+#endif
 
-  // All our checks failed, so we will return a default value which is currently
-  // UNIX.
-  return CPJ_STYLE_UNIX;
-}
+  cpj_fs_stat_thread(&state);
+
+#ifdef CPJ_THREADS
+  for (i = 1; i < thread_count; ++i) {
+    if (has_thread[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+  pthread_mutex_destroy(&state.lock);
+#else
+  (void)flags;
+#endif
+  return state.found_count;
+} /* cpj_fs_stat_column */
+#else
+cpj_size_t cpj_fs_stat_column(
+  const cpj_string_column_t *paths, unsigned int flags,
+  const cpj_fs_stat_column_t *results
+)
+{
+  cpj_size_t i;
+
+  (void)flags;
+  for (i = 0; i < paths->count; ++i) {
+    if (results->errors) {
+      results->errors[i] = ENOSYS;
+    }
+    if (results->types) {
+      results->types[i] = CPJ_WALK_OTHER;
+    }
+    if (results->sizes) {
+      results->sizes[i] = 0;
+    }
+    if (results->mtimes) {
+      results->mtimes[i] = 0;
+    }
+  }
+  return 0;
+} /* cpj_fs_stat_column */
+#endif
+
+#ifdef __linux__
+#define CPJ_SEARCHPATH_SLOT_SIZE 6
+
+/**
+ * The fields of a slot of a search path. The name is stored in the data at
+ * the offset.
+ */
+enum
+{
+  CPJ_SEARCHPATH_SLOT_HASH,
+  CPJ_SEARCHPATH_SLOT_OFFSET,
+  CPJ_SEARCHPATH_SLOT_SIZE_NAME,
+  CPJ_SEARCHPATH_SLOT_DIRECTORY,
+  CPJ_SEARCHPATH_SLOT_GENERATION,
+  CPJ_SEARCHPATH_SLOT_TYPE
+};
+
+static cpj_size_t cpj_searchpath_hash(
+  const cpj_char_t *name, cpj_size_t size, cpj_size_t directory
+)
+{
+  // Every directory gets its own sequence of slots for the same name.
+  return (cpj_size_t)(cpj_path_hash(CPJ_STYLE_UNIX, name, size) ^
+                      (directory + 1) * 0x9e3779b97f4a7c15ULL);
+} /* cpj_searchpath_hash */
+
+/**
+ * Finds the slot of a name in the current listing of a directory, or the
+ * empty slot where it would be stored.
+ */
+static cpj_size_t *cpj_searchpath_find_slot(
+  const cpj_searchpath_t *searchpath, cpj_size_t directory,
+  const cpj_char_t *name, cpj_size_t size, cpj_size_t hash
+)
+{
+  cpj_size_t index = hash & (searchpath->slot_count - 1), *slot;
+
+  for (;; index = (index + 1) & (searchpath->slot_count - 1)) {
+    slot = searchpath->slots + index * CPJ_SEARCHPATH_SLOT_SIZE;
+    if (slot[CPJ_SEARCHPATH_SLOT_GENERATION] == 0 ||
+        (slot[CPJ_SEARCHPATH_SLOT_HASH] == hash &&
+         slot[CPJ_SEARCHPATH_SLOT_DIRECTORY] == directory &&
+         slot[CPJ_SEARCHPATH_SLOT_GENERATION] ==
+           searchpath->generations[directory] &&
+         slot[CPJ_SEARCHPATH_SLOT_SIZE_NAME] == size &&
+         memcmp(searchpath->data + slot[CPJ_SEARCHPATH_SLOT_OFFSET], name,
+           size) == 0)) {
+      return slot;
+    }
+  }
+} /* cpj_searchpath_find_slot */
+
+static void cpj_searchpath_clear(cpj_searchpath_t *searchpath)
+{
+  memset(
+    searchpath->slots, 0,
+    searchpath->slot_count * CPJ_SEARCHPATH_SLOT_SIZE *
+      sizeof(*searchpath->slots)
+  );
+  memset(
+    searchpath->generations, 0,
+    searchpath->directory_count * sizeof(*searchpath->generations)
+  );
+  searchpath->data_size = 0;
+  searchpath->entry_count = 0;
+} /* cpj_searchpath_clear */
+
+/**
+ * Reads the listing of a directory into the hash set. Returns false if the
+ * listing does not fit, in which case its entries are left behind as
+ * outdated ones. A directory which can not be opened has an empty listing.
+ */
+static bool
+cpj_searchpath_read(cpj_searchpath_t *searchpath, cpj_size_t directory)
+{
+  const cpj_string_t *path = searchpath->directories + directory;
+  cpj_size_t generation = ++searchpath->generation, hash, *slot, size;
+  char buffer[CPJ_WALK_BUFFER_SIZE];
+  const cpj_walk_dirent_t *dirent;
+  struct stat status;
+  long position, read_size;
+  int fd = -1;
+
+  // The generation has to be set before reading, so the slots of the names
+  // which are already stored can be found.
+  searchpath->generations[directory] = generation;
+  searchpath->mtimes[directory] = 0;
+  if (path->size < sizeof(buffer)) {
+    memcpy(buffer, path->ptr, path->size);
+    buffer[path->size] = '\0';
+    fd = open(buffer, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  }
+  if (fd < 0) {
+    return true;
+  }
+
+  // The mtime is taken before reading, so a change during the listing is
+  // noticed by the next refresh.
+  if (fstat(fd, &status) == 0) {
+    searchpath->mtimes[directory] =
+      (long long)status.st_mtim.tv_sec * 1000000000LL +
+      status.st_mtim.tv_nsec;
+  }
+  while ((read_size = syscall(SYS_getdents64, fd, buffer, sizeof(buffer))) >
+         0) {
+    for (position = 0; position < read_size;
+         position += dirent->record_size) {
+      dirent = (const cpj_walk_dirent_t *)(buffer + position);
+      size = strlen(dirent->name);
+      if ((size == 1 && dirent->name[0] == '.') ||
+          (size == 2 && dirent->name[0] == '.' && dirent->name[1] == '.')) {
+        continue;
+      }
+      if ((searchpath->entry_count + 1) * 2 > searchpath->slot_count ||
+          searchpath->data_size + size > searchpath->data_capacity) {
+        close(fd);
+        return false;
+      }
+      hash = cpj_searchpath_hash(dirent->name, size, directory);
+      slot = cpj_searchpath_find_slot(
+        searchpath, directory, dirent->name, size, hash
+      );
+      slot[CPJ_SEARCHPATH_SLOT_HASH] = hash;
+      slot[CPJ_SEARCHPATH_SLOT_OFFSET] = searchpath->data_size;
+      slot[CPJ_SEARCHPATH_SLOT_SIZE_NAME] = size;
+      slot[CPJ_SEARCHPATH_SLOT_DIRECTORY] = directory;
+      slot[CPJ_SEARCHPATH_SLOT_GENERATION] = generation;
+      slot[CPJ_SEARCHPATH_SLOT_TYPE] = dirent->type;
+      memcpy(searchpath->data + searchpath->data_size, dirent->name, size);
+      searchpath->data_size += size;
+      ++searchpath->entry_count;
+    }
+  }
+  close(fd);
+  return true;
+} /* cpj_searchpath_read */
+
+static void
+cpj_searchpath_list(cpj_searchpath_t *searchpath, cpj_size_t directory)
+{
+  ++searchpath->list_count;
+  if (cpj_searchpath_read(searchpath, directory)) {
+    return;
+  }
+
+  // The hash set is full, so all listings are dropped and read again when
+  // needed. A listing which does not even fit on its own is never kept, its
+  // directory is probed instead.
+  cpj_searchpath_clear(searchpath);
+  if (!cpj_searchpath_read(searchpath, directory)) {
+    cpj_searchpath_clear(searchpath);
+    searchpath->generations[directory] = CPJ_SIZE_MAX;
+  }
+} /* cpj_searchpath_list */
+
+cpj_size_t cpj_searchpath_storage_size(
+  cpj_size_t directory_count, cpj_size_t entry_count, cpj_size_t data_size
+)
+{
+  return directory_count *
+           (sizeof(cpj_size_t) + sizeof(long long)) +
+         cpj_fs_cache_slot_count(entry_count) * CPJ_SEARCHPATH_SLOT_SIZE *
+           sizeof(cpj_size_t) +
+         data_size;
+} /* cpj_searchpath_storage_size */
+
+void cpj_searchpath_init(
+  cpj_searchpath_t *searchpath, const cpj_string_t *directories,
+  cpj_size_t directory_count, void *storage, cpj_size_t entry_count,
+  cpj_size_t data_size
+)
+{
+  cpj_char_t *next = storage;
+
+  searchpath->directories = directories;
+  searchpath->directory_count = directory_count;
+  searchpath->mtimes = (long long *)next;
+  next += directory_count * sizeof(long long);
+  searchpath->generations = (cpj_size_t *)next;
+  next += directory_count * sizeof(cpj_size_t);
+  searchpath->slots = (cpj_size_t *)next;
+  searchpath->slot_count = cpj_fs_cache_slot_count(entry_count);
+  next += searchpath->slot_count * CPJ_SEARCHPATH_SLOT_SIZE *
+          sizeof(cpj_size_t);
+  searchpath->data = next;
+  searchpath->data_capacity = data_size;
+  searchpath->generation = 0;
+  searchpath->list_count = 0;
+  cpj_searchpath_clear(searchpath);
+} /* cpj_searchpath_init */
+
+cpj_size_t cpj_searchpath_refresh(cpj_searchpath_t *searchpath)
+{
+  cpj_char_t buffer[PATH_MAX];
+  cpj_size_t i, drop_count = 0;
+  const cpj_string_t *path;
+  struct stat status;
+  long long mtime;
+
+  for (i = 0; i < searchpath->directory_count; ++i) {
+    path = searchpath->directories + i;
+    if (searchpath->generations[i] == 0 || path->size >= sizeof(buffer)) {
+      continue;
+    }
+    memcpy(buffer, path->ptr, path->size);
+    buffer[path->size] = '\0';
+    mtime = 0;
+    if (stat(buffer, &status) == 0 && S_ISDIR(status.st_mode)) {
+      mtime = (long long)status.st_mtim.tv_sec * 1000000000LL +
+              status.st_mtim.tv_nsec;
+    }
+    if (mtime != searchpath->mtimes[i]) {
+      searchpath->generations[i] = 0;
+      ++drop_count;
+    }
+  }
+  return drop_count;
+} /* cpj_searchpath_refresh */
+
+/**
+ * Checks whether a relative name is already normalized, which is the case
+ * for most names, so they do not have to be copied through a join.
+ */
+static bool cpj_searchpath_is_normalized(const cpj_string_t *name)
+{
+  cpj_string_t segment;
+  cpj_size_t i;
+
+  segment.ptr = name->ptr;
+  for (i = 0; i <= name->size; ++i) {
+    if (i < name->size && name->ptr[i] != '/') {
+      continue;
+    }
+    segment.size = (cpj_size_t)(name->ptr + i - segment.ptr);
+    if (segment.size == 0 || cpj_glob_is_dots(&segment, 1) ||
+        cpj_glob_is_dots(&segment, 2)) {
+      return false;
+    }
+    segment.ptr = name->ptr + i + 1;
+  }
+  return true;
+} /* cpj_searchpath_is_normalized */
+
+/**
+ * Joins a directory with a normalized name and checks whether the result
+ * exists and is not a directory, if asked to.
+ */
+static cpj_size_t cpj_searchpath_join(
+  const cpj_string_t *directory, const cpj_string_t *name, bool is_probed,
+  cpj_char_t *candidate
+)
+{
+  cpj_string_t paths[2];
+  struct stat status;
+  cpj_size_t size;
+
+  paths[0] = *directory;
+  paths[1] = *name;
+  size = cpj_path_join_multiple(
+    CPJ_STYLE_UNIX, false, true, paths, 2, candidate, PATH_MAX
+  );
+  if (size >= PATH_MAX ||
+      (is_probed &&
+       (stat(candidate, &status) != 0 || S_ISDIR(status.st_mode)))) {
+    return 0;
+  }
+  return size;
+} /* cpj_searchpath_join */
+
+cpj_size_t cpj_searchpath_find(
+  cpj_searchpath_t *searchpath, const cpj_string_t *name, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+)
+{
+  cpj_char_t normalized[PATH_MAX], candidate[PATH_MAX];
+  cpj_size_t i, first_size, hash, size, *slot;
+  cpj_string_t string, first;
+  bool is_single;
+
+  if (name->size > 0 && name->ptr[0] == '/') {
+    errno = EINVAL;
+    return 0;
+  }
+  string.ptr = normalized;
+  if (cpj_searchpath_is_normalized(name) && name->size < sizeof(normalized)) {
+    memcpy(normalized, name->ptr, name->size);
+    normalized[name->size] = '\0';
+    string.size = name->size;
+  } else {
+    string.size = cpj_path_join_multiple(
+      CPJ_STYLE_UNIX, false, true, name, 1, normalized, sizeof(normalized)
+    );
+  }
+  if (string.size >= sizeof(normalized) ||
+      (string.size == 1 && normalized[0] == '.')) {
+    errno = string.size >= sizeof(normalized) ? ENAMETOOLONG : ENOENT;
+    return 0;
+  }
+
+  // Only the first segment can be looked up in a listing. A `..` can only be
+  // leading after normalizing, and leaves the listed directory.
+  for (first_size = 0;
+       first_size < string.size && normalized[first_size] != '/';
+       ++first_size) {
+  }
+  first.ptr = normalized;
+  first.size = first_size;
+  is_single = first_size == string.size;
+  for (i = 0; i < searchpath->directory_count; ++i) {
+    if (cpj_glob_is_dots(&first, 2)) {
+      size = cpj_searchpath_join(
+        searchpath->directories + i, &string, true, candidate
+      );
+    } else {
+      if (searchpath->generations[i] == 0) {
+        cpj_searchpath_list(searchpath, i);
+      }
+      if (searchpath->generations[i] == CPJ_SIZE_MAX) {
+        size = cpj_searchpath_join(
+          searchpath->directories + i, &string, true, candidate
+        );
+      } else {
+        hash = cpj_searchpath_hash(first.ptr, first.size, i);
+        slot = cpj_searchpath_find_slot(
+          searchpath, i, first.ptr, first.size, hash
+        );
+        if (slot[CPJ_SEARCHPATH_SLOT_GENERATION] == 0 ||
+            (is_single && slot[CPJ_SEARCHPATH_SLOT_TYPE] == DT_DIR) ||
+            (!is_single && slot[CPJ_SEARCHPATH_SLOT_TYPE] == DT_REG)) {
+          continue;
+        }
+
+        // A link might lead to a directory or nowhere, and some file systems
+        // do not report the type of an entry at all, so those are probed just
+        // like without a listing.
+        size = cpj_searchpath_join(
+          searchpath->directories + i, &string,
+          !is_single || slot[CPJ_SEARCHPATH_SLOT_TYPE] == DT_LNK ||
+            slot[CPJ_SEARCHPATH_SLOT_TYPE] == DT_UNKNOWN,
+          candidate
+        );
+      }
+    }
+
+    if (size > 0) {
+      if (size < buffer_size) {
+        memcpy(buffer, candidate, size + 1);
+      }
+      return size;
+    }
+  }
+
+  errno = ENOENT;
+  return 0;
+} /* cpj_searchpath_find */
+#else
+cpj_size_t cpj_searchpath_storage_size(
+  cpj_size_t directory_count, cpj_size_t entry_count, cpj_size_t data_size
+)
+{
+  (void)directory_count;
+  (void)entry_count;
+  return data_size;
+} /* cpj_searchpath_storage_size */
+
+void cpj_searchpath_init(
+  cpj_searchpath_t *searchpath, const cpj_string_t *directories,
+  cpj_size_t directory_count, void *storage, cpj_size_t entry_count,
+  cpj_size_t data_size
+)
+{
+  (void)entry_count;
+  memset(searchpath, 0, sizeof(*searchpath));
+  searchpath->directories = directories;
+  searchpath->directory_count = directory_count;
+  searchpath->data = storage;
+  searchpath->data_capacity = data_size;
+} /* cpj_searchpath_init */
+
+cpj_size_t cpj_searchpath_refresh(cpj_searchpath_t *searchpath)
+{
+  (void)searchpath;
+  return 0;
+} /* cpj_searchpath_refresh */
+
+cpj_size_t cpj_searchpath_find(
+  cpj_searchpath_t *searchpath, const cpj_string_t *name, cpj_char_t *buffer,
+  cpj_size_t buffer_size
+)
+{
+  (void)searchpath;
+  (void)name;
+  (void)buffer;
+  (void)buffer_size;
+  errno = ENOSYS;
+  return 0;
+} /* cpj_searchpath_find */
+#endif
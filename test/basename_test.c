@@ -4,6 +4,70 @@
 #include <stdlib.h>
 #include <string.h>
 
+int basename_change_size_query(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+
+  // The size and the result do not depend on the size of the buffer.
+  if (cpj_path_change_basename_test(CPJ_STYLE_UNIX, "a/b/", "c", NULL, 0) != 3 ||
+      cpj_path_change_basename_test(CPJ_STYLE_UNIX, "a/b/", "c", buffer, 4) != 3 ||
+      strcmp(buffer, "a/c") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_change_basename_test(CPJ_STYLE_UNIX, "/folder/./file.txt//",
+        "another.txt", NULL, 0) != 19 ||
+      cpj_path_change_basename_test(CPJ_STYLE_UNIX, "/folder/./file.txt//",
+        "another.txt", buffer, 20) != 19 ||
+      strcmp(buffer, "/folder/another.txt") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_change_basename_test(CPJ_STYLE_UNIX, "/folder/./file.txt//",
+        "another.txt", buffer, 10) != 19 ||
+      strcmp(buffer, "/folder/a") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int basename_change_trailing_separators(void)
+{
+  cpj_char_t buffer[FILENAME_MAX] = "/folder/./file.txt//";
+  cpj_size_t n;
+
+  n = cpj_path_change_basename_test(CPJ_STYLE_UNIX, buffer, "another.txt", buffer,
+    sizeof(buffer));
+  if (n != 19) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "/folder/another.txt") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int basename_change_special_directory(void)
+{
+  cpj_size_t n;
+  cpj_char_t buffer[FILENAME_MAX];
+
+  n = cpj_path_change_basename_test(CPJ_STYLE_WINDOWS, "C:\\a\\b\\..", "c.txt", buffer,
+    sizeof(buffer));
+  if (n != 12) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "C:\\a\\b\\c.txt") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int basename_change_trim_only_root(void)
 {
   cpj_size_t n;
@@ -0,0 +1,255 @@
+#include "cpj_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static bool builder_init(
+  cpj_path_builder_t *builder, cpj_path_style_t style, const cpj_char_t *path,
+  cpj_char_t *buffer, cpj_size_t buffer_size, cpj_size_t *segment_ends,
+  cpj_size_t segment_capacity
+)
+{
+  cpj_string_t string;
+
+  string.ptr = path;
+  string.size = cpj_strlen(path);
+  return cpj_path_builder_init(
+    builder, style, &string, buffer, buffer_size, segment_ends,
+    segment_capacity
+  );
+}
+
+static bool builder_push(cpj_path_builder_t *builder, const cpj_char_t *name)
+{
+  cpj_string_t string;
+
+  string.ptr = name;
+  string.size = cpj_strlen(name);
+  return cpj_path_builder_push_segment(builder, &string);
+}
+
+static bool
+builder_push_relative(cpj_path_builder_t *builder, const cpj_char_t *path)
+{
+  cpj_string_t string;
+
+  string.ptr = path;
+  string.size = cpj_strlen(path);
+  return cpj_path_builder_push_relative(builder, &string);
+}
+
+static bool
+builder_is(const cpj_path_builder_t *builder, const cpj_char_t *expected)
+{
+  return builder->size == cpj_strlen(expected) &&
+         strcmp(builder->buffer, expected) == 0;
+}
+
+int builder_init_normalized(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t ends[8];
+  cpj_path_builder_t builder;
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "/a//b/./c/../d/", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends)) ||
+      !builder_is(&builder, "/a/b/d") || builder.segment_count != 3 ||
+      builder.root_size != 1 || ends[0] != 2 || ends[2] != 6) {
+    return EXIT_FAILURE;
+  }
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "../../x/..", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends)) ||
+      !builder_is(&builder, "../..") || builder.segment_count != 2 ||
+      builder.parent_count != 2) {
+    return EXIT_FAILURE;
+  }
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "", buffer, sizeof(buffer),
+        ends, ARRAY_SIZE(ends)) ||
+      !builder_is(&builder, ".") || builder.segment_count != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int builder_push_pop(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t ends[8];
+  cpj_path_builder_t builder;
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "/usr", buffer, sizeof(buffer),
+        ends, ARRAY_SIZE(ends))) {
+    return EXIT_FAILURE;
+  }
+
+  if (!builder_push(&builder, "lib") || !builder_push(&builder, "x.so") ||
+      !builder_is(&builder, "/usr/lib/x.so") ||
+      !cpj_path_builder_pop_segment(&builder) ||
+      !builder_is(&builder, "/usr/lib") || !builder_push(&builder, ".") ||
+      !builder_push(&builder, "") || !builder_is(&builder, "/usr/lib") ||
+      !builder_push(&builder, "..") || !builder_is(&builder, "/usr") ||
+      !cpj_path_builder_pop_segment(&builder) || !builder_is(&builder, "/") ||
+      cpj_path_builder_pop_segment(&builder) ||
+      !builder_push(&builder, "..") || !builder_is(&builder, "/")) {
+    return EXIT_FAILURE;
+  }
+
+  // A separator can not be part of a single segment.
+  if (builder_push(&builder, "a/b") || !builder_is(&builder, "/")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int builder_parents(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t ends[8];
+  cpj_path_builder_t builder;
+
+  // A relative path keeps the `..` which lead out of it.
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "a", buffer, sizeof(buffer),
+        ends, ARRAY_SIZE(ends)) ||
+      !builder_push(&builder, "..") || !builder_is(&builder, ".") ||
+      !builder_push(&builder, "..") || !builder_is(&builder, "..") ||
+      !builder_push(&builder, "..") || !builder_is(&builder, "../..") ||
+      !builder_push(&builder, "b") || !builder_is(&builder, "../../b") ||
+      builder.parent_count != 2 || !builder_push(&builder, "..") ||
+      !builder_push(&builder, "..") || !builder_is(&builder, "../../..") ||
+      !cpj_path_builder_pop_segment(&builder) ||
+      !builder_is(&builder, "../..") || builder.parent_count != 2) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int builder_relative(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t ends[8];
+  cpj_path_builder_t builder;
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "/a/b", buffer, sizeof(buffer),
+        ends, ARRAY_SIZE(ends))) {
+    return EXIT_FAILURE;
+  }
+
+  if (!builder_push_relative(&builder, "c/./d//") ||
+      !builder_is(&builder, "/a/b/c/d") || builder.segment_count != 4 ||
+      !builder_push_relative(&builder, "../../x/y/../z") ||
+      !builder_is(&builder, "/a/b/x/z") || ends[3] != 8 ||
+      !builder_push_relative(&builder, "../../../../../q") ||
+      !builder_is(&builder, "/q") || builder.segment_count != 1 ||
+      !builder_push_relative(&builder, "") || !builder_is(&builder, "/q")) {
+    return EXIT_FAILURE;
+  }
+
+  // Only relative paths can be pushed.
+  if (builder_push_relative(&builder, "/etc") || !builder_is(&builder, "/q")) {
+    return EXIT_FAILURE;
+  }
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "a", buffer, sizeof(buffer),
+        ends, ARRAY_SIZE(ends)) ||
+      !builder_push_relative(&builder, "../../b/../c") ||
+      !builder_is(&builder, "../c") || builder.parent_count != 1 ||
+      !builder_push_relative(&builder, "..") || !builder_is(&builder, "..")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int builder_truncate(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t ends[8];
+  cpj_path_builder_t builder;
+
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "a/b/c/d", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends))) {
+    return EXIT_FAILURE;
+  }
+
+  cpj_path_builder_truncate(&builder, 5);
+  if (!builder_is(&builder, "a/b/c/d")) {
+    return EXIT_FAILURE;
+  }
+  cpj_path_builder_truncate(&builder, 2);
+  if (!builder_is(&builder, "a/b") || builder.segment_count != 2) {
+    return EXIT_FAILURE;
+  }
+  cpj_path_builder_truncate(&builder, 0);
+  if (!builder_is(&builder, ".") || builder.segment_count != 0 ||
+      !builder_push(&builder, "e") || !builder_is(&builder, "e")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int builder_windows(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t ends[8];
+  cpj_path_builder_t builder;
+
+  if (!builder_init(&builder, CPJ_STYLE_WINDOWS, "C:/Users//me", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends)) ||
+      !builder_is(&builder, "C:\\Users\\me") ||
+      !builder_push_relative(&builder, "../you/docs") ||
+      !builder_is(&builder, "C:\\Users\\you\\docs") ||
+      builder_push(&builder, "a\\b") || !builder_push(&builder, "a.txt") ||
+      !builder_is(&builder, "C:\\Users\\you\\docs\\a.txt")) {
+    return EXIT_FAILURE;
+  }
+
+  // A drive without a separator is relative, so it keeps its `..`.
+  if (!builder_init(&builder, CPJ_STYLE_WINDOWS, "C:a", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends)) ||
+      !cpj_path_builder_pop_segment(&builder) ||
+      !builder_is(&builder, "C:.") || !builder_push(&builder, "..") ||
+      !builder_is(&builder, "C:..") ||
+      !builder_init(&builder, CPJ_STYLE_WINDOWS, "\\\\server\\share\\x",
+        buffer, sizeof(buffer), ends, ARRAY_SIZE(ends)) ||
+      !builder_push_relative(&builder, "..\\..") ||
+      !builder_is(&builder, "\\\\server\\share\\")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int builder_too_small(void)
+{
+  cpj_char_t buffer[8];
+  cpj_size_t ends[3];
+  cpj_path_builder_t builder;
+
+  if (builder_init(&builder, CPJ_STYLE_UNIX, "/abcdefgh", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends)) ||
+      builder_init(&builder, CPJ_STYLE_UNIX, "a/b/c/d", buffer,
+        sizeof(buffer), ends, ARRAY_SIZE(ends))) {
+    return EXIT_FAILURE;
+  }
+
+  // A failed push leaves the path as it was.
+  if (!builder_init(&builder, CPJ_STYLE_UNIX, "/a/b", buffer, sizeof(buffer),
+        ends, ARRAY_SIZE(ends)) ||
+      builder_push(&builder, "cdef") || !builder_is(&builder, "/a/b") ||
+      builder_push_relative(&builder, "../c/d/e") ||
+      !builder_is(&builder, "/a/b") || !builder_push(&builder, "cd") ||
+      !builder_is(&builder, "/a/b/cd") || builder_push(&builder, "e") ||
+      !builder_push_relative(&builder, "../../x/y/..") ||
+      !builder_is(&builder, "/a/x")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
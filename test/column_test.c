@@ -0,0 +1,243 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**
+ * Builds a column from zero-terminated strings. The strings are copied back
+ * to back without any terminator in between.
+ */
+static cpj_string_column_t column_create(
+  const cpj_char_t **strings, cpj_size_t count, cpj_char_t *data,
+  cpj_size_t *offsets
+)
+{
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  offsets[0] = 0;
+  for (i = 0; i < count; ++i) {
+    cpj_size_t size = cpj_strlen(strings[i]);
+    memcpy(data + offsets[i], strings[i], size);
+    offsets[i + 1] = offsets[i] + size;
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = count;
+  return column;
+}
+
+static int column_check(
+  const cpj_char_t *buffer, cpj_size_t length, const cpj_size_t *offsets,
+  const cpj_char_t **expected, cpj_size_t count
+)
+{
+  cpj_size_t i;
+
+  if (offsets[0] != 0 || offsets[count] != length || buffer[length] != '\0') {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < count; ++i) {
+    cpj_size_t size = offsets[i + 1] - offsets[i];
+    if (size != cpj_strlen(expected[i]) ||
+        memcmp(buffer + offsets[i], expected[i], size) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int column_normalize(void)
+{
+  const cpj_char_t *paths[] = {"/var/./log//", "", "a/../..", "/x/y/../z"};
+  const cpj_char_t *expected[] = {"/var/log", ".", "..", "/x/z"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_column_t column;
+  cpj_size_t length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  length = cpj_path_normalize_column(CPJ_STYLE_UNIX, &column, buffer, sizeof(buffer),
+    result_offsets);
+
+  return column_check(buffer, length, result_offsets, expected, ARRAY_SIZE(paths));
+}
+
+int column_join(void)
+{
+  const cpj_char_t *paths[] = {"file.txt", "../other", "", "/absolute"};
+  const cpj_char_t *expected[] = {"/base/dir/file.txt", "/base/other", "/base/dir",
+    "/base/dir/absolute"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_t base = cpj_string_create(CPJ_ZSTR_ARG("/base/dir/"));
+  cpj_string_column_t column;
+  cpj_size_t length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  length = cpj_path_join_column(CPJ_STYLE_UNIX, &base, &column, buffer, sizeof(buffer),
+    result_offsets);
+
+  return column_check(buffer, length, result_offsets, expected, ARRAY_SIZE(paths));
+}
+
+int column_relative(void)
+{
+  const cpj_char_t *paths[] = {"/dev/foo/bar", "/dev/baz", "/dev/foo"};
+  const cpj_char_t *expected[] = {"bar", "../baz", "."};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_t cwd = cpj_string_create(CPJ_ZSTR_ARG("/"));
+  cpj_string_t base = cpj_string_create(CPJ_ZSTR_ARG("/dev/foo"));
+  cpj_string_column_t column;
+  cpj_size_t length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  length = cpj_path_get_relative_column(CPJ_STYLE_UNIX, &cwd, &base, &column, buffer,
+    sizeof(buffer), result_offsets);
+
+  return column_check(buffer, length, result_offsets, expected, ARRAY_SIZE(paths));
+}
+
+int column_change_extension(void)
+{
+  const cpj_char_t *paths[] = {"/a/b.png", "c", "d.tar.png"};
+  const cpj_char_t *expected[] = {"/a/b.ktx2", "c.ktx2", "d.tar.ktx2"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_t extension = cpj_string_create(CPJ_ZSTR_ARG(".ktx2"));
+  cpj_string_column_t column;
+  cpj_size_t length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  length = cpj_path_change_extension_column(CPJ_STYLE_UNIX, &column, &extension, buffer,
+    sizeof(buffer), result_offsets);
+
+  return column_check(buffer, length, result_offsets, expected, ARRAY_SIZE(paths));
+}
+
+int column_guess_style(void)
+{
+  const cpj_char_t *paths[] = {"C:", "/a", "file.txt", "", "a\\b"};
+  cpj_path_style_t expected[] = {CPJ_STYLE_WINDOWS, CPJ_STYLE_UNIX, CPJ_STYLE_WINDOWS,
+    CPJ_STYLE_UNIX, CPJ_STYLE_WINDOWS};
+  cpj_path_style_t styles[ARRAY_SIZE(paths)];
+  cpj_char_t data[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  cpj_path_guess_style_column(&column, styles);
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (styles[i] != expected[i]) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int column_unterminated(void)
+{
+  // Without terminators the root of "C:" would run into the separator of the
+  // next string and "\\server\" would swallow the share name behind it.
+  const cpj_char_t *paths[] = {"C:", "\\x", "\\\\server\\", "share"};
+  const cpj_char_t *expected[] = {"C:.", "\\x", "\\\\server\\", "share"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_column_t column;
+  cpj_size_t length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  length = cpj_path_normalize_column(CPJ_STYLE_WINDOWS, &column, buffer, sizeof(buffer),
+    result_offsets);
+
+  return column_check(buffer, length, result_offsets, expected, ARRAY_SIZE(paths));
+}
+
+int column_upper_bound(void)
+{
+  const cpj_char_t *paths[] = {"", "a/../b", "/c/d/", "..", "e"};
+  cpj_char_t data[FILENAME_MAX], *buffer;
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_t cwd = cpj_string_create(CPJ_ZSTR_ARG("/home"));
+  cpj_string_t base = cpj_string_create(CPJ_ZSTR_ARG("x/y/z"));
+  cpj_string_t extension = cpj_string_create(CPJ_ZSTR_ARG("txt"));
+  cpj_string_column_t column;
+  cpj_size_t buffer_size, length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+
+  buffer_size = cpj_path_normalize_column(CPJ_STYLE_UNIX, &column, NULL, 0, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_path_normalize_column(CPJ_STYLE_UNIX, &column, buffer, buffer_size,
+    result_offsets);
+  free(buffer);
+  if (length >= buffer_size) {
+    return EXIT_FAILURE;
+  }
+
+  buffer_size = cpj_path_join_column(CPJ_STYLE_UNIX, &base, &column, NULL, 0, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_path_join_column(CPJ_STYLE_UNIX, &base, &column, buffer, buffer_size,
+    result_offsets);
+  free(buffer);
+  if (length >= buffer_size) {
+    return EXIT_FAILURE;
+  }
+
+  buffer_size = cpj_path_get_relative_column(CPJ_STYLE_UNIX, &cwd, &base, &column, NULL,
+    0, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_path_get_relative_column(CPJ_STYLE_UNIX, &cwd, &base, &column, buffer,
+    buffer_size, result_offsets);
+  free(buffer);
+  if (length >= buffer_size) {
+    return EXIT_FAILURE;
+  }
+
+  buffer_size = cpj_path_change_extension_column(CPJ_STYLE_UNIX, &column, &extension,
+    NULL, 0, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_path_change_extension_column(CPJ_STYLE_UNIX, &column, &extension, buffer,
+    buffer_size, result_offsets);
+  free(buffer);
+  if (length >= buffer_size) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int column_truncated(void)
+{
+  const cpj_char_t *paths[] = {"/first/path", "/second/path"};
+  cpj_char_t data[FILENAME_MAX], buffer[8];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_column_t column;
+  cpj_size_t length;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  length = cpj_path_normalize_column(CPJ_STYLE_UNIX, &column, buffer, sizeof(buffer),
+    result_offsets);
+
+  if (length != strlen("/first/path/second/path")) {
+    return EXIT_FAILURE;
+  }
+
+  if (result_offsets[1] != strlen("/first/path") || result_offsets[2] != length) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "/first/") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
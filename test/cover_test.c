@@ -0,0 +1,111 @@
+#include "cpj_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static int cover_check(
+  cpj_path_style_t style, const cpj_char_t **paths, cpj_size_t count,
+  cpj_size_t max_roots, double max_waste, const cpj_char_t **expected,
+  cpj_size_t expected_count
+)
+{
+  cpj_string_t strings[32], roots[32];
+  cpj_size_t i, root_count;
+
+  for (i = 0; i < count; ++i) {
+    strings[i] = cpj_string_create(paths[i], cpj_strlen(paths[i]));
+  }
+  cpj_path_sort(style, strings, count, CPJ_SORT_DEFAULT);
+
+  root_count = cpj_path_minimal_cover(style, strings, count, max_roots,
+    max_waste, roots);
+  if (root_count != expected_count) {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < root_count; ++i) {
+    if (roots[i].size != cpj_strlen(expected[i]) ||
+        memcmp(roots[i].ptr, expected[i], roots[i].size) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int cover_topmost(void)
+{
+  const cpj_char_t *paths[] = {"/src/net/a.c", "/src", "/docs/a.md",
+    "/src/b.c", "/docs-old"};
+  const cpj_char_t *expected[] = {"/docs/a.md", "/docs-old", "/src"};
+
+  return cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 8, 1.0,
+    expected, ARRAY_SIZE(expected));
+}
+
+int cover_merge(void)
+{
+  const cpj_char_t *paths[] = {"/a/b/c/x", "/a/b/c/y", "/a/b/d/z", "/a/e/f",
+    "/g/h"};
+  const cpj_char_t *expected_four[] = {"/a/b/c", "/a/b/d/z", "/a/e/f", "/g/h"};
+  const cpj_char_t *expected_three[] = {"/a/b", "/a/e/f", "/g/h"};
+  const cpj_char_t *expected_two[] = {"/a", "/g/h"};
+  const cpj_char_t *expected_one[] = {"/"};
+
+  if (cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 4, 1.0,
+        expected_four, ARRAY_SIZE(expected_four)) != EXIT_SUCCESS ||
+      cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 3, 1.0,
+        expected_three, ARRAY_SIZE(expected_three)) != EXIT_SUCCESS ||
+      cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 2, 1.0,
+        expected_two, ARRAY_SIZE(expected_two)) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 1, 1.0,
+    expected_one, ARRAY_SIZE(expected_one));
+}
+
+int cover_waste(void)
+{
+  // The paths may lose half of their segments, so "/a/e/f" may not move
+  // further up than "/a/e" and nothing may move up to the root.
+  const cpj_char_t *paths[] = {"/a/b/c/x", "/a/b/c/y", "/a/b/d/z", "/a/e/f",
+    "/g/h"};
+  const cpj_char_t *expected[] = {"/a/b", "/a/e/f", "/g/h"};
+  const cpj_char_t *expected_none[] = {"/a/b/c/x", "/a/b/c/y", "/a/b/d/z",
+    "/a/e/f", "/g/h"};
+
+  if (cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 1, 0.5, expected,
+        ARRAY_SIZE(expected)) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 1, 0.0,
+    expected_none, ARRAY_SIZE(expected_none));
+}
+
+int cover_roots(void)
+{
+  // Paths with different roots are never merged.
+  const cpj_char_t *paths[] = {"a/x", "a/y", "b", "/c/d", "/e"};
+  const cpj_char_t *expected[] = {".", "/"};
+
+  return cover_check(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 1, 1.0,
+    expected, ARRAY_SIZE(expected));
+}
+
+int cover_windows(void)
+{
+  const cpj_char_t *paths[] = {"C:\\Data\\a", "c:\\data\\b", "D:\\x",
+    "D:\\y"};
+  const cpj_char_t *expected[] = {"C:\\Data", "D:\\"};
+
+  return cover_check(CPJ_STYLE_WINDOWS, paths, ARRAY_SIZE(paths), 2, 1.0,
+    expected, ARRAY_SIZE(expected));
+}
+
+int cover_empty(void)
+{
+  return cover_check(CPJ_STYLE_UNIX, NULL, 0, 0, 1.0, NULL, 0);
+}
@@ -262,3 +262,28 @@ static inline cpj_size_t cpj_path_get_relative_test(
     path_style, &path_cwd, &base_directory_str, &path_str, buffer, buffer_size
   );
 }
+
+#ifndef _WIN32
+/**
+ * Creates a temporary tree below `root`, which holds a template for mkdtemp
+ * and receives the name of the tree. The paths are added like
+ * cpj_test_tree_add does.
+ */
+bool cpj_test_tree_create(
+  cpj_char_t *root, const cpj_char_t **paths, cpj_size_t count
+);
+
+/**
+ * Adds paths to a tree. Paths ending with a separator become directories,
+ * paths containing a '>' become symbolic links to whatever follows it, and
+ * the others become empty files.
+ */
+bool cpj_test_tree_add(
+  const cpj_char_t *root, const cpj_char_t **paths, cpj_size_t count
+);
+
+/**
+ * Removes a tree along with everything in it.
+ */
+void cpj_test_tree_remove(const cpj_char_t *root);
+#endif
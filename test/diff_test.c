@@ -0,0 +1,150 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static cpj_string_column_t column_create(
+  const cpj_char_t **strings, cpj_size_t count, cpj_char_t *data,
+  cpj_size_t *offsets
+)
+{
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  offsets[0] = 0;
+  for (i = 0; i < count; ++i) {
+    cpj_size_t size = cpj_strlen(strings[i]);
+    memcpy(data + offsets[i], strings[i], size);
+    offsets[i + 1] = offsets[i] + size;
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = count;
+  return column;
+}
+
+/**
+ * Runs a diff and compares the entries with the expected ones. An entry is
+ * written as its type, which is one of `-`, `+` or `=`, followed by the path
+ * and the number of paths if there is more than one.
+ */
+static int diff_check(
+  cpj_path_style_t style, const cpj_char_t **old_paths, cpj_size_t old_count,
+  const cpj_char_t **new_paths, cpj_size_t new_count, unsigned int flags,
+  const cpj_char_t **expected, cpj_size_t expected_count
+)
+{
+  static const char types[] = {'-', '+', '='};
+  cpj_char_t old_data[FILENAME_MAX], new_data[FILENAME_MAX];
+  cpj_size_t old_offsets[32], new_offsets[32];
+  cpj_string_column_t old_column, new_column;
+  cpj_path_diff_t diff;
+  cpj_path_diff_entry_t entry;
+  char buffer[FILENAME_MAX];
+  cpj_size_t i = 0;
+
+  old_column = column_create(old_paths, old_count, old_data, old_offsets);
+  new_column = column_create(new_paths, new_count, new_data, new_offsets);
+  cpj_path_diff_sorted(&diff, style, &old_column, &new_column, flags);
+  while (cpj_path_diff_next(&diff, &entry)) {
+    if (entry.count > 1) {
+      snprintf(buffer, sizeof(buffer), "%c%.*s:%u", types[entry.type],
+        (int)entry.path.size, entry.path.ptr, (unsigned int)entry.count);
+    } else {
+      snprintf(buffer, sizeof(buffer), "%c%.*s", types[entry.type],
+        (int)entry.path.size, entry.path.ptr);
+    }
+    if (i >= expected_count || strcmp(buffer, expected[i]) != 0) {
+      return EXIT_FAILURE;
+    }
+    ++i;
+  }
+
+  return i == expected_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int diff_merge(void)
+{
+  const cpj_char_t *old_paths[] = {"a", "a/b", "c", "/etc/hosts"};
+  const cpj_char_t *new_paths[] = {"a", "a/c", "a-b", "/", "/etc/hosts"};
+  const cpj_char_t *expected[] = {"=a", "-a/b", "+a/c", "+a-b", "-c", "+/",
+    "=/etc/hosts"};
+
+  return diff_check(CPJ_STYLE_UNIX, old_paths, ARRAY_SIZE(old_paths), new_paths,
+    ARRAY_SIZE(new_paths), CPJ_DIFF_DEFAULT, expected, ARRAY_SIZE(expected));
+}
+
+int diff_skip_common(void)
+{
+  const cpj_char_t *old_paths[] = {"a", "b", "c"};
+  const cpj_char_t *new_paths[] = {"a", "c", "d"};
+  const cpj_char_t *expected[] = {"-b", "+d"};
+
+  return diff_check(CPJ_STYLE_UNIX, old_paths, ARRAY_SIZE(old_paths), new_paths,
+    ARRAY_SIZE(new_paths), CPJ_DIFF_SKIP_COMMON, expected,
+    ARRAY_SIZE(expected));
+}
+
+int diff_collapse(void)
+{
+  const cpj_char_t *old_paths[] = {"src", "src/a.c", "src/net", "src/net/b.c",
+    "src/net/c.c", "src/net.c"};
+  const cpj_char_t *new_paths[] = {"src", "src/a.c", "src/net.c", "tests",
+    "tests/a.c"};
+  const cpj_char_t *expected[] = {"=src", "=src/a.c", "-src/net:3", "=src/net.c",
+    "+tests:2"};
+
+  return diff_check(CPJ_STYLE_UNIX, old_paths, ARRAY_SIZE(old_paths), new_paths,
+    ARRAY_SIZE(new_paths), CPJ_DIFF_COLLAPSE, expected, ARRAY_SIZE(expected));
+}
+
+int diff_collapse_implied(void)
+{
+  // The directories are not part of the lists, so the topmost directory
+  // which only contains changes is reported.
+  const cpj_char_t *old_paths[] = {"a/b/c/x", "a/b/c/y", "a/b/d", "e/f"};
+  const cpj_char_t *new_paths[] = {"a/b/d", "a/g"};
+  const cpj_char_t *expected[] = {"-a/b/c:2", "=a/b/d", "+a/g", "-e"};
+
+  return diff_check(CPJ_STYLE_UNIX, old_paths, ARRAY_SIZE(old_paths), new_paths,
+    ARRAY_SIZE(new_paths), CPJ_DIFF_COLLAPSE, expected, ARRAY_SIZE(expected));
+}
+
+int diff_collapse_partial(void)
+{
+  // A directory which still has a common path below it is not collapsed.
+  const cpj_char_t *old_paths[] = {"a", "a/b", "a/c"};
+  const cpj_char_t *new_paths[] = {"a/b"};
+  const cpj_char_t *expected[] = {"-a", "=a/b", "-a/c"};
+
+  return diff_check(CPJ_STYLE_UNIX, old_paths, ARRAY_SIZE(old_paths), new_paths,
+    ARRAY_SIZE(new_paths), CPJ_DIFF_COLLAPSE, expected, ARRAY_SIZE(expected));
+}
+
+int diff_windows(void)
+{
+  const cpj_char_t *old_paths[] = {"c:\\Data", "C:\\data\\X.txt"};
+  const cpj_char_t *new_paths[] = {"C:\\DATA", "c:\\data\\x.TXT", "D:\\y"};
+  const cpj_char_t *expected[] = {"=C:\\DATA", "=c:\\data\\x.TXT", "+D:\\y"};
+
+  return diff_check(CPJ_STYLE_WINDOWS, old_paths, ARRAY_SIZE(old_paths),
+    new_paths, ARRAY_SIZE(new_paths), CPJ_DIFF_DEFAULT, expected,
+    ARRAY_SIZE(expected));
+}
+
+int diff_empty(void)
+{
+  const cpj_char_t *new_paths[] = {"/", "/a", "/b/c"};
+  const cpj_char_t *expected[] = {"+/:3"};
+
+  if (diff_check(CPJ_STYLE_UNIX, NULL, 0, NULL, 0, CPJ_DIFF_COLLAPSE, NULL,
+        0) != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return diff_check(CPJ_STYLE_UNIX, NULL, 0, new_paths, ARRAY_SIZE(new_paths),
+    CPJ_DIFF_COLLAPSE, expected, ARRAY_SIZE(expected));
+}
@@ -0,0 +1,126 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static bool escapes(cpj_path_style_t path_style, const cpj_char_t *path)
+{
+  cpj_string_t path_string = cpj_string_create(path, cpj_strlen(path));
+  return cpj_path_escapes_root(path_style, &path_string);
+}
+
+static bool depth_reached(const cpj_char_t *path, cpj_size_t max_depth)
+{
+  cpj_string_t path_string = cpj_string_create(path, cpj_strlen(path));
+  return cpj_path_max_depth_reached(CPJ_STYLE_UNIX, &path_string, max_depth);
+}
+
+int escape_relative(void)
+{
+  if (!escapes(CPJ_STYLE_UNIX, "..") || !escapes(CPJ_STYLE_UNIX, "a/../../b") ||
+      !escapes(CPJ_STYLE_UNIX, "./a/./../..")) {
+    return EXIT_FAILURE;
+  }
+
+  if (escapes(CPJ_STYLE_UNIX, "a/b/../../c") || escapes(CPJ_STYLE_UNIX, "") ||
+      escapes(CPJ_STYLE_UNIX, "a//b/..")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int escape_dot_names(void)
+{
+  // Only `..` itself climbs up, names made of dots are normal segments.
+  if (escapes(CPJ_STYLE_UNIX, "...") || escapes(CPJ_STYLE_UNIX, "..a/..") ||
+      escapes(CPJ_STYLE_UNIX, "a../..")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int escape_absolute(void)
+{
+  // Normalizing drops these `..` segments, which is exactly what hides them.
+  if (!escapes(CPJ_STYLE_UNIX, "/..") || !escapes(CPJ_STYLE_UNIX, "/a/../..")) {
+    return EXIT_FAILURE;
+  }
+
+  if (escapes(CPJ_STYLE_UNIX, "/a/b/..")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int escape_windows(void)
+{
+  if (!escapes(CPJ_STYLE_WINDOWS, "a\\..\\..") || !escapes(CPJ_STYLE_WINDOWS, "C:..") ||
+      !escapes(CPJ_STYLE_WINDOWS, "\\\\server\\share\\..")) {
+    return EXIT_FAILURE;
+  }
+
+  // Backslashes are no separators for unix paths.
+  if (escapes(CPJ_STYLE_UNIX, "a\\..\\..")) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int escape_max_depth(void)
+{
+  if (!depth_reached("a/b/c", 3) || depth_reached("a/b/c", 4) ||
+      !depth_reached("a/b/../c", 2) || depth_reached("a/./b/../c", 3)) {
+    return EXIT_FAILURE;
+  }
+
+  if (!depth_reached("../a", 1) || depth_reached("../../a", 2) ||
+      !depth_reached("/x", 1) || !depth_reached("", 0)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int escape_column(void)
+{
+  const cpj_char_t *paths[] = {"a/b.txt", "../etc/passwd", "a/../b", "x/../../y",
+    "..."};
+  const bool expected[] = {false, true, false, true, false};
+  bool results[ARRAY_SIZE(paths)];
+  cpj_char_t data[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  offsets[0] = 0;
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    memcpy(data + offsets[i], paths[i], strlen(paths[i]));
+    offsets[i + 1] = offsets[i] + strlen(paths[i]);
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = ARRAY_SIZE(paths);
+
+  if (cpj_path_escapes_root_column(CPJ_STYLE_UNIX, &column, results) != 2) {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (results[i] != expected[i]) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (cpj_path_escapes_root_column(CPJ_STYLE_UNIX, &column, NULL) != 2) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
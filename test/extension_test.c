@@ -4,6 +4,65 @@
 #include <stdlib.h>
 #include <string.h>
 
+int extension_change_size_query(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+
+  // The size and the result do not depend on the size of the buffer.
+  if (cpj_path_change_extension_test(CPJ_STYLE_UNIX, "/folder/..", "md", NULL, 0) != 4 ||
+      cpj_path_change_extension_test(CPJ_STYLE_UNIX, "/folder/..", "md", buffer, 5) != 4 ||
+      strcmp(buffer, "/.md") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_change_extension_test(CPJ_STYLE_UNIX, "/folder/..", "md", buffer, 3) != 4 ||
+      strcmp(buffer, "/.") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_change_extension_test(CPJ_STYLE_WINDOWS, "a\\.hidden", "", NULL, 0) != 1 ||
+      cpj_path_change_extension_test(CPJ_STYLE_WINDOWS, "a\\.hidden", "", buffer, 2) != 1 ||
+      strcmp(buffer, "a") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int extension_change_parent_of_root(void)
+{
+  cpj_char_t buffer[FILENAME_MAX] = "/folder/..";
+  cpj_size_t n;
+
+  n = cpj_path_change_extension_test(CPJ_STYLE_UNIX, buffer, "md", buffer, sizeof(buffer));
+  if (n != 4) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp("/.md", buffer) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int extension_change_remove_last(void)
+{
+  cpj_char_t buffer[FILENAME_MAX] = "C:/folder//file.tar.gz";
+  cpj_size_t n;
+
+  n = cpj_path_change_extension_test(CPJ_STYLE_WINDOWS, buffer, "", buffer, sizeof(buffer));
+  if (n != 18) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp("C:\\folder\\file.tar", buffer) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int extension_change_with_trailing_slash(void)
 {
   cpj_char_t buffer[FILENAME_MAX] = "/folder/file.txt/";
@@ -0,0 +1,457 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_test.h"
+#include <errno.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <limits.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**
+ * A cache along with its storage, which is large enough for every test.
+ */
+struct fs_context
+{
+  cpj_fs_cache_t cache;
+  void *storage;
+  cpj_char_t root[64];
+};
+
+static bool fs_create(struct fs_context *context, const cpj_char_t **paths,
+  cpj_size_t count)
+{
+  context->storage = malloc(cpj_fs_cache_storage_size(64, 4096));
+  cpj_fs_cache_init(&context->cache, context->storage, 64, 4096);
+  strcpy(context->root, "/tmp/cpj_fs_XXXXXX");
+  return cpj_test_tree_create(context->root, paths, count);
+}
+
+static void fs_remove(struct fs_context *context)
+{
+  cpj_test_tree_remove(context->root);
+  free(context->storage);
+}
+
+/**
+ * Resolves a path below the root of the tree, and returns 0 with errno set if
+ * that fails.
+ */
+static cpj_size_t fs_resolve(struct fs_context *context,
+  const cpj_char_t *path, cpj_char_t *buffer, cpj_size_t buffer_size)
+{
+  cpj_char_t full[256];
+  cpj_string_t string;
+
+  string.ptr = full;
+  string.size = (cpj_size_t)snprintf(full, sizeof(full), "%s/%s",
+    context->root, path);
+  return cpj_fs_resolve(&context->cache, &string, buffer, buffer_size);
+}
+
+/**
+ * Checks that a path resolves to the same path as realpath(3) returns.
+ */
+static bool fs_is_real(struct fs_context *context, const cpj_char_t *path)
+{
+  cpj_char_t full[256], expected[PATH_MAX], buffer[PATH_MAX];
+  cpj_size_t size;
+
+  snprintf(full, sizeof(full), "%s/%s", context->root, path);
+  size = fs_resolve(context, path, buffer, sizeof(buffer));
+  return realpath(full, expected) && size == strlen(expected) &&
+         strcmp(buffer, expected) == 0;
+}
+
+static const cpj_char_t *fs_paths[] = {"a/", "a/b/", "a/b/c.txt", "a/d.txt",
+  "e/", "a/up>..", "a/down>b/c.txt", "a/link>b", "e/chain>../a/link",
+  "e/absolute>/tmp", "loop>loop", "broken>missing", "file"};
+#endif
+
+int fs_resolve_real(void)
+{
+#ifndef _WIN32
+  static const cpj_char_t *paths[] = {"a", "a/b/c.txt", "a/./b/../d.txt",
+    "a/up", "a/up/a/b", "a/down", "a/link/..", "a/link/../d.txt",
+    "e/chain/c.txt", "e/chain/../../e", "e/absolute", "e/absolute/..",
+    "//a///b//", "a/up/a/up/a/link/c.txt"};
+  struct fs_context context;
+  cpj_size_t i;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (!fs_is_real(&context, paths[i])) {
+      goto done;
+    }
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_relative(void)
+{
+#ifndef _WIN32
+  cpj_char_t cwd[PATH_MAX], buffer[PATH_MAX], expected[PATH_MAX];
+  struct fs_context context;
+  cpj_string_t path = {CPJ_ZSTR_ARG("a/link/../d.txt")};
+  int status = EXIT_FAILURE;
+
+  if (!getcwd(cwd, sizeof(cwd))) {
+    return EXIT_FAILURE;
+  }
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths)) ||
+      chdir(context.root) != 0) {
+    goto done;
+  }
+
+  // Relative paths continue at the current working directory.
+  if (!realpath(path.ptr, expected) ||
+      cpj_fs_resolve(&context.cache, &path, buffer, sizeof(buffer)) !=
+        strlen(expected) ||
+      strcmp(buffer, expected) != 0) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  if (chdir(cwd) != 0) {
+    status = EXIT_FAILURE;
+  }
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_cached(void)
+{
+#ifndef _WIN32
+  cpj_char_t buffer[PATH_MAX];
+  struct fs_context context;
+  cpj_size_t probe_count;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths)) ||
+      fs_resolve(&context, "a/link/c.txt", buffer, sizeof(buffer)) == 0) {
+    goto done;
+  }
+
+  // The second lookup and the shared prefixes are answered by the cache.
+  probe_count = context.cache.probe_count;
+  if (fs_resolve(&context, "a/link/c.txt", buffer, sizeof(buffer)) == 0 ||
+      fs_resolve(&context, "a/b", buffer, sizeof(buffer)) == 0 ||
+      context.cache.probe_count != probe_count ||
+      fs_resolve(&context, "a/d.txt", buffer, sizeof(buffer)) == 0 ||
+      context.cache.probe_count != probe_count + 1) {
+    goto done;
+  }
+
+  // Changes on disk are only noticed after invalidating the cache.
+  snprintf(buffer, sizeof(buffer), "%s/a/link", context.root);
+  if (remove(buffer) != 0 ||
+      fs_resolve(&context, "a/link/c.txt", buffer, sizeof(buffer)) == 0) {
+    goto done;
+  }
+  cpj_fs_cache_invalidate(&context.cache);
+  errno = 0;
+  if (fs_resolve(&context, "a/link/c.txt", buffer, sizeof(buffer)) != 0 ||
+      errno != ENOENT) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_overflow(void)
+{
+#ifndef _WIN32
+  cpj_char_t buffer[PATH_MAX], name[16];
+  struct fs_context context;
+  cpj_size_t i;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+
+  // A full cache starts over instead of failing.
+  for (i = 0; i < 200; ++i) {
+    snprintf(name, sizeof(name), "a/../a/x%d", (int)i);
+    errno = 0;
+    if (fs_resolve(&context, name, buffer, sizeof(buffer)) != 0 ||
+        errno != ENOENT ||
+        context.cache.entry_count * 2 > context.cache.slot_count) {
+      goto done;
+    }
+  }
+  if (!fs_is_real(&context, "a/link/../d.txt")) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_errors(void)
+{
+#ifndef _WIN32
+  static const struct
+  {
+    const cpj_char_t *path;
+    int error;
+  } cases[] = {{"missing/a", ENOENT}, {"broken", ENOENT},
+    {"loop/a", ELOOP}, {"file/a", ENOTDIR}, {"file/", ENOTDIR},
+    {"a/down/", ENOTDIR}, {"a/d.txt/..", ENOTDIR}};
+  cpj_char_t buffer[PATH_MAX];
+  struct fs_context context;
+  cpj_string_t empty = {"", 0};
+  cpj_size_t i, round;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+
+  // Failures are cached as well, so the second round reports the same.
+  for (round = 0; round < 2; ++round) {
+    for (i = 0; i < ARRAY_SIZE(cases); ++i) {
+      errno = 0;
+      if (fs_resolve(&context, cases[i].path, buffer, sizeof(buffer)) != 0 ||
+          errno != cases[i].error) {
+        goto done;
+      }
+    }
+  }
+  errno = 0;
+  if (cpj_fs_resolve(&context.cache, &empty, buffer, sizeof(buffer)) != 0 ||
+      errno != ENOENT) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_too_small(void)
+{
+#ifndef _WIN32
+  cpj_char_t buffer[PATH_MAX], small[8];
+  struct fs_context context;
+  cpj_size_t size;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+
+  // The size is returned, but nothing is written if it does not fit.
+  size = fs_resolve(&context, "a/down", buffer, sizeof(buffer));
+  memset(small, 'x', sizeof(small));
+  if (size == 0 ||
+      fs_resolve(&context, "a/down", small, sizeof(small)) != size ||
+      small[0] != 'x' || fs_resolve(&context, "a/down", buffer, size) != size) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_stat(void)
+{
+#ifndef _WIN32
+  static const cpj_char_t *paths[] = {"a", "a/b/c.txt", "a/d.txt", "a/down",
+    "a/link", "a/missing", "broken", "file", "loop"};
+  cpj_char_t data[1024], path[256];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 2], i;
+  int errors[ARRAY_SIZE(paths) + 1];
+  cpj_walk_type_t types[ARRAY_SIZE(paths) + 1];
+  unsigned long long sizes[ARRAY_SIZE(paths) + 1];
+  long long mtimes[ARRAY_SIZE(paths) + 1];
+  cpj_fs_stat_column_t results = {errors, types, sizes, mtimes};
+  cpj_string_column_t column = {data, offsets, ARRAY_SIZE(paths) + 1};
+  struct fs_context context;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+  offsets[0] = 0;
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    offsets[i + 1] = offsets[i] +
+                     (cpj_size_t)sprintf(data + offsets[i], "%s/%s",
+                       context.root, paths[i]);
+  }
+  offsets[i + 1] = offsets[i] + (cpj_size_t)sprintf(data + offsets[i], "/");
+  snprintf(path, sizeof(path), "%s/a/d.txt", context.root);
+  if (truncate(path, 5) != 0) {
+    goto done;
+  }
+
+  // Links are followed, unless they are asked for.
+  if (cpj_fs_stat_column(&column, CPJ_FS_STAT_DEFAULT, &results) != 7 ||
+      types[0] != CPJ_WALK_DIRECTORY || types[1] != CPJ_WALK_FILE ||
+      sizes[2] != 5 || mtimes[2] <= 0 || types[3] != CPJ_WALK_FILE ||
+      types[4] != CPJ_WALK_DIRECTORY || errors[5] != ENOENT ||
+      types[5] != CPJ_WALK_OTHER || mtimes[5] != 0 || errors[6] != ENOENT ||
+      errors[7] != 0 || errors[8] != ELOOP ||
+      types[9] != CPJ_WALK_DIRECTORY) {
+    goto done;
+  }
+  if (cpj_fs_stat_column(&column, CPJ_FS_STAT_NO_FOLLOW, &results) != 9 ||
+      types[3] != CPJ_WALK_SYMLINK || types[4] != CPJ_WALK_SYMLINK ||
+      types[6] != CPJ_WALK_SYMLINK || types[2] != CPJ_WALK_FILE) {
+    goto done;
+  }
+
+  // Columns which are not needed can be left out.
+  results.types = NULL;
+  results.sizes = NULL;
+  results.mtimes = NULL;
+  if (cpj_fs_stat_column(&column, CPJ_FS_STAT_DEFAULT, &results) != 7 ||
+      errors[5] != ENOENT) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_stat_parallel(void)
+{
+#ifndef _WIN32
+  static cpj_char_t data[4000 * 64];
+  static cpj_size_t offsets[4001];
+  static int errors[4000], expected[4000];
+  cpj_fs_stat_column_t results = {errors, NULL, NULL, NULL};
+  cpj_string_column_t column = {data, offsets, 4000};
+  struct fs_context context;
+  cpj_size_t i, found_count = 0;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+
+  // Every third path is missing, and the others are spread over two
+  // directories, so batches start in the middle of a directory.
+  offsets[0] = 0;
+  for (i = 0; i < 4000; ++i) {
+    offsets[i + 1] = offsets[i] +
+                     (cpj_size_t)sprintf(data + offsets[i], "%s/%s",
+                       context.root,
+                       i % 3 == 0   ? "a/x"
+                       : i % 2 == 0 ? "a/b/c.txt"
+                                    : "a/b");
+    expected[i] = i % 3 == 0 ? ENOENT : 0;
+    found_count += i % 3 != 0;
+  }
+  if (cpj_fs_stat_column(&column, CPJ_FS_STAT_PARALLEL, &results) !=
+        found_count ||
+      memcmp(errors, expected, sizeof(errors)) != 0) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int fs_stat_no_ring(void)
+{
+#ifndef _WIN32
+  static const cpj_char_t *paths[] = {"a", "a/b/c.txt", "a/d.txt", "a/down",
+    "a/link", "a/missing", "broken", "file", "loop"};
+  static cpj_char_t data[1000 * 64];
+  static cpj_size_t offsets[1001];
+  static int errors[2][1000];
+  static cpj_walk_type_t types[2][1000];
+  static unsigned long long sizes[2][1000];
+  static long long mtimes[2][1000];
+  static const unsigned int flags[] = {CPJ_FS_STAT_DEFAULT,
+    CPJ_FS_STAT_NO_FOLLOW, CPJ_FS_STAT_PARALLEL};
+  cpj_fs_stat_column_t results[2] = {
+    {errors[0], types[0], sizes[0], mtimes[0]},
+    {errors[1], types[1], sizes[1], mtimes[1]}};
+  cpj_string_column_t column = {data, offsets, 1000};
+  struct fs_context context;
+  cpj_size_t i;
+  int status = EXIT_FAILURE;
+
+  if (!fs_create(&context, fs_paths, ARRAY_SIZE(fs_paths))) {
+    goto done;
+  }
+
+  // The paths fill several windows of requests, and probing them through
+  // io_uring, where it is available, describes them just like fstatat.
+  offsets[0] = 0;
+  for (i = 0; i < 1000; ++i) {
+    offsets[i + 1] = offsets[i] +
+                     (cpj_size_t)sprintf(data + offsets[i], "%s/%s",
+                       context.root, paths[i / 7 % ARRAY_SIZE(paths)]);
+  }
+  for (i = 0; i < ARRAY_SIZE(flags); ++i) {
+    if (cpj_fs_stat_column(&column, flags[i], results) !=
+          cpj_fs_stat_column(&column, flags[i] | CPJ_FS_STAT_NO_RING,
+            results + 1) ||
+        memcmp(errors[0], errors[1], sizeof(errors[0])) != 0 ||
+        memcmp(types[0], types[1], sizeof(types[0])) != 0 ||
+        memcmp(sizes[0], sizes[1], sizeof(sizes[0])) != 0 ||
+        memcmp(mtimes[0], mtimes[1], sizeof(mtimes[0])) != 0) {
+      goto done;
+    }
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  fs_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
@@ -0,0 +1,168 @@
+#include "cpj_test.h"
+#include <stdlib.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**
+ * Compiles a pattern and checks every path against it. The paths which are
+ * expected to match come first, followed by the ones which must not match.
+ */
+static bool glob_check(
+  cpj_path_style_t style, const cpj_char_t *pattern,
+  const cpj_char_t **paths, cpj_size_t match_count, cpj_size_t count
+)
+{
+  cpj_glob_segment_t segments[16];
+  cpj_string_t string, path;
+  cpj_glob_t glob;
+  cpj_size_t i;
+
+  string.ptr = pattern;
+  string.size = cpj_strlen(pattern);
+  if (cpj_glob_compile(&glob, style, &string, segments,
+        ARRAY_SIZE(segments)) > ARRAY_SIZE(segments)) {
+    return false;
+  }
+
+  for (i = 0; i < count; ++i) {
+    path.ptr = paths[i];
+    path.size = cpj_strlen(paths[i]);
+    if (cpj_glob_match(&glob, &path) != (i < match_count)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int glob_literal(void)
+{
+  const cpj_char_t *paths[] = {"src/main.c", "src//main.c", "./src/./main.c",
+    "src/x/../main.c", "src/main.c/", "src/main.h", "/src/main.c",
+    "src/main.c/x", "main.c", "src/Main.c", ""};
+
+  if (!glob_check(CPJ_STYLE_UNIX, "src/main.c", paths, 5, ARRAY_SIZE(paths))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int glob_wildcard(void)
+{
+  const cpj_char_t *any[] = {"src/a.c", "src/.c", "src/x.y.c", "src/a.h",
+    "src/a/b.c", "a.c"};
+  const cpj_char_t *single[] = {"test_a.c", "test_..c", "test_.c",
+    "test_ab.c"};
+  const cpj_char_t *set[] = {"a1", "c9", "b0", "d1", "a", "ax"};
+  const cpj_char_t *negated[] = {"readme", "x", ".git", ""};
+  const cpj_char_t *special[] = {"*]", "]]", "x"};
+  const cpj_char_t *unclosed[] = {"[ab", "a"};
+
+  if (!glob_check(CPJ_STYLE_UNIX, "src/*.c", any, 3, ARRAY_SIZE(any)) ||
+      !glob_check(
+        CPJ_STYLE_UNIX, "test_?.c", single, 2, ARRAY_SIZE(single)
+      ) ||
+      !glob_check(CPJ_STYLE_UNIX, "[a-c][0-9]", set, 3, ARRAY_SIZE(set)) ||
+      !glob_check(CPJ_STYLE_UNIX, "[!.]*", negated, 2, ARRAY_SIZE(negated)) ||
+      !glob_check(CPJ_STYLE_UNIX, "[]*]]", special, 2, ARRAY_SIZE(special)) ||
+      !glob_check(CPJ_STYLE_UNIX, "[ab", unclosed, 1, ARRAY_SIZE(unclosed))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int glob_recursive(void)
+{
+  const cpj_char_t *test[] = {"src/test_a.c", "src/a/b/test_b.c",
+    "src/test_a.c/test_b.c", "src/a/b/test_b.h", "lib/test_a.c",
+    "src/test_a.c/x"};
+  const cpj_char_t *everything[] = {"", ".", "a", "a/b/c", "/a"};
+  const cpj_char_t *twice[] = {"a/b/c", "a/x/b/y/c", "a/b/b/c/c", "a/c/b",
+    "a/b"};
+  const cpj_char_t *root[] = {"/", "/a/b", "a"};
+
+  if (!glob_check(
+        CPJ_STYLE_UNIX, "src/**/test_*.c", test, 3, ARRAY_SIZE(test)
+      ) ||
+      !glob_check(
+        CPJ_STYLE_UNIX, "**", everything, 4, ARRAY_SIZE(everything)
+      ) ||
+      !glob_check(
+        CPJ_STYLE_UNIX, "a/**/b/**/**/c", twice, 3, ARRAY_SIZE(twice)
+      ) ||
+      !glob_check(CPJ_STYLE_UNIX, "/**", root, 2, ARRAY_SIZE(root))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int glob_normalized(void)
+{
+  const cpj_char_t *collapsed[] = {"a/b/d", "a/b/c/d"};
+  const cpj_char_t *parent[] = {"../a.c", "x/../../a.c", "../x/../a.c", "a.c",
+    "../../a.c"};
+  const cpj_char_t *absolute[] = {"/a", "/../a", "/x/../../a", "/x/a"};
+  const cpj_char_t *after_recursive[] = {"../x", "a/../x", "a/b/../x", "x",
+    "a/x"};
+
+  // A `..` within the pattern removes the segment before it, but not a `**`.
+  if (!glob_check(CPJ_STYLE_UNIX, "a/./b//c/../d", collapsed, 1,
+        ARRAY_SIZE(collapsed)) ||
+      !glob_check(CPJ_STYLE_UNIX, "../*.c", parent, 3, ARRAY_SIZE(parent)) ||
+      !glob_check(CPJ_STYLE_UNIX, "/../a", absolute, 3, ARRAY_SIZE(absolute)) ||
+      !glob_check(CPJ_STYLE_UNIX, "**/../x", after_recursive, 1,
+        ARRAY_SIZE(after_recursive))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int glob_windows(void)
+{
+  const cpj_char_t *text[] = {"c:/src/a/b.txt", "C:\\SRC\\x.Txt",
+    "C:\\src\\a.txt\\", "D:\\src\\x.txt", "src\\x.txt", "C:\\src\\x.txt2"};
+  const cpj_char_t *set[] = {"B.TXT", "a.txt", "d.txt"};
+  const cpj_char_t *network[] = {"\\\\Server\\Share\\a", "//server/share/a/b",
+    "\\\\server\\other\\a"};
+
+  if (!glob_check(
+        CPJ_STYLE_WINDOWS, "C:\\Src\\**\\*.TXT", text, 3, ARRAY_SIZE(text)
+      ) ||
+      !glob_check(CPJ_STYLE_WINDOWS, "[a-c].txt", set, 2, ARRAY_SIZE(set)) ||
+      !glob_check(CPJ_STYLE_WINDOWS, "\\\\server\\share\\**", network, 2,
+        ARRAY_SIZE(network))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int glob_too_small(void)
+{
+  cpj_glob_segment_t segments[3];
+  cpj_string_t pattern, path;
+  cpj_glob_t glob;
+
+  // The number of segments is returned even if they do not fit.
+  pattern.ptr = "/a/**/**/b/./c/";
+  pattern.size = cpj_strlen(pattern.ptr);
+  path.ptr = "/a/x/y/b";
+  path.size = cpj_strlen(path.ptr);
+  if (cpj_glob_compile(&glob, CPJ_STYLE_UNIX, &pattern, segments, 2) != 4 ||
+      cpj_glob_compile(&glob, CPJ_STYLE_UNIX, &pattern, NULL, 0) != 4) {
+    return EXIT_FAILURE;
+  }
+
+  pattern.ptr = "/a/**/b";
+  pattern.size = cpj_strlen(pattern.ptr);
+  if (cpj_glob_compile(&glob, CPJ_STYLE_UNIX, &pattern, segments, 3) != 3 ||
+      segments[1].type != CPJ_GLOB_RECURSIVE ||
+      segments[2].type != CPJ_GLOB_LITERAL || !cpj_glob_match(&glob, &path)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
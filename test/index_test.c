@@ -0,0 +1,148 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static const cpj_char_t *sorted_paths[] = {"build", "src", "src/net", "src/net/a.c",
+  "src/net/http/client.c", "src/net/http/server.c", "src/net-old", "src/net.c",
+  "/", "/etc", "/etc/hosts"};
+
+static cpj_char_t index_data[FILENAME_MAX];
+static cpj_size_t index_offsets[ARRAY_SIZE(sorted_paths) + 1];
+
+static cpj_path_index_t index_create(void)
+{
+  cpj_path_index_t index;
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  index_offsets[0] = 0;
+  for (i = 0; i < ARRAY_SIZE(sorted_paths); ++i) {
+    cpj_size_t size = strlen(sorted_paths[i]);
+    memcpy(index_data + index_offsets[i], sorted_paths[i], size);
+    index_offsets[i + 1] = index_offsets[i] + size;
+  }
+  column.data = index_data;
+  column.offsets = index_offsets;
+  column.count = ARRAY_SIZE(sorted_paths);
+  cpj_path_index_init(&index, CPJ_STYLE_UNIX, &column);
+  return index;
+}
+
+static cpj_size_t descendants(
+  const cpj_path_index_t *index, const cpj_char_t *path, cpj_size_t *first
+)
+{
+  cpj_string_t path_string = cpj_string_create(path, cpj_strlen(path));
+  return cpj_path_index_descendants_of(index, &path_string, first);
+}
+
+int index_sorted(void)
+{
+  const cpj_char_t *input[ARRAY_SIZE(sorted_paths)];
+  cpj_string_t paths[ARRAY_SIZE(sorted_paths)];
+  cpj_size_t i;
+
+  // The index relies on the order of cpj_path_sort.
+  for (i = 0; i < ARRAY_SIZE(sorted_paths); ++i) {
+    input[i] = sorted_paths[ARRAY_SIZE(sorted_paths) - 1 - i];
+    paths[i] = cpj_string_create(input[i], strlen(input[i]));
+  }
+  cpj_path_sort(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), CPJ_SORT_DEFAULT);
+  for (i = 0; i < ARRAY_SIZE(sorted_paths); ++i) {
+    if (paths[i].ptr != input[ARRAY_SIZE(sorted_paths) - 1 - i]) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int index_lookup(void)
+{
+  cpj_path_index_t index = index_create();
+  cpj_string_t net = cpj_string_create(CPJ_ZSTR_ARG("src/net"));
+  cpj_string_t hosts = cpj_string_create(CPJ_ZSTR_ARG("/etc/hosts"));
+  cpj_string_t missing = cpj_string_create(CPJ_ZSTR_ARG("src/net/b.c"));
+  cpj_size_t position;
+
+  if (!cpj_path_index_lookup(&index, &net, &position) || position != 2) {
+    return EXIT_FAILURE;
+  }
+
+  if (!cpj_path_index_lookup(&index, &hosts, &position) || position != 10) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_index_lookup(&index, &missing, &position) || position != 4) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int index_descendants(void)
+{
+  cpj_path_index_t index = index_create();
+  cpj_size_t first;
+
+  // A strcmp order would put `src/net-old` in between.
+  if (descendants(&index, "src/net", &first) != 3 || first != 3) {
+    return EXIT_FAILURE;
+  }
+
+  if (descendants(&index, "src", &first) != 6 || first != 2) {
+    return EXIT_FAILURE;
+  }
+
+  if (descendants(&index, "src/net.c", &first) != 0 || first != 8) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int index_descendants_of_root(void)
+{
+  cpj_path_index_t index = index_create();
+  cpj_size_t first;
+
+  if (descendants(&index, "/", &first) != 2 || first != 9) {
+    return EXIT_FAILURE;
+  }
+
+  if (descendants(&index, ".", &first) != 8 || first != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int index_children(void)
+{
+  cpj_path_index_t index = index_create();
+  cpj_string_t src = cpj_string_create(CPJ_ZSTR_ARG("src"));
+  cpj_string_t net = cpj_string_create(CPJ_ZSTR_ARG("src/net"));
+  cpj_string_t root = cpj_string_create(CPJ_ZSTR_ARG("."));
+  cpj_size_t children[8];
+
+  if (cpj_path_index_children_of(&index, &src, children, ARRAY_SIZE(children)) != 3 ||
+      children[0] != 2 || children[1] != 6 || children[2] != 7) {
+    return EXIT_FAILURE;
+  }
+
+  // The `http` directory is only implied by the files in it.
+  if (cpj_path_index_children_of(&index, &net, children, ARRAY_SIZE(children)) != 1 ||
+      children[0] != 3) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_index_children_of(&index, &root, children, 1) != 2 || children[0] != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -4,6 +4,56 @@
 #include <stdlib.h>
 #include <string.h>
 
+int join_dot_names(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t length;
+
+  length = cpj_path_join_test(CPJ_STYLE_UNIX, "a/b.", "..", buffer, sizeof(buffer));
+  if (length != 1 || strcmp(buffer, "a") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  length = cpj_path_join_test(CPJ_STYLE_WINDOWS, "C:\\a", ".b\\..\\c", buffer, sizeof(buffer));
+  if (length != 6 || strcmp(buffer, "C:\\a\\c") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int join_max_size(void)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_string_t paths[3];
+  cpj_size_t length, max_size;
+  const cpj_char_t *expected;
+
+  paths[0] = cpj_string_create(CPJ_ZSTR_ARG("C:"));
+  max_size = cpj_path_join_max_size(paths, 1);
+  expected = "C:.";
+  length = cpj_path_join_multiple(CPJ_STYLE_WINDOWS, false, true, paths, 1, buffer, max_size + 1);
+  if (length > max_size || length != strlen(expected) || strcmp(buffer, expected) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  paths[0] = cpj_string_create(CPJ_ZSTR_ARG("hello"));
+  paths[1] = cpj_string_create(CPJ_ZSTR_ARG("there"));
+  paths[2] = cpj_string_create(CPJ_ZSTR_ARG("world/"));
+  max_size = cpj_path_join_max_size(paths, 3);
+  expected = "hello/there/world/";
+  length = cpj_path_join_multiple(CPJ_STYLE_UNIX, false, false, paths, 3, buffer, max_size + 1);
+  if (length > max_size || length != strlen(expected) || strcmp(buffer, expected) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_join_max_size(NULL, 0) != 1) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int join_multiple(void)
 {
   cpj_char_t buffer[FILENAME_MAX];
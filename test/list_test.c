@@ -0,0 +1,249 @@
+#include "cpj_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static cpj_size_t list_write(
+  cpj_path_style_t style, const cpj_char_t **paths, cpj_size_t count,
+  cpj_size_t restart_interval, cpj_char_t *buffer, cpj_size_t buffer_size
+)
+{
+  cpj_path_list_writer_t writer;
+  cpj_char_t previous[FILENAME_MAX];
+  cpj_string_t path;
+  cpj_size_t i;
+
+  cpj_path_list_writer_init(&writer, style, restart_interval, buffer,
+    buffer_size, previous, sizeof(previous));
+  for (i = 0; i < count; ++i) {
+    path.ptr = paths[i];
+    path.size = cpj_strlen(paths[i]);
+    cpj_path_list_writer_add(&writer, &path);
+  }
+  return cpj_path_list_writer_finish(&writer);
+}
+
+static bool list_check_next(
+  cpj_path_list_reader_t *reader, const cpj_char_t *expected
+)
+{
+  cpj_string_t path;
+
+  return cpj_path_list_next(reader, &path) &&
+         path.size == cpj_strlen(expected) &&
+         strcmp(path.ptr, expected) == 0;
+}
+
+int list_roundtrip(void)
+{
+  const cpj_char_t *paths[] = {"/", "/etc", "/etc/hosts", "/etc/hosts.allow",
+    "/home/user", "/home/user/a.txt", "/home/user/b.txt", "relative/path"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t size, i;
+
+  size = list_write(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 3, data,
+    sizeof(data));
+  if (size > sizeof(data) || !cpj_path_list_open(&list, data, size) ||
+      list.count != ARRAY_SIZE(paths) || list.restart_count != 3 ||
+      list.path_style != CPJ_STYLE_UNIX || list.max_path_size != 16) {
+    return EXIT_FAILURE;
+  }
+
+  if (!cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer))) {
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (!list_check_next(&reader, paths[i])) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return cpj_path_list_next(&reader, &path) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int list_seek(void)
+{
+  const cpj_char_t *paths[] = {"a", "a/b", "a/b/c", "a/b/d", "a/e", "f"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t size, i;
+
+  size = list_write(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 4, data,
+    sizeof(data));
+  if (!cpj_path_list_open(&list, data, size) ||
+      !cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer))) {
+    return EXIT_FAILURE;
+  }
+
+  for (i = ARRAY_SIZE(paths); i > 0; --i) {
+    if (!cpj_path_list_seek(&reader, i - 1) ||
+        !list_check_next(&reader, paths[i - 1])) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!cpj_path_list_seek(&reader, ARRAY_SIZE(paths)) ||
+      cpj_path_list_next(&reader, &path) ||
+      cpj_path_list_seek(&reader, ARRAY_SIZE(paths) + 1)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int list_find(void)
+{
+  const cpj_char_t *paths[] = {"/a", "/a/b", "/a/b/c", "/a/d", "/a-b", "/b",
+    "/b/a", "/c"};
+  const cpj_char_t *searched[] = {"/", "/a", "/a/b/a", "/a/c", "/a/z", "/b",
+    "/d"};
+  const cpj_size_t expected[] = {0, 0, 2, 3, 4, 5, 8};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t size, i;
+
+  size = list_write(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 2, data,
+    sizeof(data));
+  if (!cpj_path_list_open(&list, data, size) ||
+      !cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer))) {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(searched); ++i) {
+    path.ptr = searched[i];
+    path.size = cpj_strlen(searched[i]);
+    if (cpj_path_list_find(&reader, &path) != expected[i]) {
+      return EXIT_FAILURE;
+    }
+    if (expected[i] < ARRAY_SIZE(paths)
+          ? !list_check_next(&reader, paths[expected[i]])
+          : cpj_path_list_next(&reader, &path)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int list_windows(void)
+{
+  const cpj_char_t *paths[] = {"C:\\Data", "c:\\data\\X.txt", "C:\\DATA\\y"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t size, i;
+
+  // The shared beginnings are compared exactly, so the case of every path is
+  // kept.
+  size = list_write(CPJ_STYLE_WINDOWS, paths, ARRAY_SIZE(paths), 16, data,
+    sizeof(data));
+  if (!cpj_path_list_open(&list, data, size) ||
+      list.path_style != CPJ_STYLE_WINDOWS ||
+      !cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer))) {
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (!list_check_next(&reader, paths[i])) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  path.ptr = "c:\\DATA\\x.TXT";
+  path.size = cpj_strlen(path.ptr);
+  if (cpj_path_list_find(&reader, &path) != 1 ||
+      !list_check_next(&reader, paths[1])) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int list_too_small(void)
+{
+  const cpj_char_t *paths[] = {"/usr/lib", "/usr/lib/libc.so"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_size_t size;
+
+  // The size of the whole list is returned even if it does not fit.
+  size = list_write(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 16, data, 10);
+  if (size <= 10 || cpj_path_list_open(&list, data, 10) ||
+      list_write(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 16, data,
+        size) != size ||
+      !cpj_path_list_open(&list, data, size)) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_list_reader_init(&reader, &list, buffer, 16) ||
+      !cpj_path_list_reader_init(&reader, &list, buffer, 17) ||
+      !list_check_next(&reader, paths[0]) ||
+      !list_check_next(&reader, paths[1])) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int list_invalid(void)
+{
+  const cpj_char_t *paths[] = {"a", "ab", "abc"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t size;
+
+  size = list_write(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), 16, data,
+    sizeof(data));
+  if (cpj_path_list_open(&list, data, size - 1)) {
+    return EXIT_FAILURE;
+  }
+
+  data[0] = 'X';
+  if (cpj_path_list_open(&list, data, size)) {
+    return EXIT_FAILURE;
+  }
+  data[0] = 'C';
+
+  // A path which shares more than the previous one has is rejected.
+  data[8 + 3] = 5;
+  if (!cpj_path_list_open(&list, data, size) ||
+      !cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer)) ||
+      !list_check_next(&reader, paths[0]) ||
+      cpj_path_list_next(&reader, &path)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int list_empty(void)
+{
+  cpj_char_t data[FILENAME_MAX], buffer[1];
+  cpj_path_list_t list;
+  cpj_path_list_reader_t reader;
+  cpj_string_t path;
+  cpj_size_t size;
+
+  size = list_write(CPJ_STYLE_UNIX, NULL, 0, 16, data, sizeof(data));
+  if (!cpj_path_list_open(&list, data, size) || list.count != 0 ||
+      !cpj_path_list_reader_init(&reader, &list, buffer, sizeof(buffer)) ||
+      cpj_path_list_next(&reader, &path)) {
+    return EXIT_FAILURE;
+  }
+
+  path.ptr = "a";
+  path.size = 1;
+  return cpj_path_list_find(&reader, &path) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
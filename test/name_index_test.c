@@ -0,0 +1,244 @@
+#include "cpj_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static cpj_string_column_t column_create(
+  const cpj_char_t **strings, cpj_size_t count, cpj_char_t *data,
+  cpj_size_t *offsets
+)
+{
+  cpj_string_column_t column;
+  cpj_size_t i;
+
+  offsets[0] = 0;
+  for (i = 0; i < count; ++i) {
+    cpj_size_t size = cpj_strlen(strings[i]);
+    memcpy(data + offsets[i], strings[i], size);
+    offsets[i + 1] = offsets[i] + size;
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = count;
+  return column;
+}
+
+/**
+ * Looks up a name and compares the positions of its paths with the expected
+ * ones.
+ */
+static bool name_index_check(
+  const cpj_name_index_t *index, cpj_name_kind_t kind, const cpj_char_t *name,
+  const cpj_size_t *expected, cpj_size_t expected_count
+)
+{
+  const cpj_size_t *positions;
+  cpj_string_t string;
+  cpj_size_t count, i;
+
+  string.ptr = name;
+  string.size = cpj_strlen(name);
+  count = cpj_name_index_find(index, kind, &string, &positions);
+  if (count != expected_count) {
+    return false;
+  }
+  for (i = 0; i < count; ++i) {
+    if (positions[i] != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static const cpj_char_t *name_index_paths[] = {"/usr/include/stdio.h",
+  "src/main.c", "src/net/main.c", "/", "docs/README", "src/main.h",
+  "test/.gitignore", "src/archive.tar.gz", "src/main.c/"};
+
+int name_index_basename(void)
+{
+  const cpj_size_t main_c[] = {1, 2, 8}, readme[] = {4},
+                   gitignore[] = {6};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(name_index_paths) + 1], storage[512];
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+
+  if (cpj_name_index_storage_size(ARRAY_SIZE(name_index_paths)) >
+      ARRAY_SIZE(storage)) {
+    return EXIT_FAILURE;
+  }
+  column = column_create(
+    name_index_paths, ARRAY_SIZE(name_index_paths), data, offsets
+  );
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_DEFAULT
+  );
+
+  if (!name_index_check(&index, CPJ_NAME_BASENAME, "main.c", main_c, 3) ||
+      !name_index_check(&index, CPJ_NAME_BASENAME, "README", readme, 1) ||
+      !name_index_check(&index, CPJ_NAME_BASENAME, ".gitignore", gitignore,
+        1) ||
+      !name_index_check(&index, CPJ_NAME_BASENAME, "readme", NULL, 0) ||
+      !name_index_check(&index, CPJ_NAME_BASENAME, "src", NULL, 0) ||
+      !name_index_check(&index, CPJ_NAME_BASENAME, "", NULL, 0)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int name_index_stem(void)
+{
+  const cpj_size_t main[] = {1, 2, 5, 8}, archive[] = {7}, readme[] = {4};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(name_index_paths) + 1], storage[512];
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+
+  column = column_create(
+    name_index_paths, ARRAY_SIZE(name_index_paths), data, offsets
+  );
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_DEFAULT
+  );
+
+  // A basename which starts with its only dot has no stem.
+  if (!name_index_check(&index, CPJ_NAME_STEM, "main", main, 4) ||
+      !name_index_check(&index, CPJ_NAME_STEM, "archive.tar", archive, 1) ||
+      !name_index_check(&index, CPJ_NAME_STEM, "README", readme, 1) ||
+      !name_index_check(&index, CPJ_NAME_STEM, "archive", NULL, 0) ||
+      !name_index_check(&index, CPJ_NAME_STEM, "", NULL, 0)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int name_index_extension(void)
+{
+  const cpj_size_t c[] = {1, 2, 8}, h[] = {0, 5}, gz[] = {7},
+                   gitignore[] = {6};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(name_index_paths) + 1], storage[512];
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+
+  column = column_create(
+    name_index_paths, ARRAY_SIZE(name_index_paths), data, offsets
+  );
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_PARALLEL
+  );
+
+  if (!name_index_check(&index, CPJ_NAME_EXTENSION, ".c", c, 3) ||
+      !name_index_check(&index, CPJ_NAME_EXTENSION, ".h", h, 2) ||
+      !name_index_check(&index, CPJ_NAME_EXTENSION, ".gz", gz, 1) ||
+      !name_index_check(&index, CPJ_NAME_EXTENSION, ".gitignore", gitignore,
+        1) ||
+      !name_index_check(&index, CPJ_NAME_EXTENSION, "c", NULL, 0) ||
+      !name_index_check(&index, CPJ_NAME_EXTENSION, ".C", NULL, 0)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int name_index_windows(void)
+{
+  const cpj_char_t *paths[] = {"C:\\Data\\Report.TXT", "c:\\data\\notes.txt",
+    "D:\\REPORT.txt", "C:\\"};
+  const cpj_size_t report[] = {0, 2}, txt[] = {0, 1, 2};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], storage[512];
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+
+  column = column_create(paths, ARRAY_SIZE(paths), data, offsets);
+  cpj_name_index_build(
+    &index, CPJ_STYLE_WINDOWS, &column, storage, CPJ_NAME_INDEX_DEFAULT
+  );
+
+  if (!name_index_check(&index, CPJ_NAME_BASENAME, "report.txt", report, 2) ||
+      !name_index_check(&index, CPJ_NAME_STEM, "REPORT", report, 2) ||
+      !name_index_check(&index, CPJ_NAME_EXTENSION, ".Txt", txt, 3)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int name_index_parallel(void)
+{
+  static const cpj_char_t *names[] = {"a.c", "b.c", "a.h", "README", ".x"};
+  static cpj_char_t data[4096 * 16];
+  static cpj_size_t offsets[4097], storage[3 * (8192 * 4 + 4096)];
+  const cpj_size_t *positions;
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+  cpj_string_t name;
+  cpj_size_t i, j, count, total;
+
+  offsets[0] = 0;
+  for (i = 0; i < 4096; ++i) {
+    offsets[i + 1] = offsets[i] +
+                     (cpj_size_t)sprintf(data + offsets[i], "d%u/%s",
+                       (unsigned int)(i % 7), names[i % ARRAY_SIZE(names)]);
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = 4096;
+  if (cpj_name_index_storage_size(4096) != ARRAY_SIZE(storage)) {
+    return EXIT_FAILURE;
+  }
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_PARALLEL
+  );
+
+  // Every path is found by its basename exactly once, in ascending order.
+  for (i = 0, total = 0; i < ARRAY_SIZE(names); ++i) {
+    name.ptr = names[i];
+    name.size = cpj_strlen(names[i]);
+    count = cpj_name_index_find(&index, CPJ_NAME_BASENAME, &name, &positions);
+    for (j = 0; j < count; ++j) {
+      if (positions[j] % ARRAY_SIZE(names) != i ||
+          (j > 0 && positions[j] <= positions[j - 1])) {
+        return EXIT_FAILURE;
+      }
+    }
+    total += count;
+  }
+
+  name.ptr = ".c";
+  name.size = 2;
+  if (total != 4096 ||
+      cpj_name_index_find(&index, CPJ_NAME_EXTENSION, &name, &positions) !=
+        2 * 4096 / ARRAY_SIZE(names) + 1) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int name_index_empty(void)
+{
+  cpj_size_t offsets[1] = {0}, storage[16];
+  const cpj_size_t *positions;
+  cpj_string_column_t column;
+  cpj_name_index_t index;
+  cpj_string_t name;
+
+  column.data = "";
+  column.offsets = offsets;
+  column.count = 0;
+  cpj_name_index_build(
+    &index, CPJ_STYLE_UNIX, &column, storage, CPJ_NAME_INDEX_PARALLEL
+  );
+
+  name.ptr = "a";
+  name.size = 1;
+  return cpj_name_index_find(&index, CPJ_NAME_BASENAME, &name, &positions) == 0
+           ? EXIT_SUCCESS
+           : EXIT_FAILURE;
+}
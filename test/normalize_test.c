@@ -6,6 +6,54 @@
 #include <stdlib.h>
 #include <string.h>
 
+int normalize_dot_names(void)
+{
+  const cpj_char_t *inputs[] = {"a/b./..", "a/.b/..", "a/b./../.b/c/..",
+    "../b./..", "/.b/../b."};
+  const cpj_char_t *expected[] = {"a", "a", "a/.b", "..", "/b."};
+  cpj_char_t result[FILENAME_MAX];
+  cpj_size_t i, count;
+
+  // Names of two characters with a single dot are no '..' segments.
+  for (i = 0; i < sizeof(inputs) / sizeof(*inputs); ++i) {
+    count = cpj_path_normalize_test(CPJ_STYLE_UNIX, inputs[i], result, sizeof(result));
+    if (count != strlen(expected[i]) || strcmp(result, expected[i]) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int normalize_inplace(void)
+{
+  const cpj_char_t *inputs[] = {"/var/logs/test/../../", "rel/../../", "a/b./c",
+    "/var/./logs/.//test/..//..//////", "", "C:\\..\\this/is", "C:"};
+  const cpj_char_t *expected[] = {"/var", "..", "a/b./c", "/var", ".", "C:\\this\\is",
+    "C:."};
+  cpj_path_style_t styles[] = {CPJ_STYLE_UNIX, CPJ_STYLE_UNIX, CPJ_STYLE_UNIX,
+    CPJ_STYLE_UNIX, CPJ_STYLE_UNIX, CPJ_STYLE_WINDOWS, CPJ_STYLE_WINDOWS};
+  cpj_char_t result[FILENAME_MAX];
+  cpj_size_t i, count;
+
+  for (i = 0; i < sizeof(inputs) / sizeof(*inputs); ++i) {
+    strcpy(result, inputs[i]);
+    count = cpj_path_normalize_inplace(styles[i], result, strlen(result), sizeof(result));
+    if (count != strlen(expected[i]) || strcmp(result, expected[i]) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The '.' does not fit into the buffer, but the size is still reported.
+  strcpy(result, "C:");
+  count = cpj_path_normalize_inplace(CPJ_STYLE_WINDOWS, result, 2, 3);
+  if (count != 3 || strcmp(result, "C:") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int normalize_forward_slashes(void)
 {
   cpj_size_t count;
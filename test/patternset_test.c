@@ -0,0 +1,241 @@
+#include "cpj_test.h"
+#include <stdlib.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+#define UNMATCHED CPJ_PATTERN_UNMATCHED
+#define IGNORED CPJ_PATTERN_IGNORED
+#define INCLUDED CPJ_PATTERN_INCLUDED
+
+/**
+ * A path with the verdict it is expected to get.
+ */
+struct patternset_case
+{
+  const cpj_char_t *path;
+  bool is_directory;
+  cpj_pattern_verdict_t verdict;
+};
+
+static bool patternset_check(
+  cpj_path_style_t style, const cpj_char_t **patterns, cpj_size_t count,
+  const struct patternset_case *cases, cpj_size_t case_count
+)
+{
+  cpj_string_t strings[16], path;
+  cpj_pattern_rule_t rules[16];
+  cpj_glob_segment_t segments[32];
+  cpj_patternset_t set;
+  cpj_size_t i;
+
+  for (i = 0; i < count; ++i) {
+    strings[i].ptr = patterns[i];
+    strings[i].size = cpj_strlen(patterns[i]);
+  }
+  if (cpj_patternset_compile(&set, style, strings, count, rules, segments,
+        ARRAY_SIZE(segments)) > ARRAY_SIZE(segments)) {
+    return false;
+  }
+
+  for (i = 0; i < case_count; ++i) {
+    path.ptr = cases[i].path;
+    path.size = cpj_strlen(cases[i].path);
+    if (cpj_patternset_match(&set, &path, cases[i].is_directory) !=
+        cases[i].verdict) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int patternset_basename(void)
+{
+  const cpj_char_t *patterns[] = {"node_modules", "*.o", "build/"};
+  const struct patternset_case cases[] = {{"node_modules", true, IGNORED},
+    {"src/node_modules/x.js", false, IGNORED}, {"a.o", false, IGNORED},
+    {"src/lib/b.o", false, IGNORED}, {"a.o.c", false, UNMATCHED},
+    {"build", false, UNMATCHED}, {"build", true, IGNORED},
+    {"src/build/x", false, IGNORED}, {"src/a.c", false, UNMATCHED}};
+
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_negated(void)
+{
+  const cpj_char_t *patterns[] = {"*.log", "!keep.log", "logs/",
+    "!logs/keep.log"};
+  const struct patternset_case cases[] = {{"a.log", false, IGNORED},
+    {"keep.log", false, INCLUDED}, {"x/keep.log", false, INCLUDED},
+    {"logs", true, IGNORED}, {"logs/keep.log", false, IGNORED},
+    {"x/logs/a", false, IGNORED}};
+
+  // The contents of an ignored directory can not be included again.
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_anchored(void)
+{
+  const cpj_char_t *patterns[] = {"/build", "doc/*.txt", "a/**/z", "c/**",
+    "!c/keep", "**/tmp/"};
+  const struct patternset_case cases[] = {{"build", false, IGNORED},
+    {"build/x", false, IGNORED}, {"src/build", false, UNMATCHED},
+    {"doc/a.txt", false, IGNORED}, {"doc/x/a.txt", false, UNMATCHED},
+    {"a/z", false, IGNORED}, {"a/b/c/z", false, IGNORED},
+    {"x/a/z", false, UNMATCHED}, {"c", true, UNMATCHED},
+    {"c/x", false, IGNORED}, {"c/keep", false, INCLUDED},
+    {"x/y/tmp", true, IGNORED}, {"x/y/tmp", false, UNMATCHED}};
+
+  // A trailing `**` only matches what is inside of a directory.
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_trailing_recursive(void)
+{
+  const cpj_char_t *patterns[] = {"**/abc/**", "a/**/b/**"};
+  const struct patternset_case cases[] = {{"x/abc", false, UNMATCHED},
+    {"x/abc", true, UNMATCHED}, {"abc", true, UNMATCHED},
+    {"x/abc/f", false, IGNORED}, {"abc/f", false, IGNORED},
+    {"a/x/b", false, UNMATCHED}, {"a/b", true, UNMATCHED},
+    {"a/x/b/c", false, IGNORED}, {"a/b/c", false, IGNORED}};
+
+  // A trailing `**` needs a segment of its own, even if the pattern starts
+  // with a `**` which could take all the others.
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_order(void)
+{
+  const cpj_char_t *patterns[] = {"*.c", "!test_*.c", "test_main.c",
+    "!src/*.c", "src/gen_*"};
+  const struct patternset_case cases[] = {{"a.c", false, IGNORED},
+    {"test_a.c", false, INCLUDED}, {"x/test_main.c", false, IGNORED},
+    {"src/a.c", false, INCLUDED}, {"src/gen_a.c", false, IGNORED},
+    {"src/test_main.c", false, INCLUDED}};
+
+  // The last pattern which matches decides, no matter how it is found.
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_normalized(void)
+{
+  const cpj_char_t *patterns[] = {"/build", "node_modules/", "a/b"};
+  const struct patternset_case cases[] = {{"./build", false, IGNORED},
+    {"x/../build", false, IGNORED}, {"src//node_modules/x", false, IGNORED},
+    {"a/./x/../b/", false, IGNORED}, {"/a/b", false, IGNORED},
+    {"a/b/../c", false, UNMATCHED}};
+
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_comments(void)
+{
+  const cpj_char_t *patterns[] = {"# comment", "", "   ", "\\#file",
+    "\\!bang", "spaces   ", ".", "/"};
+  const struct patternset_case cases[] = {{"# comment", false, UNMATCHED},
+    {"#file", false, IGNORED}, {"!bang", false, IGNORED},
+    {"spaces", false, IGNORED}, {"spaces   ", false, UNMATCHED},
+    {"x", false, UNMATCHED}};
+
+  if (!patternset_check(CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), cases,
+        ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_windows(void)
+{
+  const cpj_char_t *patterns[] = {"Build\\", "*.OBJ", "docs\\*.md",
+    "!x\\KEEP.obj"};
+  const struct patternset_case cases[] = {{"build", true, IGNORED},
+    {"src\\BUILD\\a.c", false, IGNORED}, {"x\\A.obj", false, IGNORED},
+    {"X/keep.OBJ", false, INCLUDED}, {"DOCS/readme.MD", false, IGNORED},
+    {"docs\\a\\readme.md", false, UNMATCHED}};
+
+  if (!patternset_check(CPJ_STYLE_WINDOWS, patterns, ARRAY_SIZE(patterns),
+        cases, ARRAY_SIZE(cases))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int patternset_too_small(void)
+{
+  const cpj_char_t *strings[] = {"a/b/c", "*.o", "# comment"};
+  cpj_string_t patterns[3], path;
+  cpj_pattern_rule_t rules[3];
+  cpj_glob_segment_t segments[4];
+  cpj_patternset_t set;
+  cpj_size_t i;
+
+  for (i = 0; i < 3; ++i) {
+    patterns[i].ptr = strings[i];
+    patterns[i].size = cpj_strlen(strings[i]);
+  }
+
+  // Nothing is compiled if the segments do not fit.
+  if (cpj_patternset_compile(
+        &set, CPJ_STYLE_UNIX, patterns, 3, rules, segments, 3
+      ) != 4 ||
+      set.rule_count != 0 ||
+      cpj_patternset_compile(
+        &set, CPJ_STYLE_UNIX, patterns, 3, rules, segments, 4
+      ) != 4 ||
+      set.rule_count != 2 || !(rules[1].flags & CPJ_PATTERN_EXTENSION)) {
+    return EXIT_FAILURE;
+  }
+
+  path.ptr = "x/a.o";
+  path.size = cpj_strlen(path.ptr);
+  return cpj_patternset_match(&set, &path, false) == IGNORED ? EXIT_SUCCESS
+                                                             : EXIT_FAILURE;
+}
+
+int patternset_empty(void)
+{
+  cpj_pattern_rule_t rules[1];
+  cpj_patternset_t set;
+  cpj_string_t path;
+
+  path.ptr = "a/b";
+  path.size = cpj_strlen(path.ptr);
+  if (cpj_patternset_compile(&set, CPJ_STYLE_UNIX, NULL, 0, rules, NULL, 0) !=
+        0 ||
+      cpj_patternset_match(&set, &path, false) != UNMATCHED) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
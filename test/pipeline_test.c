@@ -0,0 +1,238 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static const cpj_pipeline_stage_t staging_stages[] = {
+  {CPJ_PIPELINE_NORMALIZE, {CPJ_ZSTR_ARG("")}},
+  {CPJ_PIPELINE_CHANGE_ROOT, {CPJ_ZSTR_ARG("/out/tree")}},
+  {CPJ_PIPELINE_CHANGE_EXTENSION, {CPJ_ZSTR_ARG(".ktx2")}},
+  {CPJ_PIPELINE_GET_RELATIVE, {CPJ_ZSTR_ARG("/out")}},
+};
+
+int pipeline_staging(void)
+{
+  cpj_pipeline_t pipeline = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/")}, staging_stages,
+    ARRAY_SIZE(staging_stages)};
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("assets/./textures/../images//logo.png"));
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t n;
+
+  n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+  if (n != 28) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "tree/assets/images/logo.ktx2") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int pipeline_windows(void)
+{
+  const cpj_pipeline_stage_t stages[] = {
+    {CPJ_PIPELINE_CHANGE_ROOT, {CPJ_ZSTR_ARG("D:\\")}},
+    {CPJ_PIPELINE_CHANGE_EXTENSION, {CPJ_ZSTR_ARG("dds")}},
+  };
+  cpj_pipeline_t pipeline = {CPJ_STYLE_WINDOWS, {CPJ_ZSTR_ARG("")}, stages,
+    ARRAY_SIZE(stages)};
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("C:/src/textures/stone.png"));
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t n;
+
+  n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+  if (n != 25) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "D:\\src\\textures\\stone.dds") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int pipeline_drive_relative(void)
+{
+  const cpj_char_t *paths[] = {"C:a", "D:a", "D:..\\a", "C:a\\..\\..", "a",
+    "\\a"};
+  const cpj_pipeline_stage_t stages[] = {
+    {CPJ_PIPELINE_GET_RELATIVE, {CPJ_ZSTR_ARG("C:\\x\\z")}},
+  };
+  cpj_pipeline_t pipeline = {CPJ_STYLE_WINDOWS, {CPJ_ZSTR_ARG("C:\\x\\y")},
+    stages, ARRAY_SIZE(stages)};
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("C:a"));
+  cpj_char_t expected[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_size_t i, n;
+
+  // A drive-relative root is not resolved against the current directory,
+  // which is on the same drive, so it is not a segment of the result either.
+  n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+  if (n != 3 || strcmp(buffer, "C:a") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    path = cpj_string_create(paths[i], strlen(paths[i]));
+    cpj_path_get_relative(CPJ_STYLE_WINDOWS, &pipeline.cwd_directory,
+      &stages[0].argument, &path, expected, sizeof(expected));
+    n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+    if (n != strlen(expected) || strcmp(buffer, expected) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int pipeline_relative_cwd(void)
+{
+  const cpj_pipeline_stage_t stages[] = {
+    {CPJ_PIPELINE_GET_RELATIVE, {CPJ_ZSTR_ARG("/home")}},
+  };
+  cpj_pipeline_t pipeline = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/home/user")}, stages,
+    ARRAY_SIZE(stages)};
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("docs/../notes/todo.txt"));
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t n;
+
+  n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+  if (n != 19) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "user/notes/todo.txt") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int pipeline_same_as_steps(void)
+{
+  const cpj_char_t *paths[] = {"", "/", "a/b.c/", "../x.tar.gz", "/src/.hidden",
+    "/src/../../lib/a.so", "out/tree/a.png"};
+  cpj_pipeline_t pipeline = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/home")}, staging_stages,
+    ARRAY_SIZE(staging_stages)};
+  cpj_char_t expected[FILENAME_MAX], buffer[FILENAME_MAX], step[FILENAME_MAX];
+  cpj_size_t i, n;
+
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    cpj_string_t path = cpj_string_create(paths[i], strlen(paths[i]));
+    cpj_string_t argument;
+
+    cpj_path_join_multiple(CPJ_STYLE_UNIX, false, true, &path, 1, step, sizeof(step));
+    path = cpj_string_create(step, strlen(step));
+    cpj_path_change_root(CPJ_STYLE_UNIX, &path, &staging_stages[1].argument, expected,
+      sizeof(expected));
+    path = cpj_string_create(expected, strlen(expected));
+    cpj_path_change_extension(CPJ_STYLE_UNIX, &path, &staging_stages[2].argument, step,
+      sizeof(step));
+    path = cpj_string_create(step, strlen(step));
+    argument = staging_stages[3].argument;
+    cpj_path_get_relative(CPJ_STYLE_UNIX, &pipeline.cwd_directory, &argument, &path,
+      expected, sizeof(expected));
+
+    path = cpj_string_create(paths[i], strlen(paths[i]));
+    n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+    if (n != strlen(expected) || strcmp(buffer, expected) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int pipeline_column(void)
+{
+  const cpj_char_t *paths[] = {"a.png", "b/c.jpeg", "../d"};
+  const cpj_char_t *expected[] = {"tree/a.ktx2", "tree/b/c.ktx2", "d.ktx2"};
+  cpj_pipeline_t pipeline = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/")}, staging_stages,
+    ARRAY_SIZE(staging_stages)};
+  cpj_char_t data[FILENAME_MAX], *buffer;
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_string_column_t column;
+  cpj_size_t i, buffer_size, length;
+
+  offsets[0] = 0;
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    memcpy(data + offsets[i], paths[i], strlen(paths[i]));
+    offsets[i + 1] = offsets[i] + strlen(paths[i]);
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = ARRAY_SIZE(paths);
+
+  buffer_size = cpj_pipeline_run_column(&pipeline, &column, NULL, 0, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_pipeline_run_column(&pipeline, &column, buffer, buffer_size,
+    result_offsets);
+  if (length >= buffer_size || result_offsets[ARRAY_SIZE(paths)] != length) {
+    free(buffer);
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    cpj_size_t size = result_offsets[i + 1] - result_offsets[i];
+    if (size != strlen(expected[i]) ||
+        memcmp(buffer + result_offsets[i], expected[i], size) != 0) {
+      free(buffer);
+      return EXIT_FAILURE;
+    }
+  }
+
+  free(buffer);
+  return EXIT_SUCCESS;
+}
+
+int pipeline_truncated(void)
+{
+  cpj_pipeline_t pipeline = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/")}, staging_stages,
+    ARRAY_SIZE(staging_stages)};
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("images/logo.png"));
+  cpj_char_t buffer[8];
+  cpj_size_t n;
+
+  n = cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer));
+  if (n != 21) {
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(buffer, "tree/im") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int pipeline_too_many_segments(void)
+{
+  cpj_pipeline_t pipeline = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/")}, staging_stages,
+    ARRAY_SIZE(staging_stages)};
+  cpj_char_t path_buffer[CPJ_PIPELINE_SEGMENT_MAX * 2 + 1];
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_string_t path;
+  cpj_size_t i;
+
+  for (i = 0; i < CPJ_PIPELINE_SEGMENT_MAX; ++i) {
+    path_buffer[i * 2] = 'a';
+    path_buffer[i * 2 + 1] = '/';
+  }
+  path_buffer[CPJ_PIPELINE_SEGMENT_MAX * 2] = '\0';
+  path = cpj_string_create(path_buffer, strlen(path_buffer));
+
+  if (cpj_pipeline_run(&pipeline, &path, buffer, sizeof(buffer)) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (buffer[0] != '\0') {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static const cpj_rebase_rule_t build_rules[] = {
+  {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/home/ci/ws/")}, CPJ_STYLE_UNIX,
+    {CPJ_ZSTR_ARG("/src/")}},
+  {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/home/ci/ws/third_party")}, CPJ_STYLE_UNIX,
+    {CPJ_ZSTR_ARG("/deps")}},
+  {CPJ_STYLE_WINDOWS, {CPJ_ZSTR_ARG("C:\\b\\out\\")}, CPJ_STYLE_UNIX,
+    {CPJ_ZSTR_ARG("/mnt/out/")}},
+  {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/home/ci/ws")}, CPJ_STYLE_UNIX,
+    {CPJ_ZSTR_ARG("/ignored")}},
+};
+
+static int rebase_check(
+  const cpj_rebase_t *rebase, cpj_path_style_t path_style,
+  const cpj_char_t *path, const cpj_char_t *expected
+)
+{
+  cpj_string_t path_string = cpj_string_create(path, cpj_strlen(path));
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_size_t n;
+
+  n = cpj_path_rebase(rebase, path_style, &path_string, buffer, sizeof(buffer));
+  if (n != cpj_strlen(expected) || strcmp(buffer, expected) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int rebase_prefix(void)
+{
+  cpj_rebase_slot_t slots[8];
+  cpj_rebase_t rebase;
+
+  if (!cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots,
+        ARRAY_SIZE(slots))) {
+    return EXIT_FAILURE;
+  }
+
+  if (rebase_check(&rebase, CPJ_STYLE_UNIX, "/home/ci/ws/lib/a.c", "/src/lib/a.c") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  if (rebase_check(&rebase, CPJ_STYLE_UNIX, "/home/ci/ws", "/src") != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int rebase_longest(void)
+{
+  cpj_rebase_slot_t slots[8];
+  cpj_rebase_t rebase;
+
+  if (!cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots,
+        ARRAY_SIZE(slots))) {
+    return EXIT_FAILURE;
+  }
+
+  return rebase_check(&rebase, CPJ_STYLE_UNIX, "/home/ci/ws/third_party/zlib/zlib.h",
+    "/deps/zlib/zlib.h");
+}
+
+int rebase_segments(void)
+{
+  cpj_rebase_slot_t slots[8];
+  cpj_rebase_t rebase;
+
+  if (!cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots,
+        ARRAY_SIZE(slots))) {
+    return EXIT_FAILURE;
+  }
+
+  if (rebase_check(&rebase, CPJ_STYLE_UNIX, "/home/ci/wsx/a.c", "/home/ci/wsx/a.c") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return rebase_check(&rebase, CPJ_STYLE_UNIX, "/home/ci/./x/../ws//b.c", "/src/b.c");
+}
+
+int rebase_windows(void)
+{
+  cpj_rebase_slot_t slots[8];
+  cpj_rebase_t rebase;
+
+  if (!cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots,
+        ARRAY_SIZE(slots))) {
+    return EXIT_FAILURE;
+  }
+
+  if (rebase_check(&rebase, CPJ_STYLE_WINDOWS, "c:/B/OUT\\x\\y.o", "/mnt/out/x/y.o") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  // The rules of another style are not used.
+  return rebase_check(&rebase, CPJ_STYLE_WINDOWS, "/home/ci/ws/a.c",
+    "\\home\\ci\\ws\\a.c");
+}
+
+int rebase_column(void)
+{
+  const cpj_char_t *paths[] = {"/home/ci/ws/a", "/tmp/b", "/home/ci/ws/third_party"};
+  const cpj_char_t *expected = "/src/a/tmp/b/deps";
+  cpj_char_t data[FILENAME_MAX], *buffer;
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_rebase_slot_t slots[8];
+  cpj_string_column_t column;
+  cpj_rebase_t rebase;
+  cpj_size_t i, buffer_size, length;
+
+  if (!cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots,
+        ARRAY_SIZE(slots))) {
+    return EXIT_FAILURE;
+  }
+
+  offsets[0] = 0;
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    memcpy(data + offsets[i], paths[i], strlen(paths[i]));
+    offsets[i + 1] = offsets[i] + strlen(paths[i]);
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = ARRAY_SIZE(paths);
+
+  buffer_size = cpj_path_rebase_column(&rebase, CPJ_STYLE_UNIX, &column, NULL, 0, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_path_rebase_column(&rebase, CPJ_STYLE_UNIX, &column, buffer, buffer_size,
+    result_offsets);
+  if (length >= buffer_size || strcmp(buffer, expected) != 0 || result_offsets[1] != 6 ||
+      result_offsets[2] != 12 || result_offsets[3] != length) {
+    free(buffer);
+    return EXIT_FAILURE;
+  }
+  free(buffer);
+
+  return EXIT_SUCCESS;
+}
+
+int rebase_init_invalid(void)
+{
+  const cpj_rebase_rule_t empty_rule[] = {
+    {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("./")}, CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/x")}},
+  };
+  cpj_rebase_slot_t slots[8];
+  cpj_rebase_t rebase;
+
+  // The slot count must be a power of two.
+  if (cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots, 6)) {
+    return EXIT_FAILURE;
+  }
+
+  // There must be at least one empty slot.
+  if (cpj_rebase_init(&rebase, build_rules, ARRAY_SIZE(build_rules), slots, 4)) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_rebase_init(&rebase, empty_rule, ARRAY_SIZE(empty_rule), slots,
+        ARRAY_SIZE(slots))) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -6,6 +6,30 @@
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
+int relative_max_size(void)
+{
+  const cpj_char_t *bases[] = {"/a/b/c/d", "/a/b", "a/b/c", "/", ""};
+  const cpj_char_t *paths[] = {"/x", "/a/b/c/d", "../../y", "z", ""};
+  cpj_string_t cwd = cpj_string_create(CPJ_ZSTR_ARG("/home/user"));
+  cpj_char_t result[FILENAME_MAX];
+  cpj_size_t i, j, length, max_size;
+
+  for (i = 0; i < ARRAY_SIZE(bases); ++i) {
+    for (j = 0; j < ARRAY_SIZE(paths); ++j) {
+      cpj_string_t base = cpj_string_create(bases[i], cpj_strlen(bases[i]));
+      cpj_string_t path = cpj_string_create(paths[j], cpj_strlen(paths[j]));
+      max_size = cpj_path_relative_max_size(&cwd, &base, &path);
+      length = cpj_path_get_relative(CPJ_STYLE_UNIX, &cwd, &base, &path, result,
+        sizeof(result));
+      if (length > max_size) {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int relative_root_forward_slashes(void)
 {
   cpj_char_t result[FILENAME_MAX];
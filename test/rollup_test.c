@@ -0,0 +1,130 @@
+#include "cpj_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**
+ * Compares a closed directory with the next expected one, which is written
+ * as the path and the total separated by a `:`.
+ */
+static bool rollup_check_next(
+  cpj_rollup_t *rollup, const cpj_char_t **expected, cpj_size_t expected_count,
+  cpj_size_t *index
+)
+{
+  cpj_string_t directory;
+  unsigned long long value;
+  char buffer[FILENAME_MAX];
+
+  while (cpj_rollup_next(rollup, &directory, &value)) {
+    snprintf(buffer, sizeof(buffer), "%.*s:%llu", (int)directory.size,
+      directory.ptr, value);
+    if (*index >= expected_count || strcmp(buffer, expected[*index]) != 0) {
+      return false;
+    }
+    ++*index;
+  }
+
+  return true;
+}
+
+static int rollup_check(
+  cpj_path_style_t style, const cpj_char_t **paths,
+  const unsigned long long *values, cpj_size_t count,
+  const cpj_char_t **expected, cpj_size_t expected_count
+)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_rollup_level_t levels[16];
+  cpj_rollup_t rollup;
+  cpj_string_t path;
+  cpj_size_t i, index = 0;
+
+  cpj_rollup_init(&rollup, style, buffer, sizeof(buffer), levels,
+    ARRAY_SIZE(levels));
+  for (i = 0; i < count; ++i) {
+    path = cpj_string_create(paths[i], cpj_strlen(paths[i]));
+    if (!cpj_path_rollup(&rollup, &path, values[i]) ||
+        !rollup_check_next(&rollup, expected, expected_count, &index)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!cpj_rollup_finish(&rollup) ||
+      !rollup_check_next(&rollup, expected, expected_count, &index)) {
+    return EXIT_FAILURE;
+  }
+
+  return index == expected_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int rollup_totals(void)
+{
+  const cpj_char_t *paths[] = {"/a/b/x", "/a/b/y", "/a/c", "/a/d/e/z", "/f"};
+  const unsigned long long values[] = {1, 2, 4, 8, 16};
+  const cpj_char_t *expected[] = {"/a/b:3", "/a/d/e:8", "/a/d:8", "/a:15",
+    "/:31"};
+
+  return rollup_check(CPJ_STYLE_UNIX, paths, values, ARRAY_SIZE(paths),
+    expected, ARRAY_SIZE(expected));
+}
+
+int rollup_roots(void)
+{
+  const cpj_char_t *paths[] = {"a/x", "b", "/c/y"};
+  const unsigned long long values[] = {1, 2, 4};
+  const cpj_char_t *expected[] = {"a:1", ".:3", "/c:4", "/:4"};
+
+  return rollup_check(CPJ_STYLE_UNIX, paths, values, ARRAY_SIZE(paths),
+    expected, ARRAY_SIZE(expected));
+}
+
+int rollup_windows(void)
+{
+  const cpj_char_t *paths[] = {"C:\\Data\\x", "c:\\data\\y", "C:\\data2\\z"};
+  const unsigned long long values[] = {1, 2, 4};
+  const cpj_char_t *expected[] = {"C:\\Data:3", "C:\\data2:4", "C:\\:7"};
+
+  return rollup_check(CPJ_STYLE_WINDOWS, paths, values, ARRAY_SIZE(paths),
+    expected, ARRAY_SIZE(expected));
+}
+
+int rollup_empty(void)
+{
+  return rollup_check(CPJ_STYLE_UNIX, NULL, NULL, 0, NULL, 0);
+}
+
+int rollup_limits(void)
+{
+  cpj_char_t buffer[4];
+  cpj_rollup_level_t levels[3];
+  cpj_rollup_t rollup;
+  cpj_string_t path;
+
+  // The directory "/a/b" needs three levels and five characters.
+  cpj_rollup_init(&rollup, CPJ_STYLE_UNIX, buffer, sizeof(buffer), levels, 2);
+  path = cpj_string_create(CPJ_ZSTR_ARG("/a/b/c"));
+  if (cpj_path_rollup(&rollup, &path, 1)) {
+    return EXIT_FAILURE;
+  }
+  cpj_rollup_init(&rollup, CPJ_STYLE_UNIX, buffer, 3, levels, 3);
+  if (cpj_path_rollup(&rollup, &path, 1)) {
+    return EXIT_FAILURE;
+  }
+
+  // Closed directories have to be fetched before the next path.
+  cpj_rollup_init(&rollup, CPJ_STYLE_UNIX, buffer, sizeof(buffer), levels, 3);
+  path = cpj_string_create(CPJ_ZSTR_ARG("/a/b"));
+  if (!cpj_path_rollup(&rollup, &path, 1)) {
+    return EXIT_FAILURE;
+  }
+  path = cpj_string_create(CPJ_ZSTR_ARG("/c"));
+  if (!cpj_path_rollup(&rollup, &path, 1) ||
+      cpj_path_rollup(&rollup, &path, 1) || cpj_rollup_finish(&rollup)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static int sanitize_check(
+  const cpj_sanitizer_t *sanitizer, const cpj_char_t *entry,
+  cpj_sanitize_status_t expected_status, const cpj_char_t *expected
+)
+{
+  cpj_string_t entry_string = cpj_string_create(entry, cpj_strlen(entry));
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_sanitize_status_t status;
+  cpj_size_t size;
+
+  status = cpj_sanitizer_run(sanitizer, &entry_string, buffer, sizeof(buffer), &size);
+  if (status != expected_status || size != cpj_strlen(expected) ||
+      strcmp(buffer, expected) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sanitize_simple(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/tmp/out")}};
+
+  if (sanitize_check(&sanitizer, "docs//./readme.md", CPJ_SANITIZE_OK,
+        "/tmp/out/docs/readme.md") != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  if (sanitize_check(&sanitizer, "a/b/../c/", CPJ_SANITIZE_OK, "/tmp/out/a/c") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return sanitize_check(&sanitizer, "./", CPJ_SANITIZE_OK, "/tmp/out");
+}
+
+int sanitize_escape(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/tmp/out/")}};
+
+  if (sanitize_check(&sanitizer, "../etc/passwd", CPJ_SANITIZE_ESCAPE, "") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  if (sanitize_check(&sanitizer, "a/../../b", CPJ_SANITIZE_ESCAPE, "") != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return sanitize_check(&sanitizer, "a/..", CPJ_SANITIZE_OK, "/tmp/out/");
+}
+
+int sanitize_absolute(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_WINDOWS, {CPJ_ZSTR_ARG("D:\\out")}};
+
+  if (sanitize_check(&sanitizer, "/etc/passwd", CPJ_SANITIZE_ABSOLUTE, "") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  if (sanitize_check(&sanitizer, "C:evil.dll", CPJ_SANITIZE_ABSOLUTE, "") !=
+      EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return sanitize_check(&sanitizer, "\\\\server\\share\\x", CPJ_SANITIZE_ABSOLUTE, "");
+}
+
+int sanitize_windows(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_WINDOWS, {CPJ_ZSTR_ARG("D:\\out")}};
+
+  if (sanitize_check(&sanitizer, "bin/x64\\tool.exe", CPJ_SANITIZE_OK,
+        "D:\\out\\bin\\x64\\tool.exe") != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return sanitize_check(&sanitizer, "a\\..\\..\\b", CPJ_SANITIZE_ESCAPE, "");
+}
+
+int sanitize_invalid(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("out")}};
+  cpj_string_t entry = {"a\0/../../b", 10};
+  cpj_char_t buffer[FILENAME_MAX];
+
+  if (cpj_sanitizer_run(&sanitizer, &entry, buffer, sizeof(buffer), NULL) !=
+      CPJ_SANITIZE_INVALID) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sanitize_no_destination(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("")}};
+
+  if (sanitize_check(&sanitizer, "a//b/", CPJ_SANITIZE_OK, "a/b") != EXIT_SUCCESS) {
+    return EXIT_FAILURE;
+  }
+
+  return sanitize_check(&sanitizer, "a/..", CPJ_SANITIZE_OK, ".");
+}
+
+int sanitize_too_long(void)
+{
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("/out")}};
+  cpj_string_t entry = cpj_string_create(CPJ_ZSTR_ARG("long/name/../../x"));
+  cpj_string_t escape = cpj_string_create(CPJ_ZSTR_ARG("long/name/../../.."));
+  cpj_char_t buffer[8];
+  cpj_size_t size;
+
+  // The result would fit, but the segments in between do not.
+  if (cpj_sanitizer_run(&sanitizer, &entry, buffer, sizeof(buffer), &size) !=
+        CPJ_SANITIZE_TOO_LONG ||
+      size != 0 || buffer[0] != '\0') {
+    return EXIT_FAILURE;
+  }
+
+  // The name is validated even if it does not fit.
+  if (cpj_sanitizer_run(&sanitizer, &escape, buffer, sizeof(buffer), &size) !=
+      CPJ_SANITIZE_ESCAPE) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sanitize_column(void)
+{
+  const cpj_char_t *paths[] = {"a/b.txt", "../x", "c\\d", "/abs", "e/./f/"};
+  const cpj_sanitize_status_t expected_statuses[] = {CPJ_SANITIZE_OK,
+    CPJ_SANITIZE_ESCAPE, CPJ_SANITIZE_OK, CPJ_SANITIZE_ABSOLUTE, CPJ_SANITIZE_OK};
+  const cpj_char_t *expected = "d/a/b.txtd/c\\dd/e/f";
+  cpj_sanitizer_t sanitizer = {CPJ_STYLE_UNIX, {CPJ_ZSTR_ARG("d")}};
+  cpj_sanitize_status_t statuses[ARRAY_SIZE(paths)];
+  cpj_size_t offsets[ARRAY_SIZE(paths) + 1], result_offsets[ARRAY_SIZE(paths) + 1];
+  cpj_char_t data[FILENAME_MAX], *buffer;
+  cpj_string_column_t column;
+  cpj_size_t i, buffer_size, length;
+
+  offsets[0] = 0;
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    memcpy(data + offsets[i], paths[i], strlen(paths[i]));
+    offsets[i + 1] = offsets[i] + strlen(paths[i]);
+  }
+  column.data = data;
+  column.offsets = offsets;
+  column.count = ARRAY_SIZE(paths);
+
+  buffer_size = cpj_sanitizer_run_column(&sanitizer, &column, NULL, 0, NULL, NULL);
+  buffer = malloc(buffer_size);
+  length = cpj_sanitizer_run_column(&sanitizer, &column, buffer, buffer_size,
+    result_offsets, statuses);
+  if (length >= buffer_size || strcmp(buffer, expected) != 0 ||
+      result_offsets[2] != result_offsets[1] || result_offsets[5] != length) {
+    free(buffer);
+    return EXIT_FAILURE;
+  }
+  free(buffer);
+
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (statuses[i] != expected_statuses[i]) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
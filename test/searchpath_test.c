@@ -0,0 +1,298 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_test.h"
+#include <errno.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**
+ * A search path over the directories `first`, `second` and `third` of a
+ * temporary tree, along with its storage.
+ */
+struct searchpath_context
+{
+  cpj_searchpath_t searchpath;
+  cpj_string_t directories[3];
+  cpj_char_t paths[3][64];
+  cpj_char_t root[64];
+  void *storage;
+};
+
+/**
+ * Creates a temporary tree holding the directories of the search path along
+ * with the paths, and initializes the search path.
+ */
+static bool searchpath_create(struct searchpath_context *context,
+  const cpj_char_t **paths, cpj_size_t count, cpj_size_t entry_count)
+{
+  static const cpj_char_t *names[] = {"first/", "second/", "third/"};
+  cpj_size_t i;
+
+  context->storage = malloc(cpj_searchpath_storage_size(3, entry_count, 256));
+  strcpy(context->root, "/tmp/cpj_searchpath_XXXXXX");
+  if (!cpj_test_tree_create(context->root, names, ARRAY_SIZE(names))) {
+    return false;
+  }
+  for (i = 0; i < ARRAY_SIZE(names); ++i) {
+    context->directories[i].ptr = context->paths[i];
+    context->directories[i].size = (cpj_size_t)snprintf(context->paths[i],
+      sizeof(context->paths[i]), "%s/%.*s", context->root,
+      (int)strlen(names[i]) - 1, names[i]);
+  }
+  cpj_searchpath_init(&context->searchpath, context->directories, 3,
+    context->storage, entry_count, 256);
+  return cpj_test_tree_add(context->root, paths, count);
+}
+
+static void searchpath_remove(struct searchpath_context *context)
+{
+  cpj_test_tree_remove(context->root);
+  free(context->storage);
+}
+
+/**
+ * Checks that a name is found in the expected path below the root, or is not
+ * found at all if that is NULL.
+ */
+static bool searchpath_is_found(struct searchpath_context *context,
+  const cpj_char_t *name, const cpj_char_t *expected)
+{
+  cpj_char_t buffer[256], full[256];
+  cpj_string_t string;
+  cpj_size_t size;
+
+  string.ptr = name;
+  string.size = cpj_strlen(name);
+  errno = 0;
+  size = cpj_searchpath_find(&context->searchpath, &string, buffer,
+    sizeof(buffer));
+  if (!expected) {
+    return size == 0 && errno == ENOENT;
+  }
+  snprintf(full, sizeof(full), "%s/%s", context->root, expected);
+  return size == strlen(full) && strcmp(buffer, full) == 0;
+}
+
+static const cpj_char_t *searchpath_paths[] = {"first/a.h", "first/sys/",
+  "first/shared.h/", "second/a.h", "second/b.h", "second/e.h", "second/sys/",
+  "second/sys/types.h", "second/shared.h", "third/c.h", "third/broken>none",
+  "top.h"};
+#endif
+
+int searchpath_order(void)
+{
+#ifdef __linux__
+  struct searchpath_context context;
+  int status = EXIT_FAILURE;
+
+  if (!searchpath_create(&context, searchpath_paths,
+        ARRAY_SIZE(searchpath_paths), 64)) {
+    goto done;
+  }
+
+  // The first directory wins, directories are never found and neither is a
+  // link without a target.
+  if (!searchpath_is_found(&context, "a.h", "first/a.h") ||
+      !searchpath_is_found(&context, "b.h", "second/b.h") ||
+      !searchpath_is_found(&context, "c.h", "third/c.h") ||
+      !searchpath_is_found(&context, "shared.h", "second/shared.h") ||
+      !searchpath_is_found(&context, "broken", NULL) ||
+      !searchpath_is_found(&context, "sys", NULL) ||
+      !searchpath_is_found(&context, "d.h", NULL) ||
+      context.searchpath.list_count != 3) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  searchpath_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int searchpath_links(void)
+{
+#ifdef __linux__
+  static const cpj_char_t *paths[] = {"first/x.h>none", "first/y.h>sys",
+    "first/z.h>../second/x.h", "first/sys/", "second/x.h", "second/y.h"};
+  static const cpj_size_t entry_counts[] = {64, 1};
+  struct searchpath_context context;
+  cpj_size_t i;
+  int status = EXIT_FAILURE;
+
+  // Links are followed whether the listings fit or not, so neither a
+  // dangling link nor one to a directory hides the file behind it.
+  for (i = 0; i < ARRAY_SIZE(entry_counts); ++i) {
+    if (!searchpath_create(&context, paths, ARRAY_SIZE(paths),
+          entry_counts[i])) {
+      goto done;
+    }
+    if (!searchpath_is_found(&context, "x.h", "second/x.h") ||
+        !searchpath_is_found(&context, "y.h", "second/y.h") ||
+        !searchpath_is_found(&context, "z.h", "first/z.h")) {
+      goto done;
+    }
+    searchpath_remove(&context);
+  }
+  return EXIT_SUCCESS;
+
+done:
+  searchpath_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int searchpath_segments(void)
+{
+#ifdef __linux__
+  struct searchpath_context context;
+  int status = EXIT_FAILURE;
+
+  if (!searchpath_create(&context, searchpath_paths,
+        ARRAY_SIZE(searchpath_paths), 64)) {
+    goto done;
+  }
+
+  // Names are normalized before they are looked up, and a `..` which leads
+  // out of the directories is probed in each of them.
+  if (!searchpath_is_found(&context, "sys/types.h", "second/sys/types.h") ||
+      !searchpath_is_found(&context, "x/../b.h", "second/b.h") ||
+      !searchpath_is_found(&context, "./sys//./types.h",
+        "second/sys/types.h") ||
+      !searchpath_is_found(&context, "../top.h", "top.h") ||
+      !searchpath_is_found(&context, "../second/b.h", "second/b.h") ||
+      !searchpath_is_found(&context, "a.h/x", NULL) ||
+      !searchpath_is_found(&context, "sys/none.h", NULL)) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  searchpath_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int searchpath_refresh(void)
+{
+#ifdef __linux__
+  static const cpj_char_t *added_paths[] = {"first/b.h"};
+  struct timespec times[2] = {{0, 0}, {1, 0}};
+  struct searchpath_context context;
+  cpj_char_t path[256];
+  int status = EXIT_FAILURE;
+
+  if (!searchpath_create(&context, searchpath_paths,
+        ARRAY_SIZE(searchpath_paths), 64) ||
+      !searchpath_is_found(&context, "b.h", "second/b.h") ||
+      cpj_searchpath_refresh(&context.searchpath) != 0) {
+    goto done;
+  }
+
+  // A new file is only seen once the listing has been dropped. The mtime is
+  // set explicitly, since it might not change within the same tick.
+  snprintf(path, sizeof(path), "%s/first", context.root);
+  if (!cpj_test_tree_add(context.root, added_paths, 1) ||
+      utimensat(AT_FDCWD, path, times, 0) != 0 ||
+      !searchpath_is_found(&context, "b.h", "second/b.h") ||
+      cpj_searchpath_refresh(&context.searchpath) != 1 ||
+      !searchpath_is_found(&context, "b.h", "first/b.h") ||
+      !searchpath_is_found(&context, "a.h", "first/a.h") ||
+      context.searchpath.list_count != 3) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  searchpath_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int searchpath_overflow(void)
+{
+#ifdef __linux__
+  struct searchpath_context context;
+  int status = EXIT_FAILURE;
+
+  // The listings do not fit at once, so they replace each other, and the
+  // one of `second` does not fit at all.
+  if (!searchpath_create(&context, searchpath_paths,
+        ARRAY_SIZE(searchpath_paths), 3)) {
+    goto done;
+  }
+  if (!searchpath_is_found(&context, "a.h", "first/a.h") ||
+      !searchpath_is_found(&context, "c.h", "third/c.h") ||
+      !searchpath_is_found(&context, "b.h", "second/b.h") ||
+      !searchpath_is_found(&context, "shared.h", "second/shared.h") ||
+      !searchpath_is_found(&context, "sys", NULL) ||
+      !searchpath_is_found(&context, "sys/types.h", "second/sys/types.h") ||
+      context.searchpath.generations[1] != CPJ_SIZE_MAX ||
+      context.searchpath.entry_count * 2 > context.searchpath.slot_count) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  searchpath_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int searchpath_errors(void)
+{
+#ifdef __linux__
+  cpj_string_t absolute = {CPJ_ZSTR_ARG("/etc/passwd")};
+  cpj_string_t name = {CPJ_ZSTR_ARG("a.h")};
+  struct searchpath_context context;
+  cpj_char_t small[8];
+  int status = EXIT_FAILURE;
+
+  if (!searchpath_create(&context, searchpath_paths,
+        ARRAY_SIZE(searchpath_paths), 64) ||
+      !searchpath_is_found(&context, "", NULL) ||
+      !searchpath_is_found(&context, "x/..", NULL)) {
+    goto done;
+  }
+  errno = 0;
+  if (cpj_searchpath_find(&context.searchpath, &absolute, small,
+        sizeof(small)) != 0 ||
+      errno != EINVAL) {
+    goto done;
+  }
+
+  // The size is returned, but nothing is written if it does not fit.
+  memset(small, 'x', sizeof(small));
+  if (cpj_searchpath_find(&context.searchpath, &name, small, sizeof(small)) !=
+        context.directories[0].size + 4 ||
+      small[0] != 'x') {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  searchpath_remove(&context);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
@@ -0,0 +1,123 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Compares the sort keys of two paths, like strcmp does for strings.
+ */
+static int key_compare(
+  cpj_path_style_t path_style, bool natural_order, const cpj_char_t *first,
+  const cpj_char_t *second
+)
+{
+  cpj_string_t first_string = cpj_string_create(first, cpj_strlen(first));
+  cpj_string_t second_string = cpj_string_create(second, cpj_strlen(second));
+  cpj_char_t first_key[FILENAME_MAX], second_key[FILENAME_MAX];
+  cpj_size_t first_size, second_size;
+  int result;
+
+  first_size = cpj_path_sort_key(path_style, &first_string, natural_order, first_key,
+    sizeof(first_key));
+  second_size = cpj_path_sort_key(path_style, &second_string, natural_order,
+    second_key, sizeof(second_key));
+  result = memcmp(first_key, second_key,
+    first_size < second_size ? first_size : second_size);
+  if (result == 0) {
+    result = first_size < second_size ? -1 : first_size > second_size ? 1 : 0;
+  }
+  return result;
+}
+
+int sort_key_segments(void)
+{
+  // A strcmp puts `a-b/c` first, since '-' comes before '/'.
+  if (key_compare(CPJ_STYLE_UNIX, false, "a/b", "a-b/c") >= 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (key_compare(CPJ_STYLE_UNIX, false, "a", "a/b") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, false, "a/b", "a.b") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, false, "a/z", "ab") >= 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sort_key_normalized(void)
+{
+  if (key_compare(CPJ_STYLE_UNIX, false, "a/./b/../c//", "a/c") != 0 ||
+      key_compare(CPJ_STYLE_UNIX, false, "/../x", "/x") != 0 ||
+      key_compare(CPJ_STYLE_UNIX, false, "", ".") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (key_compare(CPJ_STYLE_UNIX, false, "../a", "a") == 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sort_key_roots(void)
+{
+  if (key_compare(CPJ_STYLE_UNIX, false, "z", "/a") >= 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (key_compare(CPJ_STYLE_WINDOWS, false, "C:\\a", "D:\\") >= 0 ||
+      key_compare(CPJ_STYLE_WINDOWS, false, "C:/x", "c:\\x") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sort_key_case_fold(void)
+{
+  if (key_compare(CPJ_STYLE_WINDOWS, false, "Docs\\README.md", "docs/readme.MD") != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (key_compare(CPJ_STYLE_UNIX, false, "Docs", "docs") == 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sort_key_natural(void)
+{
+  if (key_compare(CPJ_STYLE_UNIX, true, "img2.png", "img10.png") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, true, "v9/x", "v10") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, true, "a", "a0") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, true, "a1", "a01") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, true, "a-", "a1") >= 0 ||
+      key_compare(CPJ_STYLE_UNIX, true, "a1", "aa") >= 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (key_compare(CPJ_STYLE_UNIX, false, "img2.png", "img10.png") <= 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sort_key_too_small(void)
+{
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("/some/long/path/../x"));
+  cpj_char_t buffer[8];
+
+  if (cpj_path_sort_key(CPJ_STYLE_UNIX, &path, false, buffer, sizeof(buffer)) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  if (cpj_path_sort_key(CPJ_STYLE_UNIX, &path, false, NULL, 0) != 0) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
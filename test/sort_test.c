@@ -0,0 +1,109 @@
+#include "cpj_test.h"
+#include <memory.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static int sort_check(
+  cpj_path_style_t path_style, const cpj_char_t **input, const cpj_char_t **expected,
+  cpj_size_t count
+)
+{
+  cpj_string_t paths[32];
+  cpj_size_t i;
+
+  for (i = 0; i < count; ++i) {
+    paths[i] = cpj_string_create(input[i], cpj_strlen(input[i]));
+  }
+  cpj_path_sort(path_style, paths, count, CPJ_SORT_DEFAULT);
+  for (i = 0; i < count; ++i) {
+    if (paths[i].size != cpj_strlen(expected[i]) ||
+        memcmp(paths[i].ptr, expected[i], paths[i].size) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int sort_segments(void)
+{
+  const cpj_char_t *input[] = {"a-b/c", "a/b/c", "a.txt", "a", "a/b", "b", "a/b-c",
+    "a/b/a"};
+  const cpj_char_t *expected[] = {"a", "a/b", "a/b/a", "a/b/c", "a/b-c", "a-b/c",
+    "a.txt", "b"};
+
+  return sort_check(CPJ_STYLE_UNIX, input, expected, ARRAY_SIZE(input));
+}
+
+int sort_roots(void)
+{
+  const cpj_char_t *input[] = {"/b", "z", "/", "/a/x", "a"};
+  const cpj_char_t *expected[] = {"a", "z", "/", "/a/x", "/b"};
+
+  return sort_check(CPJ_STYLE_UNIX, input, expected, ARRAY_SIZE(input));
+}
+
+int sort_windows(void)
+{
+  const cpj_char_t *input[] = {"D:\\a", "c:\\Docs\\b", "C:\\docs", "C:\\DOCS-old",
+    "C:\\a"};
+  const cpj_char_t *expected[] = {"C:\\a", "C:\\docs", "c:\\Docs\\b", "C:\\DOCS-old",
+    "D:\\a"};
+
+  return sort_check(CPJ_STYLE_WINDOWS, input, expected, ARRAY_SIZE(input));
+}
+
+int sort_empty(void)
+{
+  cpj_string_t path = cpj_string_create(CPJ_ZSTR_ARG("a"));
+
+  cpj_path_sort(CPJ_STYLE_UNIX, NULL, 0, CPJ_SORT_DEFAULT);
+  cpj_path_sort(CPJ_STYLE_UNIX, &path, 1, CPJ_SORT_PARALLEL);
+
+  return path.size == 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int sort_parallel(void)
+{
+  const cpj_size_t count = 50000;
+  static const cpj_char_t *segments[] = {"usr", "lib", "a-b", "a", "b", "Include",
+    "x.c", "x"};
+  cpj_string_t *paths = malloc(count * sizeof(*paths));
+  cpj_char_t *data = malloc(count * 64);
+  cpj_char_t previous_key[256], key[256];
+  cpj_size_t i, j, previous_size = 0, size;
+  unsigned int seed = 1;
+  int result = EXIT_SUCCESS;
+
+  for (i = 0; i < count; ++i) {
+    cpj_char_t *path = data + i * 64;
+    path[0] = '\0';
+    for (j = 0; j < 1 + i % 5; ++j) {
+      seed = seed * 1103515245 + 12345;
+      if (j > 0) {
+        strcat(path, "/");
+      }
+      strcat(path, segments[(seed >> 16) % ARRAY_SIZE(segments)]);
+    }
+    paths[i] = cpj_string_create(path, strlen(path));
+  }
+
+  // Every key must be at least as large as the one in front of it.
+  cpj_path_sort(CPJ_STYLE_WINDOWS, paths, count, CPJ_SORT_PARALLEL);
+  for (i = 0; i < count && result == EXIT_SUCCESS; ++i) {
+    size = cpj_path_sort_key(CPJ_STYLE_WINDOWS, paths + i, false, key, sizeof(key));
+    if (i > 0 && memcmp(previous_key, key,
+                   previous_size < size ? previous_size : size) > 0) {
+      result = EXIT_FAILURE;
+    }
+    memcpy(previous_key, key, size);
+    previous_size = size;
+  }
+
+  free(data);
+  free(paths);
+  return result;
+}
@@ -0,0 +1,237 @@
+#include "cpj_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static bool table_create(
+  cpj_path_style_t style, const cpj_char_t **strings, cpj_size_t count,
+  cpj_char_t *data, cpj_size_t data_size, cpj_path_table_t *table
+)
+{
+  cpj_string_t paths[32] = {0};
+  cpj_size_t i, size;
+
+  for (i = 0; i < count; ++i) {
+    paths[i].ptr = strings[i];
+    paths[i].size = cpj_strlen(strings[i]);
+  }
+  size = cpj_path_table_build(style, paths, count, data, data_size);
+  return size <= data_size && cpj_path_table_open(table, data, size);
+}
+
+static bool table_check_lookup(
+  const cpj_path_table_t *table, const cpj_char_t *path, cpj_size_t expected
+)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_string_t string;
+  cpj_size_t position;
+
+  string.ptr = path;
+  string.size = cpj_strlen(path);
+  return cpj_path_table_lookup(
+           table, &string, buffer, sizeof(buffer), &position
+         ) &&
+         position == expected;
+}
+
+static bool table_check_descendants(
+  const cpj_path_table_t *table, const cpj_char_t *path,
+  cpj_size_t expected_first, cpj_size_t expected_count
+)
+{
+  cpj_char_t buffer[FILENAME_MAX];
+  cpj_string_t string;
+  cpj_size_t first, count;
+
+  string.ptr = path;
+  string.size = cpj_strlen(path);
+  count = cpj_path_table_descendants_of(
+    table, &string, buffer, sizeof(buffer), &first
+  );
+  return count == expected_count && (count == 0 || first == expected_first);
+}
+
+int table_lookup(void)
+{
+  const cpj_char_t *paths[] = {"a", "a/b", "/", "/etc", "/etc/hosts",
+    "/home/user", "/home/user/a.txt"};
+  cpj_char_t data[FILENAME_MAX], buffer[FILENAME_MAX];
+  cpj_path_table_t table;
+  cpj_string_t path;
+  cpj_size_t i;
+
+  if (!table_create(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), data,
+        sizeof(data), &table) ||
+      table.path_count != ARRAY_SIZE(paths)) {
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < ARRAY_SIZE(paths); ++i) {
+    if (!table_check_lookup(&table, paths[i], i) ||
+        !cpj_path_table_get(&table, i, &path) ||
+        strcmp(path.ptr, paths[i]) != 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The paths are normalized before they are looked up.
+  if (!table_check_lookup(&table, "/etc/../home//user/", 5) ||
+      !table_check_lookup(&table, "./a/./b", 1) ||
+      table_check_lookup(&table, "/home", 0) ||
+      table_check_lookup(&table, "/etc/hosts/x", 0) ||
+      cpj_path_table_get(&table, ARRAY_SIZE(paths), &path)) {
+    return EXIT_FAILURE;
+  }
+
+  // A buffer which is too small for the path does not find it.
+  path.ptr = paths[4];
+  path.size = cpj_strlen(paths[4]);
+  if (cpj_path_table_lookup(&table, &path, buffer, 4, NULL)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int table_descendants(void)
+{
+  const cpj_char_t *paths[] = {".", "x", "x/y", "/", "/a", "/a/b", "/a/b/c",
+    "/a/d/e", "/a-b", "/b"};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_path_table_t table;
+
+  if (!table_create(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), data,
+        sizeof(data), &table)) {
+    return EXIT_FAILURE;
+  }
+
+  if (!table_check_descendants(&table, "/", 4, 6) ||
+      !table_check_descendants(&table, "/a", 5, 3) ||
+      !table_check_descendants(&table, "/a/b/", 6, 1) ||
+      !table_check_descendants(&table, "/a/d", 7, 1) ||
+      !table_check_descendants(&table, "/a/b/c", 0, 0) ||
+      !table_check_descendants(&table, "/a/x", 0, 0) ||
+      !table_check_descendants(&table, "/a-", 0, 0) ||
+      !table_check_descendants(&table, "/a/../x", 0, 0) ||
+      !table_check_descendants(&table, ".", 1, 2) ||
+      !table_check_descendants(&table, "x", 2, 1)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int table_duplicates(void)
+{
+  const cpj_char_t *paths[] = {"/a", "/a", "/a/b", "/a/b", "/a/b", "/c"};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_path_table_t table;
+
+  // Equal paths are only stored once.
+  if (!table_create(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), data,
+        sizeof(data), &table) ||
+      table.path_count != 3 || !table_check_lookup(&table, "/a/b", 1) ||
+      !table_check_lookup(&table, "/c", 2) ||
+      !table_check_descendants(&table, "/a", 1, 1)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int table_windows(void)
+{
+  const cpj_char_t *paths[] = {"C:\\Data", "c:\\data\\X.txt", "C:\\DATA\\y",
+    "D:\\z"};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_path_table_t table;
+
+  if (!table_create(CPJ_STYLE_WINDOWS, paths, ARRAY_SIZE(paths), data,
+        sizeof(data), &table) ||
+      table.path_style != CPJ_STYLE_WINDOWS) {
+    return EXIT_FAILURE;
+  }
+
+  if (!table_check_lookup(&table, "c:/DATA/x.TXT", 1) ||
+      !table_check_lookup(&table, "d:\\Z", 3) ||
+      !table_check_descendants(&table, "c:/data", 1, 2) ||
+      !table_check_descendants(&table, "C:\\", 0, 3) ||
+      !table_check_descendants(&table, "d:\\", 3, 1)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int table_too_small(void)
+{
+  const cpj_char_t *strings[] = {"/usr/lib", "/usr/lib/libc.so"};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_path_table_t table;
+  cpj_string_t paths[2];
+  cpj_size_t size;
+
+  paths[0].ptr = strings[0];
+  paths[0].size = cpj_strlen(strings[0]);
+  paths[1].ptr = strings[1];
+  paths[1].size = cpj_strlen(strings[1]);
+
+  // Nothing is written if the table does not fit, but the size is returned.
+  size = cpj_path_table_build(CPJ_STYLE_UNIX, paths, 2, NULL, 0);
+  if (size > sizeof(data)) {
+    return EXIT_FAILURE;
+  }
+  memset(data, 'x', sizeof(data));
+  if (cpj_path_table_build(CPJ_STYLE_UNIX, paths, 2, data, size - 1) != size ||
+      data[0] != 'x' ||
+      cpj_path_table_build(CPJ_STYLE_UNIX, paths, 2, data, size) != size ||
+      !cpj_path_table_open(&table, data, size) ||
+      !table_check_lookup(&table, "/usr/lib/libc.so", 1)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int table_invalid(void)
+{
+  const cpj_char_t *paths[] = {"a", "a/b"};
+  cpj_char_t data[FILENAME_MAX];
+  cpj_path_table_t table;
+  cpj_size_t size;
+
+  if (!table_create(CPJ_STYLE_UNIX, paths, ARRAY_SIZE(paths), data,
+        sizeof(data), &table)) {
+    return EXIT_FAILURE;
+  }
+  size = (cpj_size_t)(table.strings + table.string_size - data);
+
+  if (cpj_path_table_open(&table, data, size - 1) ||
+      cpj_path_table_open(&table, data, 8)) {
+    return EXIT_FAILURE;
+  }
+
+  data[4] = CPJ_PATH_TABLE_VERSION + 1;
+  if (cpj_path_table_open(&table, data, size)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int table_empty(void)
+{
+  cpj_char_t data[FILENAME_MAX];
+  cpj_path_table_t table;
+
+  if (!table_create(CPJ_STYLE_UNIX, NULL, 0, data, sizeof(data), &table) ||
+      table.path_count != 0 || table_check_lookup(&table, "/", 0) ||
+      !table_check_descendants(&table, "/", 0, 0)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,310 @@
+#define UNIT_TESTS(XX) \
+  XX(absolute,simple) \
+  XX(absolute,absolute_path) \
+  XX(absolute,unix_relative_base) \
+  XX(absolute,windows_relative_base) \
+  XX(absolute,mixed) \
+  XX(absolute,normalization) \
+  XX(absolute,too_far) \
+  XX(absolute,check) \
+  XX(absolute,buffer_reuse) \
+  XX(basename,simple) \
+  XX(basename,empty) \
+  XX(basename,trailing_separator) \
+  XX(basename,trailing_separators) \
+  XX(basename,no_separators) \
+  XX(basename,special_directories) \
+  XX(basename,root) \
+  XX(basename,windows) \
+  XX(basename,change_simple) \
+  XX(basename,change_empty_path) \
+  XX(basename,change_only_root) \
+  XX(basename,change_empty_basename) \
+  XX(basename,change_relative) \
+  XX(basename,change_trim) \
+  XX(basename,change_trim_only_root) \
+  XX(basename,change_special_directory) \
+  XX(basename,change_trailing_separators) \
+  XX(basename,change_size_query) \
+  XX(builder,too_small) \
+  XX(builder,windows) \
+  XX(builder,truncate) \
+  XX(builder,relative) \
+  XX(builder,parents) \
+  XX(builder,push_pop) \
+  XX(builder,init_normalized) \
+  XX(column,normalize) \
+  XX(column,join) \
+  XX(column,relative) \
+  XX(column,change_extension) \
+  XX(column,guess_style) \
+  XX(column,unterminated) \
+  XX(column,upper_bound) \
+  XX(column,truncated) \
+  XX(cover,empty) \
+  XX(cover,windows) \
+  XX(cover,roots) \
+  XX(cover,waste) \
+  XX(cover,merge) \
+  XX(cover,topmost) \
+  XX(diff,empty) \
+  XX(diff,windows) \
+  XX(diff,collapse_partial) \
+  XX(diff,collapse_implied) \
+  XX(diff,collapse) \
+  XX(diff,skip_common) \
+  XX(diff,merge) \
+  XX(dirname,simple) \
+  XX(dirname,empty) \
+  XX(dirname,trailing_separator) \
+  XX(dirname,trailing_separators) \
+  XX(dirname,no_separators) \
+  XX(dirname,special_directories) \
+  XX(dirname,root) \
+  XX(dirname,three_segments) \
+  XX(dirname,relative) \
+  XX(escape,column) \
+  XX(escape,max_depth) \
+  XX(escape,windows) \
+  XX(escape,absolute) \
+  XX(escape,dot_names) \
+  XX(escape,relative) \
+  XX(extension,get_simple) \
+  XX(extension,get_without) \
+  XX(extension,get_first) \
+  XX(extension,get_last) \
+  XX(extension,get_multiple) \
+  XX(extension,check_simple) \
+  XX(extension,check_empty) \
+  XX(extension,check_without) \
+  XX(extension,change_simple) \
+  XX(extension,change_no_basename) \
+  XX(extension,change_no_extension) \
+  XX(extension,change_with_dot) \
+  XX(extension,change_overlap) \
+  XX(extension,change_overlap_long) \
+  XX(extension,change_hidden_file) \
+  XX(extension,change_with_trailing_slash) \
+  XX(extension,change_remove_last) \
+  XX(extension,change_parent_of_root) \
+  XX(extension,change_size_query) \
+  XX(fs,stat_no_ring) \
+  XX(fs,stat_parallel) \
+  XX(fs,stat) \
+  XX(fs,too_small) \
+  XX(fs,errors) \
+  XX(fs,overflow) \
+  XX(fs,cached) \
+  XX(fs,relative) \
+  XX(fs,resolve_real) \
+  XX(glob,too_small) \
+  XX(glob,windows) \
+  XX(glob,normalized) \
+  XX(glob,recursive) \
+  XX(glob,wildcard) \
+  XX(glob,literal) \
+  XX(guess,empty_string) \
+  XX(guess,windows_root) \
+  XX(guess,unix_root) \
+  XX(guess,windows_separator) \
+  XX(guess,unix_separator) \
+  XX(guess,hidden_file) \
+  XX(guess,extension) \
+  XX(guess,unguessable) \
+  XX(index,children) \
+  XX(index,descendants_of_root) \
+  XX(index,descendants) \
+  XX(index,lookup) \
+  XX(index,sorted) \
+  XX(intersection,simple) \
+  XX(intersection,trailing_separator) \
+  XX(intersection,double_separator) \
+  XX(intersection,empty) \
+  XX(intersection,unequal_roots) \
+  XX(intersection,relative_absolute_mix) \
+  XX(intersection,same_roots) \
+  XX(intersection,one_root_only) \
+  XX(intersection,relative_base) \
+  XX(intersection,relative_other) \
+  XX(intersection,skipped_end) \
+  XX(is_absolute,absolute) \
+  XX(is_absolute,unc) \
+  XX(is_absolute,device_unc) \
+  XX(is_absolute,device_dot) \
+  XX(is_absolute,device_question_mark) \
+  XX(is_absolute,relative) \
+  XX(is_absolute,windows_backslash) \
+  XX(is_absolute,windows_slash) \
+  XX(is_absolute,unix_backslash) \
+  XX(is_absolute,unix_drive) \
+  XX(is_absolute,absolute_drive) \
+  XX(is_absolute,relative_drive) \
+  XX(is_absolute,relative_windows) \
+  XX(is_absolute,root) \
+  XX(is_absolute,dir) \
+  XX(is_relative,absolute) \
+  XX(is_relative,unc) \
+  XX(is_relative,device_unc) \
+  XX(is_relative,device_dot) \
+  XX(is_relative,device_question_mark) \
+  XX(is_relative,relative) \
+  XX(is_relative,windows_backslash) \
+  XX(is_relative,windows_slash) \
+  XX(is_relative,unix_backslash) \
+  XX(is_relative,unix_drive) \
+  XX(is_relative,absolute_drive) \
+  XX(is_relative,relative_drive) \
+  XX(is_relative,relative_windows) \
+  XX(join,simple) \
+  XX(join,navigate_back) \
+  XX(join,empty) \
+  XX(join,two_absolute) \
+  XX(join,two_unc) \
+  XX(join,with_two_roots) \
+  XX(join,back_after_root) \
+  XX(join,relative_back_after_root) \
+  XX(join,multiple) \
+  XX(join,max_size) \
+  XX(join,dot_names) \
+  XX(list,empty) \
+  XX(list,invalid) \
+  XX(list,too_small) \
+  XX(list,windows) \
+  XX(list,find) \
+  XX(list,seek) \
+  XX(list,roundtrip) \
+  XX(name_index,empty) \
+  XX(name_index,parallel) \
+  XX(name_index,windows) \
+  XX(name_index,extension) \
+  XX(name_index,stem) \
+  XX(name_index,basename) \
+  XX(normalize,do_nothing) \
+  XX(normalize,navigate_back) \
+  XX(normalize,relative_too_far) \
+  XX(normalize,absolute_too_far) \
+  XX(normalize,terminated) \
+  XX(normalize,double_separator) \
+  XX(normalize,remove_current) \
+  XX(normalize,mixed) \
+  XX(normalize,overlap) \
+  XX(normalize,empty) \
+  XX(normalize,zero_length) \
+  XX(normalize,only_separators) \
+  XX(normalize,back_after_root) \
+  XX(normalize,forward_slashes) \
+  XX(normalize,inplace) \
+  XX(normalize,dot_names) \
+  XX(patternset,empty) \
+  XX(patternset,too_small) \
+  XX(patternset,windows) \
+  XX(patternset,comments) \
+  XX(patternset,normalized) \
+  XX(patternset,order) \
+  XX(patternset,trailing_recursive) \
+  XX(patternset,anchored) \
+  XX(patternset,negated) \
+  XX(patternset,basename) \
+  XX(pipeline,too_many_segments) \
+  XX(pipeline,truncated) \
+  XX(pipeline,column) \
+  XX(pipeline,same_as_steps) \
+  XX(pipeline,relative_cwd) \
+  XX(pipeline,drive_relative) \
+  XX(pipeline,windows) \
+  XX(pipeline,staging) \
+  XX(rebase,init_invalid) \
+  XX(rebase,column) \
+  XX(rebase,windows) \
+  XX(rebase,segments) \
+  XX(rebase,longest) \
+  XX(rebase,prefix) \
+  XX(relative,simple) \
+  XX(relative,relative) \
+  XX(relative,long_base) \
+  XX(relative,long_target) \
+  XX(relative,equal) \
+  XX(relative,same_base) \
+  XX(relative,base_skipped_end) \
+  XX(relative,target_skipped_end) \
+  XX(relative,base_div_skipped_end) \
+  XX(relative,target_div_skipped_end) \
+  XX(relative,skip_all) \
+  XX(relative,different_roots) \
+  XX(relative,relative_and_absolute) \
+  XX(relative,check) \
+  XX(relative,root_path_unix) \
+  XX(relative,root_path_windows) \
+  XX(relative,root_forward_slashes) \
+  XX(relative,max_size) \
+  XX(rollup,limits) \
+  XX(rollup,empty) \
+  XX(rollup,windows) \
+  XX(rollup,roots) \
+  XX(rollup,totals) \
+  XX(root,absolute) \
+  XX(root,unc) \
+  XX(root,device_unc) \
+  XX(root,device_dot) \
+  XX(root,device_question_mark) \
+  XX(root,relative) \
+  XX(root,windows_backslash) \
+  XX(root,windows_slash) \
+  XX(root,unix_backslash) \
+  XX(root,unix_drive) \
+  XX(root,absolute_drive) \
+  XX(root,relative_drive) \
+  XX(root,relative_windows) \
+  XX(root,change_simple) \
+  XX(root,change_empty) \
+  XX(root,change_separators) \
+  XX(root,change_overlapping) \
+  XX(root,change_without_root) \
+  XX(sanitize,column) \
+  XX(sanitize,too_long) \
+  XX(sanitize,no_destination) \
+  XX(sanitize,invalid) \
+  XX(sanitize,windows) \
+  XX(sanitize,absolute) \
+  XX(sanitize,escape) \
+  XX(sanitize,simple) \
+  XX(searchpath,errors) \
+  XX(searchpath,overflow) \
+  XX(searchpath,refresh) \
+  XX(searchpath,segments) \
+  XX(searchpath,order) \
+  XX(searchpath,links) \
+  XX(sort_key,too_small) \
+  XX(sort_key,natural) \
+  XX(sort_key,case_fold) \
+  XX(sort_key,roots) \
+  XX(sort_key,normalized) \
+  XX(sort_key,segments) \
+  XX(sort,parallel) \
+  XX(sort,empty) \
+  XX(sort,windows) \
+  XX(sort,roots) \
+  XX(sort,segments) \
+  XX(table,empty) \
+  XX(table,invalid) \
+  XX(table,too_small) \
+  XX(table,windows) \
+  XX(table,duplicates) \
+  XX(table,descendants) \
+  XX(table,lookup) \
+  XX(walk,missing) \
+  XX(walk,stop) \
+  XX(walk,overflow) \
+  XX(walk,deep) \
+  XX(walk,parallel) \
+  XX(walk,relative) \
+  XX(walk,patterns) \
+  XX(walk,tree) \
+  XX(windows,get_root) \
+  XX(windows,get_unc_root) \
+  XX(windows,get_root_separator) \
+  XX(windows,get_root_relative) \
+  XX(windows,intersection_case) \
+  XX(windows,root_backslash) \
+  XX(windows,root_empty) \
+
@@ -0,0 +1,68 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_test.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool cpj_test_tree_create(
+  cpj_char_t *root, const cpj_char_t **paths, cpj_size_t count
+)
+{
+  return mkdtemp(root) && cpj_test_tree_add(root, paths, count);
+}
+
+bool cpj_test_tree_add(
+  const cpj_char_t *root, const cpj_char_t **paths, cpj_size_t count
+)
+{
+  cpj_char_t path[256];
+  const cpj_char_t *target;
+  cpj_size_t i, size;
+  int fd;
+
+  for (i = 0; i < count; ++i) {
+    target = strchr(paths[i], '>');
+    size = (cpj_size_t)snprintf(path, sizeof(path), "%s/%.*s", root,
+      target ? (int)(target - paths[i]) : (int)strlen(paths[i]), paths[i]);
+    if (target) {
+      if (symlink(target + 1, path) != 0) {
+        return false;
+      }
+    } else if (path[size - 1] == '/') {
+      if (mkdir(path, 0700) != 0) {
+        return false;
+      }
+    } else {
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+      if (fd < 0) {
+        return false;
+      }
+      close(fd);
+    }
+  }
+  return true;
+}
+
+static int cpj_test_tree_remove_entry(
+  const char *path, const struct stat *status, int flag, struct FTW *ftw
+)
+{
+  (void)status;
+  (void)flag;
+  (void)ftw;
+  return remove(path);
+}
+
+void cpj_test_tree_remove(const cpj_char_t *root)
+{
+  nftw(root, cpj_test_tree_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+#endif
@@ -0,0 +1,449 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700
+#endif
+
+#include "cpj_test.h"
+#include <errno.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+/**
+ * The entries collected by walk_collect, with their paths relative to the
+ * root.
+ */
+struct walk_result
+{
+  cpj_size_t root_size;
+  cpj_char_t paths[32][64];
+  cpj_walk_entry_t entries[32];
+  cpj_size_t count;
+  cpj_size_t call_count;
+  bool is_stopping;
+};
+
+static bool walk_collect(
+  void *context, const cpj_walk_entry_t *entries, cpj_size_t entry_count
+)
+{
+  struct walk_result *result = context;
+  cpj_size_t i;
+
+  ++result->call_count;
+  for (i = 0; i < entry_count && result->count < ARRAY_SIZE(result->paths);
+       ++i) {
+    if (entries[i].path.ptr[entries[i].path.size] != '\0' ||
+        entries[i].path.size < result->root_size ||
+        entries[i].name.ptr + entries[i].name.size !=
+          entries[i].path.ptr + entries[i].path.size) {
+      return false;
+    }
+    snprintf(result->paths[result->count],
+      sizeof(result->paths[result->count]), "%s",
+      entries[i].path.ptr + result->root_size);
+    result->entries[result->count++] = entries[i];
+  }
+  return !result->is_stopping;
+}
+
+static const cpj_walk_entry_t *walk_find(
+  const struct walk_result *result, const cpj_char_t *path
+)
+{
+  cpj_size_t i;
+
+  for (i = 0; i < result->count; ++i) {
+    if (strcmp(result->paths[i], path) == 0) {
+      return result->entries + i;
+    }
+  }
+  return NULL;
+}
+
+static bool walk_tree_create(
+  cpj_char_t *root, const cpj_char_t **paths, cpj_size_t count
+)
+{
+  strcpy(root, "/tmp/cpj_walk_XXXXXX");
+  return cpj_test_tree_create(root, paths, count);
+}
+
+static bool walk_run(
+  const cpj_char_t *root, cpj_walk_t *walk, struct walk_result *result
+)
+{
+  void *storage = malloc(cpj_walk_storage_size(walk));
+  bool is_walked;
+
+  result->root_size = cpj_strlen(root) + 1;
+  result->count = 0;
+  result->call_count = 0;
+  walk->callback = walk_collect;
+  walk->context = result;
+  is_walked = cpj_walk(walk, root, storage);
+  free(storage);
+  return is_walked;
+}
+
+static const cpj_char_t *walk_tree_paths[] = {"a/", "a/b/", "a/b/c.txt",
+  "a/d.txt", "e.c", ".hidden/", ".hidden/f"};
+#endif
+
+int walk_tree(void)
+{
+#ifdef __linux__
+  cpj_char_t root[64], target[96];
+  struct walk_result result = {0};
+  const cpj_walk_entry_t *entry;
+  cpj_walk_t walk = {0};
+  int status = EXIT_FAILURE;
+
+  if (!walk_tree_create(root, walk_tree_paths, ARRAY_SIZE(walk_tree_paths))) {
+    return EXIT_FAILURE;
+  }
+  snprintf(target, sizeof(target), "%s/link", root);
+  if (symlink("a", target) != 0 || !walk_run(root, &walk, &result)) {
+    goto done;
+  }
+
+  // Symbolic links are passed, but not followed.
+  if (result.count != 8 ||
+      !(entry = walk_find(&result, "a/b/c.txt")) ||
+      entry->type != CPJ_WALK_FILE || entry->depth != 3 ||
+      entry->name.size != 5 ||
+      !(entry = walk_find(&result, "a/b")) ||
+      entry->type != CPJ_WALK_DIRECTORY || entry->depth != 2 ||
+      entry->error != 0 || !(entry = walk_find(&result, "link")) ||
+      entry->type != CPJ_WALK_SYMLINK || entry->depth != 1 ||
+      !walk_find(&result, ".hidden/f") || !walk_find(&result, "e.c") ||
+      walk_find(&result, "link/d.txt")) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int walk_patterns(void)
+{
+#ifdef __linux__
+  const cpj_char_t *strings[] = {"b/", "*.txt", "!d.txt", "/.hidden/f"};
+  cpj_string_t patterns[ARRAY_SIZE(strings)];
+  cpj_pattern_rule_t rules[ARRAY_SIZE(strings)];
+  cpj_glob_segment_t segments[8];
+  cpj_patternset_t set;
+  cpj_char_t root[64];
+  struct walk_result result = {0};
+  cpj_walk_t walk = {0};
+  cpj_size_t i;
+  int status = EXIT_FAILURE;
+
+  for (i = 0; i < ARRAY_SIZE(strings); ++i) {
+    patterns[i].ptr = strings[i];
+    patterns[i].size = cpj_strlen(strings[i]);
+  }
+  cpj_patternset_compile(
+    &set, CPJ_STYLE_UNIX, patterns, ARRAY_SIZE(patterns), rules, segments,
+    ARRAY_SIZE(segments)
+  );
+  if (!walk_tree_create(root, walk_tree_paths, ARRAY_SIZE(walk_tree_paths))) {
+    return EXIT_FAILURE;
+  }
+
+  // An ignored directory is not read at all.
+  walk.patterns = &set;
+  if (!walk_run(root, &walk, &result) || result.count != 4 ||
+      !walk_find(&result, "a") || !walk_find(&result, "a/d.txt") ||
+      !walk_find(&result, "e.c") || !walk_find(&result, ".hidden")) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int walk_relative(void)
+{
+#ifdef __linux__
+  cpj_char_t root[64], cwd[256];
+  struct walk_result result = {0};
+  cpj_walk_t walk = {0};
+  void *storage = malloc(cpj_walk_storage_size(&walk));
+  int status = EXIT_FAILURE;
+
+  if (!getcwd(cwd, sizeof(cwd)) ||
+      !walk_tree_create(root, walk_tree_paths, ARRAY_SIZE(walk_tree_paths))) {
+    free(storage);
+    return EXIT_FAILURE;
+  }
+
+  // The root is normalized, and left out if it is the current directory.
+  walk.callback = walk_collect;
+  walk.context = &result;
+  if (chdir(root) != 0 || !cpj_walk(&walk, "./a//b/../", storage) ||
+      result.count != 3 || !walk_find(&result, "a/b/c.txt") ||
+      !walk_find(&result, "a/d.txt")) {
+    goto done;
+  }
+  result.count = 0;
+  if (!cpj_walk(&walk, ".", storage) || result.count != 7 ||
+      !walk_find(&result, "a") || !walk_find(&result, ".hidden/f")) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  if (chdir(cwd) != 0) {
+    status = EXIT_FAILURE;
+  }
+  free(storage);
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+#ifdef __linux__
+struct walk_count
+{
+  atomic_size_t files;
+  atomic_size_t directories;
+  atomic_size_t errors;
+};
+
+static bool walk_count_entries(
+  void *context, const cpj_walk_entry_t *entries, cpj_size_t entry_count
+)
+{
+  struct walk_count *count = context;
+  cpj_size_t i;
+
+  for (i = 0; i < entry_count; ++i) {
+    if (entries[i].error != 0) {
+      atomic_fetch_add(&count->errors, 1);
+    } else if (entries[i].type == CPJ_WALK_DIRECTORY) {
+      atomic_fetch_add(&count->directories, 1);
+    } else {
+      atomic_fetch_add(&count->files, 1);
+    }
+  }
+  return true;
+}
+#endif
+
+int walk_parallel(void)
+{
+#ifdef __linux__
+  cpj_char_t root[64], path[128];
+  struct walk_count count;
+  cpj_walk_t walk = {0};
+  void *storage;
+  int i, j, fd, status = EXIT_FAILURE;
+
+  if (!walk_tree_create(root, NULL, 0)) {
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < 16; ++i) {
+    snprintf(path, sizeof(path), "%s/%d", root, i);
+    mkdir(path, 0700);
+    for (j = 0; j < 16; ++j) {
+      snprintf(path, sizeof(path), "%s/%d/%d", root, i, j);
+      mkdir(path, 0700);
+      snprintf(path, sizeof(path), "%s/%d/%d/file", root, i, j);
+      fd = open(path, O_WRONLY | O_CREAT, 0600);
+      close(fd);
+    }
+  }
+
+  // Small batches make the threads wait for each other, so they hand out a
+  // lot of directories.
+  walk.callback = walk_count_entries;
+  walk.context = &count;
+  walk.flags = CPJ_WALK_PARALLEL;
+  walk.thread_count = 4;
+  walk.level_count = 3;
+  walk.task_count = 4;
+  walk.batch_size = 3;
+  storage = malloc(cpj_walk_storage_size(&walk));
+  for (i = 0; i < 8; ++i) {
+    atomic_init(&count.files, 0);
+    atomic_init(&count.directories, 0);
+    atomic_init(&count.errors, 0);
+    if (!cpj_walk(&walk, root, storage) || count.files != 256 ||
+        count.directories != 16 + 256 || count.errors != 0) {
+      goto done;
+    }
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  free(storage);
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int walk_overflow(void)
+{
+#ifdef __linux__
+  const cpj_char_t *paths[] = {"a/", "a/x/", "a/x/f", "a/y/", "a/y/f"};
+  struct walk_result result = {0};
+  cpj_walk_t walk = {0};
+  cpj_char_t root[64];
+  cpj_size_t i;
+  int status = EXIT_FAILURE;
+
+  if (!walk_tree_create(root, paths, ARRAY_SIZE(paths))) {
+    return EXIT_FAILURE;
+  }
+
+  // The root and `a` take up both levels, so `a` is suspended while the
+  // directories in it are read, and nothing is lost.
+  walk.level_count = 2;
+  walk.task_count = 1;
+  if (!walk_run(root, &walk, &result) || result.count != 5 ||
+      !walk_find(&result, "a/x/f") || !walk_find(&result, "a/y/f")) {
+    goto done;
+  }
+  for (i = 0; i < result.count; ++i) {
+    if (result.entries[i].error != 0) {
+      goto done;
+    }
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int walk_deep(void)
+{
+#ifdef __linux__
+  cpj_char_t root[64], path[256];
+  cpj_size_t path_size, options_index;
+  struct walk_count count;
+  cpj_walk_t walk;
+  void *storage;
+  int i, j, fd, status = EXIT_FAILURE;
+
+  if (!walk_tree_create(root, NULL, 0)) {
+    return EXIT_FAILURE;
+  }
+
+  // A chain of 40 directories, with 40 directories holding a file each below
+  // the 15th and the 40th one. That is deeper and wider than the levels and
+  // tasks of the default options.
+  path_size = (cpj_size_t)snprintf(path, sizeof(path), "%s", root);
+  for (i = 1; i <= 40; ++i) {
+    path_size += (cpj_size_t)snprintf(path + path_size,
+      sizeof(path) - path_size, "/d");
+    mkdir(path, 0700);
+    for (j = 0; (i == 15 || i == 40) && j < 40; ++j) {
+      snprintf(path + path_size, sizeof(path) - path_size, "/%d", j);
+      mkdir(path, 0700);
+      snprintf(path + path_size, sizeof(path) - path_size, "/%d/file", j);
+      fd = open(path, O_WRONLY | O_CREAT, 0600);
+      close(fd);
+    }
+    path[path_size] = '\0';
+  }
+
+  for (options_index = 0; options_index < 3; ++options_index) {
+    memset(&walk, 0, sizeof(walk));
+    walk.callback = walk_count_entries;
+    walk.context = &count;
+    if (options_index == 1) {
+      walk.level_count = 1;
+      walk.task_count = 1;
+    } else if (options_index == 2) {
+      walk.flags = CPJ_WALK_PARALLEL;
+      walk.thread_count = 4;
+    }
+    atomic_init(&count.files, 0);
+    atomic_init(&count.directories, 0);
+    atomic_init(&count.errors, 0);
+    storage = malloc(cpj_walk_storage_size(&walk));
+    if (!cpj_walk(&walk, root, storage) || count.files != 80 ||
+        count.directories != 40 + 80 || count.errors != 0) {
+      free(storage);
+      goto done;
+    }
+    free(storage);
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int walk_stop(void)
+{
+#ifdef __linux__
+  struct walk_result result = {0};
+  cpj_walk_t walk = {0};
+  cpj_char_t root[64];
+  int status = EXIT_FAILURE;
+
+  if (!walk_tree_create(root, walk_tree_paths, ARRAY_SIZE(walk_tree_paths))) {
+    return EXIT_FAILURE;
+  }
+
+  result.is_stopping = true;
+  walk.batch_size = 2;
+  if (!walk_run(root, &walk, &result) || result.call_count != 1 ||
+      result.count != 2) {
+    goto done;
+  }
+  status = EXIT_SUCCESS;
+
+done:
+  cpj_test_tree_remove(root);
+  return status;
+#else
+  return EXIT_SUCCESS;
+#endif
+}
+
+int walk_missing(void)
+{
+  cpj_walk_t walk = {0};
+  void *storage = malloc(cpj_walk_storage_size(&walk) + 1);
+  bool is_walked;
+
+  errno = 0;
+  is_walked = cpj_walk(&walk, "/nonexistent/cpj_walk", storage);
+  free(storage);
+#ifdef __linux__
+  return !is_walked && errno == ENOENT ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+  return !is_walked ? EXIT_SUCCESS : EXIT_FAILURE;
+#endif
+}
@@ -0,0 +1,242 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <cpj.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A file which has been loaded using file_load. On POSIX systems the file is
+ * mapped, so the table is used right away without reading it.
+ */
+struct file
+{
+  char *data;
+  size_t size;
+  bool is_mapped;
+};
+
+static void usage(void)
+{
+  fputs(
+    "Usage: cpj-index build [--windows] <manifest> <table>\n"
+    "       cpj-index lookup <table> <path>...\n"
+    "       cpj-index descendants <table> <path>\n"
+    "\n"
+    "build        Writes a table of the paths of a manifest, which has one\n"
+    "             path per line. The paths are normalized and sorted.\n"
+    "lookup       Prints the position of every path, or fails if a path is\n"
+    "             not part of the table.\n"
+    "descendants  Prints all the paths below a path.\n",
+    stderr
+  );
+}
+
+static bool file_read(const char *name, struct file *file)
+{
+  FILE *stream = fopen(name, "rb");
+  long size;
+
+  if (stream == NULL) {
+    return false;
+  }
+  if (fseek(stream, 0, SEEK_END) != 0 || (size = ftell(stream)) < 0 ||
+      fseek(stream, 0, SEEK_SET) != 0) {
+    fclose(stream);
+    return false;
+  }
+
+  file->size = (size_t)size;
+  file->is_mapped = false;
+  file->data = malloc(file->size + 1);
+  if (file->data == NULL ||
+      fread(file->data, 1, file->size, stream) != file->size) {
+    free(file->data);
+    fclose(stream);
+    return false;
+  }
+
+  fclose(stream);
+  return true;
+}
+
+static bool file_load(const char *name, struct file *file)
+{
+#ifndef _WIN32
+  struct stat info;
+  int fd = open(name, O_RDONLY);
+
+  if (fd < 0) {
+    return false;
+  }
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  file->size = (size_t)info.st_size;
+  file->data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  file->is_mapped = true;
+  close(fd);
+  return file->data != MAP_FAILED;
+#else
+  return file_read(name, file);
+#endif
+}
+
+static void file_free(struct file *file)
+{
+#ifndef _WIN32
+  if (file->is_mapped) {
+    munmap(file->data, file->size);
+    return;
+  }
+#endif
+  free(file->data);
+}
+
+static int build(cpj_path_style_t style, const char *manifest, const char *out)
+{
+  struct file file;
+  cpj_string_t *paths, line;
+  cpj_char_t *normalized, *table;
+  size_t i, start, count = 0, offset = 0, size;
+  FILE *stream;
+
+  if (!file_read(manifest, &file)) {
+    fprintf(stderr, "cpj-index: could not read '%s'\n", manifest);
+    return EXIT_FAILURE;
+  }
+
+  // Every normalized path fits into its line plus two characters, since only
+  // a `.` may be added in front of the terminator.
+  for (i = 0; i < file.size; ++i) {
+    count += file.data[i] == '\n';
+  }
+  ++count;
+  paths = malloc(count * sizeof(*paths));
+  normalized = malloc(file.size + count * 2);
+  if (paths == NULL || normalized == NULL) {
+    fputs("cpj-index: out of memory\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  count = 0;
+  for (start = 0, i = 0; i <= file.size; ++i) {
+    if (i < file.size && file.data[i] != '\n') {
+      continue;
+    }
+    line.ptr = file.data + start;
+    line.size = i - start;
+    if (line.size > 0 && line.ptr[line.size - 1] == '\r') {
+      --line.size;
+    }
+    start = i + 1;
+    if (line.size == 0) {
+      continue;
+    }
+
+    paths[count].ptr = normalized + offset;
+    paths[count].size = cpj_path_join_multiple(
+      style, false, true, &line, 1, normalized + offset, line.size + 2
+    );
+    offset += paths[count].size + 1;
+    ++count;
+  }
+
+  cpj_path_sort(style, paths, count, CPJ_SORT_PARALLEL);
+  size = cpj_path_table_build(style, paths, count, NULL, 0);
+  table = malloc(size);
+  if (table == NULL) {
+    fputs("cpj-index: out of memory\n", stderr);
+    return EXIT_FAILURE;
+  }
+  cpj_path_table_build(style, paths, count, table, size);
+
+  stream = fopen(out, "wb");
+  if (stream == NULL || fwrite(table, 1, size, stream) != size ||
+      fclose(stream) != 0) {
+    fprintf(stderr, "cpj-index: could not write '%s'\n", out);
+    return EXIT_FAILURE;
+  }
+
+  free(table);
+  free(normalized);
+  free(paths);
+  file_free(&file);
+  return EXIT_SUCCESS;
+}
+
+static int query(int argc, char *argv[], bool is_descendants)
+{
+  struct file file;
+  cpj_path_table_t table;
+  cpj_string_t path;
+  cpj_char_t *buffer;
+  size_t buffer_size, position, count;
+  int i, result = EXIT_SUCCESS;
+
+  if (!file_load(argv[0], &file) ||
+      !cpj_path_table_open(&table, file.data, file.size)) {
+    fprintf(stderr, "cpj-index: '%s' is not a path table\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // Longer paths can not be part of the table, so the buffer only has to
+  // hold the longest path of the table.
+  buffer_size = table.max_path_size + 1;
+  buffer = malloc(buffer_size);
+  if (buffer == NULL) {
+    fputs("cpj-index: out of memory\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  for (i = 1; i < argc; ++i) {
+    cpj_string_t argument = {argv[i], strlen(argv[i])};
+    if (is_descendants) {
+      count = cpj_path_table_descendants_of(
+        &table, &argument, buffer, buffer_size, &position
+      );
+      while (count-- > 0 && cpj_path_table_get(&table, position++, &path)) {
+        printf("%s\n", path.ptr);
+      }
+    } else if (cpj_path_table_lookup(
+                 &table, &argument, buffer, buffer_size, &position
+               )) {
+      printf("%zu %s\n", position, argv[i]);
+    } else {
+      fprintf(stderr, "cpj-index: '%s' not found\n", argv[i]);
+      result = EXIT_FAILURE;
+    }
+  }
+
+  free(buffer);
+  file_free(&file);
+  return result;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc == 5 && strcmp(argv[1], "build") == 0 &&
+      strcmp(argv[2], "--windows") == 0) {
+    return build(CPJ_STYLE_WINDOWS, argv[3], argv[4]);
+  } else if (argc == 4 && strcmp(argv[1], "build") == 0) {
+    return build(CPJ_STYLE_UNIX, argv[2], argv[3]);
+  } else if (argc >= 4 && strcmp(argv[1], "lookup") == 0) {
+    return query(argc - 2, argv + 2, false);
+  } else if (argc == 4 && strcmp(argv[1], "descendants") == 0) {
+    return query(argc - 2, argv + 2, true);
+  }
+
+  usage();
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,814 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <cpj.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+
+struct iovec
+{
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
+
+#ifdef CPJ_NORMALIZE_THREADS
+#include <pthread.h>
+#endif
+
+#define CHUNK_SIZE (1 << 20)
+#define VECTOR_MAX 512
+#define THREAD_MAX 64
+
+enum operation
+{
+  OPERATION_NORMALIZE,
+  OPERATION_RELATIVE,
+  OPERATION_CHANGE_ROOT
+};
+
+struct options
+{
+  cpj_path_style_t style;
+  char delimiter;
+  enum operation operation;
+  cpj_string_t base;
+  cpj_string_t cwd;
+  cpj_rebase_rule_t rule;
+  cpj_rebase_slot_t slots[2];
+  cpj_rebase_t rebase;
+  size_t thread_count;
+  const char *file;
+};
+
+/**
+ * A part of the output of a chunk, which is either a view of the input or a
+ * part of the output buffer. Offsets are used, since the output buffer might
+ * grow while the chunk is processed.
+ */
+struct piece
+{
+  bool is_input;
+  size_t offset;
+  size_t size;
+};
+
+enum chunk_state
+{
+  CHUNK_EMPTY,
+  CHUNK_FILLED,
+  CHUNK_DONE
+};
+
+/**
+ * A run of complete records of the input, along with their results. The
+ * input is a view of the mapped file, or of the input buffer when reading
+ * from a stream.
+ */
+struct chunk
+{
+  const char *input;
+  size_t input_size;
+  char *input_buffer;
+  size_t input_capacity;
+  char *output;
+  size_t output_size;
+  size_t output_capacity;
+  struct piece *pieces;
+  size_t piece_count;
+  size_t piece_capacity;
+  size_t failed_count;
+  bool is_out_of_memory;
+  enum chunk_state state;
+};
+
+/**
+ * Cuts the input into chunks which end with a delimiter. A record which is
+ * cut off by the end of a read is carried over to the next chunk.
+ */
+struct reader
+{
+  const char *data;
+  size_t size;
+  size_t position;
+  bool is_mapped;
+  bool is_finished;
+  char *carry;
+  size_t carry_size;
+  size_t carry_capacity;
+};
+
+/**
+ * The chunks which are in flight. The main thread reads and writes them in
+ * order, while the workers process whichever filled chunk comes next.
+ */
+struct pool
+{
+  const struct options *options;
+  struct chunk *chunks;
+  size_t chunk_count;
+  size_t filled_count;
+  size_t next_process;
+  bool is_stopping;
+#ifdef CPJ_NORMALIZE_THREADS
+  pthread_mutex_t lock;
+  pthread_cond_t filled;
+  pthread_cond_t done;
+#endif
+};
+
+static void usage(void)
+{
+  fputs(
+    "Usage: cpj-normalize [options] [file]\n"
+    "\n"
+    "Reads paths from the file, or from stdin, and writes one result per\n"
+    "path to stdout. The paths are normalized unless an operation is given.\n"
+    "\n"
+    "-0, --null              Paths are separated by '\\0' instead of lines.\n"
+    "--windows               Paths are windows paths.\n"
+    "--relative-to <dir>     Writes each path relative to a directory.\n"
+    "--change-root <a> <b>   Moves the paths below a to b.\n"
+    "-j, --threads <count>   The number of threads, one per CPU by default.\n",
+    stderr
+  );
+}
+
+static bool grow(void **buffer, size_t *capacity, size_t needed, size_t size)
+{
+  size_t new_capacity = *capacity > 0 ? *capacity : 64;
+  void *new_buffer;
+
+  if (needed <= *capacity) {
+    return true;
+  }
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  new_buffer = realloc(*buffer, new_capacity * size);
+  if (new_buffer == NULL) {
+    return false;
+  }
+  *buffer = new_buffer;
+  *capacity = new_capacity;
+  return true;
+}
+
+/**
+ * Checks whether a unix path is written the way normalizing it would write
+ * it, in which case it does not have to be copied at all.
+ */
+static bool is_canonical(const char *path, size_t size)
+{
+  size_t i, start = 0;
+  bool is_leading = true;
+
+  if (size == 0) {
+    return false;
+  } else if (path[0] == '/') {
+    start = 1;
+    is_leading = false;
+  }
+  if (size == start || (size == 1 && path[0] == '.')) {
+    return true;
+  }
+  for (i = start; i <= size; ++i) {
+    if (i < size && path[i] != '/') {
+      continue;
+    }
+    // Empty and `.` segments are removed, and a `..` is only kept in front
+    // of a relative path.
+    if (i == start || (i - start == 1 && path[start] == '.')) {
+      return false;
+    } else if (i - start == 2 && path[start] == '.' &&
+               path[start + 1] == '.') {
+      if (!is_leading) {
+        return false;
+      }
+    } else {
+      is_leading = false;
+    }
+    start = i + 1;
+  }
+  return true;
+}
+
+static size_t apply(
+  const struct options *options, const cpj_string_t *path, char *buffer,
+  size_t buffer_size
+)
+{
+  switch (options->operation) {
+  case OPERATION_RELATIVE:
+    return cpj_path_get_relative(
+      options->style, &options->cwd, &options->base, path, buffer, buffer_size
+    );
+  case OPERATION_CHANGE_ROOT:
+    return cpj_path_rebase(
+      &options->rebase, options->style, path, buffer, buffer_size
+    );
+  default:
+    return cpj_path_join_multiple(
+      options->style, false, true, path, 1, buffer, buffer_size
+    );
+  }
+}
+
+static bool chunk_add_piece(
+  struct chunk *chunk, bool is_input, size_t offset, size_t size
+)
+{
+  struct piece *last;
+
+  // Adjacent pieces are merged, so a run of canonical records is written
+  // straight from the input at once.
+  if (chunk->piece_count > 0) {
+    last = chunk->pieces + chunk->piece_count - 1;
+    if (last->is_input == is_input && last->offset + last->size == offset) {
+      last->size += size;
+      return true;
+    }
+  }
+  if (!grow(
+        (void **)&chunk->pieces, &chunk->piece_capacity,
+        chunk->piece_count + 1, sizeof(*chunk->pieces)
+      )) {
+    return false;
+  }
+  chunk->pieces[chunk->piece_count].is_input = is_input;
+  chunk->pieces[chunk->piece_count].offset = offset;
+  chunk->pieces[chunk->piece_count].size = size;
+  ++chunk->piece_count;
+  return true;
+}
+
+static bool chunk_add_result(
+  const struct options *options, struct chunk *chunk, const cpj_string_t *path
+)
+{
+  size_t available = chunk->output_capacity - chunk->output_size, size;
+
+  size = apply(options, path, chunk->output + chunk->output_size, available);
+  if (size + 1 >= available) {
+    if (!grow(
+          (void **)&chunk->output, &chunk->output_capacity,
+          chunk->output_size + size + 2, 1
+        )) {
+      return false;
+    }
+    apply(
+      options, path, chunk->output + chunk->output_size,
+      chunk->output_capacity - chunk->output_size
+    );
+  }
+  chunk->failed_count += size == 0;
+  chunk->output[chunk->output_size + size] = options->delimiter;
+  if (!chunk_add_piece(chunk, false, chunk->output_size, size + 1)) {
+    return false;
+  }
+  chunk->output_size += size + 1;
+  return true;
+}
+
+static void chunk_process(const struct options *options, struct chunk *chunk)
+{
+  bool is_viewable = options->operation == OPERATION_NORMALIZE &&
+                     options->style == CPJ_STYLE_UNIX;
+  size_t position = 0, end;
+  const char *found;
+  cpj_string_t path;
+
+  chunk->output_size = 0;
+  chunk->piece_count = 0;
+  chunk->failed_count = 0;
+  chunk->is_out_of_memory = !grow(
+    (void **)&chunk->output, &chunk->output_capacity,
+    chunk->input_size + chunk->input_size / 4 + 64, 1
+  );
+  while (!chunk->is_out_of_memory && position < chunk->input_size) {
+    found = memchr(
+      chunk->input + position, options->delimiter,
+      chunk->input_size - position
+    );
+    end = found ? (size_t)(found - chunk->input) : chunk->input_size;
+    path.ptr = chunk->input + position;
+    path.size = end - position;
+    if (options->delimiter == '\n' && path.size > 0 &&
+        path.ptr[path.size - 1] == '\r') {
+      --path.size;
+    }
+
+    if (is_viewable && found && path.size == end - position &&
+        is_canonical(path.ptr, path.size)) {
+      chunk->is_out_of_memory |=
+        !chunk_add_piece(chunk, true, position, end + 1 - position);
+    } else {
+      chunk->is_out_of_memory |= !chunk_add_result(options, chunk, &path);
+    }
+    position = end + 1;
+  }
+}
+
+static bool write_all(struct iovec *vectors, int count)
+{
+#ifndef _WIN32
+  ssize_t written;
+
+  while (count > 0) {
+    written = writev(STDOUT_FILENO, vectors, count);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    } else if (written < 0) {
+      return false;
+    }
+    while (count > 0 && (size_t)written >= vectors->iov_len) {
+      written -= (ssize_t)vectors->iov_len;
+      ++vectors;
+      --count;
+    }
+    if (count > 0) {
+      vectors->iov_base = (char *)vectors->iov_base + written;
+      vectors->iov_len -= (size_t)written;
+    }
+  }
+  return true;
+#else
+  int i;
+
+  for (i = 0; i < count; ++i) {
+    if (fwrite(vectors[i].iov_base, 1, vectors[i].iov_len, stdout) !=
+        vectors[i].iov_len) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+static bool chunk_write(const struct chunk *chunk)
+{
+  struct iovec vectors[VECTOR_MAX];
+  const struct piece *piece;
+  size_t i;
+  int count = 0;
+
+  for (i = 0; i < chunk->piece_count; ++i) {
+    piece = chunk->pieces + i;
+    vectors[count].iov_base = (char *)(piece->is_input ? chunk->input
+                                                       : chunk->output) +
+                              piece->offset;
+    vectors[count].iov_len = piece->size;
+    if (++count == VECTOR_MAX) {
+      if (!write_all(vectors, count)) {
+        return false;
+      }
+      count = 0;
+    }
+  }
+  return write_all(vectors, count);
+}
+
+static void chunk_free(struct chunk *chunk)
+{
+  free(chunk->input_buffer);
+  free(chunk->output);
+  free(chunk->pieces);
+}
+
+static long read_some(char *buffer, size_t size)
+{
+#ifndef _WIN32
+  ssize_t result;
+
+  do {
+    result = read(STDIN_FILENO, buffer, size);
+  } while (result < 0 && errno == EINTR);
+  return (long)result;
+#else
+  size_t result = fread(buffer, 1, size, stdin);
+  return result == 0 && ferror(stdin) ? -1 : (long)result;
+#endif
+}
+
+/**
+ * Fills a chunk with the next records. The chunk is empty once the input is
+ * exhausted. Returns false if the input can not be read.
+ */
+static bool
+reader_next(struct reader *reader, char delimiter, struct chunk *chunk)
+{
+  size_t size, end;
+  const char *found;
+  long result;
+
+  if (reader->is_mapped) {
+    // A mapped file is cut into views, nothing is copied.
+    end = reader->position + CHUNK_SIZE;
+    found = end < reader->size ? memchr(
+                                   reader->data + end, delimiter,
+                                   reader->size - end
+                                 )
+                               : NULL;
+    end = found ? (size_t)(found - reader->data) + 1 : reader->size;
+    chunk->input = reader->data + reader->position;
+    chunk->input_size = end - reader->position;
+    reader->position = end;
+    reader->is_finished = end == reader->size;
+    return true;
+  }
+
+  if (!grow(
+        (void **)&chunk->input_buffer, &chunk->input_capacity,
+        reader->carry_size + CHUNK_SIZE, 1
+      )) {
+    return false;
+  }
+  if (reader->carry_size > 0) {
+    memcpy(chunk->input_buffer, reader->carry, reader->carry_size);
+  }
+  size = reader->carry_size;
+  reader->carry_size = 0;
+  for (;;) {
+    while (!reader->is_finished && size < chunk->input_capacity) {
+      result = read_some(
+        chunk->input_buffer + size, chunk->input_capacity - size
+      );
+      if (result < 0) {
+        return false;
+      }
+      reader->is_finished = result == 0;
+      size += (size_t)result;
+    }
+    for (end = size; end > 0 && chunk->input_buffer[end - 1] != delimiter;
+         --end) {
+    }
+    if (end > 0 || reader->is_finished) {
+      break;
+    }
+
+    // A single record fills the whole buffer, so the buffer has to grow.
+    if (!grow(
+          (void **)&chunk->input_buffer, &chunk->input_capacity, size * 2, 1
+        )) {
+      return false;
+    }
+  }
+
+  if (reader->is_finished) {
+    end = size;
+  }
+  if (size > end) {
+    if (!grow(
+          (void **)&reader->carry, &reader->carry_capacity, size - end, 1
+        )) {
+      return false;
+    }
+    memcpy(reader->carry, chunk->input_buffer + end, size - end);
+  }
+  reader->carry_size = size - end;
+  chunk->input = chunk->input_buffer;
+  chunk->input_size = end;
+  return true;
+}
+
+#ifdef CPJ_NORMALIZE_THREADS
+static void *pool_work(void *context)
+{
+  struct pool *pool = context;
+  struct chunk *chunk;
+
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (pool->next_process == pool->filled_count && !pool->is_stopping) {
+      pthread_cond_wait(&pool->filled, &pool->lock);
+    }
+    if (pool->next_process == pool->filled_count) {
+      break;
+    }
+    chunk = pool->chunks + pool->next_process++ % pool->chunk_count;
+    pthread_mutex_unlock(&pool->lock);
+    chunk_process(pool->options, chunk);
+    pthread_mutex_lock(&pool->lock);
+    chunk->state = CHUNK_DONE;
+    pthread_cond_broadcast(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+#endif
+
+/**
+ * Waits until a chunk has been processed, or tells whether it has been if
+ * `is_waiting` is false. Without workers the chunk is processed right away.
+ */
+static bool
+pool_is_done(struct pool *pool, struct chunk *chunk, bool is_waiting)
+{
+  bool is_done;
+
+#ifdef CPJ_NORMALIZE_THREADS
+  if (pool->chunk_count > 1) {
+    pthread_mutex_lock(&pool->lock);
+    while (is_waiting && chunk->state != CHUNK_DONE) {
+      pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    is_done = chunk->state == CHUNK_DONE;
+    pthread_mutex_unlock(&pool->lock);
+    return is_done;
+  }
+#endif
+  (void)is_waiting;
+  if (chunk->state == CHUNK_FILLED) {
+    chunk_process(pool->options, chunk);
+    chunk->state = CHUNK_DONE;
+  }
+  is_done = chunk->state == CHUNK_DONE;
+  return is_done;
+}
+
+static void pool_fill(struct pool *pool, struct chunk *chunk)
+{
+#ifdef CPJ_NORMALIZE_THREADS
+  pthread_mutex_lock(&pool->lock);
+  chunk->state = CHUNK_FILLED;
+  ++pool->filled_count;
+  pthread_cond_signal(&pool->filled);
+  pthread_mutex_unlock(&pool->lock);
+#else
+  chunk->state = CHUNK_FILLED;
+  ++pool->filled_count;
+#endif
+}
+
+/**
+ * Reads, processes and writes all chunks. While the workers process some
+ * chunks, the main thread reads the next ones and writes the finished ones
+ * in their original order.
+ */
+static int run(const struct options *options, struct reader *reader)
+{
+  struct chunk chunks[THREAD_MAX * 2];
+  size_t i, written_count = 0, failed_count = 0;
+  struct chunk *chunk;
+  struct pool pool;
+  int result = EXIT_SUCCESS;
+#ifdef CPJ_NORMALIZE_THREADS
+  pthread_t threads[THREAD_MAX];
+  bool has_thread[THREAD_MAX];
+  size_t thread_count = 0;
+#endif
+
+  memset(chunks, 0, sizeof(chunks));
+  memset(&pool, 0, sizeof(pool));
+  pool.options = options;
+  pool.chunks = chunks;
+  pool.chunk_count = options->thread_count > 1 ? options->thread_count * 2 : 1;
+#ifdef CPJ_NORMALIZE_THREADS
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.filled, NULL);
+  pthread_cond_init(&pool.done, NULL);
+  for (i = 0; options->thread_count > 1 && i < options->thread_count; ++i) {
+    has_thread[i] = pthread_create(threads + i, NULL, pool_work, &pool) == 0;
+    thread_count += has_thread[i];
+  }
+
+  // Without any worker the chunks are processed by the main thread.
+  if (thread_count == 0) {
+    pool.chunk_count = 1;
+  }
+#endif
+
+  for (;;) {
+    chunk = chunks + written_count % pool.chunk_count;
+    if (written_count < pool.filled_count &&
+        pool_is_done(
+          &pool, chunk,
+          reader->is_finished || pool.filled_count - written_count ==
+                                   pool.chunk_count
+        )) {
+      if (chunk->is_out_of_memory) {
+        fputs("cpj-normalize: out of memory\n", stderr);
+        result = EXIT_FAILURE;
+        break;
+      } else if (!chunk_write(chunk)) {
+        fputs("cpj-normalize: could not write the output\n", stderr);
+        result = EXIT_FAILURE;
+        break;
+      }
+      failed_count += chunk->failed_count;
+      chunk->state = CHUNK_EMPTY;
+      ++written_count;
+      continue;
+    } else if (reader->is_finished) {
+      break;
+    }
+
+    chunk = chunks + pool.filled_count % pool.chunk_count;
+    if (!reader_next(reader, options->delimiter, chunk)) {
+      fputs("cpj-normalize: could not read the input\n", stderr);
+      result = EXIT_FAILURE;
+      break;
+    }
+    if (chunk->input_size > 0) {
+      pool_fill(&pool, chunk);
+    }
+  }
+
+#ifdef CPJ_NORMALIZE_THREADS
+  pthread_mutex_lock(&pool.lock);
+  pool.is_stopping = true;
+  pthread_cond_broadcast(&pool.filled);
+  pthread_mutex_unlock(&pool.lock);
+  for (i = 0; options->thread_count > 1 && i < options->thread_count; ++i) {
+    if (has_thread[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+  pthread_cond_destroy(&pool.done);
+  pthread_cond_destroy(&pool.filled);
+  pthread_mutex_destroy(&pool.lock);
+#endif
+  for (i = 0; i < pool.chunk_count; ++i) {
+    chunk_free(chunks + i);
+  }
+
+  if (result == EXIT_SUCCESS && failed_count > 0) {
+    fprintf(stderr, "cpj-normalize: %zu paths could not be changed\n",
+      failed_count);
+    result = EXIT_FAILURE;
+  }
+  return result;
+}
+
+static bool reader_open(const char *name, struct reader *reader)
+{
+#ifndef _WIN32
+  struct stat info;
+  int fd;
+#endif
+
+  memset(reader, 0, sizeof(*reader));
+  if (name == NULL) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    return true;
+  }
+
+#ifndef _WIN32
+  fd = open(name, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return false;
+  }
+
+  // Only regular files have a size which can be mapped. Pipes and devices
+  // are read like the standard input instead.
+  if (!S_ISREG(info.st_mode)) {
+    if (fd != STDIN_FILENO && dup2(fd, STDIN_FILENO) < 0) {
+      close(fd);
+      return false;
+    }
+    if (fd != STDIN_FILENO) {
+      close(fd);
+    }
+    return true;
+  }
+  reader->size = (size_t)info.st_size;
+  reader->is_mapped = true;
+  reader->is_finished = reader->size == 0;
+  if (reader->size > 0) {
+    reader->data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (reader->data == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    posix_madvise((void *)reader->data, reader->size, POSIX_MADV_SEQUENTIAL);
+  }
+  close(fd);
+  return true;
+#else
+  return freopen(name, "rb", stdin) != NULL;
+#endif
+}
+
+static void reader_close(struct reader *reader)
+{
+#ifndef _WIN32
+  if (reader->is_mapped && reader->size > 0) {
+    munmap((void *)reader->data, reader->size);
+  }
+#endif
+  free(reader->carry);
+}
+
+static size_t get_cpu_count(void)
+{
+#if defined(CPJ_NORMALIZE_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+#else
+  return 1;
+#endif
+}
+
+static bool parse(int argc, char *argv[], struct options *options)
+{
+  static char cwd[4096];
+  int i;
+
+  memset(options, 0, sizeof(*options));
+  options->style = CPJ_STYLE_UNIX;
+  options->delimiter = '\n';
+  options->thread_count = get_cpu_count();
+  for (i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-0") == 0 || strcmp(argv[i], "--null") == 0) {
+      options->delimiter = '\0';
+    } else if (strcmp(argv[i], "--windows") == 0) {
+      options->style = CPJ_STYLE_WINDOWS;
+    } else if (strcmp(argv[i], "--relative-to") == 0 && i + 1 < argc &&
+               options->operation == OPERATION_NORMALIZE) {
+      options->operation = OPERATION_RELATIVE;
+      options->base.ptr = argv[++i];
+      options->base.size = strlen(options->base.ptr);
+    } else if (strcmp(argv[i], "--change-root") == 0 && i + 2 < argc &&
+               options->operation == OPERATION_NORMALIZE) {
+      options->operation = OPERATION_CHANGE_ROOT;
+      options->rule.from_prefix.ptr = argv[++i];
+      options->rule.from_prefix.size = strlen(argv[i]);
+      options->rule.to_prefix.ptr = argv[++i];
+      options->rule.to_prefix.size = strlen(argv[i]);
+    } else if ((strcmp(argv[i], "-j") == 0 ||
+                strcmp(argv[i], "--threads") == 0) &&
+               i + 1 < argc) {
+      options->thread_count = strtoul(argv[++i], NULL, 10);
+    } else if (argv[i][0] != '-' && options->file == NULL) {
+      options->file = argv[i];
+    } else {
+      return false;
+    }
+  }
+
+#ifdef CPJ_NORMALIZE_THREADS
+  if (options->thread_count == 0 || options->thread_count > THREAD_MAX) {
+    options->thread_count = options->thread_count == 0 ? 1 : THREAD_MAX;
+  }
+#else
+  options->thread_count = 1;
+#endif
+  if (options->operation == OPERATION_RELATIVE) {
+#ifndef _WIN32
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+#else
+    if (_getcwd(cwd, sizeof(cwd)) == NULL) {
+#endif
+      return false;
+    }
+    options->cwd.ptr = cwd;
+    options->cwd.size = strlen(cwd);
+  }
+  if (options->operation == OPERATION_CHANGE_ROOT) {
+    options->rule.from_style = options->style;
+    options->rule.to_style = options->style;
+    return cpj_rebase_init(&options->rebase, &options->rule, 1,
+      options->slots, 2);
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  struct options options;
+  struct reader reader;
+  int result;
+
+  if (!parse(argc, argv, &options)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+  if (!reader_open(options.file, &reader)) {
+    fprintf(stderr, "cpj-normalize: could not read '%s'\n", options.file);
+    return EXIT_FAILURE;
+  }
+
+  result = run(&options, &reader);
+  reader_close(&reader);
+  return result;
+}